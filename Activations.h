@@ -0,0 +1,119 @@
+#ifndef ACTIVATIONS_H
+#define ACTIVATIONS_H
+
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+
+// ============================================================================
+// Fonctions d'activation du LSTM (sigmoïde, tanh) à précision choisie
+//
+//   ACTIVATION_EXACTE    expf / tanhf de la libm (comportement d'origine)
+//   ACTIVATION_RAPIDE    exponentielle par réduction d'argument + polynôme
+//                        de degré 5 (type Cephes), sans branchement : boucles
+//                        vectorisables, écart absolu < 1e-6
+//   ACTIVATION_EMBARQUEE table de tanh sur [0, 8] au pas 1/32 (257 floats),
+//                        interpolation linéaire ; sigmoïde(x) = (1 + tanh(x/2))/2.
+//                        Ni exp ni division : cibles sans FPU rapide.
+//                        Écart absolu < 1e-4
+//
+// Le niveau est global (comme le noyau LSTM) et se choisit à l'initialisation ;
+// ACTIVATION_EXACTE par défaut. bench_soc donne l'écart de SOC de chaque
+// niveau sur le rejeu complet de ../donnees.
+// ============================================================================
+
+typedef enum
+{
+    ACTIVATION_EXACTE = 0,
+    ACTIVATION_RAPIDE,
+    ACTIVATION_EMBARQUEE,
+    ACTIVATION_NB_NIVEAUX
+} Activation_niveau;
+
+int               Activation_choisir(Activation_niveau niveau);   // 0 = OK, 1 = inconnu
+Activation_niveau Activation_active(void);
+const char       *Activation_nom(Activation_niveau niveau);
+
+// Tableaux : out[i] = f(in[i]) au niveau actif (in et out peuvent coïncider)
+void Activation_sigmoide(int n, const float *in, float *out);
+void Activation_tanh(int n, const float *in, float *out);
+
+// ----------------------------------------------------------------------------
+// Versions scalaires de chaque niveau
+// ----------------------------------------------------------------------------
+
+// Constantes de l'exponentielle rapide (aussi utilisées par les noyaux SIMD)
+#define ACT_EXP_MIN      -87.0f
+#define ACT_EXP_MAX       88.0f
+#define ACT_LOG2E         1.44269504088896341f
+#define ACT_LN2_HAUT      0.693359375f
+#define ACT_LN2_BAS      -2.12194440e-4f
+#define ACT_ARRONDI       12582912.0f           // 1.5 * 2^23
+#define ACT_P0            1.9875691500e-4f
+#define ACT_P1            1.3981999507e-3f
+#define ACT_P2            8.3334519073e-3f
+#define ACT_P3            4.1665795894e-2f
+#define ACT_P4            1.6666665459e-1f
+#define ACT_P5            5.0000001201e-1f
+
+static inline float act_exp_rapide(float x)
+{
+    x = x < ACT_EXP_MIN ? ACT_EXP_MIN : x;
+    x = x > ACT_EXP_MAX ? ACT_EXP_MAX : x;
+
+    // x = n ln2 + r, |r| <= ln2/2 ; n arrondi par ajout de 1.5 * 2^23
+    float t = x * ACT_LOG2E + ACT_ARRONDI;
+    float n = t - ACT_ARRONDI;
+    float r = x - n * ACT_LN2_HAUT - n * ACT_LN2_BAS;
+
+    float p = ACT_P0;
+    p = p * r + ACT_P1;
+    p = p * r + ACT_P2;
+    p = p * r + ACT_P3;
+    p = p * r + ACT_P4;
+    p = p * r + ACT_P5;
+    float y = p * r * r + r + 1.0f;
+
+    // 2^n : n est dans les bits de poids faible de t
+    uint32_t bits_t, bits_e;
+    memcpy(&bits_t, &t, sizeof(bits_t));
+    bits_e = (bits_t - 0x4B400000u + 127u) << 23;
+    float deux_n;
+    memcpy(&deux_n, &bits_e, sizeof(deux_n));
+    return y * deux_n;
+}
+
+static inline float act_sigmoide_rapide(float x)
+{
+    return 1.0f / (1.0f + act_exp_rapide(-x));
+}
+
+static inline float act_tanh_rapide(float x)
+{
+    return 1.0f - 2.0f / (act_exp_rapide(2.0f * x) + 1.0f);
+}
+
+#define ACT_TABLE_PAS_INV  32.0f
+#define ACT_TABLE_N        257
+extern const float ACT_TABLE_TANH[ACT_TABLE_N];
+
+static inline float act_tanh_embarquee(float x)
+{
+    float u = fabsf(x) * ACT_TABLE_PAS_INV;
+    float r;
+    if (!(u < (float)(ACT_TABLE_N - 1))) {
+        r = ACT_TABLE_TANH[ACT_TABLE_N - 1];
+    } else {
+        int   i = (int)u;
+        float a = u - (float)i;
+        r = ACT_TABLE_TANH[i] + a * (ACT_TABLE_TANH[i + 1] - ACT_TABLE_TANH[i]);
+    }
+    return x < 0.0f ? -r : r;
+}
+
+static inline float act_sigmoide_embarquee(float x)
+{
+    return 0.5f + 0.5f * act_tanh_embarquee(0.5f * x);
+}
+
+#endif // ACTIVATIONS_H
@@ -0,0 +1,295 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Codec_flottant.h"
+
+// ============================================================================
+// Helpers internes
+// ============================================================================
+
+static inline uint32_t bits_float(float v)
+{
+    uint32_t b;
+    memcpy(&b, &v, sizeof(b));
+    return b;
+}
+
+static inline float float_bits(uint32_t b)
+{
+    float v;
+    memcpy(&v, &b, sizeof(v));
+    return v;
+}
+
+// 64 bits big-endian à partir de p (le flux est écrit bit de poids fort d'abord)
+static inline uint64_t lire_be64(const uint8_t *p)
+{
+#if defined(__GNUC__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t w;
+    memcpy(&w, p, sizeof(w));
+    return __builtin_bswap64(w);
+#else
+    uint64_t w = 0;
+    for (int i = 0; i < 8; ++i) w = (w << 8) | p[i];
+    return w;
+#endif
+}
+
+static inline int zeros_tete(uint32_t x)
+{
+#if defined(__GNUC__)
+    return __builtin_clz(x);
+#else
+    int n = 0;
+    while (!(x & 0x80000000u)) { x <<= 1; ++n; }
+    return n;
+#endif
+}
+
+static inline int zeros_queue(uint32_t x)
+{
+#if defined(__GNUC__)
+    return __builtin_ctz(x);
+#else
+    int n = 0;
+    while (!(x & 1u)) { x >>= 1; ++n; }
+    return n;
+#endif
+}
+
+// Écriture bit à bit (bits de poids fort d'abord), n <= 32
+typedef struct
+{
+    uint8_t *sortie;
+    size_t   position;
+    uint64_t accu;
+    int      nb_bits;
+} Ecrivain_bits;
+
+static inline void ecrire_bits(Ecrivain_bits *e, uint32_t valeur, int n)
+{
+    e->accu     = (e->accu << n) | valeur;
+    e->nb_bits += n;
+    while (e->nb_bits >= 8) {
+        e->nb_bits -= 8;
+        e->sortie[e->position++] = (uint8_t)(e->accu >> e->nb_bits);
+    }
+}
+
+// ============================================================================
+// Un bloc
+// ============================================================================
+
+size_t Codec_encoder_bloc(const float *src, size_t n, uint8_t *dst)
+{
+    Ecrivain_bits e = {dst, 0, 0, 0};
+    if (n == 0) return 0;
+
+    uint32_t precedent = bits_float(src[0]);
+    ecrire_bits(&e, precedent, 32);
+
+    // fenêtre courante : zéros de tête / de queue du dernier XOR codé
+    int tete = 0, queue = 0;
+
+    for (size_t i = 1; i < n; ++i)
+    {
+        uint32_t v = bits_float(src[i]);
+        uint32_t x = v ^ precedent;
+        precedent  = v;
+
+        if (x == 0) {
+            ecrire_bits(&e, 0, 1);
+            continue;
+        }
+
+        int zt = zeros_tete(x);
+        int zq = zeros_queue(x);
+        int longueur_fenetre = 32 - tete - queue;
+        int longueur         = 32 - zt - zq;
+
+        // On garde la fenêtre si le XOR y tient et qu'elle n'est pas plus
+        // coûteuse qu'une nouvelle (10 bits d'en-tête en plus)
+        if (zt >= tete && zq >= queue && longueur_fenetre <= longueur + 10) {
+            ecrire_bits(&e, 2, 2);                      // '10'
+            ecrire_bits(&e, x >> queue, longueur_fenetre);
+        } else {
+            ecrire_bits(&e, 3, 2);                      // '11'
+            ecrire_bits(&e, (uint32_t)zt, 5);
+            ecrire_bits(&e, (uint32_t)(longueur - 1), 5);
+            ecrire_bits(&e, x >> zq, longueur);
+            tete  = zt;
+            queue = zq;
+        }
+    }
+
+    // Dernier octet incomplet, puis bourrage pour la lecture 64 bits
+    if (e.nb_bits > 0)
+        e.sortie[e.position++] = (uint8_t)(e.accu << (8 - e.nb_bits));
+    memset(e.sortie + e.position, 0, 8);
+    return e.position + 8;
+}
+
+int Codec_decoder_bloc(const uint8_t *src, size_t taille, size_t n, float *dst)
+{
+    if (n == 0) return 0;
+    if (taille < 12) return 1;
+
+    // Chaque valeur occupe au plus 44 bits : une lecture de 64 bits à
+    // l'octet courant (décalage < 8) suffit, tant qu'il reste 8 octets.
+    const size_t limite = taille - 8;
+
+    uint32_t precedent = (uint32_t)(lire_be64(src) >> 32);
+    dst[0] = float_bits(precedent);
+    size_t bit = 32;
+
+    int tete = 0, queue = 0;
+
+    for (size_t i = 1; i < n; ++i)
+    {
+        size_t octet = bit >> 3;
+        if (octet > limite) return 1;
+        uint64_t w = lire_be64(src + octet) << (bit & 7);
+
+        if (!(w >> 63)) {
+            bit += 1;                                   // '0' : valeur répétée
+        } else if (!((w >> 62) & 1)) {
+            int longueur = 32 - tete - queue;           // '10' : même fenêtre
+            uint32_t x = (uint32_t)((w << 2) >> (64 - longueur));
+            precedent ^= x << queue;
+            bit += 2 + (size_t)longueur;
+        } else {
+            tete         = (int)((w >> 57) & 31);       // '11' : nouvelle fenêtre
+            int longueur = (int)((w >> 52) & 31) + 1;
+            if (tete + longueur > 32) return 1;
+            queue = 32 - tete - longueur;
+            uint32_t x = (uint32_t)((w << 12) >> (64 - longueur));
+            precedent ^= x << queue;
+            bit += 12 + (size_t)longueur;
+        }
+
+        dst[i] = float_bits(precedent);
+    }
+
+    // Les derniers bits lus doivent être dans la partie utile du bloc
+    return ((bit + 7) >> 3) > limite ? 1 : 0;
+}
+
+// ============================================================================
+// Flux complet
+// ============================================================================
+
+static size_t taille_index(uint64_t nb_blocs)
+{
+    return sizeof(Codec_entete) + (size_t)(nb_blocs + 1) * sizeof(uint64_t);
+}
+
+int Codec_compresser(const float *src, size_t n, uint8_t **flux, size_t *taille)
+{
+    *flux   = NULL;
+    *taille = 0;
+
+    uint64_t nb_blocs = (n + CODEC_VALEURS_BLOC - 1) / CODEC_VALEURS_BLOC;
+    size_t   debut    = taille_index(nb_blocs);
+
+    // Pire cas : aucun gain (on réduit l'allocation à la fin)
+    size_t capacite = debut + (size_t)nb_blocs * CODEC_TAILLE_MAX_BLOC(CODEC_VALEURS_BLOC);
+    uint8_t *sortie = (uint8_t *)malloc(capacite);
+    if (!sortie) {
+        perror("Erreur allocation compression");
+        return 1;
+    }
+
+    Codec_entete e;
+    memset(&e, 0, sizeof(e));
+    memcpy(e.magique, CODEC_MAGIQUE, 4);
+    e.valeurs_bloc = CODEC_VALEURS_BLOC;
+    e.nb_valeurs   = n;
+    e.nb_blocs     = nb_blocs;
+    memcpy(sortie, &e, sizeof(e));
+
+    uint64_t *index = (uint64_t *)(sortie + sizeof(e));
+    size_t position = debut;
+
+    for (uint64_t b = 0; b < nb_blocs; ++b) {
+        size_t premier = (size_t)b * CODEC_VALEURS_BLOC;
+        size_t nb      = (n - premier < CODEC_VALEURS_BLOC) ? n - premier : CODEC_VALEURS_BLOC;
+        index[b]  = position;
+        position += Codec_encoder_bloc(src + premier, nb, sortie + position);
+    }
+    index[nb_blocs] = position;
+
+    uint8_t *ajuste = (uint8_t *)realloc(sortie, position);
+    *flux   = ajuste ? ajuste : sortie;
+    *taille = position;
+    return 0;
+}
+
+int Codec_verifier(const uint8_t *flux, size_t taille)
+{
+    Codec_entete e;
+    if (taille < sizeof(e)) return 1;
+    memcpy(&e, flux, sizeof(e));
+
+    if (memcmp(e.magique, CODEC_MAGIQUE, 4) != 0 || e.valeurs_bloc == 0 ||
+        e.valeurs_bloc > CODEC_VALEURS_BLOC ||
+        e.nb_blocs != (e.nb_valeurs + e.valeurs_bloc - 1) / e.valeurs_bloc ||
+        e.nb_blocs >= (taille - sizeof(e)) / sizeof(uint64_t)) {
+        return 1;
+    }
+
+    const uint8_t *index = flux + sizeof(e);
+    uint64_t precedent = taille_index(e.nb_blocs);
+    for (uint64_t b = 0; b <= e.nb_blocs; ++b) {
+        uint64_t position;
+        memcpy(&position, index + b * sizeof(uint64_t), sizeof(position));
+        if ((b == 0 && position != precedent) || position < precedent || position > taille)
+            return 1;
+        precedent = position;
+    }
+    return 0;
+}
+
+size_t Codec_nb_valeurs(const uint8_t *flux)
+{
+    Codec_entete e;
+    memcpy(&e, flux, sizeof(e));
+    return (size_t)e.nb_valeurs;
+}
+
+int Codec_lire(const uint8_t *flux, size_t taille, size_t debut, size_t nb, float *dst)
+{
+    Codec_entete e;
+    memcpy(&e, flux, sizeof(e));
+    if (debut + nb > e.nb_valeurs || e.valeurs_bloc > CODEC_VALEURS_BLOC) return 1;
+
+    const uint8_t *index = flux + sizeof(e);
+    float tampon[CODEC_VALEURS_BLOC];
+
+    while (nb > 0)
+    {
+        size_t b       = debut / e.valeurs_bloc;
+        size_t premier = b * e.valeurs_bloc;
+        size_t nb_bloc = ((size_t)e.nb_valeurs - premier < e.valeurs_bloc)
+                       ? (size_t)e.nb_valeurs - premier : e.valeurs_bloc;
+
+        uint64_t position[2];
+        memcpy(position, index + b * sizeof(uint64_t), sizeof(position));
+        if (position[1] > taille || position[0] > position[1]) return 1;
+
+        // Bloc entier demandé : décodage direct dans la destination
+        size_t saut   = debut - premier;
+        size_t utiles = nb_bloc - saut;
+        if (utiles > nb) utiles = nb;
+        float *cible  = (saut == 0 && utiles == nb_bloc) ? dst : tampon;
+
+        if (Codec_decoder_bloc(flux + position[0], (size_t)(position[1] - position[0]),
+                               nb_bloc, cible) != 0)
+            return 1;
+        if (cible == tampon) memcpy(dst, tampon + saut, utiles * sizeof(float));
+
+        dst   += utiles;
+        debut += utiles;
+        nb    -= utiles;
+    }
+    return 0;
+}
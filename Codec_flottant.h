@@ -0,0 +1,69 @@
+#ifndef CODEC_FLOTTANT_H
+#define CODEC_FLOTTANT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ============================================================================
+// Compression sans perte de séries float (XOR des valeurs successives)
+//
+// Les traces à 1 Hz varient lentement : deux floats successifs partagent
+// signe, exposant et les bits de poids fort de la mantisse. On code le XOR
+// avec la valeur précédente (schéma "Gorilla") :
+//   '0'                          XOR nul (valeur répétée)
+//   '10' + bits utiles           XOR dans la même fenêtre que le précédent
+//   '11' + 5 b zéros de tête + 5 b (longueur-1) + bits utiles
+// La première valeur d'un bloc est stockée telle quelle (32 bits).
+//
+// Les blocs de CODEC_VALEURS_BLOC valeurs sont indépendants : un flux
+// compressé commence par un index des blocs, ce qui permet de décoder
+// n'importe quelle plage sans repartir du début.
+// Les bits sont comparés, pas les valeurs : -0.0, NaN... sont restitués
+// à l'identique.
+// ============================================================================
+
+#define CODEC_MAGIQUE        "PRTX"
+#define CODEC_VALEURS_BLOC   4096
+
+// Taille maximale d'un bloc codé de n valeurs (44 bits au pire par valeur,
+// + 8 octets de bourrage qui permettent au décodeur de lire 64 bits d'un coup)
+#define CODEC_TAILLE_MAX_BLOC(n)  ((((size_t)(n) * 44u) + 7u) / 8u + 8u)
+
+// En-tête d'un flux compressé, suivi de uint64 index[nb_blocs + 1]
+// (position de chaque bloc depuis le début du flux, le dernier = fin)
+typedef struct
+{
+    char     magique[4];     // "PRTX"
+    uint32_t valeurs_bloc;
+    uint64_t nb_valeurs;
+    uint64_t nb_blocs;
+} Codec_entete;
+
+// ----------------------------------------------------------------------------
+// Un bloc (au plus CODEC_VALEURS_BLOC valeurs)
+// ----------------------------------------------------------------------------
+
+// Codage de n valeurs dans dst (capacité CODEC_TAILLE_MAX_BLOC(n)).
+// Renvoie le nombre d'octets écrits.
+size_t Codec_encoder_bloc(const float *src, size_t n, uint8_t *dst);
+
+// Décodage de n valeurs (0 = OK, 1 = bloc corrompu ou tronqué)
+int Codec_decoder_bloc(const uint8_t *src, size_t taille, size_t n, float *dst);
+
+// ----------------------------------------------------------------------------
+// Flux complet (en-tête + index + blocs)
+// ----------------------------------------------------------------------------
+
+// Compression de n valeurs ; *flux est alloué avec malloc (0 = OK, 1 = erreur)
+int Codec_compresser(const float *src, size_t n, uint8_t **flux, size_t *taille);
+
+// Vérification de l'en-tête et de l'index (0 = OK, 1 = erreur)
+int Codec_verifier(const uint8_t *flux, size_t taille);
+
+// Nombre de valeurs d'un flux vérifié
+size_t Codec_nb_valeurs(const uint8_t *flux);
+
+// Décodage des valeurs [debut, debut + nb) d'un flux vérifié (0 = OK, 1 = erreur)
+int Codec_lire(const uint8_t *flux, size_t taille, size_t debut, size_t nb, float *dst);
+
+#endif // CODEC_FLOTTANT_H
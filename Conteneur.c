@@ -0,0 +1,261 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Conteneur.h"
+#include "Codec_flottant.h"
+#include "Read_Write.h"
+
+// ============================================================================
+// Helpers internes
+// ============================================================================
+
+static size_t taille_type(uint32_t type)
+{
+    switch (type) {
+    case CONTENEUR_F32:     return sizeof(float);
+    case CONTENEUR_I32:     return sizeof(int32_t);
+    case CONTENEUR_F32_XOR: return sizeof(float);   // avant compression
+    default:                return 0;
+    }
+}
+
+static uint64_t aligne(uint64_t position)
+{
+    return (position + CONTENEUR_ALIGNEMENT - 1) / CONTENEUR_ALIGNEMENT * CONTENEUR_ALIGNEMENT;
+}
+
+// ============================================================================
+// Lecture
+// ============================================================================
+
+int Conteneur_verifier_entete(const Conteneur_entete *e, uint64_t taille_fichier, const char *chemin)
+{
+    if (memcmp(e->magique, CONTENEUR_MAGIQUE, 4) != 0) {
+        printf("Erreur : %s n'est pas un conteneur PRTC\n", chemin);
+        return 1;
+    }
+    if (e->version < CONTENEUR_VERSION_MIN || e->version > CONTENEUR_VERSION) {
+        printf("Erreur : %s version %u non supportee (attendu %d a %d)\n",
+               chemin, e->version, CONTENEUR_VERSION_MIN, CONTENEUR_VERSION);
+        return 1;
+    }
+    if (e->nb_canaux == 0 || e->nb_canaux > CONTENEUR_CANAUX_MAX) {
+        printf("Erreur : %s nombre de canaux invalide (%u)\n", chemin, e->nb_canaux);
+        return 1;
+    }
+
+    // Chaque colonne doit être alignée, de la bonne longueur et dans le fichier
+    for (uint32_t k = 0; k < e->nb_canaux; ++k) {
+        const Conteneur_canal *canal = &e->canaux[k];
+        size_t t = taille_type(canal->type);
+        if (canal->type == CONTENEUR_F32_XOR && e->version < 2) t = 0;   // inconnu en version 1
+
+        // la taille d'un canal compressé dépend des données
+        int longueur_ok = (canal->type == CONTENEUR_F32_XOR)
+                        ? canal->taille_octets >= sizeof(Codec_entete)
+                        : canal->taille_octets == e->nb_echantillons * t;
+
+        if (memchr(canal->nom, '\0', CONTENEUR_NOM_MAX) == NULL || t == 0 ||
+            canal->offset % CONTENEUR_ALIGNEMENT != 0 || !longueur_ok ||
+            canal->offset > taille_fichier ||
+            canal->taille_octets > taille_fichier - canal->offset) {
+            printf("Erreur : %s canal %u invalide\n", chemin, k);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int Conteneur_ouvrir(Conteneur *c, const char *chemin)
+{
+    if (!c) return 1;
+    c->base   = NULL;
+    c->taille = 0;
+    c->entete = NULL;
+
+    size_t taille = 0;
+    const uint8_t *base = (const uint8_t *)Mappe_fichier(chemin, &taille);
+    if (!base) return 1;
+
+    if (taille < sizeof(Conteneur_entete) ||
+        Conteneur_verifier_entete((const Conteneur_entete *)base, taille, chemin) != 0) {
+        Demappe_fichier(base);
+        return 1;
+    }
+
+    // Canaux compressés : index des blocs et nombre de valeurs
+    const Conteneur_entete *e = (const Conteneur_entete *)base;
+    for (uint32_t k = 0; k < e->nb_canaux; ++k) {
+        const Conteneur_canal *canal = &e->canaux[k];
+        if (canal->type != CONTENEUR_F32_XOR) continue;
+
+        const uint8_t *flux = base + canal->offset;
+        if (Codec_verifier(flux, (size_t)canal->taille_octets) != 0 ||
+            Codec_nb_valeurs(flux) != e->nb_echantillons) {
+            printf("Erreur : %s canal compresse %s invalide\n", chemin, canal->nom);
+            Demappe_fichier(base);
+            return 1;
+        }
+    }
+
+    c->base   = base;
+    c->taille = taille;
+    c->entete = (const Conteneur_entete *)base;
+    return 0;
+}
+
+void Conteneur_fermer(Conteneur *c)
+{
+    if (!c || !c->base) return;
+    Demappe_fichier(c->base);
+    c->base   = NULL;
+    c->taille = 0;
+    c->entete = NULL;
+}
+
+const Conteneur_canal *Conteneur_trouver_canal(const Conteneur *c, const char *nom)
+{
+    if (!c || !c->entete) return NULL;
+
+    for (uint32_t k = 0; k < c->entete->nb_canaux; ++k) {
+        if (strcmp(c->entete->canaux[k].nom, nom) == 0)
+            return &c->entete->canaux[k];
+    }
+    return NULL;
+}
+
+static const void *vue_canal(const Conteneur *c, const char *nom, uint32_t type, size_t *nb)
+{
+    if (nb) *nb = 0;
+
+    const Conteneur_canal *canal = Conteneur_trouver_canal(c, nom);
+    if (!canal) {
+        printf("Erreur : canal %s absent du conteneur\n", nom);
+        return NULL;
+    }
+    if (canal->type != type) {
+        printf("Erreur : canal %s de type %u (attendu %u)\n", nom, canal->type, type);
+        return NULL;
+    }
+
+    if (nb) *nb = (size_t)c->entete->nb_echantillons;
+    return c->base + canal->offset;
+}
+
+const float *Conteneur_canal_f32(const Conteneur *c, const char *nom, size_t *nb)
+{
+    return (const float *)vue_canal(c, nom, CONTENEUR_F32, nb);
+}
+
+const int32_t *Conteneur_canal_i32(const Conteneur *c, const char *nom, size_t *nb)
+{
+    return (const int32_t *)vue_canal(c, nom, CONTENEUR_I32, nb);
+}
+
+int Conteneur_lire_f32(const Conteneur *c, const char *nom, size_t debut, size_t nb, float *dst)
+{
+    const Conteneur_canal *canal = Conteneur_trouver_canal(c, nom);
+    if (!canal || (canal->type != CONTENEUR_F32 && canal->type != CONTENEUR_F32_XOR)) {
+        printf("Erreur : canal float %s absent du conteneur\n", nom);
+        return 1;
+    }
+    if (debut > c->entete->nb_echantillons || nb > c->entete->nb_echantillons - debut) {
+        printf("Erreur : lecture hors du canal %s\n", nom);
+        return 1;
+    }
+
+    const uint8_t *donnees = c->base + canal->offset;
+    if (canal->type == CONTENEUR_F32) {
+        memcpy(dst, (const float *)donnees + debut, nb * sizeof(float));
+        return 0;
+    }
+
+    if (Codec_lire(donnees, (size_t)canal->taille_octets, debut, nb, dst) != 0) {
+        printf("Erreur : decodage du canal %s\n", nom);
+        return 1;
+    }
+    return 0;
+}
+
+// ============================================================================
+// Écriture
+// ============================================================================
+
+int Conteneur_ecrire(const char *chemin,
+                     double periode_s,
+                     size_t nb_echantillons,
+                     int nb_canaux,
+                     const char *const noms[],
+                     const uint32_t types[],
+                     const void *const donnees[])
+{
+    if (nb_canaux <= 0 || nb_canaux > CONTENEUR_CANAUX_MAX) {
+        printf("Erreur : nombre de canaux invalide (%d)\n", nb_canaux);
+        return 1;
+    }
+
+    Conteneur_entete e;
+    memset(&e, 0, sizeof(e));
+    memcpy(e.magique, CONTENEUR_MAGIQUE, 4);
+    e.version         = CONTENEUR_VERSION;
+    e.nb_canaux       = (uint32_t)nb_canaux;
+    e.periode_s       = periode_s;
+    e.nb_echantillons = nb_echantillons;
+
+    // Colonnes compressées : le flux est produit avant l'en-tête (sa taille
+    // n'est connue qu'après compression)
+    uint8_t *compresses[CONTENEUR_CANAUX_MAX] = {NULL};
+    int erreur = 0;
+
+    uint64_t position = aligne(sizeof(Conteneur_entete));
+    for (int k = 0; k < nb_canaux && !erreur; ++k) {
+        size_t t = taille_type(types[k]);
+        if (t == 0 || strlen(noms[k]) >= CONTENEUR_NOM_MAX) {
+            printf("Erreur : canal %s invalide\n", noms[k]);
+            erreur = 1;
+            break;
+        }
+        strcpy(e.canaux[k].nom, noms[k]);
+        e.canaux[k].type          = types[k];
+        e.canaux[k].offset        = position;
+        e.canaux[k].taille_octets = (uint64_t)nb_echantillons * t;
+
+        if (types[k] == CONTENEUR_F32_XOR) {
+            size_t taille = 0;
+            erreur = Codec_compresser((const float *)donnees[k], nb_echantillons,
+                                      &compresses[k], &taille);
+            e.canaux[k].taille_octets = taille;
+        }
+        position = aligne(position + e.canaux[k].taille_octets);
+    }
+
+    FILE *f = erreur ? NULL : fopen(chemin, "wb");
+    if (!f) {
+        if (!erreur) perror("Erreur ouverture fichier");
+        for (int k = 0; k < nb_canaux; ++k) free(compresses[k]);
+        return 1;
+    }
+
+    static const uint8_t zeros[CONTENEUR_ALIGNEMENT] = {0};
+    int ok = (fwrite(&e, 1, sizeof(e), f) == sizeof(e));
+    position = sizeof(e);
+
+    for (int k = 0; k < nb_canaux && ok; ++k) {
+        // bourrage jusqu'au début de la colonne
+        size_t bourrage = (size_t)(e.canaux[k].offset - position);
+        size_t t        = (size_t)e.canaux[k].taille_octets;
+        const void *colonne = compresses[k] ? (const void *)compresses[k] : donnees[k];
+        ok = (fwrite(zeros, 1, bourrage, f) == bourrage) &&
+             (fwrite(colonne, 1, t, f) == t);
+        position = e.canaux[k].offset + t;
+    }
+
+    for (int k = 0; k < nb_canaux; ++k) free(compresses[k]);
+
+    if (fclose(f) != 0) ok = 0;
+    if (!ok) {
+        printf("Erreur ecriture %s\n", chemin);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,90 @@
+#ifndef CONTENEUR_H
+#define CONTENEUR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ============================================================================
+// Conteneur de télémétrie multi-canaux auto-descriptif (.prt)
+//
+// Un seul fichier remplace le jeu courant/tension/temperature/SOH/SOC.bin :
+//   - un en-tête fixe : nom, type, position et taille de chaque canal,
+//     période d'échantillonnage et nombre d'échantillons ;
+//   - puis les colonnes, chacune alignée sur 64 octets.
+// Le fichier est projeté en mémoire en une seule fois ; seules les pages
+// des canaux réellement lus sont chargées.
+// Format little-endian (x86 / ARM).
+// ============================================================================
+
+#define CONTENEUR_MAGIQUE     "PRTC"
+#define CONTENEUR_VERSION     2   // 2 : type CONTENEUR_F32_XOR
+#define CONTENEUR_VERSION_MIN 1   // 1 : lu tant qu'il n'a pas de canal compressé
+#define CONTENEUR_ALIGNEMENT  64
+#define CONTENEUR_NOM_MAX     16
+#define CONTENEUR_CANAUX_MAX  16
+
+// Types des colonnes
+#define CONTENEUR_F32  1   // float 32 bits
+#define CONTENEUR_I32  2   // int 32 bits
+#define CONTENEUR_F32_XOR  3   // float 32 bits compressé (Codec_flottant.h), version >= 2
+
+typedef struct
+{
+    char     nom[CONTENEUR_NOM_MAX];  // terminé par '\0'
+    uint32_t type;                    // CONTENEUR_F32, CONTENEUR_I32
+    uint32_t reserve;
+    uint64_t offset;                  // depuis le début du fichier (multiple de 64)
+    uint64_t taille_octets;           // taille de la colonne (flux compressé pour F32_XOR)
+} Conteneur_canal;
+
+typedef struct
+{
+    char     magique[4];              // "PRTC"
+    uint32_t version;
+    uint32_t nb_canaux;
+    uint32_t reserve;
+    double   periode_s;               // période d'échantillonnage (s)
+    uint64_t nb_echantillons;         // identique pour tous les canaux
+    Conteneur_canal canaux[CONTENEUR_CANAUX_MAX];
+} Conteneur_entete;
+
+// Conteneur ouvert (projection mémoire en lecture seule)
+typedef struct
+{
+    const uint8_t          *base;
+    size_t                  taille;
+    const Conteneur_entete *entete;
+} Conteneur;
+
+// Vérification d'un en-tête lu par ailleurs (0 = OK, 1 = erreur)
+int Conteneur_verifier_entete(const Conteneur_entete *e, uint64_t taille_fichier, const char *chemin);
+
+// Ouverture + vérification complète de l'en-tête (0 = OK, 1 = erreur)
+int Conteneur_ouvrir(Conteneur *c, const char *chemin);
+void Conteneur_fermer(Conteneur *c);
+
+// Descripteur d'un canal par son nom (NULL si absent)
+const Conteneur_canal *Conteneur_trouver_canal(const Conteneur *c, const char *nom);
+
+// Vues typées sur un canal (NULL si absent ou de mauvais type)
+// nb (optionnel) reçoit le nombre d'échantillons
+// Un canal compressé n'a pas de vue : utiliser Conteneur_lire_f32.
+const float   *Conteneur_canal_f32(const Conteneur *c, const char *nom, size_t *nb);
+const int32_t *Conteneur_canal_i32(const Conteneur *c, const char *nom, size_t *nb);
+
+// Copie des échantillons [debut, debut + nb) d'un canal float, compressé
+// ou non, dans dst (0 = OK, 1 = erreur)
+int Conteneur_lire_f32(const Conteneur *c, const char *nom, size_t debut, size_t nb, float *dst);
+
+// Écriture d'un conteneur : nb_canaux colonnes de nb_echantillons valeurs
+// Les colonnes de type CONTENEUR_F32_XOR sont fournies en float bruts et
+// compressées à l'écriture. (0 = OK, 1 = erreur)
+int Conteneur_ecrire(const char *chemin,
+                     double periode_s,
+                     size_t nb_echantillons,
+                     int nb_canaux,
+                     const char *const noms[],
+                     const uint32_t types[],
+                     const void *const donnees[]);
+
+#endif // CONTENEUR_H
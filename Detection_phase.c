@@ -0,0 +1,46 @@
+#include "Detection_phase.h"
+
+// ============================================================================
+// Initialisation
+// ============================================================================
+
+void Detection_init(Detection_Context *ctx)
+{
+    if (!ctx) return;
+
+    for (int k = 0; k < DETECTION_NB; ++k) ctx->tampon[k] = 0.0f;
+    ctx->indice = 0;
+    ctx->somme  = 0.0f;
+    ctx->etat   = 0;
+}
+
+// ============================================================================
+// Step : mise à jour de la moyenne glissante et de l'état
+// ============================================================================
+
+int Detection_step(Detection_Context *ctx, float courant)
+{
+    const int i = ctx->indice;
+    const float ancien = ctx->tampon[i];
+    ctx->tampon[i] = courant;
+    ctx->indice = (i + 1 < DETECTION_NB) ? i + 1 : 0;
+
+    if (ctx->indice == 0) {
+        // Fin de tour : somme complète, du plus récent au plus ancien
+        float somme = 0.0f;
+        for (int k = DETECTION_NB - 1; k >= 0; --k) somme += ctx->tampon[k];
+        ctx->somme = somme;
+    } else {
+        ctx->somme += courant - ancien;
+    }
+
+    float moyenne_charge_decharge = ctx->somme / (float)DETECTION_NB;
+
+    // Mise à jour de l'état charge/décharge
+    if (moyenne_charge_decharge > DETECTION_SEUIL_DECHARGE && ctx->etat == 0)
+        ctx->etat = 1;      // on était en charge, on passe en décharge
+    else if (moyenne_charge_decharge < DETECTION_SEUIL_CHARGE && ctx->etat == 1)
+        ctx->etat = 0;      // on était en décharge, on passe en charge
+
+    return ctx->etat;
+}
@@ -0,0 +1,41 @@
+#ifndef DETECTION_PHASE_H
+#define DETECTION_PHASE_H
+
+// ============================================================================
+// Détection de la phase charge/décharge (detection_phase_charge_decharge.m)
+//
+// Moyenne glissante du courant sur DETECTION_NB échantillons, avec
+// hystérésis : passage en décharge (etat = 1) quand la moyenne dépasse
+// DETECTION_SEUIL_DECHARGE en charge, retour en charge (etat = 0) quand elle
+// passe sous DETECTION_SEUIL_CHARGE en décharge.
+//
+// Tampon circulaire et somme courante : une écriture, une addition et une
+// soustraction par échantillon au lieu du décalage et de la somme des 60
+// valeurs. La somme est recalculée à chaque tour du tampon, dans l'ordre de
+// la somme d'origine (du plus récent au plus ancien), ce qui borne la dérive
+// des arrondis à un tour.
+//
+// Un seul détecteur par boucle : etat est calculé une fois par échantillon
+// et passé aux modules (TENSION_step, SOH_step_etat, SOP_step_deux_sens).
+// ============================================================================
+
+#define DETECTION_NB             60
+#define DETECTION_SEUIL_DECHARGE 0.1f   // A, charge -> décharge
+#define DETECTION_SEUIL_CHARGE   -1.0f  // A, décharge -> charge
+
+typedef struct
+{
+    float tampon[DETECTION_NB];
+    int   indice;               // prochaine case écrite (la plus ancienne)
+    float somme;
+    int   etat;                 // 0 = charge, 1 = décharge
+} Detection_Context;
+
+// Tampon nul, etat = 0 (charge)
+void Detection_init(Detection_Context *ctx);
+
+// Un échantillon. courant : convention de la simulation (-courant mesuré,
+// comme courant_simulation des scripts). Retour : etat
+int Detection_step(Detection_Context *ctx, float courant);
+
+#endif // DETECTION_PHASE_H
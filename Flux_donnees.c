@@ -0,0 +1,278 @@
+// Positions > 2 Go dans les fichiers (Raspberry Pi 32 bits)
+#define _FILE_OFFSET_BITS 64
+
+#include <stdlib.h>
+#include <string.h>
+#include "Flux_donnees.h"
+#include "Conteneur.h"
+#include "Read_Write.h"
+
+#ifdef _WIN32
+#define fseek64 _fseeki64
+#define ftell64 _ftelli64
+#else
+#define fseek64 fseeko
+#define ftell64 ftello
+#endif
+
+static const char *noms_canaux[FLUX_NB_CANAUX] = {"courant", "tension", "temperature", "SOH", "SOC"};
+
+// ============================================================================
+// Helpers internes
+// ============================================================================
+
+static long long taille_fichier(FILE *fp)
+{
+    if (fseek64(fp, 0, SEEK_END) != 0) return -1;
+    long long taille = ftell64(fp);
+    fseek64(fp, 0, SEEK_SET);
+    return taille;
+}
+
+static void fermer_fichiers(Flux_Context *f)
+{
+    for (int k = 0; k < FLUX_NB_CANAUX; ++k) {
+        if (f->fichiers[k]) fclose(f->fichiers[k]);
+        f->fichiers[k]  = NULL;
+        f->compresse[k] = 0;
+    }
+    Conteneur_fermer(&f->conteneur);
+}
+
+// Source conteneur : une ouverture par canal (positions indépendantes)
+// Renvoie 0 si OK, 1 si erreur, -1 si pas de conteneur
+static int ouvrir_conteneur(Flux_Context *f, const char *dossier)
+{
+    char chemin[256];
+    snprintf(chemin, sizeof(chemin), "%s/%s", dossier, DONNEES_CONTENEUR);
+
+    FILE *fp = fopen(chemin, "rb");
+    if (fp == NULL) return -1;
+
+    Conteneur_entete e;
+    long long taille = taille_fichier(fp);
+    int lu = (fread(&e, sizeof(e), 1, fp) == 1);
+    fclose(fp);
+
+    if (!lu || taille < (long long)sizeof(e) ||
+        Conteneur_verifier_entete(&e, (uint64_t)taille, chemin) != 0) {
+        printf("Erreur lecture en-tete %s\n", chemin);
+        return 1;
+    }
+
+    for (int k = 0; k < FLUX_NB_CANAUX; ++k) {
+        const Conteneur_canal *canal = NULL;
+        for (uint32_t j = 0; j < e.nb_canaux; ++j) {
+            if (strcmp(e.canaux[j].nom, noms_canaux[k]) == 0) canal = &e.canaux[j];
+        }
+        if (!canal || (canal->type != CONTENEUR_F32 && canal->type != CONTENEUR_F32_XOR)) {
+            printf("Erreur : canal %s absent ou non float dans %s\n", noms_canaux[k], chemin);
+            fermer_fichiers(f);
+            return 1;
+        }
+
+        // Canal compressé : décodé depuis la projection du conteneur
+        if (canal->type == CONTENEUR_F32_XOR) {
+            if (!f->conteneur.base && Conteneur_ouvrir(&f->conteneur, chemin) != 0) {
+                fermer_fichiers(f);
+                return 1;
+            }
+            f->compresse[k] = 1;
+            continue;
+        }
+
+        f->fichiers[k] = fopen(chemin, "rb");
+        if (!f->fichiers[k]) {
+            printf("Erreur ouverture fichier %s\n", chemin);
+            fermer_fichiers(f);
+            return 1;
+        }
+        f->origines[k] = (long long)canal->offset;
+    }
+
+    f->nb_total = (size_t)e.nb_echantillons;
+    return 0;
+}
+
+// Source historique : les 5 fichiers .bin sans en-tête
+static int ouvrir_fichiers_bin(Flux_Context *f, const char *dossier)
+{
+    size_t N = 0;
+
+    for (int k = 0; k < FLUX_NB_CANAUX; ++k) {
+        char chemin[256];
+        snprintf(chemin, sizeof(chemin), "%s/%s.bin", dossier, noms_canaux[k]);
+
+        f->fichiers[k] = fopen(chemin, "rb");
+        if (!f->fichiers[k]) {
+            printf("Erreur ouverture fichier %s\n", chemin);
+            fermer_fichiers(f);
+            return 1;
+        }
+        f->origines[k] = 0;
+
+        size_t n = (size_t)(taille_fichier(f->fichiers[k]) / (long long)sizeof(float));
+        if (k == 0) {
+            N = n;
+        } else if (n != N) {
+            printf("Attention : %s contient %zu elements au lieu de %zu\n", chemin, n, N);
+            if (n < N) N = n;
+        }
+    }
+
+    f->nb_total = N;
+    return 0;
+}
+
+// ============================================================================
+// Thread de lecture : remplit les blocs libres de l'anneau
+// ============================================================================
+
+static void *thread_lecture(void *arg)
+{
+    Flux_Context *f = (Flux_Context *)arg;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&f->verrou);
+        while (f->nb_pleins == FLUX_NB_TAMPONS && !f->arret)
+            pthread_cond_wait(&f->cond_libre, &f->verrou);
+        int arret  = f->arret;
+        int indice = f->ecriture;
+        pthread_mutex_unlock(&f->verrou);
+
+        if (arret) break;
+
+        // Lecture hors verrou : le bloc `indice` n'est pas vu par le consommateur
+        Flux_bloc *bloc = &f->blocs[indice];
+        size_t reste = f->nb_total - f->prochain;
+        size_t nb    = (reste < FLUX_TAILLE_BLOC) ? reste : FLUX_TAILLE_BLOC;
+        int erreur   = 0;
+
+        for (int k = 0; k < FLUX_NB_CANAUX && nb > 0; ++k) {
+            if (f->compresse[k]) {
+                if (Conteneur_lire_f32(&f->conteneur, noms_canaux[k], f->prochain, nb,
+                                       bloc->canaux[k]) != 0)
+                    erreur = 1;
+                continue;
+            }
+            long long position = f->origines[k] + (long long)(f->prochain * sizeof(float));
+            if (fseek64(f->fichiers[k], position, SEEK_SET) != 0 ||
+                fread(bloc->canaux[k], sizeof(float), nb, f->fichiers[k]) != nb) {
+                erreur = 1;
+            }
+        }
+        bloc->nb = nb;
+
+        pthread_mutex_lock(&f->verrou);
+        f->prochain += nb;
+        if (nb > 0 && !erreur) {
+            f->ecriture = (indice + 1) % FLUX_NB_TAMPONS;
+            f->nb_pleins++;
+        }
+        f->erreur |= erreur;
+        if (f->prochain >= f->nb_total || erreur) f->fin = 1;
+        int fin = f->fin;
+        pthread_cond_signal(&f->cond_plein);
+        pthread_mutex_unlock(&f->verrou);
+
+        if (fin) break;
+    }
+
+    return NULL;
+}
+
+// ============================================================================
+// API publique
+// ============================================================================
+
+int Flux_ouvrir(Flux_Context *f, const char *dossier, size_t debut)
+{
+    if (!f) return 1;
+    memset(f, 0, sizeof(*f));
+
+    int r = ouvrir_conteneur(f, dossier);
+    if (r < 0) r = ouvrir_fichiers_bin(f, dossier);
+    if (r != 0) return 1;
+
+    f->prochain = (debut < f->nb_total) ? debut : f->nb_total;
+
+    f->blocs = (Flux_bloc *)malloc(FLUX_NB_TAMPONS * sizeof(Flux_bloc));
+    if (!f->blocs) {
+        perror("Erreur allocation blocs flux");
+        fermer_fichiers(f);
+        return 1;
+    }
+
+    pthread_mutex_init(&f->verrou, NULL);
+    pthread_cond_init(&f->cond_plein, NULL);
+    pthread_cond_init(&f->cond_libre, NULL);
+
+    if (pthread_create(&f->thread, NULL, thread_lecture, f) != 0) {
+        printf("Erreur creation thread de lecture\n");
+        pthread_mutex_destroy(&f->verrou);
+        pthread_cond_destroy(&f->cond_plein);
+        pthread_cond_destroy(&f->cond_libre);
+        free(f->blocs);
+        f->blocs = NULL;
+        fermer_fichiers(f);
+        return 1;
+    }
+
+    return 0;
+}
+
+size_t Flux_nb_echantillons(const Flux_Context *f)
+{
+    return f ? f->nb_total : 0;
+}
+
+int Flux_bloc_suivant(Flux_Context *f)
+{
+    if (!f || !f->blocs) return 0;
+
+    pthread_mutex_lock(&f->verrou);
+
+    // On rend le bloc consommé au thread de lecture
+    if (f->bloc) {
+        f->bloc = NULL;
+        f->lecture = (f->lecture + 1) % FLUX_NB_TAMPONS;
+        f->nb_pleins--;
+        pthread_cond_signal(&f->cond_libre);
+    }
+
+    while (f->nb_pleins == 0 && !f->fin)
+        pthread_cond_wait(&f->cond_plein, &f->verrou);
+
+    int disponible = (f->nb_pleins > 0);
+    if (disponible) {
+        f->bloc     = &f->blocs[f->lecture];
+        f->position = 0;
+    } else if (f->erreur) {
+        printf("Erreur lecture des donnees (echantillon %zu)\n", f->prochain);
+    }
+
+    pthread_mutex_unlock(&f->verrou);
+    return disponible;
+}
+
+void Flux_fermer(Flux_Context *f)
+{
+    if (!f || !f->blocs) return;
+
+    pthread_mutex_lock(&f->verrou);
+    f->arret = 1;
+    pthread_cond_signal(&f->cond_libre);
+    pthread_mutex_unlock(&f->verrou);
+
+    pthread_join(f->thread, NULL);
+
+    pthread_mutex_destroy(&f->verrou);
+    pthread_cond_destroy(&f->cond_plein);
+    pthread_cond_destroy(&f->cond_libre);
+
+    free(f->blocs);
+    f->blocs = NULL;
+    f->bloc  = NULL;
+    fermer_fichiers(f);
+}
@@ -0,0 +1,98 @@
+#ifndef FLUX_DONNEES_H
+#define FLUX_DONNEES_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <pthread.h>
+#include "Conteneur.h"
+
+// ============================================================================
+// Lecture en flux des données d'entrée, par blocs, avec préchargement
+//
+// Un thread de lecture remplit un anneau de FLUX_NB_TAMPONS blocs de
+// FLUX_TAILLE_BLOC échantillons x 5 canaux pendant que la boucle principale
+// consomme le bloc courant : les E/S recouvrent le calcul et la mémoire
+// utilisée ne dépend pas de la longueur de l'enregistrement.
+// Source : conteneur ../donnees/donnees.prt s'il existe, sinon les 5 .bin.
+// Les canaux compressés du conteneur sont décodés par le thread de lecture.
+// ============================================================================
+
+#define FLUX_NB_CANAUX    5
+#define FLUX_TAILLE_BLOC  65536
+#define FLUX_NB_TAMPONS   3
+
+// Un échantillon (un pas de 1 s)
+typedef struct
+{
+    float courant;
+    float tension;
+    float temperature;
+    float SOH;
+    float SOC;
+} Echantillon;
+
+typedef struct
+{
+    float  canaux[FLUX_NB_CANAUX][FLUX_TAILLE_BLOC];
+    size_t nb;      // nombre d'échantillons valides dans le bloc
+} Flux_bloc;
+
+typedef struct
+{
+    // Source
+    FILE  *fichiers[FLUX_NB_CANAUX];
+    long long origines[FLUX_NB_CANAUX];  // position de la colonne dans le fichier
+    size_t nb_total;                     // nombre d'échantillons de la source
+    Conteneur conteneur;                 // projeté si des canaux sont compressés
+    int   compresse[FLUX_NB_CANAUX];     // canal décodé par le thread (pas de fichier)
+    size_t prochain;                     // prochain échantillon à lire (thread)
+
+    // Anneau de blocs (partagé avec le thread de lecture)
+    Flux_bloc *blocs;
+    int  ecriture;      // prochain bloc à remplir
+    int  lecture;       // bloc en cours de consommation
+    int  nb_pleins;     // blocs remplis non encore rendus
+    int  fin;           // le thread a tout lu
+    int  arret;         // demande d'arrêt du thread
+    int  erreur;        // erreur de lecture
+
+    pthread_t       thread;
+    pthread_mutex_t verrou;
+    pthread_cond_t  cond_plein;
+    pthread_cond_t  cond_libre;
+
+    // Curseur (thread principal uniquement)
+    const Flux_bloc *bloc;
+    size_t position;
+} Flux_Context;
+
+// Ouverture de la source dans `dossier` à partir de l'échantillon `debut`
+// et démarrage du préchargement (0 = OK, 1 = erreur)
+int Flux_ouvrir(Flux_Context *f, const char *dossier, size_t debut);
+
+// Nombre total d'échantillons de la source
+size_t Flux_nb_echantillons(const Flux_Context *f);
+
+// Arrêt du thread + fermeture des fichiers
+void Flux_fermer(Flux_Context *f);
+
+// Passage au bloc suivant (usage interne de Flux_suivant)
+int Flux_bloc_suivant(Flux_Context *f);
+
+// Curseur : échantillon suivant dans *e. Renvoie 1, ou 0 en fin de données.
+static inline int Flux_suivant(Flux_Context *f, Echantillon *e)
+{
+    if (!f->bloc || f->position >= f->bloc->nb) {
+        if (!Flux_bloc_suivant(f)) return 0;
+    }
+
+    size_t i = f->position++;
+    e->courant     = f->bloc->canaux[0][i];
+    e->tension     = f->bloc->canaux[1][i];
+    e->temperature = f->bloc->canaux[2][i];
+    e->SOH         = f->bloc->canaux[3][i];
+    e->SOC         = f->bloc->canaux[4][i];
+    return 1;
+}
+
+#endif // FLUX_DONNEES_H
@@ -0,0 +1,21 @@
+#include "Interpolateur.h"
+
+void Interpolateur_init(Interpolateur *it, const float *x, const float *y, int n)
+{
+    it->x      = x;
+    it->y      = y;
+    it->n      = n;
+    it->indice = 0;
+}
+
+int Interpolateur_chercher(const Interpolateur *it, float x_req)
+{
+    // Invariant : x[bas] < x_req <= x[haut]
+    int bas = 0, haut = it->n - 1;
+    while (haut - bas > 1) {
+        int milieu = (bas + haut) / 2;
+        if (it->x[milieu] < x_req) bas  = milieu;
+        else                       haut = milieu;
+    }
+    return bas;
+}
@@ -0,0 +1,57 @@
+#ifndef INTERPOLATEUR_H
+#define INTERPOLATEUR_H
+
+// ============================================================================
+// Interpolation linéaire avec mémorisation de l'intervalle
+//
+// Pour les tables à abscisses irrégulières (loi RUL(SOH)...), qu'on ne peut
+// pas rééchantillonner sans erreur sur une grille à pas constant.
+// L'entrée évolue lentement d'un appel à l'autre : on repart de l'intervalle
+// précédent et on se déplace d'au plus INTERPOLATEUR_PAS_LOCAUX intervalles,
+// sinon recherche dichotomique.
+//
+// Résultat identique bit à bit à interp1Drapide (même intervalle choisi,
+// mêmes opérations) ; l'interpolateur appartient au contexte du module et
+// n'est pas partageable entre deux séries d'appels indépendantes.
+// ============================================================================
+
+#define INTERPOLATEUR_PAS_LOCAUX 2
+
+typedef struct
+{
+    const float *x;     // abscisses croissantes
+    const float *y;
+    int          n;     // >= 2
+    int          indice; // dernier intervalle : x[indice] < x_req <= x[indice+1]
+} Interpolateur;
+
+// Association à une table (x croissant, n >= 2)
+void Interpolateur_init(Interpolateur *it, const float *x, const float *y, int n);
+
+// Recherche dichotomique de l'intervalle (x[0] < x_req < x[n-1])
+int Interpolateur_chercher(const Interpolateur *it, float x_req);
+
+static inline float Interpolateur_eval(Interpolateur *it, float x_req)
+{
+    const float *x = it->x;
+    const float *y = it->y;
+
+    // Bornes (NaN : dernière valeur, comme interp1Drapide)
+    if (x_req <= x[0])              return y[0];
+    if (!(x_req < x[it->n - 1]))    return y[it->n - 1];
+
+    int i = it->indice;
+    int pas = 0;
+    while (x_req > x[i + 1] && pas < INTERPOLATEUR_PAS_LOCAUX) { ++i; ++pas; }
+    while (x_req <= x[i]    && pas < INTERPOLATEUR_PAS_LOCAUX) { --i; ++pas; }
+    if (x_req > x[i + 1] || x_req <= x[i])
+        i = Interpolateur_chercher(it, x_req);
+    it->indice = i;
+
+    float dx = x[i + 1] - x[i];
+    float dy = y[i + 1] - y[i];
+    float t  = (x_req - x[i]) / dx;
+    return y[i] + t * dy;
+}
+
+#endif // INTERPOLATEUR_H
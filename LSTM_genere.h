@@ -0,0 +1,46 @@
+#ifndef LSTM_GENERE_H
+#define LSTM_GENERE_H
+
+#include <stdint.h>
+#include "Reseau_poids.h"
+
+// ============================================================================
+// Noyaux LSTM générés pour un réseau donné (generation_lstm)
+//
+// Pour un réseau fixé (tailles E, H et poids), generation_lstm écrit une
+// fonction de pas entièrement déroulée : bornes, indices et décalages sont
+// des constantes, les poids (normalisation repliée, comme SOC_Modele) sont
+// des tableaux static const alignés. Plus de boucle ni de taille lue à
+// l'exécution ; le compilateur vectorise les blocs de lignes.
+//
+// Même ordre d'addition que le noyau portable : sur un processeur sans FMA,
+// résultats identiques à LSTM_pas en noyau portable ; activations au niveau
+// actif (Activations.h).
+//
+// Les variantes sont rangées dans un fichier généré (cible make genere,
+// output/LSTM_genere.c) ; un modèle SOC compilé utilise la variante dont
+// l'empreinte des poids est la sienne (SOC_genere_enregistrer).
+// ============================================================================
+
+typedef struct
+{
+    const char *nom;
+    int         nb_entrees;     // E
+    int         nb_unites;      // H
+    uint32_t    empreinte;      // SOC_Modele_empreinte du modèle d'origine
+
+    // Un pas : x brut (E valeurs), h et c (H valeurs) mis à jour
+    void  (*pas)(const float *x, float *h, float *c);
+    // Couche de sortie : WFC * h + bFC
+    float (*sortie)(const float *h);
+
+    // Réseau source (blocs au format Reseau_poids, 1 sortie), pour
+    // recompiler le modèle générique correspondant
+    const float *blocs[RESEAU_NB_BLOCS];
+} LSTM_genere;
+
+// Variantes du fichier généré
+extern const LSTM_genere *const LSTM_genere_variantes[];
+extern const int                LSTM_genere_nb;
+
+#endif // LSTM_GENERE_H
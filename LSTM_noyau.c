@@ -0,0 +1,726 @@
+#include <string.h>
+#include "LSTM_noyau.h"
+#include "Activations.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LSTM_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define LSTM_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Produit fusionné : acc[nb_lignes] = b + W * xh
+typedef void (*Produit_portes)(const LSTM_poids *p, const float *xh, float *acc);
+
+// Partie récurrente seule : acc[nb_lignes] = proj + R * h (colonnes de h)
+typedef void (*Produit_recurrent)(const LSTM_poids *p, const float *proj, const float *h,
+                                  float *acc);
+
+// Projection des entrées de T pas : proj[t * nb_lignes] = b + W_x * x[t * E]
+typedef void (*Projection)(const LSTM_poids *p, int T, const float *x, float *proj);
+
+// Produit par lot (GEMM) : acc[nb_lignes x cap] = b + W * xh[(E+H) x cap],
+// une colonne par cellule, cap multiple de 8
+typedef void (*Produit_lot)(const LSTM_poids *p, int cap, const float *xh, float *acc);
+
+// Activations rapides + cellule dans les registres SIMD : n valeurs (multiple
+// de la largeur SIMD) ; les portes i, f, g, o sont à acc, acc + ecart,
+// acc + 2*ecart, acc + 3*ecart
+typedef void (*Portes_rapides)(int n, int ecart, const float *acc, float *c, float *h);
+
+// Tailles (E, H) disposant d'un produit spécialisé : bornes de boucle
+// constantes, que le compilateur déroule ; même ordre que les tableaux
+// produits_<isa> générés par LSTM_PRODUITS
+#define LSTM_NB_SPECIALISATIONS 3
+static const int tailles_specialisees[LSTM_NB_SPECIALISATIONS][2] = {
+    {3, 12}, {3, 20}, {3, 32}
+};
+
+// Produit générique + produits spécialisés d'une implantation. Le corps
+// part de init et parcourt nc colonnes de W : produit complet (b, toutes
+// les colonnes), projection des entrées (b, E colonnes) ou partie
+// récurrente (projection, H colonnes suivantes). Dans les trois cas, même
+// suite d'additions par ligne, colonne après colonne : projection puis
+// partie récurrente donnent exactement le produit complet.
+#define LSTM_PRODUIT_TAILLE(cible, isa, E, H)                                          \
+    cible static void produit_##isa##_##E##_##H(const LSTM_poids *p, const float *xh,  \
+                                                float *acc)                            \
+    { produit_##isa##_corps(p->b, p->W, xh, acc, 4 * LSTM_UNITES_PAD(H), (E) + (H)); } \
+    cible static void recurrent_##isa##_##E##_##H(const LSTM_poids *p, const float *proj, \
+                                                  const float *h, float *acc)          \
+    { produit_##isa##_corps(proj, p->W + (E) * 4 * LSTM_UNITES_PAD(H), h, acc,         \
+                            4 * LSTM_UNITES_PAD(H), (H)); }
+
+#define LSTM_PRODUITS(cible, isa)                                                      \
+    cible static void produit_##isa(const LSTM_poids *p, const float *xh, float *acc)  \
+    { produit_##isa##_corps(p->b, p->W, xh, acc, p->nb_lignes,                         \
+                            p->nb_entrees + p->nb_unites); }                           \
+    cible static void recurrent_##isa(const LSTM_poids *p, const float *proj,          \
+                                      const float *h, float *acc)                      \
+    { produit_##isa##_corps(proj, p->W + p->nb_entrees * p->nb_lignes, h, acc,         \
+                            p->nb_lignes, p->nb_unites); }                             \
+    cible static void projection_##isa(const LSTM_poids *p, int T, const float *x,     \
+                                       float *proj)                                    \
+    {                                                                                  \
+        const int E = p->nb_entrees, nl = p->nb_lignes;                                \
+        for (int t = 0; t < T; ++t)                                                    \
+            produit_##isa##_corps(p->b, p->W, x + (size_t)t * E, proj + (size_t)t * nl, \
+                                  nl, E);                                              \
+    }                                                                                  \
+    LSTM_PRODUIT_TAILLE(cible, isa, 3, 12)                                             \
+    LSTM_PRODUIT_TAILLE(cible, isa, 3, 20)                                             \
+    LSTM_PRODUIT_TAILLE(cible, isa, 3, 32)                                             \
+    static const Produit_portes produits_##isa[LSTM_NB_SPECIALISATIONS] = {            \
+        produit_##isa##_3_12, produit_##isa##_3_20, produit_##isa##_3_32               \
+    };                                                                                 \
+    static const Produit_recurrent recurrents_##isa[LSTM_NB_SPECIALISATIONS] = {       \
+        recurrent_##isa##_3_12, recurrent_##isa##_3_20, recurrent_##isa##_3_32         \
+    };
+
+// ============================================================================
+// Empaquetage
+// ============================================================================
+
+int LSTM_empaqueter(LSTM_poids *p, int nb_entrees, int nb_unites,
+                    const float *const W[4], const float *const R[4],
+                    const float *const b[4])
+{
+    if (nb_entrees < 1 || nb_entrees > LSTM_MAX_ENTREES ||
+        nb_unites  < 1 || nb_unites  > LSTM_MAX_UNITES)
+        return 1;
+
+    memset(p, 0, sizeof(*p));
+    p->nb_entrees    = nb_entrees;
+    p->nb_unites     = nb_unites;
+    p->nb_unites_pad = LSTM_UNITES_PAD(nb_unites);
+    p->nb_lignes     = 4 * p->nb_unites_pad;
+
+    p->specialisation = -1;
+    for (int k = 0; k < LSTM_NB_SPECIALISATIONS; ++k)
+        if (tailles_specialisees[k][0] == nb_entrees && tailles_specialisees[k][1] == nb_unites)
+            p->specialisation = k;
+
+    for (int k = 0; k < 4; ++k) {
+        for (int r = 0; r < nb_unites; ++r) {
+            int ligne = k * p->nb_unites_pad + r;
+            for (int j = 0; j < nb_entrees; ++j)
+                p->W[j * p->nb_lignes + ligne] = W[k][r * nb_entrees + j];
+            for (int j = 0; j < nb_unites; ++j)
+                p->W[(nb_entrees + j) * p->nb_lignes + ligne] = R[k][r * nb_unites + j];
+            p->b[ligne] = b[k][r];
+        }
+    }
+    return 0;
+}
+
+// ============================================================================
+// Produits matrice-vecteur (nb_lignes multiple de 32)
+// ============================================================================
+
+static inline __attribute__((always_inline))
+void produit_portable_corps(const float *init, const float *W, const float *xh, float *acc,
+                            const int nl, const int nc)
+{
+    // Par paquets de 8 lignes : 8 accumulateurs indépendants, que le
+    // compilateur garde en registres
+    for (int l = 0; l < nl; l += 8) {
+        float a[8];
+        for (int q = 0; q < 8; ++q) a[q] = init[l + q];
+        const float *w = W + l;
+        for (int j = 0; j < nc; ++j, w += nl) {
+            const float v = xh[j];
+            for (int q = 0; q < 8; ++q) a[q] += w[q] * v;
+        }
+        for (int q = 0; q < 8; ++q) acc[l + q] = a[q];
+    }
+}
+
+LSTM_PRODUITS(, portable)
+
+static void produit_lot_portable(const LSTM_poids *p, int cap, const float *xh, float *acc)
+{
+    const int nl = p->nb_lignes;
+    const int nc = p->nb_entrees + p->nb_unites;
+
+    // Ligne par ligne (lignes de complément sautées), par paquets de 8
+    // cellules : 8 accumulateurs indépendants, comme produit_portable
+    for (int l = 0; l < nl; ++l) {
+        if (l % p->nb_unites_pad >= p->nb_unites) continue;
+        for (int n = 0; n < cap; n += 8) {
+            float a[8];
+            for (int q = 0; q < 8; ++q) a[q] = p->b[l];
+            const float *x = xh + n;
+            for (int j = 0; j < nc; ++j, x += cap) {
+                const float w = p->W[j * nl + l];
+                for (int q = 0; q < 8; ++q) a[q] += w * x[q];
+            }
+            for (int q = 0; q < 8; ++q) acc[(size_t)l * cap + n + q] = a[q];
+        }
+    }
+}
+
+#ifdef LSTM_X86
+__attribute__((target("sse2")))
+static inline __attribute__((always_inline))
+void produit_sse_corps(const float *init, const float *W, const float *xh, float *acc,
+                       const int nl, const int nc)
+{
+    for (int l = 0; l < nl; l += 16) {
+        __m128 a0 = _mm_load_ps(init + l);
+        __m128 a1 = _mm_load_ps(init + l + 4);
+        __m128 a2 = _mm_load_ps(init + l + 8);
+        __m128 a3 = _mm_load_ps(init + l + 12);
+        const float *w = W + l;
+        for (int j = 0; j < nc; ++j, w += nl) {
+            __m128 v = _mm_set1_ps(xh[j]);
+            a0 = _mm_add_ps(a0, _mm_mul_ps(_mm_load_ps(w),      v));
+            a1 = _mm_add_ps(a1, _mm_mul_ps(_mm_load_ps(w + 4),  v));
+            a2 = _mm_add_ps(a2, _mm_mul_ps(_mm_load_ps(w + 8),  v));
+            a3 = _mm_add_ps(a3, _mm_mul_ps(_mm_load_ps(w + 12), v));
+        }
+        _mm_store_ps(acc + l,      a0);
+        _mm_store_ps(acc + l + 4,  a1);
+        _mm_store_ps(acc + l + 8,  a2);
+        _mm_store_ps(acc + l + 12, a3);
+    }
+}
+
+LSTM_PRODUITS(__attribute__((target("sse2"))), sse)
+
+// Lot : un poids diffusé multiplie 16 cellules à la fois (4 registres)
+__attribute__((target("sse2")))
+static void produit_lot_sse(const LSTM_poids *p, int cap, const float *xh, float *acc)
+{
+    const int nl = p->nb_lignes;
+    const int nc = p->nb_entrees + p->nb_unites;
+
+    for (int l = 0; l < nl; ++l) {
+        if (l % p->nb_unites_pad >= p->nb_unites) continue;
+        const __m128 bl = _mm_set1_ps(p->b[l]);
+        float *a = acc + (size_t)l * cap;
+        int n = 0;
+        for (; n + 16 <= cap; n += 16) {
+            __m128 a0 = bl, a1 = bl, a2 = bl, a3 = bl;
+            const float *x = xh + n;
+            for (int j = 0; j < nc; ++j, x += cap) {
+                __m128 v = _mm_set1_ps(p->W[j * nl + l]);
+                a0 = _mm_add_ps(a0, _mm_mul_ps(_mm_load_ps(x),      v));
+                a1 = _mm_add_ps(a1, _mm_mul_ps(_mm_load_ps(x + 4),  v));
+                a2 = _mm_add_ps(a2, _mm_mul_ps(_mm_load_ps(x + 8),  v));
+                a3 = _mm_add_ps(a3, _mm_mul_ps(_mm_load_ps(x + 12), v));
+            }
+            _mm_store_ps(a + n,      a0);
+            _mm_store_ps(a + n + 4,  a1);
+            _mm_store_ps(a + n + 8,  a2);
+            _mm_store_ps(a + n + 12, a3);
+        }
+        for (; n < cap; n += 4) {
+            __m128 a0 = bl;
+            const float *x = xh + n;
+            for (int j = 0; j < nc; ++j, x += cap)
+                a0 = _mm_add_ps(a0, _mm_mul_ps(_mm_load_ps(x), _mm_set1_ps(p->W[j * nl + l])));
+            _mm_store_ps(a + n, a0);
+        }
+    }
+}
+
+// Exponentielle rapide (mêmes constantes que act_exp_rapide)
+__attribute__((target("sse2")))
+static inline __m128 exp_sse(__m128 x)
+{
+    x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(ACT_EXP_MIN)), _mm_set1_ps(ACT_EXP_MAX));
+    __m128 t = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(ACT_LOG2E)), _mm_set1_ps(ACT_ARRONDI));
+    __m128 n = _mm_sub_ps(t, _mm_set1_ps(ACT_ARRONDI));
+    __m128 r = _mm_sub_ps(_mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(ACT_LN2_HAUT))),
+                          _mm_mul_ps(n, _mm_set1_ps(ACT_LN2_BAS)));
+
+    __m128 q = _mm_set1_ps(ACT_P0);
+    q = _mm_add_ps(_mm_mul_ps(q, r), _mm_set1_ps(ACT_P1));
+    q = _mm_add_ps(_mm_mul_ps(q, r), _mm_set1_ps(ACT_P2));
+    q = _mm_add_ps(_mm_mul_ps(q, r), _mm_set1_ps(ACT_P3));
+    q = _mm_add_ps(_mm_mul_ps(q, r), _mm_set1_ps(ACT_P4));
+    q = _mm_add_ps(_mm_mul_ps(q, r), _mm_set1_ps(ACT_P5));
+    __m128 y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(q, r), r), r), _mm_set1_ps(1.0f));
+
+    __m128i e = _mm_sub_epi32(_mm_castps_si128(t), _mm_set1_epi32(0x4B400000 - 127));
+    return _mm_mul_ps(y, _mm_castsi128_ps(_mm_slli_epi32(e, 23)));
+}
+
+__attribute__((target("sse2")))
+static void portes_sse(int n, int ecart, const float *acc, float *c, float *h)
+{
+    const __m128 un   = _mm_set1_ps(1.0f);
+    const __m128 deux = _mm_set1_ps(2.0f);
+    const __m128 zero = _mm_setzero_ps();
+
+    for (int r = 0; r < n; r += 4) {
+        __m128 it = _mm_div_ps(un, _mm_add_ps(un, exp_sse(_mm_sub_ps(zero, _mm_load_ps(acc + r)))));
+        __m128 ft = _mm_div_ps(un, _mm_add_ps(un, exp_sse(_mm_sub_ps(zero, _mm_load_ps(acc + ecart + r)))));
+        __m128 gt = _mm_sub_ps(un, _mm_div_ps(deux, _mm_add_ps(exp_sse(_mm_mul_ps(deux, _mm_load_ps(acc + 2 * ecart + r))), un)));
+        __m128 ot = _mm_div_ps(un, _mm_add_ps(un, exp_sse(_mm_sub_ps(zero, _mm_load_ps(acc + 3 * ecart + r)))));
+
+        __m128 ct = _mm_add_ps(_mm_mul_ps(ft, _mm_load_ps(c + r)), _mm_mul_ps(it, gt));
+        __m128 th = _mm_sub_ps(un, _mm_div_ps(deux, _mm_add_ps(exp_sse(_mm_mul_ps(deux, ct)), un)));
+        _mm_store_ps(c + r, ct);
+        _mm_store_ps(h + r, _mm_mul_ps(ot, th));
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static inline __attribute__((always_inline))
+void produit_avx2_corps(const float *init, const float *W, const float *xh, float *acc,
+                        const int nl, const int nc)
+{
+    for (int l = 0; l < nl; l += 32) {
+        __m256 a0 = _mm256_load_ps(init + l);
+        __m256 a1 = _mm256_load_ps(init + l + 8);
+        __m256 a2 = _mm256_load_ps(init + l + 16);
+        __m256 a3 = _mm256_load_ps(init + l + 24);
+        const float *w = W + l;
+        for (int j = 0; j < nc; ++j, w += nl) {
+            __m256 v = _mm256_broadcast_ss(xh + j);
+            a0 = _mm256_fmadd_ps(_mm256_load_ps(w),      v, a0);
+            a1 = _mm256_fmadd_ps(_mm256_load_ps(w + 8),  v, a1);
+            a2 = _mm256_fmadd_ps(_mm256_load_ps(w + 16), v, a2);
+            a3 = _mm256_fmadd_ps(_mm256_load_ps(w + 24), v, a3);
+        }
+        _mm256_store_ps(acc + l,      a0);
+        _mm256_store_ps(acc + l + 8,  a1);
+        _mm256_store_ps(acc + l + 16, a2);
+        _mm256_store_ps(acc + l + 24, a3);
+    }
+}
+
+LSTM_PRODUITS(__attribute__((target("avx2,fma"))), avx2)
+
+__attribute__((target("avx2,fma")))
+static void produit_lot_avx2(const LSTM_poids *p, int cap, const float *xh, float *acc)
+{
+    const int nl = p->nb_lignes;
+    const int nc = p->nb_entrees + p->nb_unites;
+
+    for (int l = 0; l < nl; ++l) {
+        if (l % p->nb_unites_pad >= p->nb_unites) continue;
+        const __m256 bl = _mm256_set1_ps(p->b[l]);
+        float *a = acc + (size_t)l * cap;
+        int n = 0;
+        for (; n + 32 <= cap; n += 32) {
+            __m256 a0 = bl, a1 = bl, a2 = bl, a3 = bl;
+            const float *x = xh + n;
+            for (int j = 0; j < nc; ++j, x += cap) {
+                __m256 v = _mm256_broadcast_ss(p->W + j * nl + l);
+                a0 = _mm256_fmadd_ps(_mm256_load_ps(x),      v, a0);
+                a1 = _mm256_fmadd_ps(_mm256_load_ps(x + 8),  v, a1);
+                a2 = _mm256_fmadd_ps(_mm256_load_ps(x + 16), v, a2);
+                a3 = _mm256_fmadd_ps(_mm256_load_ps(x + 24), v, a3);
+            }
+            _mm256_store_ps(a + n,      a0);
+            _mm256_store_ps(a + n + 8,  a1);
+            _mm256_store_ps(a + n + 16, a2);
+            _mm256_store_ps(a + n + 24, a3);
+        }
+        for (; n < cap; n += 8) {
+            __m256 a0 = bl;
+            const float *x = xh + n;
+            for (int j = 0; j < nc; ++j, x += cap)
+                a0 = _mm256_fmadd_ps(_mm256_load_ps(x), _mm256_broadcast_ss(p->W + j * nl + l), a0);
+            _mm256_store_ps(a + n, a0);
+        }
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256 exp_avx2(__m256 x)
+{
+    x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(ACT_EXP_MIN)), _mm256_set1_ps(ACT_EXP_MAX));
+    __m256 t = _mm256_fmadd_ps(x, _mm256_set1_ps(ACT_LOG2E), _mm256_set1_ps(ACT_ARRONDI));
+    __m256 n = _mm256_sub_ps(t, _mm256_set1_ps(ACT_ARRONDI));
+    __m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(ACT_LN2_HAUT), x);
+    r = _mm256_fnmadd_ps(n, _mm256_set1_ps(ACT_LN2_BAS), r);
+
+    __m256 q = _mm256_set1_ps(ACT_P0);
+    q = _mm256_fmadd_ps(q, r, _mm256_set1_ps(ACT_P1));
+    q = _mm256_fmadd_ps(q, r, _mm256_set1_ps(ACT_P2));
+    q = _mm256_fmadd_ps(q, r, _mm256_set1_ps(ACT_P3));
+    q = _mm256_fmadd_ps(q, r, _mm256_set1_ps(ACT_P4));
+    q = _mm256_fmadd_ps(q, r, _mm256_set1_ps(ACT_P5));
+    __m256 y = _mm256_fmadd_ps(_mm256_mul_ps(q, r), r, _mm256_add_ps(r, _mm256_set1_ps(1.0f)));
+
+    __m256i e = _mm256_sub_epi32(_mm256_castps_si256(t), _mm256_set1_epi32(0x4B400000 - 127));
+    return _mm256_mul_ps(y, _mm256_castsi256_ps(_mm256_slli_epi32(e, 23)));
+}
+
+__attribute__((target("avx2,fma")))
+static void portes_avx2(int n, int ecart, const float *acc, float *c, float *h)
+{
+    const __m256 un   = _mm256_set1_ps(1.0f);
+    const __m256 deux = _mm256_set1_ps(2.0f);
+    const __m256 zero = _mm256_setzero_ps();
+
+    for (int r = 0; r < n; r += 8) {
+        __m256 it = _mm256_div_ps(un, _mm256_add_ps(un, exp_avx2(_mm256_sub_ps(zero, _mm256_load_ps(acc + r)))));
+        __m256 ft = _mm256_div_ps(un, _mm256_add_ps(un, exp_avx2(_mm256_sub_ps(zero, _mm256_load_ps(acc + ecart + r)))));
+        __m256 gt = _mm256_sub_ps(un, _mm256_div_ps(deux, _mm256_add_ps(exp_avx2(_mm256_mul_ps(deux, _mm256_load_ps(acc + 2 * ecart + r))), un)));
+        __m256 ot = _mm256_div_ps(un, _mm256_add_ps(un, exp_avx2(_mm256_sub_ps(zero, _mm256_load_ps(acc + 3 * ecart + r)))));
+
+        __m256 ct = _mm256_fmadd_ps(ft, _mm256_load_ps(c + r), _mm256_mul_ps(it, gt));
+        __m256 th = _mm256_sub_ps(un, _mm256_div_ps(deux, _mm256_add_ps(exp_avx2(_mm256_mul_ps(deux, ct)), un)));
+        _mm256_store_ps(c + r, ct);
+        _mm256_store_ps(h + r, _mm256_mul_ps(ot, th));
+    }
+}
+#endif
+
+#ifdef LSTM_NEON
+#if defined(__aarch64__)
+#define neon_madd(a, w, v) vfmaq_f32((a), (w), (v))
+#else
+#define neon_madd(a, w, v) vmlaq_f32((a), (w), (v))
+#endif
+
+static inline __attribute__((always_inline))
+void produit_neon_corps(const float *init, const float *W, const float *xh, float *acc,
+                        const int nl, const int nc)
+{
+    for (int l = 0; l < nl; l += 16) {
+        float32x4_t a0 = vld1q_f32(init + l);
+        float32x4_t a1 = vld1q_f32(init + l + 4);
+        float32x4_t a2 = vld1q_f32(init + l + 8);
+        float32x4_t a3 = vld1q_f32(init + l + 12);
+        const float *w = W + l;
+        for (int j = 0; j < nc; ++j, w += nl) {
+            float32x4_t v = vdupq_n_f32(xh[j]);
+            a0 = neon_madd(a0, vld1q_f32(w),      v);
+            a1 = neon_madd(a1, vld1q_f32(w + 4),  v);
+            a2 = neon_madd(a2, vld1q_f32(w + 8),  v);
+            a3 = neon_madd(a3, vld1q_f32(w + 12), v);
+        }
+        vst1q_f32(acc + l,      a0);
+        vst1q_f32(acc + l + 4,  a1);
+        vst1q_f32(acc + l + 8,  a2);
+        vst1q_f32(acc + l + 12, a3);
+    }
+}
+
+LSTM_PRODUITS(, neon)
+
+static void produit_lot_neon(const LSTM_poids *p, int cap, const float *xh, float *acc)
+{
+    const int nl = p->nb_lignes;
+    const int nc = p->nb_entrees + p->nb_unites;
+
+    for (int l = 0; l < nl; ++l) {
+        if (l % p->nb_unites_pad >= p->nb_unites) continue;
+        const float32x4_t bl = vdupq_n_f32(p->b[l]);
+        float *a = acc + (size_t)l * cap;
+        int n = 0;
+        for (; n + 16 <= cap; n += 16) {
+            float32x4_t a0 = bl, a1 = bl, a2 = bl, a3 = bl;
+            const float *x = xh + n;
+            for (int j = 0; j < nc; ++j, x += cap) {
+                float32x4_t v = vdupq_n_f32(p->W[j * nl + l]);
+                a0 = neon_madd(a0, vld1q_f32(x),      v);
+                a1 = neon_madd(a1, vld1q_f32(x + 4),  v);
+                a2 = neon_madd(a2, vld1q_f32(x + 8),  v);
+                a3 = neon_madd(a3, vld1q_f32(x + 12), v);
+            }
+            vst1q_f32(a + n,      a0);
+            vst1q_f32(a + n + 4,  a1);
+            vst1q_f32(a + n + 8,  a2);
+            vst1q_f32(a + n + 12, a3);
+        }
+        for (; n < cap; n += 4) {
+            float32x4_t a0 = bl;
+            const float *x = xh + n;
+            for (int j = 0; j < nc; ++j, x += cap)
+                a0 = neon_madd(a0, vld1q_f32(x), vdupq_n_f32(p->W[j * nl + l]));
+            vst1q_f32(a + n, a0);
+        }
+    }
+}
+
+#if defined(__aarch64__)
+#define neon_div(a, b) vdivq_f32((a), (b))
+#else
+// Pas de division en NEON 32 bits : estimation + 2 itérations de Newton
+static inline float32x4_t neon_div(float32x4_t a, float32x4_t b)
+{
+    float32x4_t inv = vrecpeq_f32(b);
+    inv = vmulq_f32(vrecpsq_f32(b, inv), inv);
+    inv = vmulq_f32(vrecpsq_f32(b, inv), inv);
+    return vmulq_f32(a, inv);
+}
+#endif
+
+static inline float32x4_t exp_neon(float32x4_t x)
+{
+    x = vminq_f32(vmaxq_f32(x, vdupq_n_f32(ACT_EXP_MIN)), vdupq_n_f32(ACT_EXP_MAX));
+    float32x4_t t = neon_madd(vdupq_n_f32(ACT_ARRONDI), x, vdupq_n_f32(ACT_LOG2E));
+    float32x4_t n = vsubq_f32(t, vdupq_n_f32(ACT_ARRONDI));
+    float32x4_t r = vmlsq_f32(x, n, vdupq_n_f32(ACT_LN2_HAUT));
+    r = vmlsq_f32(r, n, vdupq_n_f32(ACT_LN2_BAS));
+
+    float32x4_t q = vdupq_n_f32(ACT_P0);
+    q = neon_madd(vdupq_n_f32(ACT_P1), q, r);
+    q = neon_madd(vdupq_n_f32(ACT_P2), q, r);
+    q = neon_madd(vdupq_n_f32(ACT_P3), q, r);
+    q = neon_madd(vdupq_n_f32(ACT_P4), q, r);
+    q = neon_madd(vdupq_n_f32(ACT_P5), q, r);
+    float32x4_t y = neon_madd(vaddq_f32(r, vdupq_n_f32(1.0f)), vmulq_f32(q, r), r);
+
+    int32x4_t e = vsubq_s32(vreinterpretq_s32_f32(t), vdupq_n_s32(0x4B400000 - 127));
+    return vmulq_f32(y, vreinterpretq_f32_s32(vshlq_n_s32(e, 23)));
+}
+
+static void portes_neon(int n, int ecart, const float *acc, float *c, float *h)
+{
+    const float32x4_t un   = vdupq_n_f32(1.0f);
+    const float32x4_t deux = vdupq_n_f32(2.0f);
+
+    for (int r = 0; r < n; r += 4) {
+        float32x4_t it = neon_div(un, vaddq_f32(un, exp_neon(vnegq_f32(vld1q_f32(acc + r)))));
+        float32x4_t ft = neon_div(un, vaddq_f32(un, exp_neon(vnegq_f32(vld1q_f32(acc + ecart + r)))));
+        float32x4_t gt = vsubq_f32(un, neon_div(deux, vaddq_f32(exp_neon(vmulq_f32(deux, vld1q_f32(acc + 2 * ecart + r))), un)));
+        float32x4_t ot = neon_div(un, vaddq_f32(un, exp_neon(vnegq_f32(vld1q_f32(acc + 3 * ecart + r)))));
+
+        float32x4_t ct = neon_madd(vmulq_f32(it, gt), ft, vld1q_f32(c + r));
+        float32x4_t th = vsubq_f32(un, neon_div(deux, vaddq_f32(exp_neon(vmulq_f32(deux, ct)), un)));
+        vst1q_f32(c + r, ct);
+        vst1q_f32(h + r, vmulq_f32(ot, th));
+    }
+}
+#endif
+
+// ============================================================================
+// Choix du noyau
+// ============================================================================
+
+static LSTM_noyau     noyau_actif = LSTM_NB_NOYAUX;     // pas encore choisi
+static Produit_portes produit     = produit_portable;
+static Produit_lot    produit_lot = produit_lot_portable;
+static Produit_recurrent recurrent  = recurrent_portable;
+static Projection     projection  = projection_portable;
+static const Produit_portes    *produits_specialises   = produits_portable;
+static const Produit_recurrent *recurrents_specialises = recurrents_portable;
+static int            specialisation_active = 1;
+static Portes_rapides portes      = NULL;               // NULL : activations scalaires
+
+int LSTM_noyau_disponible(LSTM_noyau k)
+{
+    switch (k) {
+    case LSTM_NOYAU_REFERENCE:
+    case LSTM_NOYAU_PORTABLE:
+        return 1;
+#ifdef LSTM_X86
+    case LSTM_NOYAU_SSE:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse2") != 0;
+    case LSTM_NOYAU_AVX2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+#ifdef LSTM_NEON
+    case LSTM_NOYAU_NEON:
+        return 1;
+#endif
+    default:
+        return 0;
+    }
+}
+
+int LSTM_noyau_choisir(LSTM_noyau k)
+{
+    if (k < 0 || k >= LSTM_NB_NOYAUX || !LSTM_noyau_disponible(k)) return 1;
+
+    switch (k) {
+#ifdef LSTM_X86
+    case LSTM_NOYAU_SSE:
+        produit = produit_sse;  produits_specialises = produits_sse;
+        recurrent = recurrent_sse;  recurrents_specialises = recurrents_sse;
+        projection = projection_sse;
+        produit_lot = produit_lot_sse;  portes = portes_sse;  break;
+    case LSTM_NOYAU_AVX2:
+        produit = produit_avx2; produits_specialises = produits_avx2;
+        recurrent = recurrent_avx2; recurrents_specialises = recurrents_avx2;
+        projection = projection_avx2;
+        produit_lot = produit_lot_avx2; portes = portes_avx2; break;
+#endif
+#ifdef LSTM_NEON
+    case LSTM_NOYAU_NEON:
+        produit = produit_neon; produits_specialises = produits_neon;
+        recurrent = recurrent_neon; recurrents_specialises = recurrents_neon;
+        projection = projection_neon;
+        produit_lot = produit_lot_neon; portes = portes_neon; break;
+#endif
+    default:
+        produit = produit_portable; produits_specialises = produits_portable;
+        recurrent = recurrent_portable; recurrents_specialises = recurrents_portable;
+        projection = projection_portable;
+        produit_lot = produit_lot_portable; portes = NULL; break;
+    }
+    noyau_actif = k;
+    return 0;
+}
+
+LSTM_noyau LSTM_noyau_actif(void)
+{
+    if (noyau_actif == LSTM_NB_NOYAUX) {
+        static const LSTM_noyau preference[] = {
+            LSTM_NOYAU_AVX2, LSTM_NOYAU_NEON, LSTM_NOYAU_SSE, LSTM_NOYAU_PORTABLE
+        };
+        for (int i = 0; i < 4; ++i)
+            if (LSTM_noyau_choisir(preference[i]) == 0) break;
+    }
+    return noyau_actif;
+}
+
+void LSTM_specialisation_activer(int active)
+{
+    specialisation_active = (active != 0);
+}
+
+int LSTM_specialise(const LSTM_poids *p)
+{
+    return p->specialisation >= 0 && specialisation_active;
+}
+
+const char *LSTM_noyau_nom(LSTM_noyau k)
+{
+    static const char *noms[LSTM_NB_NOYAUX] = {
+        "reference", "portable", "sse", "avx2", "neon"
+    };
+    return (k >= 0 && k < LSTM_NB_NOYAUX) ? noms[k] : "?";
+}
+
+// ============================================================================
+// Un pas
+// ============================================================================
+
+// Portes, cellule et état caché à partir des accumulateurs
+static void portes_cellule(const LSTM_poids *p, const float *acc, float *h, float *c)
+{
+    const int H   = p->nb_unites;
+    const int pad = p->nb_unites_pad;
+
+    // Niveau rapide avec un noyau SIMD : activations et cellule en registres
+    // (les unités de complément restent à c = h = 0)
+    if (portes && Activation_active() == ACTIVATION_RAPIDE) {
+        _Alignas(32) float cp[LSTM_MAX_UNITES] = {0};
+        _Alignas(32) float hp[LSTM_MAX_UNITES];
+        memcpy(cp, c, (size_t)H * sizeof(float));
+        portes(pad, pad, acc, cp, hp);
+        memcpy(c, cp, (size_t)H * sizeof(float));
+        memcpy(h, hp, (size_t)H * sizeof(float));
+        return;
+    }
+
+    // Sinon : activations par tableaux au niveau actif, porte par porte
+    float it[LSTM_MAX_UNITES], ft[LSTM_MAX_UNITES];
+    float gt[LSTM_MAX_UNITES], ot[LSTM_MAX_UNITES];
+    Activation_sigmoide(H, acc,           it);
+    Activation_sigmoide(H, acc + pad,     ft);
+    Activation_tanh    (H, acc + 2 * pad, gt);
+    Activation_sigmoide(H, acc + 3 * pad, ot);
+
+    for (int r = 0; r < H; ++r)
+        c[r] = ft[r] * c[r] + it[r] * gt[r];
+    Activation_tanh(H, c, h);
+    for (int r = 0; r < H; ++r)
+        h[r] = ot[r] * h[r];
+}
+
+void LSTM_pas(const LSTM_poids *p, const float *x, float *h, float *c)
+{
+    _Alignas(32) float xh[LSTM_MAX_ENTREES + LSTM_MAX_UNITES];
+    _Alignas(32) float acc[4 * LSTM_MAX_UNITES];
+
+    if (noyau_actif == LSTM_NB_NOYAUX) LSTM_noyau_actif();
+
+    memcpy(xh, x, (size_t)p->nb_entrees * sizeof(float));
+    memcpy(xh + p->nb_entrees, h, (size_t)p->nb_unites * sizeof(float));
+
+    if (p->specialisation >= 0 && specialisation_active)
+        produits_specialises[p->specialisation](p, xh, acc);
+    else
+        produit(p, xh, acc);
+
+    portes_cellule(p, acc, h, c);
+}
+
+// ============================================================================
+// Projection des entrées hors ligne
+// ============================================================================
+
+void LSTM_projeter(const LSTM_poids *p, int T, const float *x, float *proj)
+{
+    if (noyau_actif == LSTM_NB_NOYAUX) LSTM_noyau_actif();
+    projection(p, T, x, proj);
+}
+
+void LSTM_pas_projete(const LSTM_poids *p, const float *proj, float *h, float *c)
+{
+    _Alignas(32) float hp[LSTM_MAX_UNITES];
+    _Alignas(32) float acc[4 * LSTM_MAX_UNITES];
+
+    if (noyau_actif == LSTM_NB_NOYAUX) LSTM_noyau_actif();
+
+    memcpy(hp, h, (size_t)p->nb_unites * sizeof(float));
+
+    if (p->specialisation >= 0 && specialisation_active)
+        recurrents_specialises[p->specialisation](p, proj, hp, acc);
+    else
+        recurrent(p, proj, hp, acc);
+
+    portes_cellule(p, acc, h, c);
+}
+
+// ============================================================================
+// Un pas pour un lot de cellules
+// ============================================================================
+
+#define LSTM_LOT_BLOC 64    // cellules traitées par appel d'activation
+
+void LSTM_pas_lot(const LSTM_poids *p, int cap, float *xh, float *c, float *acc)
+{
+    if (noyau_actif == LSTM_NB_NOYAUX) LSTM_noyau_actif();
+
+    const int    H     = p->nb_unites;
+    const size_t ecart = (size_t)p->nb_unites_pad * cap;   // d'une porte à la suivante
+    float       *h     = xh + (size_t)p->nb_entrees * cap;
+
+    // Toutes les portes de toutes les cellules en un produit ; h n'est
+    // réécrit qu'ensuite
+    produit_lot(p, cap, xh, acc);
+
+    for (int r = 0; r < H; ++r)
+    {
+        const float *a  = acc + (size_t)r * cap;
+        float       *cr = c   + (size_t)r * cap;
+        float       *hr = h   + (size_t)r * cap;
+
+        if (portes && Activation_active() == ACTIVATION_RAPIDE) {
+            portes(cap, (int)ecart, a, cr, hr);
+            continue;
+        }
+
+        // Activations par tableaux, par blocs de LSTM_LOT_BLOC cellules
+        for (int n = 0; n < cap; n += LSTM_LOT_BLOC)
+        {
+            const int m = (cap - n < LSTM_LOT_BLOC) ? cap - n : LSTM_LOT_BLOC;
+            float it[LSTM_LOT_BLOC], ft[LSTM_LOT_BLOC], gt[LSTM_LOT_BLOC], ot[LSTM_LOT_BLOC];
+            Activation_sigmoide(m, a + n,             it);
+            Activation_sigmoide(m, a + ecart + n,     ft);
+            Activation_tanh    (m, a + 2 * ecart + n, gt);
+            Activation_sigmoide(m, a + 3 * ecart + n, ot);
+
+            for (int q = 0; q < m; ++q)
+                cr[n + q] = ft[q] * cr[n + q] + it[q] * gt[q];
+            Activation_tanh(m, cr + n, hr + n);
+            for (int q = 0; q < m; ++q)
+                hr[n + q] = ot[q] * hr[n + q];
+        }
+    }
+}
@@ -0,0 +1,106 @@
+#ifndef LSTM_NOYAU_H
+#define LSTM_NOYAU_H
+
+// ============================================================================
+// Noyau LSTM à portes fusionnées
+//
+// Les quatre portes (i, f, g, o) sont regroupées dans un seul bloc de poids
+// [4*H x (E+H)], appliqué en UN produit matrice-vecteur au vecteur concaténé
+// [xt ; ht] ; les activations et la mise à jour de la cellule sont faites
+// dans la même passe, directement sur les accumulateurs.
+//
+// Disposition des poids (préparée une fois par LSTM_empaqueter) :
+//   - chaque porte occupe nb_unites_pad lignes (H complété à un multiple de
+//     8, lignes de complément nulles) : i | f | g | o ;
+//   - stockage par colonne : W[j * nb_lignes + ligne], j = entrée puis état
+//     caché. Le produit devient une suite de "accu += colonne * scalaire",
+//     ce qui se vectorise sans réduction horizontale.
+//
+// Plusieurs implantations du produit (C portable, SSE, AVX2+FMA, NEON) ;
+// la meilleure disponible sur le processeur est choisie à l'exécution.
+// Les résultats diffèrent de la référence scalaire (8 produits séparés)
+// par l'ordre des additions et, en AVX2/NEON, par les FMA : écart relatif
+// de l'ordre de 1e-6 sur la sortie du réseau.
+//
+// Activations au niveau choisi dans Activations.h ; au niveau rapide, les
+// noyaux SIMD les calculent directement dans les registres.
+// ============================================================================
+
+#define LSTM_MAX_ENTREES  8
+#define LSTM_MAX_UNITES   32
+#define LSTM_UNITES_PAD(n) (((n) + 7) & ~7)
+
+typedef struct
+{
+    int nb_entrees;         // E
+    int nb_unites;          // H
+    int nb_unites_pad;      // H complété à un multiple de 8
+    int nb_lignes;          // 4 * nb_unites_pad
+    int specialisation;     // produit spécialisé pour (E, H), -1 : générique
+
+    _Alignas(32) float W[(LSTM_MAX_ENTREES + LSTM_MAX_UNITES) * 4 * LSTM_MAX_UNITES];
+    _Alignas(32) float b[4 * LSTM_MAX_UNITES];
+} LSTM_poids;
+
+// Implantations du pas LSTM
+typedef enum
+{
+    LSTM_NOYAU_REFERENCE = 0,   // chemin scalaire d'origine du module appelant
+    LSTM_NOYAU_PORTABLE,        // portes fusionnées, C pur
+    LSTM_NOYAU_SSE,
+    LSTM_NOYAU_AVX2,            // AVX2 + FMA
+    LSTM_NOYAU_NEON,
+    LSTM_NB_NOYAUX
+} LSTM_noyau;
+
+// Empaquetage des matrices d'origine (ordre des portes : i, f, g, o).
+// W[k] : [H x E], R[k] : [H x H], b[k] : [H], lignes contiguës.
+// (0 = OK, 1 = dimensions non supportées)
+int LSTM_empaqueter(LSTM_poids *p, int nb_entrees, int nb_unites,
+                    const float *const W[4], const float *const R[4],
+                    const float *const b[4]);
+
+// Noyau utilisé par LSTM_pas : le meilleur disponible, sauf choix explicite
+LSTM_noyau  LSTM_noyau_actif(void);
+int         LSTM_noyau_disponible(LSTM_noyau k);
+int         LSTM_noyau_choisir(LSTM_noyau k);    // 0 = OK, 1 = non disponible
+const char *LSTM_noyau_nom(LSTM_noyau k);
+
+// Produits spécialisés par taille : pour (E, H) = (3, 12), (3, 20), (3, 32),
+// LSTM_empaqueter retient un produit à bornes constantes, choisi à chaque
+// pas dans l'implantation active ; les autres tailles passent par le
+// produit générique. Résultats identiques dans les deux cas.
+void LSTM_specialisation_activer(int active);    // 1 par défaut
+int  LSTM_specialise(const LSTM_poids *p);       // produit spécialisé utilisé ?
+
+// Un pas : x (E entrées, déjà normalisées), h et c (H valeurs) mis à jour
+void LSTM_pas(const LSTM_poids *p, const float *x, float *h, float *c);
+
+// ----------------------------------------------------------------------------
+// Projection des entrées hors ligne : quand toute la série est connue, la
+// partie W_x * x de T pas se calcule d'un bloc ([4*H x E] * [E x T], poids
+// des entrées gardés en cache), puis chaque pas ne fait plus que la partie
+// récurrente R * h.
+//   x    [T x E] : entrées normalisées, un pas par ligne
+//   proj [T x nb_lignes] : b + W_x * x_t, aligné sur 32 octets
+// Même suite d'additions que LSTM_pas avec le même noyau : LSTM_projeter
+// puis LSTM_pas_projete pas à pas donnent exactement LSTM_pas.
+// ----------------------------------------------------------------------------
+void LSTM_projeter(const LSTM_poids *p, int T, const float *x, float *proj);
+void LSTM_pas_projete(const LSTM_poids *p, const float *proj, float *h, float *c);
+
+// ----------------------------------------------------------------------------
+// Lot de cellules : un pas pour cap cellules en un seul produit matriciel
+// [4*H x (E+H)] * [(E+H) x cap] au lieu de cap produits matrice-vecteur.
+// Disposition SoA, une ligne de cap valeurs par grandeur :
+//   xh  [(E+H) x cap] : entrées normalisées puis états cachés (h mis à jour)
+//   c   [H x cap]     : cellules (mises à jour)
+//   acc [nb_lignes x cap] : accumulateurs des portes (travail)
+// cap multiple de 8, tableaux alignés sur 32 octets. Même ordre d'addition
+// que LSTM_pas avec le même noyau : résultats identiques cellule par cellule.
+// ----------------------------------------------------------------------------
+#define LSTM_LOT_CAPACITE(n) (((n) + 7) & ~7)
+
+void LSTM_pas_lot(const LSTM_poids *p, int cap, float *xh, float *c, float *acc);
+
+#endif // LSTM_NOYAU_H
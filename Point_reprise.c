@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <string.h>
+#include "Point_reprise.h"
+#include "Activations.h"
+
+// ============================================================================
+// Helpers internes
+// ============================================================================
+
+static void tailles_contextes(uint32_t tailles[REPRISE_NB_MODULES])
+{
+    tailles[0] = sizeof(TEMP_Context);
+    tailles[1] = sizeof(TENSION_Context);
+    tailles[2] = sizeof(SOE_Context);
+    tailles[3] = sizeof(SOH_Context);
+    tailles[4] = sizeof(RUL_Context);
+    tailles[5] = sizeof(RINT_Context);
+    tailles[6] = sizeof(SOC_Context);
+    tailles[7] = sizeof(SOP_Context);
+    tailles[8] = sizeof(Detection_Context);
+    tailles[9] = 2 * sizeof(SOP_Amorce);
+}
+
+static void identifier_modele_soc(Reprise_modele_soc *id, const SOC_Context *soc)
+{
+    id->empreinte    = SOC_Modele_empreinte(soc->modele);
+    id->nb_unites    = (uint32_t)soc->modele->lstm.nb_unites;
+    id->activation   = (uint32_t)Activation_active();
+    id->noyau_genere = (soc->modele->genere != NULL);
+}
+
+// ============================================================================
+// Capture / restauration
+// ============================================================================
+
+void Reprise_capturer(Reprise_instantane *r, const Reprise_modules *m,
+                      uint64_t echantillon, int64_t position_resultats)
+{
+    memset(r, 0, sizeof(*r));
+    memcpy(r->magique, REPRISE_MAGIQUE, 4);
+    r->version = REPRISE_VERSION;
+    tailles_contextes(r->tailles);
+    identifier_modele_soc(&r->modele_soc, m->soc);
+
+    r->echantillon        = echantillon;
+    r->position_resultats = position_resultats;
+
+    r->temp    = *m->temp;
+    r->tension = *m->tension;
+    r->soe     = *m->soe;
+    r->soh     = *m->soh;
+    r->rul     = *m->rul;
+    r->rint    = *m->rint;
+    r->soc     = *m->soc;
+    r->sop     = *m->sop;
+    r->detection = *m->detection;
+    r->sop_amorces[0] = m->sop_deux_sens->amorce[0];
+    r->sop_amorces[1] = m->sop_deux_sens->amorce[1];
+
+    // Pointeurs vers les tables : sans valeur d'une exécution à l'autre
+    r->tension.OCV_charge         = NULL;
+    r->tension.OCV_decharge       = NULL;
+    r->soe.LOI_INTEG_OCV_DECHARGE = NULL;
+    r->rul.Loi_RUL.x              = NULL;
+    r->rul.Loi_RUL.y              = NULL;
+    r->soc.modele                 = NULL;
+    r->sop.modele                 = NULL;
+}
+
+int Reprise_restaurer(const Reprise_instantane *r, const Reprise_modules *m,
+                      const char *chemin)
+{
+    Reprise_modele_soc id;
+    identifier_modele_soc(&id, m->soc);
+    if (memcmp(&id, &r->modele_soc, sizeof(id)) != 0) {
+        printf("Erreur : %s produit par un autre modele SOC "
+               "(empreinte %08X, %u unites, activations %u, noyau genere %u ; "
+               "actuel %08X, %u unites, activations %u, noyau genere %u)\n",
+               chemin, (unsigned)r->modele_soc.empreinte, (unsigned)r->modele_soc.nb_unites,
+               (unsigned)r->modele_soc.activation, (unsigned)r->modele_soc.noyau_genere,
+               (unsigned)id.empreinte, (unsigned)id.nb_unites,
+               (unsigned)id.activation, (unsigned)id.noyau_genere);
+        return 1;
+    }
+
+    // Les contextes sont initialisés : on garde leurs tables
+    TENSION_Context tension = r->tension;
+    tension.OCV_charge   = m->tension->OCV_charge;
+    tension.OCV_decharge = m->tension->OCV_decharge;
+
+    SOE_Context soe = r->soe;
+    soe.LOI_INTEG_OCV_DECHARGE = m->soe->LOI_INTEG_OCV_DECHARGE;
+
+    RUL_Context rul = r->rul;
+    rul.Loi_RUL.x = m->rul->Loi_RUL.x;
+    rul.Loi_RUL.y = m->rul->Loi_RUL.y;
+
+    SOC_Context soc = r->soc;
+    soc.modele = m->soc->modele;
+
+    SOP_Context sop = r->sop;
+    sop.modele = m->sop->modele;
+
+    *m->temp    = r->temp;
+    *m->tension = tension;
+    *m->soe     = soe;
+    *m->soh     = r->soh;
+    *m->rul     = rul;
+    *m->rint    = r->rint;
+    *m->soc     = soc;
+    *m->sop     = sop;
+    *m->detection = r->detection;
+    m->sop_deux_sens->amorce[0] = r->sop_amorces[0];
+    m->sop_deux_sens->amorce[1] = r->sop_amorces[1];
+    return 0;
+}
+
+// ============================================================================
+// Fichier
+// ============================================================================
+
+int Reprise_ecrire(const char *chemin, const Reprise_instantane *r)
+{
+    char temporaire[260];
+    snprintf(temporaire, sizeof(temporaire), "%s.tmp", chemin);
+
+    FILE *f = fopen(temporaire, "wb");
+    if (!f) {
+        perror("Erreur ouverture fichier");
+        return 1;
+    }
+    int ok = (fwrite(r, sizeof(*r), 1, f) == 1);
+    if (fclose(f) != 0) ok = 0;
+
+    // rename n'écrase pas un fichier existant sous Windows
+#ifdef _WIN32
+    if (ok) remove(chemin);
+#endif
+    if (!ok || rename(temporaire, chemin) != 0) {
+        printf("Erreur ecriture point de reprise %s\n", chemin);
+        remove(temporaire);
+        return 1;
+    }
+    return 0;
+}
+
+int Reprise_lire(const char *chemin, Reprise_instantane *r)
+{
+    FILE *f = fopen(chemin, "rb");
+    if (!f) {
+        perror("Erreur ouverture fichier");
+        return 1;
+    }
+
+    // lecture d'un octet de plus pour détecter un fichier trop long
+    char en_trop;
+    int ok = (fread(r, sizeof(*r), 1, f) == 1) && (fread(&en_trop, 1, 1, f) == 0);
+    fclose(f);
+
+    uint32_t tailles[REPRISE_NB_MODULES];
+    tailles_contextes(tailles);
+
+    if (!ok || memcmp(r->magique, REPRISE_MAGIQUE, 4) != 0) {
+        printf("Erreur : %s n'est pas un point de reprise valide\n", chemin);
+        return 1;
+    }
+    if (r->version != REPRISE_VERSION ||
+        memcmp(r->tailles, tailles, sizeof(tailles)) != 0) {
+        printf("Erreur : %s produit par une autre version des modules\n", chemin);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,98 @@
+#ifndef POINT_REPRISE_H
+#define POINT_REPRISE_H
+
+#include <stdint.h>
+
+#include "sur_temperature.h"
+#include "sur_tension.h"
+#include "SOE.h"
+#include "SOH.h"
+#include "RUL.h"
+#include "RINT.h"
+#include "SOC.h"
+#include "SOP.h"
+#include "Detection_phase.h"
+
+// ============================================================================
+// Point de reprise : image binaire versionnée de tous les contextes
+//
+// L'instantané contient une copie de chaque X_Context, le prochain
+// échantillon à traiter et la position de fin du fichier de résultats.
+// Capture et restauration sont de simples copies de structures ; l'écriture
+// passe par un fichier temporaire renommé, pour ne jamais laisser de point
+// de reprise à moitié écrit.
+//
+// Les tables (pointeurs vers les constantes des modules) ne sont pas
+// sauvegardées : elles sont reprises d'un contexte fraîchement initialisé.
+// L'identité du modèle SOC (empreinte des poids, taille, niveau des
+// activations, noyau généré) est enregistrée : la restauration refuse un
+// état produit par un autre modèle.
+// Toute modification d'un X_Context change sa taille enregistrée dans
+// l'en-tête et rend les anciens points de reprise illisibles (refusés).
+// ============================================================================
+
+#define REPRISE_MAGIQUE  "PRTK"
+#define REPRISE_VERSION  5
+#define REPRISE_NB_MODULES 10
+
+// Contextes de la boucle principale
+typedef struct
+{
+    TEMP_Context    *temp;
+    TENSION_Context *tension;
+    SOE_Context     *soe;
+    SOH_Context     *soh;
+    RUL_Context     *rul;
+    RINT_Context    *rint;
+    SOC_Context     *soc;
+    SOP_Context     *sop;
+    Detection_Context *detection;           // phase charge/décharge commune
+    SOP_Deux_sens   *sop_deux_sens;         // seules les amorces sont gardées
+} Reprise_modules;
+
+// Modèle SOC qui a produit l'état
+typedef struct
+{
+    uint32_t empreinte;                       // SOC_Modele_empreinte
+    uint32_t nb_unites;
+    uint32_t activation;                      // Activation_niveau
+    uint32_t noyau_genere;                    // 1 : noyau LSTM_genere
+} Reprise_modele_soc;
+
+typedef struct
+{
+    char     magique[4];                      // "PRTK"
+    uint32_t version;
+    uint32_t tailles[REPRISE_NB_MODULES];     // sizeof de chaque contexte
+    uint32_t reserve;
+    Reprise_modele_soc modele_soc;
+
+    uint64_t echantillon;                     // prochain échantillon à traiter
+    int64_t  position_resultats;              // fin du fichier de résultats
+
+    TEMP_Context    temp;
+    TENSION_Context tension;
+    SOE_Context     soe;
+    SOH_Context     soh;
+    RUL_Context     rul;
+    RINT_Context    rint;
+    SOC_Context     soc;
+    SOP_Context     sop;
+    Detection_Context detection;
+    SOP_Amorce      sop_amorces[2];         // démarrage à chaud charge, décharge
+} Reprise_instantane;
+
+// Copie des contextes dans l'instantané
+void Reprise_capturer(Reprise_instantane *r, const Reprise_modules *m,
+                      uint64_t echantillon, int64_t position_resultats);
+
+// Copie de l'instantané dans les contextes (déjà initialisés par X_init)
+// 0 = OK, 1 = modèle SOC différent (contextes inchangés)
+int Reprise_restaurer(const Reprise_instantane *r, const Reprise_modules *m,
+                      const char *chemin);
+
+// Écriture atomique / lecture avec vérification (0 = OK, 1 = erreur)
+int Reprise_ecrire(const char *chemin, const Reprise_instantane *r);
+int Reprise_lire(const char *chemin, Reprise_instantane *r);
+
+#endif // POINT_REPRISE_H
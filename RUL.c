@@ -1,9 +1,6 @@
 #include <math.h>
 #include "RUL.h"
 
-// Prototype de l'interpolation (implémentée ailleurs)
-float interp1Drapide(const float *x, const float *y, int n, float x_req);
-
 /* ================== Helpers matrices 2x2 / 2x1 ================== */
 
 static inline float f_absf(float x) { return x < 0.0f ? -x : x; }
@@ -86,10 +83,7 @@ static void estimation_RUL_core(RUL_Context *ctx, float SOH, float delta_SOC)
         Pkkm1[2] += ctx->Q[2]; Pkkm1[3] += ctx->Q[3];
 
         /* Mesure z = RUL_modele(SOH) via loi RUL(SOH) */
-        float z_mes = interp1Drapide(ctx->X_Loi_RUL,
-                                     ctx->Y_Loi_RUL,
-                                     ctx->n_loi,
-                                     SOH);
+        float z_mes = Interpolateur_eval(&ctx->Loi_RUL, SOH);
 
         /* Résidu : z - H x_pred ; ici H = [1 0], donc H*x_pred = x_pred[0] */
         float residu = z_mes - x_pred[0];
@@ -154,15 +148,10 @@ void RUL_init(RUL_Context *ctx)
     ctx->P[3] = 0.0129244f;
 
     /* Loi RUL(SOH) */
-    ctx->X_Loi_RUL = X_Loi_RUL_tab;
-    ctx->Y_Loi_RUL = Y_Loi_RUL_tab;
-    ctx->n_loi     = N_LOI_RUL;
+    Interpolateur_init(&ctx->Loi_RUL, X_Loi_RUL_tab, Y_Loi_RUL_tab, N_LOI_RUL);
 
     /* Initialisation des états internes */
-    ctx->RUL_est = interp1Drapide(ctx->X_Loi_RUL,
-                                  ctx->Y_Loi_RUL,
-                                  ctx->n_loi,
-                                  1.0f);      // SOH=1
+    ctx->RUL_est = Interpolateur_eval(&ctx->Loi_RUL, 1.0f);      // SOH=1
 
     ctx->vitesse_degradation = 1.0f;
     ctx->integrale_SOC       = 0.0f;
@@ -1,6 +1,8 @@
 #ifndef RUL_H
 #define RUL_H
 
+#include "Interpolateur.h"
+
 // ============================================================================
 // Contexte RUL : paramètres + états internes du filtre de Kalman
 // ============================================================================
@@ -17,10 +19,8 @@ typedef struct
     float R;        // variance de bruit de mesure
     float P[4];     // covariance d'état 2x2
 
-    // Loi RUL(SOH)
-    const float *X_Loi_RUL;
-    const float *Y_Loi_RUL;
-    int          n_loi;
+    // Loi RUL(SOH) : abscisses irrégulières, intervalle mémorisé
+    Interpolateur Loi_RUL;
 
     // États internes du filtre
     float RUL_est;             // composante d'état : RUL
@@ -1,59 +1,242 @@
 #include "Read_Write.h"
+#include "Conteneur.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <time.h>
+#endif
+
+// ============================================================================
+// Projection mémoire des fichiers d'entrée (lecture seule, zéro copie)
+//
+// Les fichiers sont projetés avec mmap (MapViewOfFile sous Windows) : aucune
+// copie en RAM, les pages sont lues à la demande et le cache disque est
+// partagé entre plusieurs exécutions sur le même jeu de données.
+// On garde la taille de chaque projection pour pouvoir la libérer à partir
+// de la seule adresse (Free_donnees ne connaît que les pointeurs).
+// ============================================================================
+
+#define NB_MAPPAGES_MAX 32
+
+typedef struct {
+    const void *adresse;
+    size_t      taille;
+} Mappage;
+
+static Mappage mappages[NB_MAPPAGES_MAX];
+static size_t  nb_echantillons_charges = 0;
+
+const void *Mappe_fichier(const char *chemin, size_t *taille_octets)
+{
+    if (taille_octets) *taille_octets = 0;
+
+    int libre = -1;
+    for (int k = 0; k < NB_MAPPAGES_MAX; ++k) {
+        if (mappages[k].adresse == NULL) { libre = k; break; }
+    }
+    if (libre < 0) {
+        printf("Erreur : trop de fichiers projetes en memoire\n");
+        return NULL;
+    }
+
+    void  *adresse = NULL;
+    size_t taille  = 0;
+
+#ifdef _WIN32
+    HANDLE fichier = CreateFileA(chemin, GENERIC_READ, FILE_SHARE_READ, NULL,
+                                 OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (fichier == INVALID_HANDLE_VALUE) {
+        printf("Erreur ouverture fichier %s\n", chemin);
+        return NULL;
+    }
+    LARGE_INTEGER taille_fichier;
+    if (!GetFileSizeEx(fichier, &taille_fichier) || taille_fichier.QuadPart == 0) {
+        printf("Erreur taille fichier %s\n", chemin);
+        CloseHandle(fichier);
+        return NULL;
+    }
+    taille = (size_t)taille_fichier.QuadPart;
+    HANDLE projection = CreateFileMappingA(fichier, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (projection != NULL) {
+        adresse = MapViewOfFile(projection, FILE_MAP_READ, 0, 0, 0);
+        // la vue garde la projection vivante : on peut fermer les handles
+        CloseHandle(projection);
+    }
+    CloseHandle(fichier);
+    if (adresse == NULL) {
+        printf("Erreur projection fichier %s\n", chemin);
+        return NULL;
+    }
+#else
+    int fd = open(chemin, O_RDONLY);
+    if (fd < 0) {
+        printf("Erreur ouverture fichier %s\n", chemin);
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        printf("Erreur taille fichier %s\n", chemin);
+        close(fd);
+        return NULL;
+    }
+    taille  = (size_t)st.st_size;
+    adresse = mmap(NULL, taille, PROT_READ, MAP_SHARED, fd, 0);
+    // le descripteur n'est plus nécessaire une fois la projection faite
+    close(fd);
+    if (adresse == MAP_FAILED) {
+        perror("Erreur mmap");
+        return NULL;
+    }
+    // lecture séquentielle dans la boucle de rejeu : lecture anticipée agressive
+    madvise(adresse, taille, MADV_SEQUENTIAL);
+#endif
+
+    mappages[libre].adresse = adresse;
+    mappages[libre].taille  = taille;
+    if (taille_octets) *taille_octets = taille;
+    return adresse;
+}
+
+void Demappe_fichier(const void *adresse)
+{
+    if (adresse == NULL) return;
+
+    for (int k = 0; k < NB_MAPPAGES_MAX; ++k) {
+        if (mappages[k].adresse == adresse) {
+#ifdef _WIN32
+            UnmapViewOfFile(adresse);
+#else
+            munmap((void *)adresse, mappages[k].taille);
+#endif
+            mappages[k].adresse = NULL;
+            mappages[k].taille  = 0;
+            return;
+        }
+    }
+    printf("Erreur : adresse %p non projetee\n", adresse);
+}
+
+size_t Nb_echantillons_donnees(void)
+{
+    return nb_echantillons_charges;
+}
+
+// Conteneur utilisé par le dernier Charge_donnees (base NULL : fichiers .bin)
+static Conteneur conteneur_donnees;
+// Canaux compressés du conteneur, décodés en mémoire (NULL sinon)
+static float *canaux_decodes[5];
+
+// Chargement depuis ../donnees/donnees.prt s'il existe : une seule projection,
+// longueurs vérifiées à l'ouverture. Renvoie 1 si les données viennent du conteneur.
+static int Charge_conteneur(const float **donnees[], const char *const canaux[], int nb)
+{
+    const char *chemin = "../donnees/" DONNEES_CONTENEUR;
+
+    FILE *fp = fopen(chemin, "rb");
+    if (fp == NULL) return 0;
+    fclose(fp);
+
+    if (Conteneur_ouvrir(&conteneur_donnees, chemin) != 0) return 0;
+
+    size_t N = (size_t)conteneur_donnees.entete->nb_echantillons;
+    for (int k = 0; k < nb; k++) {
+        const Conteneur_canal *canal = Conteneur_trouver_canal(&conteneur_donnees, canaux[k]);
+
+        if (canal && canal->type == CONTENEUR_F32_XOR) {
+            // pas de vue directe sur un canal compressé : décodage complet
+            canaux_decodes[k] = (float *)malloc(N * sizeof(float));
+            if (canaux_decodes[k] &&
+                Conteneur_lire_f32(&conteneur_donnees, canaux[k], 0, N, canaux_decodes[k]) != 0) {
+                free(canaux_decodes[k]);
+                canaux_decodes[k] = NULL;
+            }
+            *donnees[k] = canaux_decodes[k];
+        } else {
+            *donnees[k] = Conteneur_canal_f32(&conteneur_donnees, canaux[k], NULL);
+        }
+
+        if (*donnees[k] == NULL) {
+            for (int j = 0; j <= k; j++) {
+                free(canaux_decodes[j]);
+                canaux_decodes[j] = NULL;
+                *donnees[j] = NULL;
+            }
+            Conteneur_fermer(&conteneur_donnees);
+            return 0;
+        }
+    }
+
+    nb_echantillons_charges = N;
+    return 1;
+}
 
 void Charge_donnees (const float **courant,const float **tension, const float **temperature, const float **SOH, const float **SOC) {
+    const char *canaux[] = {"courant", "tension", "temperature", "SOH", "SOC"};
     char *fichiers[] = {"courant.bin", "tension.bin", "temperature.bin",  "SOH.bin", "SOC.bin"};
     //tableau avec les adresses des pointeurs
     const float **donnees[] = {courant, tension, temperature, SOH, SOC };
     int nFichiers = 5;
-    
-    size_t N = 4841577; // nombre d'éléments dans ton fichier
+
+    if (Charge_conteneur(donnees, canaux, nFichiers)) return;
+
+    // N est déduit de la taille des fichiers (plus de valeur codée en dur)
+    size_t N = 0;
+    nb_echantillons_charges = 0;
 
     for(int k = 0; k < nFichiers; k++) {
-        //on modifie l'adresse vers laquel pointe le pointeur (dereferencement donnees)
-        *donnees[k] = malloc(N * sizeof(float));
+        char chemin[256];
+        snprintf(chemin, sizeof(chemin), "../donnees/%s", fichiers[k]); // dossier "donnees"
+
+        size_t taille = 0;
+        *donnees[k] = (const float *)Mappe_fichier(chemin, &taille);
         if(*donnees[k] == NULL) {
-            printf("Erreur allocation mémoire\n");
-            // ici, tu pourrais libérer ce qui a déjà été alloué
+            // on libère ce qui a déjà été projeté
+            for (int j = 0; j < k; j++) {
+                Demappe_fichier(*donnees[j]);
+                *donnees[j] = NULL;
+            }
             return;
         }
-    }
 
-    for(int k = 0; k < nFichiers; k++) {
-    // Si besoin, tu peux construire un chemin complet
-    char chemin[256];
-    snprintf(chemin, sizeof(chemin), "../donnees/%s", fichiers[k]); // dossier "donnees"
-    //snprintf(chemin, sizeof(chemin), "donnees/%s", fichiers[k]);
-    //printf(chemin);
-    
-    FILE *fp;
-    // Ouverture du fichier binaire
-    fp = fopen(chemin, "rb"); // rb = read binary
-    if(fp == NULL) {
-        printf("Erreur ouverture fichier !\n");
-        // Donner contient les adresses des pointeurs, je veux modifier l'adresse pointer par le pointeur, donc dereferencement
-        free(*donnees[k]);
-        return;
-    }
+        if (taille % sizeof(float) != 0) {
+            printf("Attention : %s n'a pas une taille multiple de %zu octets\n",
+                   fichiers[k], sizeof(float));
+        }
 
-    // Lecture des données dans le vecteur
-    size_t nbLu = fread(*donnees[k], sizeof(float), N, fp);
-    if(nbLu != N) {
-        printf("Erreur lecture fichier : lu %zu éléments au lieu de %zu\n", nbLu, N);
+        size_t n = taille / sizeof(float);
+        if (k == 0) {
+            N = n;
+        } else if (n != N) {
+            printf("Attention : %s contient %zu elements au lieu de %zu\n", fichiers[k], n, N);
+            if (n < N) N = n;
+        }
     }
 
-    fclose(fp);
-
-    //printf("Premier : %f\n", (*donnees[k])[0]);
-    //printf("Dernier : %f\n", (*donnees[k])[N-1]);
-    }
+    nb_echantillons_charges = N;
 }
 
 void Free_donnees (const float *courant, const float *tension, const float *temperature, const float *SOH, const float *SOC) {
-    free(courant);
-    free(tension);
-    free(temperature);
-    free(SOH);
-    free(SOC);
+    if (conteneur_donnees.base != NULL) {
+        // toutes les vues pointent dans la même projection
+        for (int k = 0; k < 5; k++) {
+            free(canaux_decodes[k]);
+            canaux_decodes[k] = NULL;
+        }
+        Conteneur_fermer(&conteneur_donnees);
+        nb_echantillons_charges = 0;
+        return;
+    }
+    Demappe_fichier(courant);
+    Demappe_fichier(tension);
+    Demappe_fichier(temperature);
+    Demappe_fichier(SOH);
+    Demappe_fichier(SOC);
+    nb_echantillons_charges = 0;
 }
 
 int Ecriture_result(float *data, const int NbIteration, const char *nom_fichier){
@@ -131,47 +314,19 @@ float interp1Drapide(const float *x_tab, const float *y_tab, int n, float x)
 }
 
 // ============================================================================
-// Reproduction de detection_phase_charge_decharge.m en C
-//
-// état = 0 --> charge
-// état = 1 --> décharge
+// Horloge monotone des bancs d'essai (secondes, origine arbitraire)
 // ============================================================================
-void detection_charge_decharge_rw(
-    float courant,
-    float tampon_charge_decharge[60],
-    int *etat,
-    int *etat_precedent
-)
-{
-    // tampon_charge_decharge(2:end) = tampon_charge_decharge(1:end-1);
-    for (int k = 59; k > 0; --k) {
-        tampon_charge_decharge[k] = tampon_charge_decharge[k - 1];
-    }
-
-    // tampon_charge_decharge(1) = courant;
-    tampon_charge_decharge[0] = courant;
-
-    // moyenne_charge_decharge = mean(tampon_charge_decharge);
-    float somme = 0.0f;
-    for (int k = 0; k < 60; ++k) {
-        somme += tampon_charge_decharge[k];
-    }
-    float moyenne_charge_decharge = somme / 60.0f;
-
-    int etat_loc = *etat_precedent;
 
-    // Mise à jour de l'état charge/décharge
-    // état = 0 --> charge
-    // état = 1 --> décharge
-    if (moyenne_charge_decharge > 0.1f && etat_loc == 0) {
-        // on était en charge, on passe en décharge
-        etat_loc = 1;
-    } else if (moyenne_charge_decharge < -1.0f && etat_loc == 1) {
-        // on était en décharge, on passe en charge
-        etat_loc = 0;
-    }
-    // sinon : etat_loc inchangé
-
-    *etat = etat_loc;
-    *etat_precedent = etat_loc;
-}
\ No newline at end of file
+double Horloge_secondes(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER compteur, frequence;
+    QueryPerformanceCounter(&compteur);
+    QueryPerformanceFrequency(&frequence);
+    return (double)compteur.QuadPart / (double)frequence.QuadPart;
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + 1e-9 * (double)t.tv_nsec;
+#endif
+}
@@ -4,10 +4,22 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+// Projection mémoire en lecture seule d'un fichier (NULL si erreur)
+const void *Mappe_fichier(const char *chemin, size_t *taille_octets);
+void Demappe_fichier(const void *adresse);
+
+// Conteneur lu en priorité par Charge_donnees (sinon les 5 fichiers .bin)
+#define DONNEES_CONTENEUR "donnees.prt"
+
+// Les vecteurs rendus par Charge_donnees sont des vues projetées en mémoire
+// (lecture seule) : ne pas les modifier, les libérer avec Free_donnees.
 void Charge_donnees (const float **courant,const float **tension, const float **temperature, const float **SOH, const float **SOC);
 void Free_donnees (const float *courant, const float *tension, const float *temperature, const float *SOH, const float *SOC);
+// Nombre d'échantillons du dernier Charge_donnees (déduit de la taille des fichiers)
+size_t Nb_echantillons_donnees(void);
 int Ecriture_result(float *data, const int NbIteration, const char *nom_fichier);
 int Ecriture_result_int(int *data, const int NbIteration, const char *nom_fichier);
 float interp1Drapide(const float *x_tab, const float *y_tab, int n, float x);
-void detection_charge_decharge_rw(float courant,float tampon_charge_decharge[60],int *etat,int *etat_precedent);
+// Horloge monotone pour les chronométrages des bancs d'essai (s)
+double Horloge_secondes(void);
 #endif 
\ No newline at end of file
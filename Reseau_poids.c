@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include <string.h>
+#include "Reseau_poids.h"
+#include "Read_Write.h"
+
+// ============================================================================
+// Helpers internes
+// ============================================================================
+
+static uint64_t aligne(uint64_t position)
+{
+    return (position + RESEAU_ALIGNEMENT - 1) / RESEAU_ALIGNEMENT * RESEAU_ALIGNEMENT;
+}
+
+const char *Reseau_nom_bloc(Reseau_bloc b)
+{
+    static const char *noms[RESEAU_NB_BLOCS] = {
+        "MOY", "ECART_TYPE",
+        "Wi", "Wf", "Wg", "Wo",
+        "Ri", "Rf", "Rg", "Ro",
+        "bi", "bf", "bg", "bo",
+        "WFC", "bFC", "HT_INIT", "CT_INIT"
+    };
+    return (b >= 0 && b < RESEAU_NB_BLOCS) ? noms[b] : "?";
+}
+
+size_t Reseau_taille_bloc(Reseau_bloc b, uint32_t E, uint32_t H, uint32_t O)
+{
+    switch (b) {
+    case RESEAU_MOY: case RESEAU_ECART_TYPE:
+        return E;
+    case RESEAU_WI: case RESEAU_WF: case RESEAU_WG: case RESEAU_WO:
+        return (size_t)H * E;
+    case RESEAU_RI: case RESEAU_RF: case RESEAU_RG: case RESEAU_RO:
+        return (size_t)H * H;
+    case RESEAU_BI: case RESEAU_BF: case RESEAU_BG: case RESEAU_BO:
+    case RESEAU_HT_INIT: case RESEAU_CT_INIT:
+        return H;
+    case RESEAU_WFC:
+        return (size_t)O * H;
+    case RESEAU_BFC:
+        return O;
+    default:
+        return 0;
+    }
+}
+
+static int dimensions_valides(uint32_t E, uint32_t H, uint32_t O)
+{
+    return E >= 1 && E <= RESEAU_TAILLE_MAX &&
+           H >= 1 && H <= RESEAU_TAILLE_MAX &&
+           O >= 1 && O <= RESEAU_TAILLE_MAX;
+}
+
+// ============================================================================
+// Lecture
+// ============================================================================
+
+int Reseau_ouvrir(Reseau_poids *r, const char *chemin)
+{
+    if (!r) return 1;
+    memset(r, 0, sizeof(*r));
+
+    size_t taille = 0;
+    const uint8_t *base = (const uint8_t *)Mappe_fichier(chemin, &taille);
+    if (!base) return 1;
+
+    const Reseau_entete *e = (const Reseau_entete *)base;
+    int erreur = 0;
+
+    if (taille < sizeof(Reseau_entete) || memcmp(e->magique, RESEAU_MAGIQUE, 4) != 0) {
+        printf("Erreur : %s n'est pas un fichier de poids PRTW\n", chemin);
+        erreur = 1;
+    } else if (e->version != RESEAU_VERSION) {
+        printf("Erreur : %s version %u non supportee (attendu %d)\n",
+               chemin, e->version, RESEAU_VERSION);
+        erreur = 1;
+    } else if (!dimensions_valides(e->nb_entrees, e->nb_unites, e->nb_sorties) ||
+               memchr(e->nom, '\0', RESEAU_NOM_MAX) == NULL) {
+        printf("Erreur : %s en-tete invalide\n", chemin);
+        erreur = 1;
+    }
+
+    // Chaque bloc doit être aligné et entièrement dans le fichier
+    for (int b = 0; b < RESEAU_NB_BLOCS && !erreur; ++b) {
+        uint64_t octets = Reseau_taille_bloc((Reseau_bloc)b, e->nb_entrees,
+                                             e->nb_unites, e->nb_sorties) * sizeof(float);
+        if (e->offset[b] % RESEAU_ALIGNEMENT != 0 || e->offset[b] < sizeof(Reseau_entete) ||
+            e->offset[b] > taille || octets > taille - e->offset[b]) {
+            printf("Erreur : %s bloc %s invalide\n", chemin, Reseau_nom_bloc((Reseau_bloc)b));
+            erreur = 1;
+        }
+    }
+
+    if (erreur) {
+        Demappe_fichier(base);
+        return 1;
+    }
+
+    r->base   = base;
+    r->taille = taille;
+    r->entete = e;
+    for (int b = 0; b < RESEAU_NB_BLOCS; ++b)
+        r->bloc[b] = (const float *)(base + e->offset[b]);
+    return 0;
+}
+
+void Reseau_fermer(Reseau_poids *r)
+{
+    if (!r || !r->base) return;
+    Demappe_fichier(r->base);
+    memset(r, 0, sizeof(*r));
+}
+
+// ============================================================================
+// Écriture
+// ============================================================================
+
+int Reseau_ecrire(const char *chemin, const char *nom,
+                  uint32_t E, uint32_t H, uint32_t O,
+                  const float *const blocs[RESEAU_NB_BLOCS])
+{
+    if (!dimensions_valides(E, H, O)) {
+        printf("Erreur : dimensions du reseau invalides (%u, %u, %u)\n", E, H, O);
+        return 1;
+    }
+    if (!nom || strlen(nom) >= RESEAU_NOM_MAX) {
+        printf("Erreur : nom de reseau invalide\n");
+        return 1;
+    }
+
+    Reseau_entete e;
+    memset(&e, 0, sizeof(e));
+    memcpy(e.magique, RESEAU_MAGIQUE, 4);
+    e.version    = RESEAU_VERSION;
+    e.nb_entrees = E;
+    e.nb_unites  = H;
+    e.nb_sorties = O;
+    strcpy(e.nom, nom);
+
+    uint64_t position = aligne(sizeof(Reseau_entete));
+    for (int b = 0; b < RESEAU_NB_BLOCS; ++b) {
+        e.offset[b] = position;
+        position = aligne(position + Reseau_taille_bloc((Reseau_bloc)b, E, H, O) * sizeof(float));
+    }
+
+    FILE *f = fopen(chemin, "wb");
+    if (!f) {
+        perror("Erreur ouverture fichier");
+        return 1;
+    }
+
+    static const uint8_t zeros[RESEAU_ALIGNEMENT] = {0};
+    int ok = (fwrite(&e, 1, sizeof(e), f) == sizeof(e));
+    position = sizeof(e);
+
+    for (int b = 0; b < RESEAU_NB_BLOCS && ok; ++b) {
+        // bourrage jusqu'au début du bloc
+        size_t bourrage = (size_t)(e.offset[b] - position);
+        size_t n        = Reseau_taille_bloc((Reseau_bloc)b, E, H, O);
+        ok = (fwrite(zeros, 1, bourrage, f) == bourrage) &&
+             (fwrite(blocs[b], sizeof(float), n, f) == n);
+        position = e.offset[b] + n * sizeof(float);
+    }
+
+    if (fclose(f) != 0) ok = 0;
+    if (!ok) {
+        printf("Erreur ecriture %s\n", chemin);
+        return 1;
+    }
+    return 0;
+}
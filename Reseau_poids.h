@@ -0,0 +1,76 @@
+#ifndef RESEAU_POIDS_H
+#define RESEAU_POIDS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ============================================================================
+// Fichier de poids d'un réseau LSTM (.prtw)
+//
+// Remplace les tableaux recopiés dans chaque source (SOC.c, SOC_Aurore.c,
+// .ino...) : un réentraînement ne demande plus de recompilation.
+//   - un en-tête fixe : tailles (entrées E, unités H, sorties O), nom du
+//     réseau, position de chaque bloc ;
+//   - puis les blocs float, chacun aligné sur 64 octets : statistiques de
+//     normalisation, matrices des portes (ordre i, f, g, o, lignes
+//     contiguës comme dans les sources), couche de sortie, états initiaux.
+// Le fichier est projeté en mémoire (Mappe_fichier) : les blocs s'utilisent
+// sur place, alignés pour les chargements SIMD.
+// Format little-endian (x86 / ARM).
+// ============================================================================
+
+#define RESEAU_MAGIQUE     "PRTW"
+#define RESEAU_VERSION     1
+#define RESEAU_ALIGNEMENT  64
+#define RESEAU_NOM_MAX     32
+#define RESEAU_TAILLE_MAX  4096     // borne de chaque dimension
+
+typedef enum
+{
+    RESEAU_MOY = 0,         // [E]
+    RESEAU_ECART_TYPE,      // [E]
+    RESEAU_WI, RESEAU_WF, RESEAU_WG, RESEAU_WO,     // [H x E]
+    RESEAU_RI, RESEAU_RF, RESEAU_RG, RESEAU_RO,     // [H x H]
+    RESEAU_BI, RESEAU_BF, RESEAU_BG, RESEAU_BO,     // [H]
+    RESEAU_WFC,             // [O x H]
+    RESEAU_BFC,             // [O]
+    RESEAU_HT_INIT,         // [H]
+    RESEAU_CT_INIT,         // [H]
+    RESEAU_NB_BLOCS
+} Reseau_bloc;
+
+typedef struct
+{
+    char     magique[4];                // "PRTW"
+    uint32_t version;
+    uint32_t nb_entrees;
+    uint32_t nb_unites;
+    uint32_t nb_sorties;
+    uint32_t reserve;
+    char     nom[RESEAU_NOM_MAX];       // terminé par '\0'
+    uint64_t offset[RESEAU_NB_BLOCS];   // depuis le début du fichier (multiple de 64)
+} Reseau_entete;
+
+// Réseau ouvert (projection mémoire en lecture seule)
+typedef struct
+{
+    const uint8_t       *base;
+    size_t               taille;
+    const Reseau_entete *entete;
+    const float         *bloc[RESEAU_NB_BLOCS];
+} Reseau_poids;
+
+// Nom d'un bloc (celui des tableaux dans les sources) et nombre de floats
+const char *Reseau_nom_bloc(Reseau_bloc b);
+size_t      Reseau_taille_bloc(Reseau_bloc b, uint32_t E, uint32_t H, uint32_t O);
+
+// Ouverture + vérification de l'en-tête (0 = OK, 1 = erreur)
+int  Reseau_ouvrir(Reseau_poids *r, const char *chemin);
+void Reseau_fermer(Reseau_poids *r);
+
+// Écriture : blocs[b] de Reseau_taille_bloc(b, E, H, O) floats (0 = OK, 1 = erreur)
+int Reseau_ecrire(const char *chemin, const char *nom,
+                  uint32_t E, uint32_t H, uint32_t O,
+                  const float *const blocs[RESEAU_NB_BLOCS]);
+
+#endif // RESEAU_POIDS_H
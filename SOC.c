@@ -1,5 +1,11 @@
 #include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
 #include "SOC.h"
+#include "LSTM_noyau.h"
+#include "Reseau_poids.h"
+#include "Activations.h"
 
 // ============================================================================
 // Constantes modèle SOC (identiques à votre code actuel)
@@ -374,25 +380,19 @@ static void MatriceFoisVecteur(int nbLignesMatrice,
     }
 }
 
+// Activations au niveau choisi (Activations.h)
 static void sigma_g_sigmoide(int n, const float *in, float *out)
 {
-    for (int i = 0; i < n; ++i)
-    {
-        float x = in[i];
-        out[i] = 1.0f / (1.0f + expf(-x));
-    }
+    Activation_sigmoide(n, in, out);
 }
 
 static void sigma_c_tanh(int n, const float *in, float *out)
 {
-    for (int i = 0; i < n; ++i)
-    {
-        out[i] = tanhf(in[i]);
-    }
+    Activation_tanh(n, in, out);
 }
 
-// Un pas de LSTM : met à jour ctx->ht, ctx->ct et renvoie la sortie brute LSTM
-static float predictionLSTM(SOC_Context *ctx)
+// Chemin de référence : 8 produits séparés (xt déjà normalisé)
+static void pas_LSTM_reference(SOC_Context *ctx)
 {
     float *xt  = ctx->xt;
     float *ht  = ctx->ht;
@@ -404,12 +404,6 @@ static float predictionLSTM(SOC_Context *ctx)
     float *v1  = ctx->vect_intermediaire_1;
     float *v2  = ctx->vect_intermediaire_2;
 
-    // 1) Mise en forme de l'entrée : normalisation (xt = (xt - MOY) / ECART_TYPE)
-    for (int i = 0; i < SOC_TAILLE_ENTREE; ++i)
-    {
-        xt[i] = (xt[i] - MOY[i]) / ECART_TYPE[i];
-    }
-
     // 2) it
     MatriceFoisVecteur(SOC_TAILLE_RESEAU, SOC_TAILLE_ENTREE, Wi, xt, v1);
     MatriceFoisVecteur(SOC_TAILLE_RESEAU, SOC_TAILLE_RESEAU, Ri, ht, v2);
@@ -446,12 +440,277 @@ static float predictionLSTM(SOC_Context *ctx)
     sigma_c_tanh(SOC_TAILLE_RESEAU, ct, ht);
     for (int i = 0; i < SOC_TAILLE_RESEAU; ++i)
         ht[i] = ot[i] * ht[i];
+}
 
-    // 8) sortie LSTM : WFC * ht + bFC (tailleSortie=1)
-    MatriceFoisVecteur(SOC_TAILLE_SORTIE, SOC_TAILLE_RESEAU, WFC, ht, v1);
-    float sortie = v1[0] + bFC;
+// ============================================================================
+// Compilation du modèle
+// ============================================================================
+
+// Modèle intégré (tableaux ci-dessus), compilé au premier SOC_init
+static SOC_Modele modele_integre;
+static int        modele_integre_compile = 0;
+
+// Noyaux générés enregistrés (SOC_genere_enregistrer)
+static const LSTM_genere *const *variantes_generees = NULL;
+static int                       nb_variantes_generees = 0;
+static int                       genere_actif = 1;
+
+// Point fixe de la récurrence de Pk en float, depuis Pk = 1 : au-delà, Pk
+// ne bouge plus et le gain Kk est constant
+static void regime_permanent_Kalman(SOC_Modele *m)
+{
+    float Pk = 1.0f;
+    m->Pk_permanent    = -1.0f;     // jamais atteint (Pk > 0)
+    m->Kk_permanent    = 0.0f;
+    m->pas_transitoire = 0;
+
+    for (long k = 0; k < 10000000L; ++k) {
+        float P  = Pk + m->Qk;
+        float Kk = P / (P + m->Rk);
+        float P1 = (1.0f - Kk) * P;
+        if (P1 == Pk) {
+            m->Pk_permanent    = Pk;
+            m->Kk_permanent    = Kk;
+            m->pas_transitoire = k;
+            return;
+        }
+        Pk = P1;
+    }
+}
+
+// Compilation d'un réseau E entrées, H unités, 1 sortie (tableaux au
+// format des sources : lignes contiguës, portes i, f, g, o)
+static int compiler_reseau(SOC_Modele *m, const char *nom, int E, int H,
+                           const float *const W[4], const float *const R[4],
+                           const float *const b[4], const float *W_FC, float b_FC,
+                           const float *moy, const float *ecart_type,
+                           const float *ht_init, const float *ct_init)
+{
+    if (E != SOC_TAILLE_ENTREE || H < 1 || H > LSTM_MAX_UNITES) {
+        printf("SOC : reseau %s non supporte (%d entrees, %d unites)\n", nom, E, H);
+        return 1;
+    }
+
+    // Normalisation (x - MOY) / ECART_TYPE repliée dans les poids d'entrée
+    // et les biais, calculés en double :
+    //   W' = W / ECART_TYPE,   b' = b - W * (MOY / ECART_TYPE)
+    float W_replie[4][LSTM_MAX_UNITES * LSTM_MAX_ENTREES];
+    float b_replie[4][LSTM_MAX_UNITES];
+
+    for (int k = 0; k < 4; ++k) {
+        for (int r = 0; r < H; ++r) {
+            double biais = b[k][r];
+            for (int j = 0; j < E; ++j) {
+                double w = W[k][r * E + j];
+                W_replie[k][r * E + j] = (float)(w / ecart_type[j]);
+                biais -= w * (double)moy[j] / (double)ecart_type[j];
+            }
+            b_replie[k][r] = (float)biais;
+        }
+    }
+
+    const float *const Wp[4] = {W_replie[0], W_replie[1], W_replie[2], W_replie[3]};
+    const float *const bp[4] = {b_replie[0], b_replie[1], b_replie[2], b_replie[3]};
+    if (LSTM_empaqueter(&m->lstm, E, H, Wp, R, bp) != 0) {
+        printf("SOC : dimensions du reseau %s non supportees\n", nom);
+        return 1;
+    }
+
+    snprintf(m->nom, sizeof(m->nom), "%s", nom);
+    for (int r = 0; r < LSTM_MAX_UNITES; ++r) {
+        m->WFC[r]     = (r < H) ? W_FC[r]    : 0.0f;
+        m->ht_init[r] = (r < H) ? ht_init[r] : 0.0f;
+        m->ct_init[r] = (r < H) ? ct_init[r] : 0.0f;
+    }
+    m->bFC = b_FC;
+
+    // Scalaires invariants
+    m->coef_coulomb = moins_eta_sur_Q * dt;
+    m->Qk = Qk;
+    m->Rk = Rk;
+    regime_permanent_Kalman(m);
+
+    // Noyau généré pour ces poids exacts, s'il y en a un
+    m->genere = NULL;
+    const uint32_t empreinte = SOC_Modele_empreinte(m);
+    for (int v = 0; v < nb_variantes_generees; ++v) {
+        const LSTM_genere *g = variantes_generees[v];
+        if (g->nb_entrees == E && g->nb_unites == H && g->empreinte == empreinte) {
+            m->genere = g;
+            break;
+        }
+    }
+    return 0;
+}
+
+int SOC_Modele_compiler(SOC_Modele *m)
+{
+    if (!m) return 1;
+
+    const float *const W[4] = {Wi, Wf, Wg, Wo};
+    const float *const R[4] = {Ri, Rf, Rg, Ro};
+    const float *const b[4] = {bi, bf, bg, bo};
+    return compiler_reseau(m, "integre", SOC_TAILLE_ENTREE, SOC_TAILLE_RESEAU, W, R, b,
+                           WFC, bFC, MOY, ECART_TYPE, HT_INIT, CT_INIT);
+}
+
+int SOC_Modele_compiler_blocs(SOC_Modele *m, const char *nom, int E, int H, int O,
+                              const float *const blocs[RESEAU_NB_BLOCS])
+{
+    if (!m) return 1;
+    if (O != SOC_TAILLE_SORTIE) {
+        printf("SOC : reseau %s a %d sorties (attendu %d)\n", nom, O, SOC_TAILLE_SORTIE);
+        return 1;
+    }
+
+    const float *const W[4] = {blocs[RESEAU_WI], blocs[RESEAU_WF], blocs[RESEAU_WG], blocs[RESEAU_WO]};
+    const float *const R[4] = {blocs[RESEAU_RI], blocs[RESEAU_RF], blocs[RESEAU_RG], blocs[RESEAU_RO]};
+    const float *const b[4] = {blocs[RESEAU_BI], blocs[RESEAU_BF], blocs[RESEAU_BG], blocs[RESEAU_BO]};
+    return compiler_reseau(m, nom, E, H, W, R, b,
+                           blocs[RESEAU_WFC], blocs[RESEAU_BFC][0],
+                           blocs[RESEAU_MOY], blocs[RESEAU_ECART_TYPE],
+                           blocs[RESEAU_HT_INIT], blocs[RESEAU_CT_INIT]);
+}
+
+int SOC_Modele_charger(SOC_Modele *m, const char *chemin)
+{
+    if (!m) return 1;
+
+    Reseau_poids r;
+    if (Reseau_ouvrir(&r, chemin) != 0) return 1;
+
+    // Blocs utilisés sur place (projection), copiés dans le modèle compilé
+    const Reseau_entete *e = r.entete;
+    int erreur = SOC_Modele_compiler_blocs(m, e->nom, (int)e->nb_entrees, (int)e->nb_unites,
+                                           (int)e->nb_sorties, r.bloc);
+    Reseau_fermer(&r);
+    return erreur;
+}
+
+const SOC_Modele *SOC_modele_integre(void)
+{
+    if (!modele_integre_compile) {
+        SOC_Modele_compiler(&modele_integre);
+        modele_integre_compile = 1;
+    }
+    return &modele_integre;
+}
+
+uint32_t SOC_Modele_empreinte(const SOC_Modele *m)
+{
+    const LSTM_poids *p = &m->lstm;
+    const size_t nb_W = (size_t)p->nb_lignes * (size_t)(p->nb_entrees + p->nb_unites);
+
+    const struct { const void *octets; size_t taille; } parties[4] = {
+        { p->W,    nb_W * sizeof(float) },
+        { p->b,    (size_t)p->nb_lignes * sizeof(float) },
+        { m->WFC,  (size_t)p->nb_unites * sizeof(float) },
+        { &m->bFC, sizeof(float) }
+    };
+
+    uint32_t h = 2166136261u;
+    for (int k = 0; k < 4; ++k) {
+        const uint8_t *o = (const uint8_t *)parties[k].octets;
+        for (size_t i = 0; i < parties[k].taille; ++i) {
+            h ^= o[i];
+            h *= 16777619u;
+        }
+    }
+    return h;
+}
+
+void SOC_genere_enregistrer(const LSTM_genere *const *variantes, int nb)
+{
+    variantes_generees    = variantes;
+    nb_variantes_generees = (variantes && nb > 0) ? nb : 0;
+}
 
-    return sortie;
+void SOC_genere_activer(int actif)
+{
+    genere_actif = (actif != 0);
+}
+
+// Couche de sortie : WFC * ht + bFC (tailleSortie=1)
+static inline float sortie_FC(const SOC_Modele *m, const float *ht)
+{
+    float sortie = 0.0f;
+    for (int i = 0; i < m->lstm.nb_unites; ++i)
+        sortie += m->WFC[i] * ht[i];
+
+    return sortie + m->bFC;
+}
+
+// Prédiction SOC par comptage coulombimétrique
+// (moins_eta_sur_Q * dt / SOH ne change qu'avec le SOH)
+static inline float prediction_coulomb(SOC_Context *ctx, float I, float SOH)
+{
+    if (SOH != ctx->SOH_precedent) {
+        ctx->SOH_precedent = SOH;
+        ctx->coef_SOH      = ctx->modele->coef_coulomb / SOH;
+    }
+    return ctx->SOC - ctx->coef_SOH * I;
+}
+
+// Filtre de Kalman (Fk = Hk = 1) sur la prédiction coulombmétrique SOC et la
+// sortie LSTM ; met à jour ctx->SOC et ctx->Pk
+static inline float correction_Kalman(SOC_Context *ctx, float SOC, float prediction_LSTM)
+{
+    const SOC_Modele *m = ctx->modele;
+    prediction_LSTM = clamp01(prediction_LSTM);
+
+    // Pk ne dépend pas des mesures : une fois son point fixe atteint, le
+    // gain est celui du modèle
+    float Kk;
+    if (ctx->Pk == m->Pk_permanent) {
+        Kk = m->Kk_permanent;
+    } else {
+        ctx->Pk += m->Qk;
+        float Sk = ctx->Pk + m->Rk;
+        Kk = ctx->Pk / Sk;
+        ctx->Pk = (1.0f - Kk) * ctx->Pk;
+    }
+
+    float residu = prediction_LSTM - SOC;
+    SOC = SOC + Kk * residu;
+    SOC = clamp01(SOC);
+
+    ctx->SOC = SOC;
+    return SOC;
+}
+
+// Un pas de LSTM : met à jour ctx->ht, ctx->ct et renvoie la sortie brute LSTM
+static float predictionLSTM(SOC_Context *ctx)
+{
+    const SOC_Modele *m = ctx->modele;
+    float *xt  = ctx->xt;
+    float *ht  = ctx->ht;
+
+    if (m == &modele_integre && LSTM_noyau_actif() == LSTM_NOYAU_REFERENCE)
+    {
+        // 1) Mise en forme de l'entrée : normalisation (xt = (xt - MOY) / ECART_TYPE)
+        for (int i = 0; i < SOC_TAILLE_ENTREE; ++i)
+        {
+            xt[i] = (xt[i] - MOY[i]) / ECART_TYPE[i];
+        }
+
+        // 2) à 7) portes, cellule et état caché, poids d'origine (réseau
+        //    intégré seulement)
+        pas_LSTM_reference(ctx);
+    }
+    else if (m->genere && genere_actif)
+    {
+        // Noyau généré pour ces poids : pas et sortie déroulés
+        m->genere->pas(xt, ht, ctx->ct);
+        return m->genere->sortie(ht);
+    }
+    else
+    {
+        // Normalisation repliée dans le modèle compilé : xt brut
+        LSTM_pas(&m->lstm, xt, ht, ctx->ct);
+    }
+
+    // 8) sortie LSTM : WFC * ht + bFC (tailleSortie=1)
+    return sortie_FC(m, ht);
 }
 
 // ============================================================================
@@ -460,18 +719,30 @@ static float predictionLSTM(SOC_Context *ctx)
 
 void SOC_init(SOC_Context *ctx)
 {
-    if (!ctx) return;
+    SOC_init_modele(ctx, SOC_modele_integre());
+}
+
+void SOC_init_modele(SOC_Context *ctx, const SOC_Modele *m)
+{
+    if (!ctx || !m) return;
+    ctx->modele = m;
 
     // SOC et Pk
     ctx->SOC = 0.0f;
     ctx->Pk  = 1.0f;
 
+    // Coefficient coulombmétrique : recalculé au premier pas
+    ctx->SOH_precedent = 0.0f;
+    ctx->coef_SOH      = 0.0f;
+
     // Etats LSTM initiaux
+    for (int i = 0; i < LSTM_MAX_UNITES; ++i)
+    {
+        ctx->ht[i] = m->ht_init[i];
+        ctx->ct[i] = m->ct_init[i];
+    }
     for (int i = 0; i < SOC_TAILLE_RESEAU; ++i)
     {
-        ctx->ht[i] = HT_INIT[i];
-        ctx->ct[i] = CT_INIT[i];
-
         ctx->it[i] = 0.0f;
         ctx->ft[i] = 0.0f;
         ctx->gt[i] = 0.0f;
@@ -498,8 +769,7 @@ float SOC_step(SOC_Context *ctx,
     float I = -courant;
 
     // 1) Prediction SOC par comptage coulombimétrique
-    float SOC = ctx->SOC;
-    SOC = SOC - moins_eta_sur_Q * dt * I / SOH;
+    float SOC = prediction_coulomb(ctx, I, SOH);
 
     // 2) Préparation entrée LSTM brute (non normalisée)
     ctx->xt[0] = I;
@@ -508,18 +778,195 @@ float SOC_step(SOC_Context *ctx,
 
     // 3) Prediction LSTM
     float prediction_LSTM = predictionLSTM(ctx);
-    prediction_LSTM = clamp01(prediction_LSTM);
 
-    // 4) Filtre de Kalman (Fk = Hk = 1)
-    ctx->Pk += Qk;
-    float residu = prediction_LSTM - SOC;
-    float Sk = ctx->Pk + Rk;
-    float Kk = ctx->Pk / Sk;
+    // 4) Filtre de Kalman
+    return correction_Kalman(ctx, SOC, prediction_LSTM);
+}
 
-    SOC = SOC + Kk * residu;
-    SOC = clamp01(SOC);
-    ctx->Pk = (1.0f - Kk) * ctx->Pk;
+void SOC_rejouer(SOC_Context *ctx,
+                 const float *courant, const float *tension,
+                 const float *temperature, const float *SOH, size_t N,
+                 float *sortie)
+{
+    if (!ctx || !sortie) return;
+    const SOC_Modele *m = ctx->modele;
+
+    // Chemin de référence (poids d'origine) : pas de projection possible
+    if (m == &modele_integre && LSTM_noyau_actif() == LSTM_NOYAU_REFERENCE) {
+        for (size_t k = 0; k < N; ++k)
+            sortie[k] = SOC_step(ctx, courant[k], tension[k], temperature[k], SOH[k]);
+        return;
+    }
 
-    ctx->SOC = SOC;
-    return SOC;
+    const LSTM_poids *p = &m->lstm;
+    const int nl = p->nb_lignes;
+    float x[SOC_BLOC_PROJECTION * SOC_TAILLE_ENTREE];
+    _Alignas(32) float proj[SOC_BLOC_PROJECTION * 4 * LSTM_MAX_UNITES];
+
+    for (size_t debut = 0; debut < N; debut += SOC_BLOC_PROJECTION) {
+        const int T = (N - debut < SOC_BLOC_PROJECTION) ? (int)(N - debut) : SOC_BLOC_PROJECTION;
+
+        // 1) Entrées brutes du bloc [-I, U, T] et leur projection d'un coup
+        for (int t = 0; t < T; ++t) {
+            x[t * SOC_TAILLE_ENTREE + 0] = -courant[debut + t];
+            x[t * SOC_TAILLE_ENTREE + 1] = tension[debut + t];
+            x[t * SOC_TAILLE_ENTREE + 2] = temperature[debut + t];
+        }
+        LSTM_projeter(p, T, x, proj);
+
+        // 2) Pas à pas : partie récurrente, sortie, coulomb et Kalman
+        for (int t = 0; t < T; ++t) {
+            const size_t k = debut + (size_t)t;
+            float SOC = prediction_coulomb(ctx, -courant[k], SOH[k]);
+            LSTM_pas_projete(p, proj + (size_t)t * nl, ctx->ht, ctx->ct);
+            sortie[k] = correction_Kalman(ctx, SOC, sortie_FC(m, ctx->ht));
+        }
+    }
+    if (N > 0) {
+        ctx->xt[0] = -courant[N - 1];
+        ctx->xt[1] = tension[N - 1];
+        ctx->xt[2] = temperature[N - 1];
+    }
+}
+
+// ============================================================================
+// Lot de cellules
+// ============================================================================
+
+int SOC_Batch_init(SOC_Batch *lot, int nb_cellules)
+{
+    return SOC_Batch_init_modele(lot, nb_cellules, SOC_modele_integre());
+}
+
+int SOC_Batch_init_modele(SOC_Batch *lot, int nb_cellules, const SOC_Modele *m)
+{
+    if (!lot || !m) return 1;
+    lot->memoire = NULL;
+    if (nb_cellules < 1) {
+        printf("SOC_Batch_init : nombre de cellules invalide (%d)\n", nb_cellules);
+        return 1;
+    }
+
+    const size_t H     = (size_t)m->lstm.nb_unites;
+    const size_t cap   = (size_t)LSTM_LOT_CAPACITE(nb_cellules);
+    const size_t n_xh  = (SOC_TAILLE_ENTREE + H) * cap;
+    const size_t n_ct  = H * cap;
+    const size_t n_acc = (size_t)m->lstm.nb_lignes * cap;
+
+    // Un seul bloc, chaque tableau aligné sur 32 octets (cap multiple de 8)
+    lot->memoire = malloc((n_xh + n_ct + n_acc + 3 * cap) * sizeof(float) + 32);
+    if (!lot->memoire) {
+        perror("SOC_Batch_init : allocation");
+        return 1;
+    }
+    float *p = (float *)(((uintptr_t)lot->memoire + 31) & ~(uintptr_t)31);
+
+    lot->modele      = m;
+    lot->nb_cellules = nb_cellules;
+    lot->capacite    = (int)cap;
+    lot->xh          = p;  p += n_xh;
+    lot->ct          = p;  p += n_ct;
+    lot->acc         = p;  p += n_acc;
+    lot->SOC         = p;  p += cap;
+    lot->Pk          = p;  p += cap;
+    lot->SOC_predit  = p;
+
+    // Cellules de complément comprises : elles calculent sans effet
+    for (size_t i = 0; i < n_xh;  ++i) lot->xh[i]  = 0.0f;
+    for (size_t i = 0; i < n_acc; ++i) lot->acc[i] = 0.0f;
+    for (int k = 0; k < (int)cap; ++k) SOC_Batch_reinit_cellule(lot, k);
+    return 0;
+}
+
+void SOC_Batch_liberer(SOC_Batch *lot)
+{
+    if (!lot) return;
+    free(lot->memoire);
+    lot->memoire = NULL;
+    lot->nb_cellules = 0;
+    lot->capacite = 0;
+}
+
+void SOC_Batch_reinit_cellule(SOC_Batch *lot, int k)
+{
+    if (!lot || k < 0 || k >= lot->capacite) return;
+
+    const int cap = lot->capacite;
+    float *ht = lot->xh + SOC_TAILLE_ENTREE * cap;
+    for (int r = 0; r < lot->modele->lstm.nb_unites; ++r) {
+        ht[r * cap + k]      = lot->modele->ht_init[r];
+        lot->ct[r * cap + k] = lot->modele->ct_init[r];
+    }
+    lot->SOC[k]        = 0.0f;
+    lot->Pk[k]         = 1.0f;
+    lot->SOC_predit[k] = 0.0f;
+}
+
+void SOC_Batch_step(SOC_Batch *lot,
+                    const float *courant,
+                    const float *tension,
+                    const float *temperature,
+                    const float *SOH,
+                    float *SOC)
+{
+    if (!lot || !lot->memoire) return;
+
+    const SOC_Modele *m = lot->modele;
+    const int N   = lot->nb_cellules;
+    const int cap = lot->capacite;
+    float *x_I = lot->xh;
+    float *x_U = lot->xh + cap;
+    float *x_T = lot->xh + 2 * cap;
+
+    // 1) Prédiction coulombmétrique et entrées brutes (normalisation
+    //    repliée dans le modèle)
+    for (int n = 0; n < N; ++n)
+    {
+        float I = -courant[n];
+        lot->SOC_predit[n] = lot->SOC[n] - m->coef_coulomb / SOH[n] * I;
+        x_I[n] = I;
+        x_U[n] = tension[n];
+        x_T[n] = temperature[n];
+    }
+
+    // 2) LSTM de toutes les cellules
+    LSTM_pas_lot(&m->lstm, cap, lot->xh, lot->ct, lot->acc);
+
+    // 3) Sortie WFC * ht + bFC, ligne par ligne (acc sert de tampon)
+    const float *ht     = lot->xh + SOC_TAILLE_ENTREE * cap;
+    float       *sortie = lot->acc;
+    for (int n = 0; n < cap; ++n) sortie[n] = 0.0f;
+    for (int r = 0; r < m->lstm.nb_unites; ++r) {
+        const float w = m->WFC[r];
+        for (int n = 0; n < cap; n += 8)
+            for (int q = 0; q < 8; ++q)
+                sortie[n + q] += w * ht[r * cap + n + q];
+    }
+
+    // 4) Filtre de Kalman (Fk = Hk = 1) sur toutes les cellules, par paquets
+    //    de 8 sans branchement
+    const float Qk_m = m->Qk, Rk_m = m->Rk, bFC_m = m->bFC;
+    for (int n = 0; n < cap; n += 8)
+    {
+        for (int q = 0; q < 8; ++q)
+        {
+            float prediction = sortie[n + q] + bFC_m;
+            prediction = prediction < 0.0f ? 0.0f : prediction;
+            prediction = prediction > 1.0f ? 1.0f : prediction;
+
+            float s  = lot->SOC_predit[n + q];
+            float Pk = lot->Pk[n + q] + Qk_m;
+            float Kk = Pk / (Pk + Rk_m);
+
+            s = s + Kk * (prediction - s);
+            s = s < 0.0f ? 0.0f : s;
+            s = s > 1.0f ? 1.0f : s;
+
+            lot->SOC[n + q] = s;
+            lot->Pk[n + q]  = (1.0f - Kk) * Pk;
+        }
+    }
+
+    if (SOC)
+        for (int n = 0; n < N; ++n) SOC[n] = lot->SOC[n];
 }
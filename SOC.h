@@ -1,20 +1,84 @@
 #ifndef SOC_H
 #define SOC_H
 
+#include "LSTM_noyau.h"
+#include "LSTM_genere.h"
+
 // Dimension du réseau (identique à votre code actuel)
 #define SOC_TAILLE_ENTREE  3
 #define SOC_TAILLE_RESEAU  20
 #define SOC_TAILLE_SORTIE  1
 
+// ============================================================================
+// Modèle SOC compilé
+//
+// Préparé une fois à l'initialisation à partir des tableaux du réseau :
+//   - normalisation (x - MOY) / ECART_TYPE repliée dans les poids d'entrée
+//     et les biais (W' = W / ECART_TYPE, b' = b - W * MOY / ECART_TYPE) :
+//     le noyau reçoit [I, U, T] bruts, sans division par pas ;
+//   - poids des quatre portes empaquetés pour le noyau fusionné ;
+//   - scalaires invariants : moins_eta_sur_Q * dt, Qk, Rk, et point fixe
+//     de la variance Pk (qui ne dépend pas des mesures) avec son gain.
+// Écart avec le chemin d'origine : arrondis du repliement, de l'ordre de
+// 1e-7 sur le SOC (bench_soc).
+//
+// Le réseau vient des tableaux de SOC.c (modèle intégré) ou d'un fichier de
+// poids .prtw (Reseau_poids.h, conversion_reseau) : 3 entrées, 1 sortie,
+// jusqu'à LSTM_MAX_UNITES unités. Le noyau est choisi selon la taille ; un
+// noyau généré pour ces poids exacts (LSTM_genere.h) le remplace s'il est
+// enregistré.
+// ============================================================================
+typedef struct
+{
+    char  nom[32];
+    LSTM_poids lstm;                    // portes, normalisation repliée
+    float WFC[LSTM_MAX_UNITES];         // couche de sortie
+    float bFC;
+    float ht_init[LSTM_MAX_UNITES];
+    float ct_init[LSTM_MAX_UNITES];
+
+    float coef_coulomb;                 // moins_eta_sur_Q * dt
+    float Qk, Rk;
+    float Pk_permanent;                 // point fixe de Pk (-1 : aucun)
+    float Kk_permanent;                 // gain correspondant
+    long  pas_transitoire;              // pas depuis Pk = 1 avant le point fixe
+
+    const LSTM_genere *genere;          // noyau généré pour ces poids (NULL : aucun)
+} SOC_Modele;
+
+// Compilation du modèle intégré (0 = OK, 1 = erreur)
+int SOC_Modele_compiler(SOC_Modele *m);
+
+// Compilation d'un fichier de poids .prtw (0 = OK, 1 = erreur)
+int SOC_Modele_charger(SOC_Modele *m, const char *chemin);
+
+// Compilation de blocs au format Reseau_poids (E, H, O, blocs[RESEAU_NB_BLOCS])
+int SOC_Modele_compiler_blocs(SOC_Modele *m, const char *nom, int E, int H, int O,
+                              const float *const blocs[RESEAU_NB_BLOCS]);
+
+// Modèle intégré, compilé au premier appel (utilisé par SOC_init)
+const SOC_Modele *SOC_modele_integre(void);
+
+// Empreinte (FNV-1a) des poids compilés : portes, couche de sortie
+uint32_t SOC_Modele_empreinte(const SOC_Modele *m);
+
+// Noyaux générés : les modèles compilés ensuite utilisent la variante de
+// même taille et de même empreinte. Leur utilisation par SOC_step se coupe
+// globalement (comparaison avec le chemin générique)
+void SOC_genere_enregistrer(const LSTM_genere *const *variantes, int nb);
+void SOC_genere_activer(int actif);     // 1 par défaut
+
 // Contexte SOC : contient l'état du LSTM + SOC + Pk
 typedef struct
 {
+    const SOC_Modele *modele;        // modèle compilé utilisé par SOC_step
+
     // États internes LSTM
     float xt[SOC_TAILLE_ENTREE];     // entrée normalisée [I, U, T]
-    float ht[SOC_TAILLE_RESEAU];     // état caché
-    float ct[SOC_TAILLE_RESEAU];     // état cellule
+    float ht[LSTM_MAX_UNITES];       // état caché (nb_unites du modèle)
+    float ct[LSTM_MAX_UNITES];       // état cellule
 
-    // Gates intermédiaires
+    // Gates intermédiaires (chemin de référence, réseau intégré)
     float it[SOC_TAILLE_RESEAU];
     float ft[SOC_TAILLE_RESEAU];
     float gt[SOC_TAILLE_RESEAU];
@@ -28,11 +92,19 @@ typedef struct
     float SOC;   // SOC courant (0–1)
     float Pk;    // variance
 
+    // Coefficient coulombmétrique moins_eta_sur_Q * dt / SOH, recalculé
+    // seulement quand le SOH change
+    float SOH_precedent;
+    float coef_SOH;
+
 } SOC_Context;
 
-// Initialisation du contexte SOC (états LSTM + SOC + Pk)
+// Initialisation du contexte SOC (états LSTM + SOC + Pk), modèle intégré
 void SOC_init(SOC_Context *ctx);
 
+// Idem avec un modèle compilé par l'appelant (qui doit lui survivre)
+void SOC_init_modele(SOC_Context *ctx, const SOC_Modele *m);
+
 // Step SOC : 1 échantillon → 1 SOC mis à jour
 // Entrées : courant (A), tension (V), température (°C), SOH (0–1)
 // Retour : SOC estimé après correction Kalman
@@ -42,4 +114,61 @@ float SOC_step(SOC_Context *ctx,
                float temperature,
                float SOH);
 
+// Rejeu hors ligne d'une série connue d'avance : N pas comme SOC_step
+// (ctx mis à jour, SOC dans sortie[N]). Les entrées du LSTM sont projetées
+// par blocs de SOC_BLOC_PROJECTION pas (LSTM_projeter), puis seule la
+// partie récurrente reste faite pas à pas. Résultats identiques à SOC_step
+// avec le noyau fusionné ; avec un noyau généré, SOC_step en diffère par
+// l'ordre des additions (le rejeu n'utilise pas les noyaux générés).
+#define SOC_BLOC_PROJECTION 64
+
+void SOC_rejouer(SOC_Context *ctx,
+                 const float *courant, const float *tension,
+                 const float *temperature, const float *SOH, size_t N,
+                 float *sortie);
+
+// ============================================================================
+// Lot de cellules : SOC de N cellules (pack, baie) en un seul passage LSTM
+//
+// Les états sont rangés en SoA (une ligne de `capacite` valeurs par
+// grandeur, capacite = N arrondi à un multiple de 8) : chaque pas devient
+// un produit matriciel poids [80 x 23] * états [23 x N] (LSTM_pas_lot),
+// suivi du filtre de Kalman appliqué à toutes les cellules d'une même
+// boucle vectorisable. Chaque cellule suit le calcul de SOC_step (même
+// noyau, même niveau d'activation) ; si une variante générée du réseau est
+// enregistrée, SOC_step en diffère par l'ordre des additions (le lot
+// n'utilise pas les noyaux générés).
+// ============================================================================
+typedef struct
+{
+    const SOC_Modele *modele;
+    int    nb_cellules;
+    int    capacite;        // nb_cellules arrondi à un multiple de 8
+
+    float *xh;              // [(ENTREE + H) x capacite] : xt brut puis ht
+    float *ct;              // [H x capacite]
+    float *acc;             // accumulateurs des portes (travail)
+    float *SOC;             // [capacite]
+    float *Pk;              // [capacite]
+    float *SOC_predit;      // [capacite] prédiction coulombmétrique (travail)
+
+    void  *memoire;         // bloc unique alloué par SOC_Batch_init
+} SOC_Batch;
+
+// Allocation + états initiaux de toutes les cellules (0 = OK, 1 = erreur)
+int  SOC_Batch_init(SOC_Batch *lot, int nb_cellules);
+int  SOC_Batch_init_modele(SOC_Batch *lot, int nb_cellules, const SOC_Modele *m);
+void SOC_Batch_liberer(SOC_Batch *lot);
+
+// Remet la cellule k dans l'état de SOC_init (remplacement de cellule...)
+void SOC_Batch_reinit_cellule(SOC_Batch *lot, int k);
+
+// Un pas pour toutes les cellules : entrées et SOC[] de nb_cellules valeurs
+void SOC_Batch_step(SOC_Batch *lot,
+                    const float *courant,
+                    const float *tension,
+                    const float *temperature,
+                    const float *SOH,
+                    float *SOC);
+
 #endif // SOC_RESEAU_CHARGE_DECH_H
@@ -1,4 +1,5 @@
 #include "SOC_Reseau_charge_dech.h"
+#include "Activations.h"
 #include "Read_Write.h"
 
 #define max(a,b) ((a) > (b) ? (a) : (b))
@@ -572,20 +573,12 @@ void predictionLSTM(int tailleEntree, int tailleReseau, int tailleSortie, float
 
 void sigma_g_sigmoide(int x_size, float *pointeur_entree, float *pointeur_sortie_sig) {
 
-  int i;
-
-  for (i = 0; i <= x_size - 1; i++) {
-    *(pointeur_sortie_sig + i) = 1 / (1 + exp(-*(pointeur_entree + i)));
-  }
+  Activation_sigmoide(x_size, pointeur_entree, pointeur_sortie_sig);
 }
 
 void sigma_c_tanh(int x_size, float *pointeur_entree, float *pointeur_sortie_tanh) {
 
-  int i;
-
-  for (i = 0; i <= x_size - 1; i++) {
-    *(pointeur_sortie_tanh + i) = tanh(*(pointeur_entree + i));
-  }
+  Activation_tanh(x_size, pointeur_entree, pointeur_sortie_tanh);
 }
 
 
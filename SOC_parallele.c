@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <pthread.h>
+#include "SOC_parallele.h"
+#include "LSTM_noyau.h"
+
+// ============================================================================
+// Helpers internes
+// ============================================================================
+
+typedef struct
+{
+    const SOC_Modele *modele;
+    const float *courant, *tension, *temperature, *SOH;
+    SOC_Segment  segment;
+    float       *sortie;
+} Tache_segment;
+
+// Rodage depuis l'état initial, puis le segment
+static void *thread_segment(void *arg)
+{
+    const Tache_segment *t = (const Tache_segment *)arg;
+    const SOC_Segment *s = &t->segment;
+
+    SOC_Context ctx;
+    SOC_init_modele(&ctx, t->modele);
+
+    for (size_t k = s->depart; k < s->debut; ++k)
+        SOC_step(&ctx, t->courant[k], t->tension[k], t->temperature[k], t->SOH[k]);
+    for (size_t k = s->debut; k < s->fin; ++k)
+        t->sortie[k] = SOC_step(&ctx, t->courant[k], t->tension[k], t->temperature[k], t->SOH[k]);
+
+    return NULL;
+}
+
+// ============================================================================
+// API publique
+// ============================================================================
+
+void SOC_parallele_decouper(SOC_Segment *segments, int nb_segments,
+                            size_t N, size_t rodage)
+{
+    for (int k = 0; k < nb_segments; ++k) {
+        SOC_Segment *s = &segments[k];
+        s->debut  = N * (size_t)k / (size_t)nb_segments;
+        s->fin    = N * (size_t)(k + 1) / (size_t)nb_segments;
+        s->depart = (s->debut > rodage) ? s->debut - rodage : 0;
+    }
+}
+
+int SOC_parallele(const SOC_Modele *m,
+                  const float *courant, const float *tension,
+                  const float *temperature, const float *SOH, size_t N,
+                  int nb_segments, size_t rodage,
+                  float *sortie, SOC_Segment *segments)
+{
+    if (!m || !courant || !tension || !temperature || !SOH || !sortie) return 1;
+    if (nb_segments < 1 || nb_segments > SOC_PARALLELE_MAX_SEGMENTS) {
+        printf("SOC_parallele : nombre de segments invalide (%d)\n", nb_segments);
+        return 1;
+    }
+
+    Tache_segment taches[SOC_PARALLELE_MAX_SEGMENTS];
+    pthread_t     threads[SOC_PARALLELE_MAX_SEGMENTS];
+    SOC_Segment   decoupe[SOC_PARALLELE_MAX_SEGMENTS];
+    SOC_parallele_decouper(decoupe, nb_segments, N, rodage);
+
+    // Choix du noyau LSTM fait ici : les threads ne font que le lire
+    LSTM_noyau_actif();
+
+    int erreur = 0;
+    int lances = 0;
+    for (int k = 0; k < nb_segments; ++k) {
+        Tache_segment *t = &taches[k];
+        t->modele      = m;
+        t->courant     = courant;
+        t->tension     = tension;
+        t->temperature = temperature;
+        t->SOH         = SOH;
+        t->segment     = decoupe[k];
+        t->sortie      = sortie;
+        if (k == nb_segments - 1) break;    // le dernier tourne ici
+
+        if (pthread_create(&threads[k], NULL, thread_segment, t) != 0) {
+            printf("Erreur creation thread du segment %d\n", k);
+            erreur = 1;
+            break;
+        }
+        ++lances;
+    }
+
+    if (!erreur) thread_segment(&taches[nb_segments - 1]);
+    for (int k = 0; k < lances; ++k) pthread_join(threads[k], NULL);
+
+    if (segments)
+        for (int k = 0; k < nb_segments; ++k) segments[k] = decoupe[k];
+    return erreur;
+}
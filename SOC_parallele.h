@@ -0,0 +1,47 @@
+#ifndef SOC_PARALLELE_H
+#define SOC_PARALLELE_H
+
+#include <stddef.h>
+#include "SOC.h"
+
+// ============================================================================
+// Retraitement hors ligne du SOC en parallèle dans le temps
+//
+// SOC_step est séquentiel (ht, ct, SOC et Pk d'un pas au suivant). Pour
+// rejouer un long historique, la série est coupée en K segments traités
+// chacun par un thread : le thread k repart de l'état initial (SOC_init)
+// `rodage` échantillons avant le début de son segment et jette les sorties
+// de ce rodage. Le LSTM oublie son état initial et le Kalman (gain fort
+// tant que Pk est grand) se recale sur la prédiction : en fin de rodage,
+// l'état rejoint celui du rejeu séquentiel à un écart près, qui décroît
+// ensuite. Le segment 0 part du vrai début : identique au séquentiel.
+//
+// Coût : N + (K - 1) * rodage pas répartis sur K threads. L'écart aux
+// raccords dépend du rodage ; retraitement_soc le mesure contre le rejeu
+// séquentiel.
+// ============================================================================
+
+#define SOC_PARALLELE_MAX_SEGMENTS 64
+
+typedef struct
+{
+    size_t depart;      // premier pas calculé (début du rodage)
+    size_t debut;       // premier pas rendu
+    size_t fin;         // fin du segment (exclue)
+} SOC_Segment;
+
+// Découpe de N échantillons en K segments de tailles égales (à un près),
+// rodage borné par le début de la série
+void SOC_parallele_decouper(SOC_Segment *segments, int nb_segments,
+                            size_t N, size_t rodage);
+
+// SOC des N échantillons dans sortie[N] avec le modèle m, un thread par
+// segment (1 <= nb_segments <= SOC_PARALLELE_MAX_SEGMENTS). segments
+// (facultatif) reçoit la découpe. 0 = OK, 1 = erreur
+int SOC_parallele(const SOC_Modele *m,
+                  const float *courant, const float *tension,
+                  const float *temperature, const float *SOH, size_t N,
+                  int nb_segments, size_t rodage,
+                  float *sortie, SOC_Segment *segments);
+
+#endif // SOC_PARALLELE_H
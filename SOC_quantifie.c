@@ -0,0 +1,475 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "SOC_quantifie.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define SOC_Q_SSE2 1
+#endif
+
+// ============================================================================
+// Helpers internes
+// ============================================================================
+
+#define UN_Q15 32767
+#define UN_Q30 (1 << 30)
+
+// Poids des portes rangés par paires de colonnes (j dans le bloc) : pour la
+// paire j/2, les nl lignes entrelacées (colonne paire, colonne impaire)
+#define INDICE_W(j, l, nl) ((((j) >> 1) * (nl) + (l)) * 2 + ((j) & 1))
+
+static int16_t sature16(int32_t v)
+{
+    return (int16_t)(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+}
+
+static int32_t clamp_Q30(int32_t v)
+{
+    return v < 0 ? 0 : (v > UN_Q30 ? UN_Q30 : v);
+}
+
+// Réel r > 0 écrit M * 2^-dec, M dans [2^30, 2^31) (0 = OK, 1 = hors plage)
+static int multiplicateur(double r, int32_t *M, int8_t *dec)
+{
+    *M = 0;
+    *dec = 1;
+    if (!(r > 0.0)) return (r == 0.0) ? 0 : 1;
+
+    int e;
+    double f = frexp(r, &e);                    // r = f 2^e, f dans [0.5, 1)
+    long long m = llround(f * 2147483648.0);
+    if (m == 2147483648LL) { m >>= 1; ++e; }
+    int d = 31 - e;
+
+    // Trop petit : on sacrifie des bits de mantisse
+    while (d > 62 && m > 0) { m >>= 1; --d; }
+    if (d < 1) return 1;
+
+    *M   = (int32_t)m;
+    *dec = (int8_t)d;
+    return 0;
+}
+
+// (acc * M) >> dec, arrondi au plus proche
+static inline int32_t requantifier(int32_t acc, int32_t M, int dec)
+{
+    return (int32_t)(((int64_t)acc * M + ((int64_t)1 << (dec - 1))) >> dec);
+}
+
+// tanh d'une pré-activation Q12, résultat Q15. Sans branchement : |z| borné
+// à 8 (la dernière valeur est doublée dans la table), signe par masque
+static inline int32_t tanh_Q(const int16_t *table, int32_t z)
+{
+    const int32_t signe = z >> 31;              // 0 ou -1
+    int32_t u = (z ^ signe) - signe;
+    u = u < ((SOC_Q_TABLE_N - 1) << 7) ? u : ((SOC_Q_TABLE_N - 1) << 7);
+    const int32_t i = u >> 7;                   // pas 1/32 = 128 en Q12
+    const int32_t a = u & 127;
+    const int32_t r = table[i] + (((table[i + 1] - table[i]) * a + 64) >> 7);
+    return (r ^ signe) - signe;
+}
+
+#ifdef SOC_Q_SSE2
+// Deux valeurs int16 consécutives en un mot de 32 bits (opérande de pmaddwd)
+static inline int32_t paire_Q(const int16_t *v)
+{
+    return (int32_t)((uint32_t)(uint16_t)v[0] | ((uint32_t)(uint16_t)v[1] << 16));
+}
+#endif
+
+static inline int32_t sigmoide_Q(const int16_t *table, int32_t z)
+{
+    return (UN_Q15 + 1 + tanh_Q(table, z >> 1)) >> 1;
+}
+
+// ============================================================================
+// Calibration
+// ============================================================================
+
+int SOC_Q_calibrer(SOC_Q_Calibration *cal, const SOC_Modele *m,
+                   const float *courant, const float *tension,
+                   const float *temperature, const float *SOH, size_t N)
+{
+    if (!cal || !m || N == 0) return 1;
+    memset(cal, 0, sizeof(*cal));
+    memcpy(cal->magique, SOC_Q_CALIB_MAGIQUE, 4);
+    cal->version         = SOC_Q_CALIB_VERSION;
+    snprintf(cal->nom, sizeof(cal->nom), "%s", m->nom);
+    cal->nb_entrees      = (uint32_t)m->lstm.nb_entrees;
+    cal->nb_unites       = (uint32_t)m->lstm.nb_unites;
+    cal->nb_echantillons = N;
+
+    SOC_Context ctx;
+    SOC_init_modele(&ctx, m);
+    const int H = m->lstm.nb_unites;
+
+    for (int r = 0; r < H; ++r)
+        if (fabsf(ctx.ct[r]) > cal->cellule_max) cal->cellule_max = fabsf(ctx.ct[r]);
+
+    for (size_t k = 0; k < N; ++k) {
+        // Entrées brutes du LSTM, comme dans SOC_step : [-courant, U, T]
+        const float x[SOC_TAILLE_ENTREE] = { -courant[k], tension[k], temperature[k] };
+        for (int j = 0; j < SOC_TAILLE_ENTREE; ++j)
+            if (fabsf(x[j]) > cal->entree_max[j]) cal->entree_max[j] = fabsf(x[j]);
+
+        SOC_step(&ctx, courant[k], tension[k], temperature[k], SOH[k]);
+        for (int r = 0; r < H; ++r)
+            if (fabsf(ctx.ct[r]) > cal->cellule_max) cal->cellule_max = fabsf(ctx.ct[r]);
+    }
+    return 0;
+}
+
+int SOC_Q_Calibration_ecrire(const char *chemin, const SOC_Q_Calibration *cal)
+{
+    FILE *f = fopen(chemin, "wb");
+    if (!f) {
+        perror("Erreur ouverture fichier");
+        return 1;
+    }
+    int ok = (fwrite(cal, sizeof(*cal), 1, f) == 1);
+    if (fclose(f) != 0) ok = 0;
+    if (!ok) {
+        printf("Erreur ecriture %s\n", chemin);
+        return 1;
+    }
+    return 0;
+}
+
+int SOC_Q_Calibration_lire(const char *chemin, SOC_Q_Calibration *cal)
+{
+    FILE *f = fopen(chemin, "rb");
+    if (!f) {
+        perror("Erreur ouverture calibration");
+        return 1;
+    }
+    int ok = (fread(cal, sizeof(*cal), 1, f) == 1);
+    fclose(f);
+
+    if (!ok || memcmp(cal->magique, SOC_Q_CALIB_MAGIQUE, 4) != 0) {
+        printf("Erreur : %s n'est pas un fichier de calibration PRTQ\n", chemin);
+        return 1;
+    }
+    if (cal->version != SOC_Q_CALIB_VERSION) {
+        printf("Erreur : %s version %u non supportee (attendu %d)\n",
+               chemin, cal->version, SOC_Q_CALIB_VERSION);
+        return 1;
+    }
+    if (memchr(cal->nom, '\0', sizeof(cal->nom)) == NULL ||
+        cal->nb_entrees < 1 || cal->nb_entrees > LSTM_MAX_ENTREES) {
+        printf("Erreur : %s en-tete invalide\n", chemin);
+        return 1;
+    }
+    return 0;
+}
+
+// ============================================================================
+// Quantification
+// ============================================================================
+
+int SOC_Q_Modele_quantifier(SOC_Q_Modele *q, const SOC_Modele *m,
+                            const SOC_Q_Calibration *cal)
+{
+    if (!q || !m || !cal) return 1;
+
+    const LSTM_poids *p = &m->lstm;
+    const int E = p->nb_entrees, H = p->nb_unites;
+    if ((int)cal->nb_entrees != E || (int)cal->nb_unites != H) {
+        printf("SOC_Q : calibration %s (%u x %u) pour le reseau %s (%d x %d)\n",
+               cal->nom, cal->nb_entrees, cal->nb_unites, m->nom, E, H);
+        return 1;
+    }
+
+    memset(q, 0, sizeof(*q));
+    snprintf(q->nom, sizeof(q->nom), "%s", m->nom);
+    q->nb_entrees    = E;
+    q->nb_unites     = H;
+    q->nb_unites_pad = p->nb_unites_pad;
+    q->nb_lignes     = p->nb_lignes;
+    q->nb_paires_x   = (E + 1) / 2;
+    q->nb_paires_h   = (H + 1) / 2;
+    const int nl = p->nb_lignes;
+    const int nc = E + H;
+
+    // Échelles des colonnes : entrées (calibration + marge) et h (Q15)
+    double echelle[LSTM_MAX_ENTREES + LSTM_MAX_UNITES];
+    for (int j = 0; j < E; ++j) {
+        double plage = (double)cal->entree_max[j] * SOC_Q_MARGE;
+        if (!(plage > 0.0)) plage = 1.0;
+        echelle[j]       = plage / UN_Q15;
+        q->entree_inv[j] = (float)(1.0 / echelle[j]);
+    }
+    for (int j = 0; j < H; ++j) echelle[E + j] = 1.0 / UN_Q15;
+    q->courant_echelle = (float)echelle[0];
+
+    // Cellule : assez de bits entiers pour max |c| avec la marge
+    double c_max = (double)cal->cellule_max * SOC_Q_MARGE;
+    int bits_entiers = 0;
+    while (bits_entiers < 14 && (double)(1 << bits_entiers) <= c_max) ++bits_entiers;
+    q->bits_cellule = 15 - bits_entiers;
+
+    int erreur = 0;
+
+    // Portes : une échelle par ligne et par bloc (entrées en int16, h en
+    // int8), échelles des colonnes repliées
+    for (int l = 0; l < nl && !erreur; ++l) {
+        for (int bloc = 0; bloc < 2 && !erreur; ++bloc) {
+            const int j0 = bloc ? E : 0, j1 = bloc ? nc : E;
+            double w_max = 0.0;
+            for (int j = j0; j < j1; ++j) {
+                double w = fabs((double)p->W[j * nl + l] * echelle[j]);
+                if (w > w_max) w_max = w;
+            }
+            const double niveaux = bloc ? 127.0 : SOC_Q_WX_NIVEAUX;
+            double s = (w_max > 0.0) ? w_max / niveaux : 1.0;
+            for (int j = j0; j < j1; ++j) {
+                long w = lrint((double)p->W[j * nl + l] * echelle[j] / s);
+                if (bloc) q->Wh[INDICE_W(j - E, l, nl)] = (int8_t)w;
+                else      q->Wx[INDICE_W(j, l, nl)]     = (int16_t)w;
+            }
+            erreur = bloc ? multiplicateur(s * (1 << SOC_Q_Z_BITS), &q->Mh[l], &q->dh[l])
+                          : multiplicateur(s * (1 << SOC_Q_Z_BITS), &q->Mx[l], &q->dx[l]);
+        }
+        q->b[l] = (int32_t)lrint((double)p->b[l] * (1 << SOC_Q_Z_BITS));
+    }
+
+    // Sortie vers le SOC en Q30
+    double w_max = 0.0;
+    for (int r = 0; r < H; ++r)
+        if (fabs((double)m->WFC[r]) > w_max) w_max = fabs((double)m->WFC[r]);
+    double s_fc = (w_max > 0.0) ? w_max / UN_Q15 / 127.0 : 1.0;
+    for (int r = 0; r < H; ++r)
+        q->WFC[r] = (int8_t)lrint((double)m->WFC[r] / UN_Q15 / s_fc);
+    if (!erreur) erreur = multiplicateur(s_fc * UN_Q30, &q->M_FC, &q->dec_FC);
+    q->bFC = (int64_t)llrint((double)m->bFC * UN_Q30);
+
+    // États initiaux
+    for (int r = 0; r < H; ++r) {
+        q->ht_init[r] = sature16((int32_t)lrint((double)m->ht_init[r] * UN_Q15));
+        q->ct_init[r] = sature16((int32_t)lrint((double)m->ct_init[r] * (1 << q->bits_cellule)));
+    }
+
+    // Table de tanh Q15 sur [0, 8] au pas 1/32
+    for (int k = 0; k < SOC_Q_TABLE_N; ++k)
+        q->table_tanh[k] = (int16_t)lrint(tanh(k / 32.0) * UN_Q15);
+    q->table_tanh[SOC_Q_TABLE_N] = q->table_tanh[SOC_Q_TABLE_N - 1];
+
+    // Kalman : point fixe de Pk en Q30, comme regime_permanent_Kalman
+    q->coef_coulomb = m->coef_coulomb;
+    q->Qk = (int32_t)lrint((double)m->Qk * UN_Q30);
+    q->Rk = (int32_t)lrint((double)m->Rk * UN_Q30);
+    q->Pk_permanent = -1;
+    q->Kk_permanent = 0;
+    int32_t Pk = UN_Q30;
+    for (long k = 0; k < 10000000L; ++k) {
+        int32_t P  = Pk + q->Qk;
+        int32_t Kk = (int32_t)(((int64_t)P << 30) / ((int64_t)P + q->Rk));
+        int32_t P1 = (int32_t)(((int64_t)(UN_Q30 - Kk) * P) >> 30);
+        if (P1 == Pk) {
+            q->Pk_permanent = Pk;
+            q->Kk_permanent = Kk;
+            break;
+        }
+        Pk = P1;
+    }
+
+    if (erreur) printf("SOC_Q : echelles hors plage pour le reseau %s\n", m->nom);
+    return erreur;
+}
+
+size_t SOC_Q_octets_poids(const SOC_Q_Modele *q, int quantifie)
+{
+    const size_t lignes = 4 * (size_t)q->nb_unites;
+    const size_t nx = (size_t)q->nb_entrees * lignes, nh = (size_t)q->nb_unites * lignes;
+    return quantifie ? nx * sizeof(int16_t) + nh * sizeof(int8_t) : (nx + nh) * sizeof(float);
+}
+
+size_t SOC_Q_octets_modele(const SOC_Q_Modele *q, int quantifie)
+{
+    const size_t H = (size_t)q->nb_unites;
+    if (!quantifie)     // portes, biais, sortie, états initiaux
+        return SOC_Q_octets_poids(q, 0) + (4 * H + H + 1 + 2 * H) * sizeof(float);
+
+    return SOC_Q_octets_poids(q, 1)
+         + 4 * H * (2 * (sizeof(int32_t) + sizeof(int8_t)) + sizeof(int32_t))   // M, d, b
+         + H * sizeof(int8_t) + sizeof(int32_t) + sizeof(int8_t) + sizeof(int64_t)
+         + 2 * H * sizeof(int16_t)
+         + SOC_Q_TABLE_N * sizeof(int16_t);
+}
+
+// ============================================================================
+// API publique
+// ============================================================================
+
+void SOC_Q_init(SOC_Q_Context *ctx, const SOC_Q_Modele *q)
+{
+    if (!ctx || !q) return;
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->modele = q;
+
+    ctx->SOC = 0;
+    ctx->Pk  = UN_Q30;
+
+    ctx->SOH_precedent = 0.0f;
+    for (int r = 0; r < q->nb_unites; ++r) {
+        ctx->h[r] = q->ht_init[r];
+        ctx->c[r] = q->ct_init[r];
+    }
+}
+
+// Un pas de LSTM entier : met à jour h, c et renvoie la sortie en Q30,
+// bornée à [0, 1]
+static int32_t predictionLSTM_Q(SOC_Q_Context *ctx, const int16_t *x)
+{
+    const SOC_Q_Modele *q = ctx->modele;
+    const int E   = q->nb_entrees;
+    const int H   = q->nb_unites;
+    const int pad = q->nb_unites_pad;
+    const int nl  = q->nb_lignes;
+    const int16_t *table = q->table_tanh;
+
+    // Entrées et h complétés à un nombre pair de colonnes
+    const int npx = q->nb_paires_x, nph = q->nb_paires_h;
+    int16_t xq[LSTM_MAX_ENTREES + 1], hq[LSTM_MAX_UNITES + 1];
+    int32_t acc_x[4 * LSTM_MAX_UNITES], acc_h[4 * LSTM_MAX_UNITES];
+    xq[2 * npx - 1] = 0;
+    hq[2 * nph - 1] = 0;
+    memcpy(xq, x, (size_t)E * sizeof(int16_t));
+    memcpy(hq, ctx->h, (size_t)H * sizeof(int16_t));
+
+    // Produit des portes par paires de colonnes, paquets de 8 lignes :
+    // deux produits int16 x int16 sommés en int32 (pmaddwd, SMLAD sur M4),
+    // un accumulateur par bloc
+#ifdef SOC_Q_SSE2
+    for (int l = 0; l < nl; l += 8) {
+        __m128i a0 = _mm_setzero_si128(), a1 = _mm_setzero_si128();
+        const int16_t *wx = q->Wx + 2 * l;
+        for (int p = 0; p < npx; ++p, wx += 2 * nl) {
+            const __m128i v = _mm_set1_epi32(paire_Q(xq + 2 * p));
+            a0 = _mm_add_epi32(a0, _mm_madd_epi16(_mm_loadu_si128((const __m128i *)wx), v));
+            a1 = _mm_add_epi32(a1, _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(wx + 8)), v));
+        }
+        _mm_storeu_si128((__m128i *)(acc_x + l),     a0);
+        _mm_storeu_si128((__m128i *)(acc_x + l + 4), a1);
+
+        a0 = _mm_setzero_si128();
+        a1 = _mm_setzero_si128();
+        const int8_t *wh = q->Wh + 2 * l;
+        for (int p = 0; p < nph; ++p, wh += 2 * nl) {
+            const __m128i v  = _mm_set1_epi32(paire_Q(hq + 2 * p));
+            const __m128i w8 = _mm_loadu_si128((const __m128i *)wh);
+            // int8 -> int16 : octet dupliqué puis décalage arithmétique
+            const __m128i wb = _mm_srai_epi16(_mm_unpacklo_epi8(w8, w8), 8);
+            const __m128i wt = _mm_srai_epi16(_mm_unpackhi_epi8(w8, w8), 8);
+            a0 = _mm_add_epi32(a0, _mm_madd_epi16(wb, v));
+            a1 = _mm_add_epi32(a1, _mm_madd_epi16(wt, v));
+        }
+        _mm_storeu_si128((__m128i *)(acc_h + l),     a0);
+        _mm_storeu_si128((__m128i *)(acc_h + l + 4), a1);
+    }
+#else
+    for (int l = 0; l < nl; l += 8) {
+        int32_t a[8] = {0};
+        const int16_t *wx = q->Wx + 2 * l;
+        for (int p = 0; p < npx; ++p, wx += 2 * nl) {
+            const int32_t v0 = xq[2 * p], v1 = xq[2 * p + 1];
+#pragma GCC unroll 8
+            for (int k = 0; k < 8; ++k)
+                a[k] += (int32_t)wx[2 * k] * v0 + (int32_t)wx[2 * k + 1] * v1;
+        }
+        for (int k = 0; k < 8; ++k) acc_x[l + k] = a[k];
+
+        for (int k = 0; k < 8; ++k) a[k] = 0;
+        const int8_t *wh = q->Wh + 2 * l;
+        for (int p = 0; p < nph; ++p, wh += 2 * nl) {
+            const int32_t v0 = hq[2 * p], v1 = hq[2 * p + 1];
+#pragma GCC unroll 8
+            for (int k = 0; k < 8; ++k)
+                a[k] += (int32_t)wh[2 * k] * v0 + (int32_t)wh[2 * k + 1] * v1;
+        }
+        for (int k = 0; k < 8; ++k) acc_h[l + k] = a[k];
+    }
+#endif
+
+    // Portes, cellule et état caché (h écrit après la boucle : les
+    // écritures int16 ne se confondent pas avec la table pour le compilateur)
+    const int bc = q->bits_cellule;
+    int16_t h[LSTM_MAX_UNITES];
+    for (int r = 0; r < H; ++r) {
+        int32_t z[4];
+        for (int g = 0; g < 4; ++g) {
+            const int l = g * pad + r;
+            z[g] = requantifier(acc_x[l], q->Mx[l], q->dx[l])
+                 + requantifier(acc_h[l], q->Mh[l], q->dh[l]) + q->b[l];
+        }
+        int32_t it = sigmoide_Q(table, z[0]);
+        int32_t ft = sigmoide_Q(table, z[1]);
+        int32_t gt = tanh_Q    (table, z[2]);
+        int32_t ot = sigmoide_Q(table, z[3]);
+
+        // c = f c + i g : Q15 x Q(bc) -> Q(bc), Q15 x Q15 -> Q(bc)
+        int32_t c = ((ft * ctx->c[r] + (1 << 14)) >> 15)
+                  + ((it * gt + (1 << (29 - bc))) >> (30 - bc));
+        c = sature16(c);
+        ctx->c[r] = (int16_t)c;
+
+        int32_t c_Q12 = (bc >= SOC_Q_Z_BITS) ? c >> (bc - SOC_Q_Z_BITS)
+                                              : c * (1 << (SOC_Q_Z_BITS - bc));
+        h[r] = sature16((ot * tanh_Q(table, c_Q12) + (1 << 14)) >> 15);
+    }
+    memcpy(ctx->h, h, (size_t)H * sizeof(int16_t));
+
+    // Sortie : WFC * h + bFC en Q30, en 64 bits puis bornée à [0, 1] comme
+    // clamp01 (la sortie brute peut dépasser 2)
+    int32_t s = 0;
+    for (int r = 0; r < H; ++r) s += (int32_t)q->WFC[r] * ctx->h[r];
+    int64_t y = (((int64_t)s * q->M_FC + ((int64_t)1 << (q->dec_FC - 1))) >> q->dec_FC) + q->bFC;
+    return (int32_t)(y < 0 ? 0 : (y > UN_Q30 ? UN_Q30 : y));
+}
+
+float SOC_Q_step(SOC_Q_Context *ctx,
+                 float courant,
+                 float tension,
+                 float temperature,
+                 float SOH)
+{
+    if (!ctx) return 0.0f;
+    const SOC_Q_Modele *q = ctx->modele;
+
+    // Mesures -> int16 (sur cible : valeurs du CAN mises à l'échelle)
+    const float x[SOC_TAILLE_ENTREE] = { -courant, tension, temperature };
+    int16_t xq[SOC_TAILLE_ENTREE];
+    for (int j = 0; j < SOC_TAILLE_ENTREE; ++j)
+        xq[j] = sature16((int32_t)lrintf(x[j] * q->entree_inv[j]));
+
+    // 1) Prédiction coulombmétrique en Q30 : SOC - coef / SOH * I
+    if (SOH != ctx->SOH_precedent) {
+        ctx->SOH_precedent = SOH;
+        double r = (double)q->coef_coulomb / (double)SOH * (double)q->courant_echelle * UN_Q30;
+        int8_t d;
+        if (multiplicateur(fabs(r), &ctx->M_coulomb, &d) != 0) { ctx->M_coulomb = 0; d = 1; }
+        if (r < 0.0) ctx->M_coulomb = -ctx->M_coulomb;
+        ctx->dec_coulomb = d;
+    }
+    int32_t SOC = ctx->SOC - requantifier(xq[0], ctx->M_coulomb, ctx->dec_coulomb);
+
+    // 2) Prédiction LSTM
+    int32_t prediction = predictionLSTM_Q(ctx, xq);
+
+    // 3) Kalman (Fk = Hk = 1), gain constant au point fixe de Pk
+    int32_t Kk;
+    if (ctx->Pk == q->Pk_permanent) {
+        Kk = q->Kk_permanent;
+    } else {
+        int32_t P = ctx->Pk + q->Qk;
+        Kk = (int32_t)(((int64_t)P << 30) / ((int64_t)P + q->Rk));
+        ctx->Pk = (int32_t)(((int64_t)(UN_Q30 - Kk) * P) >> 30);
+    }
+
+    int32_t residu = prediction - SOC;
+    SOC += (int32_t)(((int64_t)Kk * residu + (1 << 29)) >> 30);
+    SOC = clamp_Q30(SOC);
+
+    ctx->SOC = SOC;
+    return (float)SOC * (1.0f / UN_Q30);
+}
@@ -0,0 +1,146 @@
+#ifndef SOC_QUANTIFIE_H
+#define SOC_QUANTIFIE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "SOC.h"
+
+// ============================================================================
+// SOC quantifié : LSTM et Kalman en arithmétique entière (cibles sans FPU)
+//
+// Même calcul que SOC_step, en entiers seulement dans le pas :
+//   - poids des portes en deux blocs avec chacun une échelle par ligne :
+//     bloc récurrent de h en int8 (l'essentiel des poids), bloc des
+//     entrées en int16 sur SOC_Q_WX_NIVEAUX (quelques colonnes, mais l'écart
+//     de SOC en int8 y est 8 fois plus grand) ; rangés par paires de
+//     colonnes entrelacées (deux produits par multiplication-accumulation
+//     int16 : pmaddwd en SSE2, SMLAD sur Cortex-M4), lignes complétées à un
+//     multiple de 8 ; les échelles des entrées et de h sont repliées ;
+//   - entrées [I, U, T] en int16 (échelle de la calibration), h et portes
+//     en Q15, cellule c en int16 à virgule fixe choisie par la calibration ;
+//   - accumulation int32 par bloc, puis une multiplication entière
+//     (mantisse + décalage) par ligne et par bloc vers les pré-activations
+//     en Q12 ;
+//   - sigmoïde et tanh par une table Q15 de tanh sur [0, 8] au pas 1/32
+//     (257 valeurs, interpolation linéaire entière),
+//     sigmoïde(z) = (1 + tanh(z / 2)) / 2 ;
+//   - SOC et Kalman en Q30 : point fixe de Pk et son gain précalculés,
+//     coefficient coulombmétrique recalculé quand le SOH change.
+// Seules les conversions des mesures (int16) et du SOC rendu (float), et le
+// coefficient coulombmétrique à chaque changement de SOH, restent en
+// flottant : sur cible, les mesures arrivent déjà en entiers (CAN).
+//
+// Les échelles viennent d'une calibration : rejeu de ../donnees en float
+// (maximums des entrées et de la cellule), écrite par calibration_soc dans
+// un fichier .prtq. bench_soc_q donne l'écart de SOC avec SOC_step et le
+// temps par pas.
+// ============================================================================
+
+#define SOC_Q_CALIB_MAGIQUE  "PRTQ"
+#define SOC_Q_CALIB_VERSION  1
+#define SOC_Q_MARGE          1.25f      // marge des échelles sur les maximums
+
+#define SOC_Q_Z_BITS         12         // pré-activations en Q12
+#define SOC_Q_TABLE_N        257        // tanh sur [0, 8] au pas 1/32
+#define SOC_Q_WX_NIVEAUX     4095       // poids des entrées : E * 4095 * 2^15 < 2^31
+
+// Maximums relevés sur le rejeu flottant
+typedef struct
+{
+    char     magique[4];                // "PRTQ"
+    uint32_t version;
+    char     nom[32];                   // réseau calibré
+    uint32_t nb_entrees;
+    uint32_t nb_unites;
+    uint64_t nb_echantillons;
+    float    entree_max[LSTM_MAX_ENTREES];  // max |x| brut par entrée
+    float    cellule_max;                   // max |c|
+} SOC_Q_Calibration;
+
+// Modèle quantifié (constant après SOC_Q_Modele_quantifier : en flash sur cible)
+typedef struct
+{
+    char nom[32];
+    int  nb_entrees;            // E
+    int  nb_unites;             // H
+    int  nb_unites_pad;         // H complété à un multiple de 8
+    int  nb_lignes;             // 4 * nb_unites_pad
+    int  nb_paires_x;           // paires de colonnes des entrées
+    int  nb_paires_h;           // paires de colonnes de h
+
+    float entree_inv[LSTM_MAX_ENTREES];     // x_q = x * entree_inv (mesures)
+    float courant_echelle;                  // A par unité de x_q[0]
+    int   bits_cellule;                     // c en Q(bits_cellule)
+
+    // Portes : W?[((colonne / 2) * nb_lignes + ligne) * 2 + colonne % 2],
+    // z = (acc_x * Mx) >> dx + (acc_h * Mh) >> dh + b (Q12)
+    int16_t Wx[(LSTM_MAX_ENTREES + 1) * 4 * LSTM_MAX_UNITES];
+    int8_t  Wh[(LSTM_MAX_UNITES + 1) * 4 * LSTM_MAX_UNITES];
+    int32_t Mx[4 * LSTM_MAX_UNITES], Mh[4 * LSTM_MAX_UNITES];
+    int8_t  dx[4 * LSTM_MAX_UNITES], dh[4 * LSTM_MAX_UNITES];
+    int32_t b[4 * LSTM_MAX_UNITES];
+
+    // Sortie en Q30 : (sum WFC h) * M_FC >> dec_FC + bFC
+    int8_t  WFC[LSTM_MAX_UNITES];
+    int32_t M_FC;
+    int8_t  dec_FC;
+    int64_t bFC;
+
+    int16_t ht_init[LSTM_MAX_UNITES];       // Q15
+    int16_t ct_init[LSTM_MAX_UNITES];       // Q(bits_cellule)
+
+    int16_t table_tanh[SOC_Q_TABLE_N + 1];  // Q15, dernière valeur doublée
+
+    // Kalman en Q30
+    float   coef_coulomb;                   // moins_eta_sur_Q * dt
+    int32_t Qk, Rk;
+    int32_t Pk_permanent;                   // point fixe de Pk (-1 : aucun)
+    int32_t Kk_permanent;
+} SOC_Q_Modele;
+
+typedef struct
+{
+    const SOC_Q_Modele *modele;
+
+    int16_t h[LSTM_MAX_UNITES];     // Q15
+    int16_t c[LSTM_MAX_UNITES];     // Q(bits_cellule)
+
+    int32_t SOC;                    // Q30
+    int32_t Pk;                     // Q30
+
+    // Coefficient coulombmétrique par unité de x_q[0], en Q30 après
+    // décalage, recalculé seulement quand le SOH change
+    float   SOH_precedent;
+    int32_t M_coulomb;
+    int8_t  dec_coulomb;
+} SOC_Q_Context;
+
+// Calibration par rejeu flottant (SOC_step avec le modèle m) des N
+// échantillons ; 0 = OK, 1 = erreur
+int SOC_Q_calibrer(SOC_Q_Calibration *cal, const SOC_Modele *m,
+                   const float *courant, const float *tension,
+                   const float *temperature, const float *SOH, size_t N);
+
+// Fichier de calibration .prtq (0 = OK, 1 = erreur)
+int SOC_Q_Calibration_ecrire(const char *chemin, const SOC_Q_Calibration *cal);
+int SOC_Q_Calibration_lire(const char *chemin, SOC_Q_Calibration *cal);
+
+// Quantification d'un modèle compilé avec sa calibration (0 = OK, 1 = erreur)
+int SOC_Q_Modele_quantifier(SOC_Q_Modele *q, const SOC_Modele *m,
+                            const SOC_Q_Calibration *cal);
+
+// Octets des paramètres : poids des portes seuls, et modèle complet
+// (portes + échelles + biais + sortie + table), float ou quantifié
+size_t SOC_Q_octets_poids(const SOC_Q_Modele *q, int quantifie);
+size_t SOC_Q_octets_modele(const SOC_Q_Modele *q, int quantifie);
+
+void  SOC_Q_init(SOC_Q_Context *ctx, const SOC_Q_Modele *q);
+
+// Même interface que SOC_step
+float SOC_Q_step(SOC_Q_Context *ctx,
+                 float courant,
+                 float tension,
+                 float temperature,
+                 float SOH);
+
+#endif // SOC_QUANTIFIE_H
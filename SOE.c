@@ -1,13 +1,12 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include "SOE_Theo.h"
-#include "Read_Write.h"
+#include "SOE.h"
 
 // ============================================================================
 // Fonction principale : estimation du SOE (fonction pure, point par point)
 // ============================================================================
 float estimation_SOE(float SOC, float SOH, float moins_eta_sur_Q,
-                     const float *X_OCV, const float *LOI_INTEG_OCV_DECHARGE, int n)
+                     const Table_uniforme *LOI_INTEG_OCV_DECHARGE)
 {
     if (SOC < 0.0f) SOC = 0.0f;
     if (SOC > 1.0f) SOC = 1.0f;
@@ -17,7 +16,7 @@ float estimation_SOE(float SOC, float SOH, float moins_eta_sur_Q,
 
     float integrale_courant_pred = (1.0f / moins_eta_sur_Q) * SOH * SOC;
 
-    float ocv_moyenne = interp1Drapide(X_OCV, LOI_INTEG_OCV_DECHARGE, n, SOC);
+    float ocv_moyenne = Table_uniforme_eval(LOI_INTEG_OCV_DECHARGE, SOC);
 
     return ocv_moyenne * integrale_courant_pred;
 }
@@ -34,12 +33,19 @@ static const float LOI_INTEG_OCV_DECHARGE_TAB[104] = {
     2.17810726521397, 2.42387651090271, 2.52340973680752, 2.61810811995897, 2.68830211253072, 2.74359059498592, 2.78879588809875, 2.82666386791756, 2.85892699638151, 2.88674873587964, 2.91099216582562, 2.93230092085619, 2.95118693957418, 2.96805445200887, 2.98323334088822, 2.99698282496203, 3.00951383340767, 3.02099577240751, 3.03157050451826, 3.04135200243041, 3.05043125074092, 3.05889154736900, 3.06679943747442, 3.07421029433268, 3.08117465468151, 3.08773344544836, 3.09392632129709, 3.09978513541024, 3.10533809272911, 3.11061286868298, 3.11563458838623, 3.12042148478899, 3.12499478136048, 3.12937079285950, 3.13356656210501, 3.13759596424894, 3.14147273931224, 3.14520869191849, 3.14881474321317, 3.15230058057039, 3.15567400082808, 3.15894253028603, 3.16211476725150, 3.16519395741560, 3.16818841327157, 3.17110283618178, 3.17393913430038, 3.17670384504597, 3.17940069811906, 3.18203251803023, 3.18460238097567, 3.18711415999426, 3.18956997325686, 3.19197239919673, 3.19432416892391, 3.19662621118576, 3.19888148091879, 3.20109253142139, 3.20326007104181, 3.20538549032296, 3.20747073935636, 3.20951817680704, 3.21152878261973, 3.21350399988768, 3.21544549827404, 3.21735409303498, 3.21923181425047, 3.22107908554545, 3.22289697440416, 3.22468724981292, 3.22644939766687, 3.22818518684065, 3.22989427830465, 3.23157744502623, 3.23323652892598, 3.23487132683029, 3.23648286281331, 3.23807107816518, 3.23963706601348, 3.24118185321509, 3.24270541010895, 3.24420955500570, 3.24569407112564, 3.24715939970186, 3.24860685797354, 3.25003637676908, 3.25144889436468, 3.25284569654290, 3.25422795676839, 3.25559540209492, 3.25694900283186, 3.25829111445285, 3.25962184504910, 3.26094286505299, 3.26225615840580, 3.26356353177906, 3.26487058920003, 3.26619163131266, 3.26688951827563, 3.26758740523860, 3.26776083629660, 3.26932171581863, 3.27335170386112, 3.27435920087174
 };
 
+// Loi rééchantillonnée à pas constant (compilée au premier SOE_init)
+static Table_uniforme LOI_INTEG_OCV_DECHARGE_UNIFORME;
+static int            table_compilee = 0;
+
 void SOE_init(SOE_Context *ctx)
 {
+    if (!table_compilee) {
+        Table_uniforme_compiler(&LOI_INTEG_OCV_DECHARGE_UNIFORME, X_OCV_TAB,
+                                LOI_INTEG_OCV_DECHARGE_TAB, 104, 0);
+        table_compilee = 1;
+    }
     ctx->moins_eta_sur_Q           = 2.300303904920101e-04f;
-    ctx->X_OCV                     = X_OCV_TAB;
-    ctx->LOI_INTEG_OCV_DECHARGE    = LOI_INTEG_OCV_DECHARGE_TAB;
-    ctx->n                         = 104;
+    ctx->LOI_INTEG_OCV_DECHARGE    = &LOI_INTEG_OCV_DECHARGE_UNIFORME;
 }
 
 // Calcul d’un échantillon : SOC, SOH → SOE
@@ -48,8 +54,6 @@ float SOE_step(float SOC, float SOH, const SOE_Context *ctx)
     return estimation_SOE(SOC,
                           SOH,
                           ctx->moins_eta_sur_Q,
-                          ctx->X_OCV,
-                          ctx->LOI_INTEG_OCV_DECHARGE,
-                          ctx->n);
+                          ctx->LOI_INTEG_OCV_DECHARGE);
 }
 
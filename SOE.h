@@ -1,16 +1,16 @@
 #ifndef SOE_THEO_H
 #define SOE_THEO_H
 
+#include "Table_uniforme.h"
+
 // Fonction pure (déjà existante)
 float estimation_SOE(float SOC, float SOH, float moins_eta_sur_Q,
-                     const float *X_OCV, const float *LOI_INTEG_OCV_DECHARGE, int n);
+                     const Table_uniforme *LOI_INTEG_OCV_DECHARGE);
 
 // Petit contexte pour éviter de repasser les tables partout
 typedef struct {
     float moins_eta_sur_Q;
-    const float *X_OCV;
-    const float *LOI_INTEG_OCV_DECHARGE;
-    int n;
+    const Table_uniforme *LOI_INTEG_OCV_DECHARGE;   // pas constant
 } SOE_Context;
 
 // Initialisation du contexte (tables + constante)
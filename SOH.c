@@ -1,47 +1,15 @@
 #include <math.h>
-#include <string.h>
 #include "SOH.h"
 
 // ============================================================================
-// Fonctions internes (static) : moyenne, détection, calcul SOH
+// Fonctions internes (static) : changement de phase, calcul SOH
 // ============================================================================
 
-static float moyenne(const float *tableau, int taille)
+// Changement de phase : met à jour ctx->etat_precedent
+static bool changement_phase(SOH_Context *ctx, int etat)
 {
-    float somme = 0.0f;
-    for (int i = 0; i < taille; i++) {
-        somme += tableau[i];
-    }
-    return somme / (float)taille;
-}
-
-// Détection charge/décharge : met à jour ctx->etat_precedent et renvoie changement_etat
-static bool detection_charge_decharge_core(SOH_Context *ctx,
-                                           float courant)
-{
-    // Décalage du tampon vers la droite
-    memmove(&ctx->tampon_charge_decharge[1],
-            &ctx->tampon_charge_decharge[0],
-            (ctx->taille_tampon - 1) * sizeof(float));
-
-    ctx->tampon_charge_decharge[0] = courant;
-
-    float moyenne_charge_decharge = moyenne(ctx->tampon_charge_decharge,
-                                            ctx->taille_tampon);
-
-    bool etat;
-    // Mise à jour de l'état charge/décharge
-    if ((moyenne_charge_decharge > 0.1f) && !ctx->etat_precedent) {
-        etat = true;   // passe en décharge
-    } else if ((moyenne_charge_decharge < -1.0f) && ctx->etat_precedent) {
-        etat = false;  // passe en charge
-    } else {
-        etat = ctx->etat_precedent; // pas de changement
-    }
-
-    bool changement_etat = (etat != ctx->etat_precedent);
-    ctx->etat_precedent  = etat;
-
+    bool changement_etat = ((etat != 0) != ctx->etat_precedent);
+    ctx->etat_precedent  = (etat != 0);
     return changement_etat;
 }
 
@@ -103,7 +71,6 @@ void SOH_init(SOH_Context *ctx)
 {
     if (!ctx) return;
 
-    ctx->taille_tampon = 60;
     ctx->dt            = 1.0f;
     ctx->moins_eta_sur_Q = 0.00023003f;
     ctx->integrale_courant_neuf = 1.0f / ctx->moins_eta_sur_Q;
@@ -114,10 +81,8 @@ void SOH_init(SOH_Context *ctx)
     ctx->b_filtre[0] = 0.0154662914031034;
     ctx->b_filtre[1] = 0.0154662914031034;
 
-    // Tampon courant
-    for (int i = 0; i < ctx->taille_tampon; ++i) {
-        ctx->tampon_charge_decharge[i] = 0.0f;
-    }
+    // Détection charge/décharge
+    Detection_init(&ctx->detection);
     ctx->etat_precedent   = false;
 
     // Variables SOH
@@ -138,11 +103,20 @@ float SOH_step(SOH_Context *ctx, float courant, float SOC)
 {
     if (!ctx) return 1.0f;
 
-    // même convention que SOH_setup : on utilise -courant pour la détection et le calcul
+    // Détection charge/décharge (même convention : -courant)
+    int etat = Detection_step(&ctx->detection, -courant);
+
+    return SOH_step_etat(ctx, courant, SOC, etat);
+}
+
+float SOH_step_etat(SOH_Context *ctx, float courant, float SOC, int etat)
+{
+    if (!ctx) return 1.0f;
+
+    // même convention que SOH_setup : on utilise -courant pour le calcul
     float courant_sim = -courant;
 
-    // Détection charge/décharge
-    bool changement_etat = detection_charge_decharge_core(ctx, courant_sim);
+    bool changement_etat = changement_phase(ctx, etat);
 
     // Calcul du SOH
     calcul_SOH_core(ctx, courant_sim, changement_etat, SOC);
@@ -2,6 +2,7 @@
 #define SOH_V1_H
 
 #include <stdbool.h>
+#include "Detection_phase.h"
 
 // ============================================================================
 // Contexte SOH : paramètres + états internes
@@ -10,7 +11,6 @@
 typedef struct
 {
     // Paramètres généraux
-    int   taille_tampon;          // typiquement 60
     float dt;                     // pas de temps (s)
     float moins_eta_sur_Q;        // 1 / (eta * Q)
     float integrale_courant_neuf; // 1 / moins_eta_sur_Q
@@ -19,8 +19,10 @@ typedef struct
     double a_filtre[2];
     double b_filtre[2];
 
-    // Tampon pour détection charge/décharge
-    float tampon_charge_decharge[60]; // taille max 60
+    // Détection charge/décharge : avancée par SOH_step seul. La boucle
+    // principale appelle SOH_step_etat avec le détecteur commun : ce
+    // détecteur y reste à Detection_init (copie constante au point de reprise)
+    Detection_Context detection;
     bool  etat_precedent;
 
     // Variables pour le SOH
@@ -46,4 +48,11 @@ void SOH_init(SOH_Context *ctx);
 // ============================================================================
 float SOH_step(SOH_Context *ctx, float courant, float SOC);
 
+// ============================================================================
+// Step SOH avec la phase déjà détectée (détecteur commun de la boucle,
+// Detection_step(-courant)) : même résultat que SOH_step
+// - etat : 0 = charge, 1 = décharge
+// ============================================================================
+float SOH_step_etat(SOH_Context *ctx, float courant, float SOC, int etat);
+
 #endif // SOH_V1_H
@@ -4,61 +4,69 @@
 #include "SOP.h"
 #include "Read_Write.h"
 #include <stdbool.h>
+#include <string.h>
 
-/* ========================================================================== */
-/*  Interpolation rapide + dérivée (interp1rapide_der.m)                      */
-/* ========================================================================== */
-/* MATLAB : interp1rapide_der(x,y,x_req) retourne [sortie, der]              */
-/*  - On suppose x croissant et de taille n                                   */
-/* ========================================================================== */
-static void interp1rapide_der(const float *x,
-                              const float *y,
-                              int          n,
-                              float        x_req,
-                              float       *sortie,
-                              float       *der){
-    int indice = -1;
-    //printf("x_req=%f\n", x_req);
-    /* liste_indice = find(x_req > x); indice = max(liste_indice) */
-    for (int i = 0; i < n; ++i)
-    {
-        if (x_req > x[i]) indice = i;
-    }
-    //printf("indice=%d\n", indice);
-    float coord;
-    if (indice >= 0 && indice < n - 1)
-    {
-        /* cas "normal" */
-        float dx = x[indice + 1] - x[indice];
+static float modele_SOC_CC_step(float moins_eta_sur_Q,
+                                float dt,
+                                float SOC_prev,
+                                float I,
+                                float SOH);
 
-        if (dx == 0.0f) dx = 1e-9f;
-        coord  = (x_req - x[indice]) / dx;
-        *der   = (y[indice + 1] - y[indice]) / dx;
-    }
-    else if (indice < 0)
-    {
-        /* x_req avant la première abscisse => indice = 0 en C */
-        indice = 0;
-        float dx = x[1] - x[0];
-        if (dx == 0.0f) dx = 1e-9f;
-        coord  = 0.0f;
-        *der   = (y[1] - y[0]) / dx;
-        //printf("dx=%f\n", dx);
-        //printf("y=%f\n", y[1] - y[0]);
-        //printf("deriv=%f\n", *der);
-    }
-    else
-    {
-        /* x_req au-delà de la dernière abscisse => indice = n-2 en C */
-        indice = n - 2;
-        float dx = x[indice + 1] - x[indice];
-        if (dx == 0.0f) dx = 1e-9f;
-        coord  = 1.0f;
-        *der   = (y[indice + 1] - y[indice]) / dx;
-    } 
-    //printf("y=%f\n", y[indice]);
-    *sortie = (1.0f - coord) * y[indice] + coord * y[indice + 1];
-    //printf("sortie=%f\n", *sortie);
+static void modele_thermique_foster_ordre_2_step(const float parametre[4],
+                                                 float       I,
+                                                 float       dt,
+                                                 float       TAMB,
+                                                 float      *T1,   // in/out
+                                                 float      *T2);  // in/out
+
+static float modele_tension_1RC_step(float        I,
+                                     float        SOC,
+                                     float       *Ir,   // in/out
+                                     int          etat, // 1 = décharge, 0 = charge
+                                     const Table_uniforme *OCV_charge,
+                                     const Table_uniforme *OCV_decharge,
+                                     float        dt,
+                                     float        R1,
+                                     float        C1,
+                                     float        R0);
+
+static float recherche_racine_SOP_Pegase_1RC(
+    float moins_eta_sur_Q,
+    float dt,
+    int   horizon,
+    float SOC_actuel,
+    float SOH_actuel,
+    const float *coefficients_modele_temperature, /* taille 4 */
+    float T1_init,
+    float temperature_actuelle,
+    float TAMB,
+    float SOC_min,
+    float SOC_max,
+    float U_min,
+    float U_max,
+    float T_max,
+    float I_min,
+    float I_max,
+    float consigne_courant,      /* courant(i) dans le script */
+    float Ir_init,
+    int   etat,
+    const Table_uniforme *OCV_charge,
+    const Table_uniforme *OCV_decharge,
+    float R1,
+    float C1,
+    float R0,
+    float courant_requete, 
+    float *residus,        /* courant(i) dans le script */
+    const Horizon_SOP *modele_horizon,
+    SOP_Amorce *amorce     /* NULL : démarrage à froid */
+);
+
+/* Traces par échantillon (outil SOP) */
+static int traces_SOP = 0;
+
+void SOP_traces(int actif)
+{
+    traces_SOP = actif;
 }
 
 void simuler_horizon_batterie(float moins_eta_sur_Q,
@@ -72,10 +80,8 @@ void simuler_horizon_batterie(float moins_eta_sur_Q,
                               float TAMB,
                               float Ir_init,
                               int   etat,
-                              const float *X_OCV_dep,
-                              const float *Y_OCV_dep_charge,
-                              const float *Y_OCV_dep_decharge,
-                              int   n_OCV,
+                              const Table_uniforme *OCV_charge,
+                              const Table_uniforme *OCV_decharge,
                               float R1,
                               float C1,
                               float R0,
@@ -100,10 +106,8 @@ void simuler_horizon_batterie(float moins_eta_sur_Q,
     // Il faut aussi une tension initiale : on peut la calculer une fois
     float U0 = modele_tension_1RC_step(I_candidat, SOC, &Ir,
                                        etat,
-                                       X_OCV_dep,
-                                       Y_OCV_dep_charge,
-                                       Y_OCV_dep_decharge,
-                                       n_OCV,
+                                       OCV_charge,
+                                       OCV_decharge,
                                        dt, R1, C1, R0);
     //printf("U0=%f\n", U0);
     U_minmax[0] = U0;
@@ -122,10 +126,8 @@ void simuler_horizon_batterie(float moins_eta_sur_Q,
         // 3) Avancer la tension (Ir mis à jour dedans)
         float U = modele_tension_1RC_step(I_candidat, SOC, &Ir,
                                         etat,
-                                          X_OCV_dep,
-                                          Y_OCV_dep_charge,
-                                          Y_OCV_dep_decharge,
-                                          n_OCV,
+                                          OCV_charge,
+                                          OCV_decharge,
                                          dt, R1, C1, R0);
         //printf("k=%f\n", k); 
         //printf("U_blo=%f\n", U);
@@ -185,10 +187,8 @@ static float modele_tension_1RC_step(float        I,
                                      float        SOC,
                                      float       *Ir,   // in/out
                                      int          etat, // 1 = décharge, 0 = charge
-                                     const float *X_OCV_dep,
-                                     const float *Y_OCV_dep_charge,
-                                     const float *Y_OCV_dep_decharge,
-                                     int          n_OCV,
+                                     const Table_uniforme *OCV_charge,
+                                     const Table_uniforme *OCV_decharge,
                                      float        dt,
                                      float        R1,
                                      float        C1,
@@ -209,11 +209,11 @@ static float modele_tension_1RC_step(float        I,
     //printf("Ir=%f\n", *Ir);
     
     // Choix table OCV
-    const float *Y_tab = etat ? Y_OCV_dep_decharge : Y_OCV_dep_charge;
+    const Table_uniforme *table = etat ? OCV_decharge : OCV_charge;
 
-    // Interpolation OCV(SOC)
-    float OCV, der_dummy;
-    interp1rapide_der(X_OCV_dep, Y_tab, n_OCV, SOC, &OCV, &der_dummy);
+    // Interpolation OCV(SOC) à pas constant (sans recherche d'intervalle)
+    float der_dummy;
+    float OCV = Table_uniforme_eval_der(table, SOC, &der_dummy);
     //OCV = 0;
     //printf("OCV=%f\n", OCV);
     //printf("der=%f\n", der_dummy);
@@ -224,6 +224,341 @@ static float modele_tension_1RC_step(float        I,
     // printf("I=%f\n", I);
     return U;
 }
+
+/* ========================================================================== */
+/*  Horizon à courant constant en forme fermée                               */
+/* ========================================================================== */
+/*
+ * Sous courant candidat I constant, les trois modèles pas à pas ont une
+ * solution explicite au pas n de l'horizon (n = 0 : état initial) :
+ *   SOC_n = SOC_0 - n * d,                      d = moins_eta_sur_Q*dt*I/SOH
+ *   Ir_n  = g*I + (Ir_0 - g*I) * alpha^n        g = beta / (1 - alpha)
+ *   T1_n  = T_inf + (T1_0 - T_inf) * p^n        T_inf = R1_th*I^2 + TAMB
+ *   T2_n  = T_inf + A * p^n + B * q^n           A = a2*(T1_0 - T_inf)/(p - q)
+ * avec p = 1 - dt/(R1_th*C1_th), q = 1 - a2, a2 = dt/(R2_th*C2_th).
+ * La tension au pas k utilise Ir_(k+1) (Ir est mis à jour avant U) :
+ *   U_k   = OCV(SOC_k) + D * alpha^k + cte,     D = -R1*(Ir_0 - g*I)*alpha
+ *
+ * Extrêmes sur n = 0..horizon-1 :
+ *   - SOC et T1 sont monotones : valeurs aux deux bouts ;
+ *   - T2 (deux exponentielles) a au plus un point stationnaire, donné en
+ *     forme fermée, évalué aux deux pas entiers qui l'encadrent ;
+ *   - U : si l'OCV (croissante) et le terme en alpha^k varient dans le même
+ *     sens, U est monotone (deux bouts). Sinon, sur chaque morceau linéaire
+ *     de l'OCV traversé, au plus un point stationnaire (forme fermée avec
+ *     la pente du morceau), plus les pas qui encadrent chaque noeud de la
+ *     table franchi (coudes).
+ * Les puissances, logarithmes, noeuds et pentes de l'OCV, qui ne dépendent
+ * pas de I, sont calculés une fois par horizon_SOP_compiler : une
+ * évaluation coûte quelques multiplications, 2 lectures OCV et, dans les
+ * cas non monotones, deux lectures et exponentielles par candidat.
+ */
+
+int horizon_SOP_compiler(Horizon_SOP *h,
+                         float dt,
+                         int   horizon,
+                         const float parametre_therm[4],
+                         float R0,
+                         float R1,
+                         float C1,
+                         const float *X_OCV,
+                         int          n_OCV,
+                         const Table_uniforme *OCV_charge,
+                         const Table_uniforme *OCV_decharge)
+{
+    h->horizon = horizon;
+    h->dt      = dt;
+    h->R0      = R0;
+    h->R1      = R1;
+    h->R1_th   = parametre_therm[0];
+
+    /* 1RC : mêmes alpha / beta que modele_tension_1RC_step */
+    float denom = R1 * C1;
+    float alpha = 1.0f, beta = 0.0f;
+    if (denom != 0.0f) {
+        alpha = -dt / denom + 1.0f;
+        beta  =  dt / denom;
+    }
+    h->alpha = alpha;
+    h->beta  = beta;
+    if (alpha == 1.0f) {            /* Ir figé */
+        h->gain_Ir   = 0.0f;
+        h->ln_alpha  = 0.0f;
+        h->alpha_fin = 1.0f;
+    } else {
+        h->gain_Ir   = beta / (1.0f - alpha);
+        h->ln_alpha  = (float)log((double)alpha);
+        h->alpha_fin = (float)pow((double)alpha, (double)horizon);
+    }
+
+    /* Foster : mêmes coefficients que modele_thermique_foster_ordre_2_step */
+    double p  = 1.0 - (double)(dt / (parametre_therm[0] * parametre_therm[1]));
+    double a2 = (double)(dt / (parametre_therm[2] * parametre_therm[3]));
+    double q  = 1.0 - a2;
+    h->p     = (float)p;
+    h->q     = (float)q;
+    h->k_A   = (float)(a2 / (p - q));
+    h->ln_p  = (float)log(p);
+    h->ln_q  = (float)log(q);
+    h->p_fin = (float)pow(p, (double)(horizon - 1));
+    h->q_fin = (float)pow(q, (double)(horizon - 1));
+    h->a1    = dt / (parametre_therm[0] * parametre_therm[1]);
+    h->a2    = dt / (parametre_therm[2] * parametre_therm[3]);
+
+    /* OCV : noeuds de la table d'origine et pente de chaque morceau
+       (morceau j entre les noeuds j-1 et j, plat hors de la table) */
+    h->OCV[0]    = OCV_charge;
+    h->OCV[1]    = OCV_decharge;
+    h->nb_noeuds = (n_OCV <= SOP_OCV_NOEUDS_MAX) ? n_OCV : 0;
+    for (int j = 0; j < h->nb_noeuds; ++j) h->noeuds[j] = X_OCV[j];
+    for (int e = 0; e < 2; ++e) {
+        h->croissante[e] = 1;
+        h->pente[e][0]   = 0.0f;
+        h->pente[e][h->nb_noeuds] = 0.0f;
+        for (int j = 1; j < h->nb_noeuds; ++j) {
+            float pente = (Table_uniforme_eval(h->OCV[e], X_OCV[j])
+                         - Table_uniforme_eval(h->OCV[e], X_OCV[j - 1]))
+                        / (X_OCV[j] - X_OCV[j - 1]);
+            h->pente[e][j] = pente;
+            if (pente < 0.0f) h->croissante[e] = 0;
+        }
+    }
+
+    /* Forme fermée valable pour des modes réels décroissants et distincts */
+    h->valide = horizon >= 1 && h->nb_noeuds >= 2
+             && alpha > 0.0f && alpha <= 1.0f && (alpha < 1.0f || beta == 0.0f)
+             && p > 0.0 && p < 1.0 && q > 0.0 && q < 1.0
+             && fabs(p - q) > 1e-4;
+    h->analytique = h->valide;
+    return h->valide ? 0 : 1;
+}
+
+/* Pas entier(s) qui encadrent x de ]0, n_fin[ : 0, 1 ou 2 pas dans n[] */
+static int pas_voisins(float x, int n_fin, int n[2])
+{
+    if (!(x > 0.0f && x < (float)n_fin)) return 0;     /* NaN compris */
+    int k = (int)x;
+    n[0] = k;
+    if (k + 1 > n_fin) return 1;
+    n[1] = k + 1;
+    return 2;
+}
+
+static inline void etendre(float v, float minmax[2])
+{
+    if (v < minmax[0]) minmax[0] = v;
+    if (v > minmax[1]) minmax[1] = v;
+}
+
+/*
+ * Plusieurs horizons d'un coup : h[0..nb_points-1] compilés pour des
+ * horizons croissants (mêmes paramètres). Les points intérieurs (point
+ * stationnaire de T2, de U, coudes de l'OCV) ne dépendent pas de l'horizon :
+ * ils sont cherchés une fois sur le plus long et chacun étend les min/max
+ * des horizons qui le contiennent ; seules les valeurs de fin d'horizon
+ * sont propres à chaque horizon.
+ */
+static void simuler_horizon_analytique_points(const Horizon_SOP *h,
+                                              int   nb_points,
+                                              float moins_eta_sur_Q,
+                                              float SOC_init,
+                                              float SOH,
+                                              float T1_init,
+                                              float T2_init,
+                                              float TAMB,
+                                              float Ir_init,
+                                              int   etat,
+                                              float I_candidat,
+                                              float (*SOC_minmax)[2],
+                                              float (*T1_minmax)[2],
+                                              float (*T2_minmax)[2],
+                                              float (*U_minmax)[2],
+                                              float *Ir_final)
+{
+    const Horizon_SOP *h_fin = &h[nb_points - 1];
+    const int   n_fin = h_fin->horizon - 1;
+    const float I     = I_candidat;
+
+    /* ---- SOC : linéaire en n ---- */
+    float d_SOC   = moins_eta_sur_Q * h_fin->dt * I / SOH;
+    float SOC_fin = SOC_init - (float)n_fin * d_SOC;
+    for (int p = 0; p < nb_points; ++p) {
+        SOC_minmax[p][0] = SOC_init; SOC_minmax[p][1] = SOC_init;
+        etendre(SOC_init - (float)(h[p].horizon - 1) * d_SOC, SOC_minmax[p]);
+    }
+
+    /* ---- T1 : une exponentielle ---- */
+    float T_inf = h_fin->R1_th * I * I + TAMB;
+    float E1    = T1_init - T_inf;
+    for (int p = 0; p < nb_points; ++p) {
+        T1_minmax[p][0] = T1_init; T1_minmax[p][1] = T1_init;
+        etendre(T_inf + E1 * h[p].p_fin, T1_minmax[p]);
+    }
+
+    /* ---- T2 : deux exponentielles ---- */
+    float A = h_fin->k_A * E1;
+    float B = T2_init - T_inf - A;
+    for (int p = 0; p < nb_points; ++p) {
+        T2_minmax[p][0] = T2_init; T2_minmax[p][1] = T2_init;
+        etendre(T_inf + A * h[p].p_fin + B * h[p].q_fin, T2_minmax[p]);
+    }
+    if (A != 0.0f && B != 0.0f) {
+        /* A ln(p) p^n + B ln(q) q^n = 0 */
+        float r = -(B * h_fin->ln_q) / (A * h_fin->ln_p);
+        if (r > 0.0f) {
+            int n[2];
+            int nb = pas_voisins(logf(r) / (h_fin->ln_p - h_fin->ln_q), n_fin, n);
+            for (int j = 0; j < nb; ++j) {
+                float x = (float)n[j];
+                float v = T_inf + A * expf(x * h_fin->ln_p) + B * expf(x * h_fin->ln_q);
+                for (int p = nb_points - 1; p >= 0 && n[j] <= h[p].horizon - 1; --p)
+                    etendre(v, T2_minmax[p]);
+            }
+        }
+    }
+
+    /* ---- U : OCV le long du SOC + une exponentielle ---- */
+    const int             e     = etat ? 1 : 0;
+    const Table_uniforme *table = h_fin->OCV[e];
+    float Ir_inf = h_fin->gain_Ir * I;
+    float E_ir   = Ir_init - Ir_inf;
+    float U_cte  = -h_fin->R1 * Ir_inf - h_fin->R0 * I;
+    float D      = -h_fin->R1 * E_ir * h_fin->alpha;
+
+    float U_0 = Table_uniforme_eval(table, SOC_init) + U_cte + D;
+    for (int p = 0; p < nb_points; ++p) {
+        U_minmax[p][0] = U_0;
+        U_minmax[p][1] = U_0;
+        etendre(Table_uniforme_eval(table, SOC_init - (float)(h[p].horizon - 1) * d_SOC)
+                + U_cte - h_fin->R1 * E_ir * h[p].alpha_fin, U_minmax[p]);
+    }
+
+    /* OCV(SOC_k) varie dans le sens de -d, D*alpha^k dans le sens de -D */
+    int monotone = d_SOC == 0.0f || D == 0.0f || h_fin->ln_alpha == 0.0f
+                || (h_fin->croissante[e] && (d_SOC > 0.0f) == (D > 0.0f));
+    if (!monotone) {
+        float inv_d    = 1.0f / d_SOC;
+        float c        = d_SOC / (D * h_fin->ln_alpha);    /* alpha^k* = pente * c */
+        float SOC_bas  = fminf(SOC_init, SOC_fin);
+        float SOC_haut = fmaxf(SOC_init, SOC_fin);
+        const float *pentes = h_fin->pente[e];
+        int   dernier  = -1;
+
+        for (int j = 0; j <= h_fin->nb_noeuds; ++j) {
+            float xa = (j > 0)                ? h_fin->noeuds[j - 1] : -INFINITY;
+            float xb = (j < h_fin->nb_noeuds) ? h_fin->noeuds[j]     :  INFINITY;
+            if (xb < SOC_bas || xa > SOC_haut) continue;
+
+            float candidats[2];
+            int   nb_c = 0;
+
+            /* Point stationnaire dans le morceau j */
+            float r = pentes[j] * c;
+            if (r > 0.0f) {
+                float x = logf(r) / h_fin->ln_alpha;
+                float s = SOC_init - x * d_SOC;
+                if (s >= xa && s <= xb) candidats[nb_c++] = x;
+            }
+            /* Coude au noeud j, s'il est franchi */
+            if (j < h_fin->nb_noeuds && xb > SOC_bas && xb < SOC_haut)
+                candidats[nb_c++] = (SOC_init - xb) * inv_d;
+
+            for (int m = 0; m < nb_c; ++m) {
+                int n[2];
+                int nb = pas_voisins(candidats[m], n_fin, n);
+                for (int i = 0; i < nb; ++i) {
+                    if (n[i] == dernier) continue;
+                    dernier = n[i];
+                    float x = (float)n[i];
+                    float v = Table_uniforme_eval(table, SOC_init - x * d_SOC)
+                            + U_cte + D * expf(x * h_fin->ln_alpha);
+                    for (int p = nb_points - 1; p >= 0 && n[i] <= h[p].horizon - 1; --p)
+                        etendre(v, U_minmax[p]);
+                }
+            }
+        }
+    }
+
+    if (Ir_final) *Ir_final = Ir_inf + E_ir * h_fin->alpha_fin;
+}
+
+void simuler_horizon_analytique(const Horizon_SOP *h,
+                                float moins_eta_sur_Q,
+                                float SOC_init,
+                                float SOH,
+                                float T1_init,
+                                float T2_init,
+                                float TAMB,
+                                float Ir_init,
+                                int   etat,
+                                float I_candidat,
+                                float SOC_minmax[2],
+                                float T1_minmax[2],
+                                float T2_minmax[2],
+                                float U_minmax[2],
+                                float *Ir_final)
+{
+    simuler_horizon_analytique_points(h, 1, moins_eta_sur_Q, SOC_init, SOH,
+                                      T1_init, T2_init, TAMB, Ir_init, etat, I_candidat,
+                                      (float (*)[2])SOC_minmax, (float (*)[2])T1_minmax,
+                                      (float (*)[2])T2_minmax, (float (*)[2])U_minmax,
+                                      Ir_final);
+}
+
+/* ========================================================================== */
+/*  Évaluateur d'horizon                                                      */
+/* ========================================================================== */
+
+/* Évaluations de la dernière recherche du thread appelant (SOP_evaluations) */
+static _Thread_local int nb_evaluations;
+
+int SOP_evaluations(void)
+{
+    return nb_evaluations;
+}
+
+/* Même interface que simuler_horizon_batterie, plus le modèle compilé :
+   forme fermée si h->analytique (SOP_Parametres.evaluateur), pas à pas sinon */
+static void evaluer_horizon(const Horizon_SOP *h,
+                            float moins_eta_sur_Q,
+                            float dt,
+                            int   horizon,
+                            float SOC_init,
+                            float SOH,
+                            const float parametre_therm[4],
+                            float T1_init,
+                            float T2_init,
+                            float TAMB,
+                            float Ir_init,
+                            int   etat,
+                            const Table_uniforme *OCV_charge,
+                            const Table_uniforme *OCV_decharge,
+                            float R1,
+                            float C1,
+                            float R0,
+                            float I_candidat,
+                            float SOC_minmax[2],
+                            float T1_minmax[2],
+                            float T2_minmax[2],
+                            float U_minmax[2],
+                            float *Ir_final)
+{
+    ++nb_evaluations;
+    if (h->analytique) {
+        simuler_horizon_analytique(h, moins_eta_sur_Q, SOC_init, SOH,
+                                   T1_init, T2_init, TAMB, Ir_init, etat,
+                                   I_candidat,
+                                   SOC_minmax, T1_minmax, T2_minmax, U_minmax,
+                                   Ir_final);
+        return;
+    }
+
+    simuler_horizon_batterie(moins_eta_sur_Q, dt, horizon, SOC_init, SOH,
+                             parametre_therm, T1_init, T2_init, TAMB, Ir_init,
+                             etat, OCV_charge, OCV_decharge, R1, C1, R0,
+                             I_candidat, SOC_minmax, T1_minmax, T2_minmax,
+                             U_minmax, Ir_final);
+}
 /* ========================================================================== */
 /*  Modèle SOC comptage coulombmétrique (modele_SOC_CC.m)                    */
 /* ========================================================================== */
@@ -394,18 +729,18 @@ static float recherche_racine_SOP_Pegase_1RC(
     float consigne_courant,      /* courant(i) dans le script */
     float Ir_init,
     int   etat,
-    const float *X_OCV_dep,
-    const float *Y_OCV_dep_charge,
-    const float *Y_OCV_dep_decharge,
-    int   n_OCV,
+    const Table_uniforme *OCV_charge,
+    const Table_uniforme *OCV_decharge,
     float R1,
     float C1,
     float R0,
     float courant_requete, 
-    float *residus        /* courant(i) dans le script */
+    float *residus,        /* courant(i) dans le script */
+    const Horizon_SOP *modele_horizon,
+    SOP_Amorce *amorce
 ){
     /* --- Allocation locale pour les prédictions --- */
-    float courant_candidat_racine;
+    float courant_candidat_racine = 0.0f;
     float SOC_minmax_A[2];
     float T1_minmax_A[2], T2_minmax_A[2];
     float U_minmax_A[2];
@@ -432,6 +767,22 @@ static float recherche_racine_SOP_Pegase_1RC(
         borne_A = 0.0f;
         borne_B = I_min;
     }
+    const float borne_physique = borne_B;
+
+    /* Démarrage à chaud : encadrement étroit autour de la racine précédente */
+    bool chaud = amorce && amorce->valide && amorce->etat == etat
+              && amorce->cote == (consigne_courant > 0.0f);
+    bool itere = false;
+    if (chaud) {
+        float s = (consigne_courant > 0.0f) ? 1.0f : -1.0f;
+        borne_A = amorce->courant - s * SOP_AMORCE_DEMI_LARGEUR;
+        borne_B = amorce->courant + s * SOP_AMORCE_DEMI_LARGEUR;
+        if (s * borne_A < 0.0f)               borne_A = 0.0f;
+        if (s * borne_B > s * borne_physique) borne_B = borne_physique;
+        /* Racine saturée à la consigne à la fin : inutile de chercher au-delà */
+        if (s * borne_B > s * consigne_courant) borne_B = consigne_courant;
+        if (s * borne_A > s * consigne_courant) borne_A = consigne_courant;
+    }
 
     /* ---------------- Évaluation initiale de la borne A ---------------- */
     for (int i = 0; i < horizon; ++i)
@@ -455,30 +806,29 @@ static float recherche_racine_SOP_Pegase_1RC(
 
     //printf("SOC_actuel=%f\n", SOC_actuel);
 
-    simuler_horizon_batterie(moins_eta_sur_Q,
-                              dt,
-                              horizon,
-                              SOC_actuel,
-                              SOH_actuel,
-                              coefficients_modele_temperature,
-                              T1_init,
-                              temperature_actuelle,
-                              TAMB,
-                              Ir_init,
-                              etat,
-                              X_OCV_dep,
-                              Y_OCV_dep_charge,
-                              Y_OCV_dep_decharge,
-                              n_OCV,
-                              R1,
-                              C1,
-                              R0,
-                              courant_candidat_racine,
-                              SOC_minmax_A, // [min, max]
-                              T1_minmax_A,
-                              T2_minmax_A,
-                              U_minmax_A,
-                              NULL);
+    evaluer_horizon(modele_horizon,
+                    moins_eta_sur_Q,
+                    dt,
+                    horizon,
+                    SOC_actuel,
+                    SOH_actuel,
+                    coefficients_modele_temperature,
+                    T1_init,
+                    temperature_actuelle,
+                    TAMB,
+                    Ir_init,
+                    etat,
+                    OCV_charge,
+                    OCV_decharge,
+                    R1,
+                    C1,
+                    R0,
+                    courant_candidat_racine,
+                    SOC_minmax_A, // [min, max]
+                    T1_minmax_A,
+                    T2_minmax_A,
+                    U_minmax_A,
+                    NULL);
     
     //printf("SOC_actuel=%f\n", SOC_actuel);
     //printf("courant_racine=%f\n", courant_candidat_racine);                          
@@ -531,6 +881,8 @@ static float recherche_racine_SOP_Pegase_1RC(
          //printf("residus_A_1=%f\n", residus_borne_A[1]);
          //printf("residus_A_2=%f\n", residus_borne_A[2]);
         //return 0.0f;
+        if (chaud && borne_A != 0.0f)
+            goto repli;
         courant_final = borne_A;
     }else{
 
@@ -540,30 +892,29 @@ static float recherche_racine_SOP_Pegase_1RC(
 courant_candidat_racine = borne_B;
 //printf("corant_B=%f\n", courant_candidat_racine);
 
-simuler_horizon_batterie(moins_eta_sur_Q,
-                         dt,
-                         horizon,
-                         SOC_actuel,
-                         SOH_actuel,
-                         coefficients_modele_temperature,
-                         T1_init,
-                         temperature_actuelle,
-                         TAMB,
-                         Ir_init,
-                         etat,
-                         X_OCV_dep,
-                         Y_OCV_dep_charge,
-                         Y_OCV_dep_decharge,
-                         n_OCV,
-                         R1,
-                         C1,
-                         R0,
-                         courant_candidat_racine,
-                         SOC_minmax_B,   /* [min,max] */
-                         T1_minmax_B,
-                         T2_minmax_B,
-                         U_minmax_B,
-                         NULL);
+evaluer_horizon(modele_horizon,
+                moins_eta_sur_Q,
+                dt,
+                horizon,
+                SOC_actuel,
+                SOH_actuel,
+                coefficients_modele_temperature,
+                T1_init,
+                temperature_actuelle,
+                TAMB,
+                Ir_init,
+                etat,
+                OCV_charge,
+                OCV_decharge,
+                R1,
+                C1,
+                R0,
+                courant_candidat_racine,
+                SOC_minmax_B,   /* [min,max] */
+                T1_minmax_B,
+                T2_minmax_B,
+                U_minmax_B,
+                NULL);
 
 float residus_borne_B[3];
 
@@ -593,17 +944,23 @@ if (residus_borne_B[0] < 0.0f &&
     residus_borne_B[1] < 0.0f &&
     residus_borne_B[2] < 0.0f)
 {
-    printf("residus_B_0, on s'est fait avoir=\n");
+    if (chaud && borne_B != borne_physique
+              && borne_B != consigne_courant)
+        goto repli;
+    if (traces_SOP) printf("residus_B_0, on s'est fait avoir=\n");
     courant_final = borne_B;
     //return borne_B;
 }else{
 //printf("residus_B_0, ou pas\n");
+itere = true;
+float borne_C_prec = borne_A;
 for (int iter = 0; iter < 12; ++iter)
 {
     float borne_C;
     //printf("Iteration=%d\n", iter);
     /* ----------- Calcul du pas après la première itération ----------- */
-    if (iter > 0)
+    /* (à chaud : la consigne est en général hors de l'encadrement étroit) */
+    if (iter > 0 || chaud)
     {
         float pente[3];
         float pas_vecteur[3];
@@ -651,30 +1008,29 @@ for (int iter = 0; iter < 12; ++iter)
 
     float SOC_minmax_C[2], T1_minmax_C[2], T2_minmax_C[2], U_minmax_C[2];
 
-    simuler_horizon_batterie(moins_eta_sur_Q,
-                             dt,
-                             horizon,
-                             SOC_actuel,
-                             SOH_actuel,
-                             coefficients_modele_temperature,
-                             T1_init,
-                             temperature_actuelle,
-                             TAMB,
-                             Ir_init,
-                             etat,
-                             X_OCV_dep,
-                             Y_OCV_dep_charge,
-                             Y_OCV_dep_decharge,
-                             n_OCV,
-                             R1,
-                             C1,
-                             R0,
-                             borne_C,
-                             SOC_minmax_C,
-                             T1_minmax_C,
-                             T2_minmax_C,
-                             U_minmax_C,
-                             NULL);
+    evaluer_horizon(modele_horizon,
+                    moins_eta_sur_Q,
+                    dt,
+                    horizon,
+                    SOC_actuel,
+                    SOH_actuel,
+                    coefficients_modele_temperature,
+                    T1_init,
+                    temperature_actuelle,
+                    TAMB,
+                    Ir_init,
+                    etat,
+                    OCV_charge,
+                    OCV_decharge,
+                    R1,
+                    C1,
+                    R0,
+                    borne_C,
+                    SOC_minmax_C,
+                    T1_minmax_C,
+                    T2_minmax_C,
+                    U_minmax_C,
+                    NULL);
 
     float residus_borne_C[3];
     //printf("borne_C=%f\n", borne_C);
@@ -752,9 +1108,23 @@ for (int iter = 0; iter < 12; ++iter)
         coteA = false;
         //printf("coteB=true\n");
     }
+
+    /* À chaud : arrêt dès que l'encadrement ou le pas est assez petit */
+    if (chaud && (fabsf(borne_B - borne_A) <= SOP_AMORCE_TOLERANCE ||
+                  fabsf(borne_C - borne_C_prec) <= SOP_AMORCE_TOLERANCE))
+        break;
+    borne_C_prec = borne_C;
 }}}
 //printf("courant_final=\n");
 
+/* Racine gardée pour l'échantillon suivant (seulement si la boucle a tourné) */
+if (amorce) {
+    amorce->valide  = itere;
+    amorce->etat    = etat;
+    amorce->cote    = (consigne_courant > 0.0f);
+    amorce->courant = courant_final;
+}
+
 /* ----------------------- Saturation finale du courant ----------------------- */
 
 if (consigne_courant <= 0.0f)
@@ -765,33 +1135,180 @@ else
 //printf("courant_final=%f\n", courant_final);
 return courant_final;
 
+repli:
+    /* Encadrement étroit invalide (signes des résidus) : encadrement complet */
+    amorce->valide = 0;
+    ++amorce->nb_replis;
+    return recherche_racine_SOP_Pegase_1RC(
+        moins_eta_sur_Q, dt, horizon, SOC_actuel, SOH_actuel,
+        coefficients_modele_temperature, T1_init, temperature_actuelle, TAMB,
+        SOC_min, SOC_max, U_min, U_max, T_max, I_min, I_max,
+        consigne_courant, Ir_init, etat, OCV_charge, OCV_decharge,
+        R1, C1, R0, courant_requete, residus, modele_horizon, amorce);
 }
 
 /* ========================================================================== */
-/*  Fonction principale : SOP_predictif (script_SOP_predictif_1_RC...)        */
+/*  Recherche de racine sur grille de candidats (voies SIMD)                  */
 /* ========================================================================== */
-void SOP_predictif(
-    const float *courant,
-    const float *tension,
-    const float *temperature,
-    const float *SOH,
-    const float *SOC,
-    size_t       N,
+/*
+ * Variante de recherche_racine_SOP_Pegase_1RC : au lieu d'un courant
+ * candidat par simulation d'horizon (jusqu'à 2 + 12 simulations en série),
+ * chaque passe simule nb_candidats courants (4, 8 ou 16) ensemble et
+ * resserre l'encadrement [borne_A admissible, borne_B en violation] d'un
+ * facteur nb_candidats + 1 :
+ *   - passe 1 : borne_A = 0, borne_B = consigne (ou I_max / I_min si la
+ *     consigne les dépasse) et nb_candidats - 2 points réguliers entre les
+ *     deux ; 0 en violation -> 0, consigne admissible -> consigne ;
+ *   - passes suivantes : nb_candidats points réguliers dans ]A, B[ ;
+ *     arrêt quand |B - A| <= SOP_GRILLE_TOLERANCE.
+ * Les contraintes se dégradent quand |I| augmente : le premier candidat en
+ * violation (par |I| croissant) borne la racine. Le résultat est la borne
+ * admissible A (conservatif), à SOP_GRILLE_TOLERANCE près de la racine.
+ *
+ * La simulation des candidats est celle de simuler_horizon_batterie, par
+ * blocs de SOP_VOIES courants : boucles à nombre de tours fixe sur les
+ * voies que gcc vectorise (SSE sur x86, NEON sur la Pi), divisions sorties
+ * de l'horizon, seule la lecture de la table OCV reste voie par voie.
+ * Contrainte thermique : T2 max en charge comme en décharge (la borne A
+ * de la recherche par sécante prend T2 min en décharge).
+ */
 
-    float moins_eta_sur_Q,
-    const float coeffs_thermique[4],
-    float TAMB,
-    float T1_init,
-    float T2_init,
+#define SOP_VOIES             4         /* courants par bloc SIMD            */
+#define SOP_CANDIDATS_MAX     16
 
-    const float *X_OCV,
-    const float *Y_OCV_charge,
-    const float *Y_OCV_decharge,
-    int          n_OCV,
-    float R0,
-    float R1,
-    float C1_RC,
+/* Min/max sur l'horizon des grandeurs contraintes, par candidat */
+typedef struct
+{
+    float SOC_min[SOP_CANDIDATS_MAX], SOC_max[SOP_CANDIDATS_MAX];
+    float T2_max[SOP_CANDIDATS_MAX];
+    float U_min[SOP_CANDIDATS_MAX],   U_max[SOP_CANDIDATS_MAX];
+} Horizon_candidats;
+
+/* Horizon pas à pas de nb_candidats courants (multiple de SOP_VOIES).
+   Min/max courants relevés dans sortie[p] après points[p] pas (points
+   croissants, le dernier <= h->horizon) : un seul balayage pour plusieurs
+   horizons. */
+static void simuler_horizon_candidats(const Horizon_SOP *h,
+                                      float moins_eta_sur_Q,
+                                      float SOC_init,
+                                      float SOH,
+                                      float T1_init,
+                                      float T2_init,
+                                      float TAMB,
+                                      float Ir_init,
+                                      int   etat,
+                                      const float *I,
+                                      int   nb_candidats,
+                                      const int *points,
+                                      int   nb_points,
+                                      Horizon_candidats *sortie)
+{
+    const int fin = points[nb_points - 1];
+
+    const Table_uniforme *table = h->OCV[etat ? 1 : 0];
+    const float u_max = (float)(table->n - 1);
+    const int   i_max = table->n - 2;
+
+    for (int b = 0; b < nb_candidats; b += SOP_VOIES) {
+        const float *Ib = I + b;
+        float d[SOP_VOIES], T_inf[SOP_VOIES], R0I[SOP_VOIES];
+        float SOC[SOP_VOIES], T1[SOP_VOIES], T2[SOP_VOIES], Ir[SOP_VOIES], U[SOP_VOIES];
+        float SOC_mn[SOP_VOIES], SOC_mx[SOP_VOIES], T2_mx[SOP_VOIES];
+        float U_mn[SOP_VOIES], U_mx[SOP_VOIES];
+
+        for (int j = 0; j < SOP_VOIES; ++j) {
+            d[j]     = moins_eta_sur_Q * h->dt * Ib[j] / SOH;
+            T_inf[j] = h->R1_th * Ib[j] * Ib[j] + TAMB;
+            R0I[j]   = h->R0 * Ib[j];
+            SOC[j]   = SOC_init;
+            T1[j]    = T1_init;
+            T2[j]    = T2_init;
+            Ir[j]    = Ir_init;
+        }
+
+        int p = 0;
+        for (int k = 0; k < fin; ++k) {
+            if (k > 0)
+                for (int j = 0; j < SOP_VOIES; ++j) {
+                    SOC[j] -= d[j];
+                    float T1_prev = T1[j];
+                    T1[j] = T1_prev + h->a1 * (T_inf[j] - T1_prev);
+                    T2[j] = T2[j]   + h->a2 * (T1_prev - T2[j]);
+                }
+
+            /* OCV(SOC) : indice et poids vectoriels, lecture voie par voie */
+            float u[SOP_VOIES], y0[SOP_VOIES], y1[SOP_VOIES];
+            int   i[SOP_VOIES];
+            for (int j = 0; j < SOP_VOIES; ++j) {
+                float v = (SOC[j] - table->x0) * table->inv_pas;
+                v = !(v < u_max) ? u_max : v;           /* NaN compris */
+                v = (v > 0.0f) ? v : 0.0f;
+                int n = (int)v;
+                i[j] = (n < i_max) ? n : i_max;
+                u[j] = v - (float)i[j];
+            }
+            for (int j = 0; j < SOP_VOIES; ++j) {
+                y0[j] = table->y[i[j]];
+                y1[j] = table->y[i[j] + 1];
+            }
+            for (int j = 0; j < SOP_VOIES; ++j) {
+                Ir[j] = h->alpha * Ir[j] + h->beta * Ib[j];
+                U[j]  = y0[j] + u[j] * (y1[j] - y0[j]) - h->R1 * Ir[j] - R0I[j];
+            }
 
+            if (k == 0) {
+                for (int j = 0; j < SOP_VOIES; ++j) {
+                    SOC_mn[j] = SOC_mx[j] = SOC[j];
+                    T2_mx[j]  = T2[j];
+                    U_mn[j]   = U_mx[j]   = U[j];
+                }
+            } else {
+                for (int j = 0; j < SOP_VOIES; ++j) {
+                    SOC_mn[j] = (SOC[j] < SOC_mn[j]) ? SOC[j] : SOC_mn[j];
+                    SOC_mx[j] = (SOC[j] > SOC_mx[j]) ? SOC[j] : SOC_mx[j];
+                    T2_mx[j]  = (T2[j]  > T2_mx[j])  ? T2[j]  : T2_mx[j];
+                    U_mn[j]   = (U[j]   < U_mn[j])   ? U[j]   : U_mn[j];
+                    U_mx[j]   = (U[j]   > U_mx[j])   ? U[j]   : U_mx[j];
+                }
+            }
+
+            for (; p < nb_points && points[p] == k + 1; ++p)
+                for (int j = 0; j < SOP_VOIES; ++j) {
+                    sortie[p].SOC_min[b + j] = SOC_mn[j];
+                    sortie[p].SOC_max[b + j] = SOC_mx[j];
+                    sortie[p].T2_max[b + j]  = T2_mx[j];
+                    sortie[p].U_min[b + j]   = U_mn[j];
+                    sortie[p].U_max[b + j]   = U_mx[j];
+                }
+        }
+    }
+}
+
+/* Résidus [SOC, T, U] du candidat j (> 0 : contrainte violée) */
+static void residus_candidat(const Horizon_candidats *hc, int j, float consigne_courant,
+                             float SOC_min, float SOC_max, float U_min, float U_max,
+                             float T_max, float residus[3])
+{
+    if (consigne_courant > 0.0f) {
+        residus[0] = SOC_min - hc->SOC_min[j];
+        residus[1] = hc->T2_max[j] - T_max;
+        residus[2] = U_min - hc->U_min[j];
+    } else {
+        residus[0] = hc->SOC_max[j] - SOC_max;
+        residus[1] = hc->T2_max[j] - T_max;
+        residus[2] = hc->U_max[j] - U_max;
+    }
+}
+
+static float recherche_racine_SOP_grille(
+    const Horizon_SOP *h,
+    int   nb_candidats,             /* 4, 8 ou 16 */
+    float moins_eta_sur_Q,
+    float SOC_actuel,
+    float SOH_actuel,
+    float T1_init,
+    float temperature_actuelle,
+    float TAMB,
     float SOC_min,
     float SOC_max,
     float U_min,
@@ -799,507 +1316,265 @@ void SOP_predictif(
     float T_max,
     float I_min,
     float I_max,
-
-    float *SOP_charge,
-    float *SOP_decharge
-)
-{
-    const float dt = 1.0f;         /* comme dans le script */
-
-    /* --- Paramètres de réglage des correcteurs instantanés --- */
-    const float Ki_T_decharge = 1.0f;
-    const float Kp_T_decharge = 5.0f;
-    const float Ki_T_charge   = -1.0f;
-    const float Kp_T_charge   = -5.0f;
-    const float Ki_Umax       = -5.0f;
-    const float Kp_Umax       = -5.0f;
-    const float Ki_Umin       = -5.0f;
-    const float Kp_Umin       = -5.0f;
-
-    const int horizon = 30;       /* horizon de prédiction */
-    float residus[3];
-    bool predictif = true;
-
-    /* --- Buffers internes (comme dans le script) --- */
-    float *courant_resultat          = (float*)calloc(N, sizeof(float));
-    float *courant_candidat          = (float*)calloc(N, sizeof(float));
-    float *delta_I_SOCmax            = (float*)calloc(N, sizeof(float));
-    float *delta_I_Umax              = (float*)calloc(N, sizeof(float));
-    float *delta_I_SOCmin            = (float*)calloc(N, sizeof(float));
-    float *delta_I_Umin              = (float*)calloc(N, sizeof(float));
-    float *delta_I_Tmax_charge       = (float*)calloc(N, sizeof(float));
-    float *delta_I_Tmax_decharge     = (float*)calloc(N, sizeof(float));
-    float *delta_I_Imax              = (float*)calloc(N, sizeof(float));
-    float *delta_I_Imin              = (float*)calloc(N, sizeof(float));
-    float *delta_I_consigne          = (float*)calloc(N, sizeof(float));
-    float *delta_I_candidat          = (float*)calloc(N, sizeof(float));
-    float *SOC_actuel                = (float*)calloc(N, sizeof(float));
-    float *temperature_actuelle      = (float*)calloc(N, sizeof(float));
-    float *tension_actuelle          = (float*)calloc(N, sizeof(float));
-    float *Ir                        = (float*)calloc(N, sizeof(float));
-    int   *etat                      = (int*)  calloc(N, sizeof(int));
-    float *tampon_charge_decharge    = (float*)calloc(60, sizeof(float));
-    float *moyenne_charge_decharge   = (float*)calloc(N, sizeof(float));
-    float *indicateur_boucle         = (float*)calloc(N, sizeof(float));
-    float *courant_predi = (float*)calloc(N, sizeof(float)); 
-
-    if (!courant_resultat || !courant_candidat || !delta_I_SOCmax || !delta_I_Umax ||
-        !delta_I_SOCmin || !delta_I_Umin || !delta_I_Tmax_charge || !delta_I_Tmax_decharge ||
-        !delta_I_Imax || !delta_I_Imin || !delta_I_consigne || !delta_I_candidat ||
-        !SOC_actuel || !temperature_actuelle || !tension_actuelle || !Ir ||
-        !etat || !tampon_charge_decharge || !moyenne_charge_decharge || !indicateur_boucle || !courant_predi)
-    {
-        fprintf(stderr, "Erreur allocation mémoire dans SOP_predictif\n");
-        goto cleanup;
-    }
-
-    /* Conditions initiales (copiées du script) */
-    SOC_actuel[0] = SOC[0];
-    SOC_actuel[1] = SOC[0];
-    SOC_actuel[2] = SOC[0];
-
-    temperature_actuelle[0] = temperature[0];
-    temperature_actuelle[1] = temperature[0];
-    temperature_actuelle[2] = temperature[0];
-
-    tension_actuelle[0] = tension[0];
-    tension_actuelle[1] = tension[0];
-    tension_actuelle[2] = tension[0];
-
-    Ir[0] = 0.0f; Ir[1] = 0.0f; Ir[2] = 0.0f;
-
-    float courant_final_km1 = -courant[0];
-
-    /* Boucle principale i = 3 : L-1 => indices [2 .. N-2] en C */
-    for (size_t i = 2; i < N - 1; ++i)
-    {
-        /* ================================================================== */
-        /* 1) Indicateur charge/décharge                                     */
-        /* ================================================================== */
-        /* Filtre moyenneur sur le courant (tampon de taille 60) */
-        // On fait de la place pour la nouvelle valeure de courant
-        for (int k = 59; k > 0; --k)
-            tampon_charge_decharge[k] = tampon_charge_decharge[k - 1];
-        tampon_charge_decharge[0] = -courant[i];
-
-        /* moyenne */
-        float somme = 0.0f;
-        for (int k = 0; k < 60; ++k) somme += tampon_charge_decharge[k];
-        moyenne_charge_decharge[i] = somme / 60.0f;
-
-        /* Mise à jour de l’état : 0 charge, 1 décharge */
-        if (i > 0)
-        {
-            if (moyenne_charge_decharge[i] > 0.1f && etat[i - 1] == 0)
-                etat[i] = 1;
-            else if (moyenne_charge_decharge[i] < -1.0f && etat[i - 1] == 1)
-                etat[i] = 0;
-            else
-                etat[i] = etat[i - 1];
+    float consigne_courant,
+    float Ir_init,
+    int   etat,
+    float *residus
+){
+    float candidats[SOP_CANDIDATS_MAX];
+    Horizon_candidats hc;
+    float r[3] = { 0.0f, 0.0f, 0.0f };
+
+    float borne_A = 0.0f;
+    float borne_B = (consigne_courant > 0.0f) ? I_max : I_min;
+    if (fabsf(consigne_courant) < fabsf(borne_B)) borne_B = consigne_courant;
+
+    nb_evaluations = 0;
+    while (nb_evaluations < SOP_GRILLE_PASSES_MAX) {
+        int premiere = (nb_evaluations == 0);
+
+        /* Passe 1 : A et B compris ; ensuite : points intérieurs de ]A, B[ */
+        for (int j = 0; j < nb_candidats; ++j) {
+            float t = premiere ? (float)j / (float)(nb_candidats - 1)
+                               : (float)(j + 1) / (float)(nb_candidats + 1);
+            candidats[j] = borne_A + t * (borne_B - borne_A);
+        }
+        if (premiere) candidats[nb_candidats - 1] = borne_B;
+
+        simuler_horizon_candidats(h, moins_eta_sur_Q, SOC_actuel, SOH_actuel,
+                                  T1_init, temperature_actuelle, TAMB, Ir_init,
+                                  etat, candidats, nb_candidats, &h->horizon, 1, &hc);
+        ++nb_evaluations;
+
+        /* Premier candidat en violation, par |I| croissant */
+        int v = nb_candidats;
+        for (int j = 0; j < nb_candidats; ++j) {
+            residus_candidat(&hc, j, consigne_courant, SOC_min, SOC_max,
+                             U_min, U_max, T_max, r);
+            if (r[0] > 0.0f || r[1] > 0.0f || r[2] > 0.0f) { v = j; break; }
+            for (int k = 0; k < 3; ++k) residus[k] = r[k];
         }
 
-        /* ================================================================== */
-        /* 2) Limitation PREDICTIVE (appel à la racine SOP)                   */
-        /* ================================================================== */
-
-        float courant_final = recherche_racine_SOP_Pegase_1RC(
-            moins_eta_sur_Q, dt, horizon,
-            SOC_actuel[i], SOH[i],
-            coeffs_thermique,
-            T1_init, temperature_actuelle[i], TAMB,
-            SOC_min, SOC_max, U_min, U_max, T_max,
-            I_min, I_max,
-            -courant[i],             /* consigne_courant */
-            Ir[i], etat[i],
-            X_OCV, Y_OCV_charge, Y_OCV_decharge, n_OCV,
-            R1, C1_RC, R0,
-            -courant[i], residus              /* courant_requete */
-        );
-
-        printf("courant_final=%f\n", courant_final);
-        printf("boucle=%zu\n", i);
-        courant_predi[i] = courant_final;
-        //printf("courant_predi %f\n", courant_predi[i]);
-        /* On ne dépasse pas la consigne */
-        if (-courant[i] > 0.0f)
-        {
-            //printf("1.0");
-            if (courant_final > -courant[i]){
-                //printf("1.0.1");
-                courant_final = -courant[i];
-            }
+        if (premiere && v == 0) {                   /* déjà hors contraintes à 0 */
+            for (int k = 0; k < 3; ++k) residus[k] = r[k];
+            return borne_A;
         }
-        else
-        {
-            //printf("1.1");
-            if (courant_final < -courant[i]){
-                //printf("1.1.1");
-                courant_final = -courant[i];
-        }}
-
-        courant_resultat[i] = courant_final;
-
-        /* ================================================================== */
-        /* 3) Limitation INSTANTANÉE (boucles SOC / U / T)                    */
-        /* ================================================================== */
-
-        /* ----------------- SOC max ----------------- */
-        //float delta_I_SOCmax;
-        if (SOC_actuel[i] >= SOC_max) {
-            //printf("2.0");
-            /* On impose I = 0 */
-            delta_I_SOCmax[i] = -courant_candidat[i - 1];
+        if (v == nb_candidats) {                    /* tous admissibles */
+            if (premiere) return borne_B;
+            borne_A = candidats[nb_candidats - 1];
         } else {
-            //printf("2.1");
-            /* On limite vers I_min */
-            delta_I_SOCmax[i] = I_min - courant_candidat[i - 1];
+            if (v > 0) borne_A = candidats[v - 1];
+            borne_B = candidats[v];
         }
+        if (fabsf(borne_B - borne_A) <= SOP_GRILLE_TOLERANCE) break;
+    }
+    return borne_A;
+}
 
-        /* ----------------- U max ----------------- */
-
-        /* erreur Umax */
-        float erreur_Umax = U_max - tension_actuelle[i - 1];
-
-        /* dérivée de la tension : -(U(k)-U(k-1))/dt */
-        float der_erreur_Umax =
-            -(tension_actuelle[i - 1] - tension_actuelle[i - 2]) / dt;
-
-        /* correcteur PI sur delta_I */
-        delta_I_Umax[i] =
-            Ki_Umax * erreur_Umax + Kp_Umax * der_erreur_Umax;
-
-        /* saturation : delta_I ne peut pas rendre I positif */
-        float max_delta_for_zero = -courant_candidat[i - 1];
-        if (delta_I_Umax[i] > max_delta_for_zero)
-            delta_I_Umax[i] = max_delta_for_zero;
+/* ========================================================================== */
+/*  Plusieurs horizons en une recherche                                       */
+/* ========================================================================== */
+/*
+ * Limites à 2, 10, 30 et 60 s... : les min/max d'un horizon court sont ceux
+ * d'un préfixe de l'horizon long. Une évaluation d'un courant candidat donne
+ * donc ses résidus pour tous les horizons : forme fermée à plusieurs points
+ * de relevé (simuler_horizon_analytique_points, seules les valeurs de fin
+ * d'horizon sont propres à chacun), ou balayage pas à pas unique
+ * (simuler_horizon_candidats) si la forme fermée n'est pas disponible.
+ *
+ * Chaque horizon garde son encadrement [A admissible, B en violation] sur
+ * g = max des résidus. Les bornes 0 et I_max (ou I_min) sont évaluées une
+ * fois pour tous ; puis, du plus long horizon au plus court, fausse
+ * position (Illinois) jusqu'à |B - A| <= SOP_GRILLE_TOLERANCE. Chaque
+ * évaluation resserre l'encadrement de tous les horizons qu'elle coupe :
+ * la limite d'un horizon long étant au plus celle d'un horizon court, les
+ * horizons courts partent de la limite déjà trouvée, et les horizons non
+ * limités (souvent tous, en décharge) sont réglés par les deux bornes.
+ * Résultat : la borne A (conservatif), comme recherche_racine_SOP_grille.
+ */
 
-        /* ===================== BOUCLES SOP DÉCHARGE ===================== */
+#define SOP_MULTI_EVALUATIONS_MAX 64   /* par sens, tous horizons confondus */
+
+/* g = max des résidus [SOC, T, U] du courant I pour chaque horizon */
+static void residus_horizons(const Horizon_SOP *h,      /* [nb_horizons] */
+                             const int *horizons,
+                             int   nb_horizons,
+                             float moins_eta_sur_Q,
+                             float SOC_actuel,
+                             float SOH_actuel,
+                             float T1_init,
+                             float temperature_actuelle,
+                             float TAMB,
+                             float SOC_min,
+                             float SOC_max,
+                             float U_min,
+                             float U_max,
+                             float T_max,
+                             float consigne_courant,
+                             float Ir_init,
+                             int   etat,
+                             float I,
+                             float *g)                  /* [nb_horizons] */
+{
+    const Horizon_SOP *h_fin = &h[nb_horizons - 1];
+    float SOC_mm[SOP_HORIZONS_MAX][2], T2_mm[SOP_HORIZONS_MAX][2], U_mm[SOP_HORIZONS_MAX][2];
+
+    ++nb_evaluations;
+    if (h_fin->analytique) {
+        float T1_mm[SOP_HORIZONS_MAX][2];
+        simuler_horizon_analytique_points(h, nb_horizons, moins_eta_sur_Q, SOC_actuel,
+                                          SOH_actuel, T1_init, temperature_actuelle, TAMB,
+                                          Ir_init, etat, I, SOC_mm, T1_mm, T2_mm, U_mm, NULL);
+    } else {
+        const float Iv[SOP_VOIES] = { I, I, I, I };
+        Horizon_candidats hc[SOP_HORIZONS_MAX];
+        simuler_horizon_candidats(h_fin, moins_eta_sur_Q, SOC_actuel, SOH_actuel,
+                                  T1_init, temperature_actuelle, TAMB, Ir_init, etat,
+                                  Iv, SOP_VOIES, horizons, nb_horizons, hc);
+        for (int p = 0; p < nb_horizons; ++p) {
+            SOC_mm[p][0] = hc[p].SOC_min[0];  SOC_mm[p][1] = hc[p].SOC_max[0];
+            T2_mm[p][1]  = hc[p].T2_max[0];
+            U_mm[p][0]   = hc[p].U_min[0];    U_mm[p][1]   = hc[p].U_max[0];
+        }
+    }
 
-        /* ---------- SOCmin ---------- */
-        if (SOC_actuel[i] <= SOC_min) {
-            //printf("3.0");
-            /* On impose I = 0 si SOC est en dessous du minimum */
-            delta_I_SOCmin[i] = -courant_candidat[i - 1];
+    for (int p = 0; p < nb_horizons; ++p) {
+        float r_T = T2_mm[p][1] - T_max;
+        float r_SOC, r_U;
+        if (consigne_courant > 0.0f) {
+            r_SOC = SOC_min - SOC_mm[p][0];
+            r_U   = U_min - U_mm[p][0];
         } else {
-            //printf("3.1");
-            /* Sinon, on autorise jusqu'à I_max */
-            delta_I_SOCmin[i] = I_max - courant_candidat[i - 1];
+            r_SOC = SOC_mm[p][1] - SOC_max;
+            r_U   = U_mm[p][1] - U_max;
         }
+        g[p] = fmaxf(r_SOC, fmaxf(r_T, r_U));
+    }
+}
 
-        /* ---------- Umin ---------- */
-        float erreur_Umin = U_min - tension_actuelle[i - 1];
-        float der_erreur_Umin =
-            -(tension_actuelle[i - 1] - tension_actuelle[i - 2]) / dt;
-
-        delta_I_Umin[i] =
-            Ki_Umin * erreur_Umin + Kp_Umin * der_erreur_Umin;
+static void recherche_racine_SOP_horizons(
+    const Horizon_SOP *h,           /* [nb_horizons], compilés par horizon */
+    const int *horizons,
+    int   nb_horizons,
+    float moins_eta_sur_Q,
+    float SOC_actuel,
+    float SOH_actuel,
+    float T1_init,
+    float temperature_actuelle,
+    float TAMB,
+    float SOC_min,
+    float SOC_max,
+    float U_min,
+    float U_max,
+    float T_max,
+    float borne,                    /* I_max (décharge) ou I_min (charge) */
+    float Ir_init,
+    int   etat,
+    float *limites                  /* [nb_horizons] */
+){
+    float A[SOP_HORIZONS_MAX], B[SOP_HORIZONS_MAX];
+    float g_A[SOP_HORIZONS_MAX], g_B[SOP_HORIZONS_MAX], g[SOP_HORIZONS_MAX];
+    const float s = (borne > 0.0f) ? 1.0f : -1.0f;
+
+#define RESIDUS_HORIZONS(I)                                                    \
+    residus_horizons(h, horizons, nb_horizons, moins_eta_sur_Q, SOC_actuel,   \
+                     SOH_actuel, T1_init, temperature_actuelle, TAMB,          \
+                     SOC_min, SOC_max, U_min, U_max, T_max, borne, Ir_init,    \
+                     etat, (I), g)
+
+    nb_evaluations = 0;
+
+    /* Bornes communes : 0 en violation -> limite 0, borne admissible -> borne */
+    RESIDUS_HORIZONS(0.0f);
+    for (int p = 0; p < nb_horizons; ++p) {
+        A[p] = 0.0f;  g_A[p] = g[p];
+        B[p] = (g[p] > 0.0f) ? 0.0f : borne;
+    }
+    RESIDUS_HORIZONS(borne);
+    for (int p = 0; p < nb_horizons; ++p) {
+        if (B[p] == 0.0f) continue;
+        if (g[p] <= 0.0f) A[p] = borne;
+        else              g_B[p] = g[p];
+    }
 
-        /* Saturation : on ne doit pas dépasser ce qui mettrait I à 0 */
-        {
-            float min_delta = -courant_candidat[i - 1];
-            if (delta_I_Umin[i] < min_delta)
-                delta_I_Umin[i] = min_delta;
+    for (int p = nb_horizons - 1; p >= 0; --p) {
+        int cote = 0;               /* dernier côté remplacé (Illinois) */
+        while (fabsf(B[p] - A[p]) > SOP_GRILLE_TOLERANCE &&
+               nb_evaluations < SOP_MULTI_EVALUATIONS_MAX) {
+            /* Fausse position, ramenée au milieu si elle colle à un bord */
+            float c = (A[p] * g_B[p] - B[p] * g_A[p]) / (g_B[p] - g_A[p]);
+            float marge = 0.25f * SOP_GRILLE_TOLERANCE;
+            if (!(s * c > s * A[p] + marge && s * c < s * B[p] - marge))
+                c = 0.5f * (A[p] + B[p]);
+
+            RESIDUS_HORIZONS(c);
+
+            /* Resserre tous les encadrements qui contiennent c */
+            for (int q = 0; q < nb_horizons; ++q) {
+                if (!(s * c > s * A[q] && s * c < s * B[q])) continue;
+                if (g[q] <= 0.0f) { A[q] = c;  g_A[q] = g[q]; }
+                else              { B[q] = c;  g_B[q] = g[q]; }
+            }
+            int c_cote = (g[p] <= 0.0f) ? -1 : 1;
+            if (c_cote == cote) {
+                if (cote < 0) g_B[p] *= 0.5f;
+                else          g_A[p] *= 0.5f;
+            }
+            cote = c_cote;
         }
+    }
+#undef RESIDUS_HORIZONS
 
-        /* ---------- Tmax ---------- */
-        float erreur_Tmax = T_max - temperature_actuelle[i];
-        float der_erreur_Tmax =
-            -(temperature_actuelle[i] - temperature_actuelle[i - 1]) / dt;
-
-        delta_I_Tmax_charge[i] =
-            Ki_T_charge * erreur_Tmax + Kp_T_charge * der_erreur_Tmax;
-
-        delta_I_Tmax_decharge[i] =
-            Ki_T_decharge * erreur_Tmax + Kp_T_decharge * der_erreur_Tmax;
-
-        /* Saturations charge / décharge */
-        {
-            float max_delta_charge = -courant_candidat[i - 1];
-            if (delta_I_Tmax_charge[i] > max_delta_charge)
-                delta_I_Tmax_charge[i] = max_delta_charge;
-
-            float min_delta_decharge = -courant_candidat[i - 1];
-            if (delta_I_Tmax_decharge[i] < min_delta_decharge)
-                delta_I_Tmax_decharge[i] = min_delta_decharge;
-        }
+    for (int p = 0; p < nb_horizons; ++p) limites[p] = A[p];
+}
 
-        /* ----- CALCUL DU SOP ----- */
+/* ========================================================================== */
+/*  Choix du solveur                                                          */
+/* ========================================================================== */
 
-        /* ---------- Limites Imax / Imin ---------- */
-        delta_I_Imax[i] = I_max - courant_candidat[i - 1];
-        delta_I_Imin[i] = I_min - courant_candidat[i - 1];
+/* Solveur du modèle sur un état : grille si param.nb_candidats (candidats
+   pas à pas), sécante sinon (amorce : démarrage à chaud, NULL : à froid) */
+static float resoudre_SOP(const SOP_Modele *m,
+                          float SOC, float SOH, float T1, float T2,
+                          float Ir, int etat, float consigne,
+                          float *residus, SOP_Amorce *amorce)
+{
+    const SOP_Parametres *p = &m->param;
+    nb_evaluations = 0;
+
+    if (p->nb_candidats != 0)
+        return recherche_racine_SOP_grille(
+            &m->horizon, p->nb_candidats, p->moins_eta_sur_Q,
+            SOC, SOH, T1, T2, p->TAMB,
+            p->SOC_min, p->SOC_max, p->U_min, p->U_max, p->T_max,
+            p->I_min, p->I_max, consigne, Ir, etat, residus);
+
+    return recherche_racine_SOP_Pegase_1RC(
+        p->moins_eta_sur_Q, p->dt, p->horizon,
+        SOC, SOH, p->coeffs_thermique, T1, T2, p->TAMB,
+        p->SOC_min, p->SOC_max, p->U_min, p->U_max, p->T_max,
+        p->I_min, p->I_max,
+        consigne, Ir, etat,
+        &m->OCV_charge, &m->OCV_decharge,
+        p->R1, p->C1_RC, p->R0,
+        consigne, residus, &m->horizon, amorce);
+}
 
+float SOP_resoudre(const SOP_Modele *m,
+                   float SOC, float SOH, float T1, float T2,
+                   float Ir, int etat, float consigne, SOP_Amorce *amorce)
+{
+    float residus[3];
+    return resoudre_SOP(m, SOC, SOH, T1, T2, Ir, etat, consigne, residus, amorce);
+}
 
-        /* Limites courants en charge */
-        float I_lim_Imin       = courant_candidat[i - 1] + delta_I_Imin[i];
-        float I_lim_SOCmax     = courant_candidat[i - 1] + delta_I_SOCmax[i];
-        float I_lim_Umax       = courant_candidat[i - 1] + delta_I_Umax[i];
-        float I_lim_Tmax_charge= courant_candidat[i - 1] + delta_I_Tmax_charge[i];
+/* ========================================================================== */
+/*  Paramètres par défaut (script SOP + surveillance_tension / température)   */
+/* ========================================================================== */
 
-        /* Côté charge : on prend la limite la plus "haute" (max) */
-        float LIMITE_CRITIQUE_COURANTS_CHARGE = I_lim_Imin;
-        if (I_lim_SOCmax      > LIMITE_CRITIQUE_COURANTS_CHARGE) LIMITE_CRITIQUE_COURANTS_CHARGE = I_lim_SOCmax;
-        if (I_lim_Umax        > LIMITE_CRITIQUE_COURANTS_CHARGE) LIMITE_CRITIQUE_COURANTS_CHARGE = I_lim_Umax;
-        if (I_lim_Tmax_charge > LIMITE_CRITIQUE_COURANTS_CHARGE) LIMITE_CRITIQUE_COURANTS_CHARGE = I_lim_Tmax_charge;
+#define SOP_N_OCV 21
 
-        /* Limites courants en décharge */
-        float I_lim_Imax          = courant_candidat[i - 1] + delta_I_Imax[i];
-        float I_lim_SOCmin        = courant_candidat[i - 1] + delta_I_SOCmin[i];
-        float I_lim_Umin          = courant_candidat[i - 1] + delta_I_Umin[i];
-        float I_lim_Tmax_decharge = courant_candidat[i - 1] + delta_I_Tmax_decharge[i];
-
-        /* Côté décharge : on prend la limite la plus "basse" (min) */
-        float LIMITE_CRITIQUE_COURANTS_DECHARGE = I_lim_Imax;
-        if (I_lim_SOCmin        < LIMITE_CRITIQUE_COURANTS_DECHARGE) LIMITE_CRITIQUE_COURANTS_DECHARGE = I_lim_SOCmin;
-        if (I_lim_Umin          < LIMITE_CRITIQUE_COURANTS_DECHARGE) LIMITE_CRITIQUE_COURANTS_DECHARGE = I_lim_Umin;
-        if (I_lim_Tmax_decharge < LIMITE_CRITIQUE_COURANTS_DECHARGE) LIMITE_CRITIQUE_COURANTS_DECHARGE = I_lim_Tmax_decharge;
-
-        /* SOP = courant critique * tension */
-        SOP_charge[i]   = LIMITE_CRITIQUE_COURANTS_CHARGE   * tension_actuelle[i - 1];
-        SOP_decharge[i] = LIMITE_CRITIQUE_COURANTS_DECHARGE * tension_actuelle[i - 1];
-
-
-        // /* ---------- Limites Imax / Imin ---------- */
-        // delta_I_Imax[i] = I_max - courant_candidat[i - 1];
-        // delta_I_Imin[i] = I_min - courant_candidat[i - 1];
-
-        float delta_I_consigne;
-
-        if (predictif) {
-            //printf("4.0");
-            delta_I_consigne = courant_resultat[i] - courant_candidat[i - 1];
-        } else {
-            //printf("4.1");
-            delta_I_consigne = -courant[i] - courant_candidat[i - 1];
-        }
-
-        int   indicateur = 0;
-        float delta_I_candidat;
-
-        /* Première comparaison avec SOCmax */
-        if (delta_I_consigne < delta_I_SOCmax[i]) {
-            //printf("5.0");
-            indicateur      = 1;
-            delta_I_candidat = delta_I_SOCmax[i];
-        } else {
-            //printf("5.1");
-            indicateur      = 0;
-            delta_I_candidat = delta_I_consigne;
-        }
-
-        /* Umax */
-        if (delta_I_candidat < delta_I_Umax[i]) {
-            //printf("6.0");
-            indicateur       = 2;
-            delta_I_candidat = delta_I_Umax[i];
-            //printf("delta_I_6=%f\n", delta_I_candidat);
-        }
-
-        /* Tmax charge */
-        if (delta_I_candidat < delta_I_Tmax_charge[i]) {
-            //printf("7");
-            indicateur       = 3;
-            delta_I_candidat = delta_I_Tmax_charge[i];
-        }
-
-        /* SOCmin */
-        if (delta_I_candidat > delta_I_SOCmin[i]) {
-            //printf("8");
-            indicateur       = 4;
-            delta_I_candidat = delta_I_SOCmin[i];
-        }
-
-        /* Umin */
-        if (delta_I_candidat > delta_I_Umin[i]) {
-            //printf("9");
-            indicateur       = 5;
-            delta_I_candidat = delta_I_Umin[i];
-        }
-
-        /* Tmax décharge */
-        if (delta_I_candidat > delta_I_Tmax_decharge[i]) {
-            //printf("10");
-            indicateur       = 6;
-            delta_I_candidat = delta_I_Tmax_decharge[i];
-        }
-
-        /* Imax */
-        if (delta_I_candidat > delta_I_Imax[i]) {
-            //printf("11");
-            indicateur       = 7;
-            delta_I_candidat = delta_I_Imax[i];
-        }
-
-        /* Imin */
-        if (delta_I_candidat < delta_I_Imin[i]) {
-            //printf("12");
-            indicateur       = 8;
-            delta_I_candidat = delta_I_Imin[i];
-        }
-
-        /* Sauvegarde de l'indicateur si vous avez un tableau */
-        indicateur_boucle[i] = indicateur;
-
-        /* Calcul du courant final autorisé */
-        //printf("delta_I_fin=%f\n", delta_I_candidat);
-        //printf("courant i moins un=%f\n", courant_candidat[i - 1]);
-        courant_candidat[i] = courant_candidat[i - 1] + dt * delta_I_candidat;
-        //printf("I_cand=%f\n", courant_candidat[i]);  
-            
-        /* --- Évaluation de la robustesse : déformation du modèle --- */
-        float courant_SOC         = 1.0f * courant_candidat[i];
-        float courant_temperature = 1.0f * courant_candidat[i];
-        float courant_tension     = 1.0f * courant_candidat[i];
-
-        /* --- Simulation du système sur horizon_simulation pas --- */
-        float SOC = SOC_actuel[i];
-        float T1  = T1_init;
-        float T2  = temperature_actuelle[i];
-
-        /* Ir pour la simulation de la tension “système” (indépendant de l'Ir de l'algo) */
-        float Ir_sys = Ir[i];
-        float U_sys  = 0.0f;
-
-        for (int k = 0; k < 1; ++k)
-        {
-            /* 1) Avancer le SOC avec courant_SOC */
-            SOC = modele_SOC_CC_step(moins_eta_sur_Q,
-                                    dt,
-                                    SOC,
-                                    courant_SOC,
-                                    SOH[i]);
-            //printf("k=%d\n", k);
-            //printf("SOC=%f\n", SOC);
-            /* 2) Avancer le thermique avec courant_temperature */
-            modele_thermique_foster_ordre_2_step(coeffs_thermique,
-                                                courant_temperature,
-                                                dt,
-                                                TAMB,
-                                                &T1,
-                                                &T2);
-
-            /* 3) Avancer la tension “système” avec courant_tension et Ir_sys local */
-            U_sys = modele_tension_1RC_step(courant_tension,
-                                            SOC,
-                                            &Ir_sys,
-                                            etat[i],
-                                            X_OCV,
-                                            Y_OCV_charge,
-                                            Y_OCV_decharge,
-                                            n_OCV,
-                                            dt,
-                                            R1,
-                                            C1_RC,
-                                            R0);
-        }
-
-        /* Mise à jour des états du système simulé pour l'itération suivante */
-        SOC_actuel[i + 1]         = SOC;
-        temperature_actuelle[i + 1] = T2;
-        T1_init                   = T1;
-        tension_actuelle[i + 1]   = U_sys;
-
-        etat[i+1]=etat[i];
-
-        /* --- Mise à jour de l'état Ir de l'algorithme SOP --- */
-        /* On repart de Ir[i], comme en MATLAB, et on le fait évoluer avec le courant réellement appliqué */
-        Ir[i + 1] = Ir[i];
-        (void) modele_tension_1RC_step(courant_candidat[i],
-                                    SOC_actuel[i + 1],
-                                    &Ir[i + 1],
-                                    etat[i],
-                                    X_OCV,
-                                    Y_OCV_charge,
-                                    Y_OCV_decharge,
-                                    n_OCV,
-                                    dt,
-                                    R1,
-                                    C1_RC,
-                                    R0);
-
-        printf("La valeur est : %f\n", courant_candidat[i]);
-
-    }
-
-
-//printf("etat %d\n", etat[9998]);
-Ecriture_result(courant_candidat, N, "courant_resultat_PC_result");
-Ecriture_result(SOC_actuel, N, "SOP_PC_result");
-Ecriture_result(tension_actuelle, N, "TENSION_PC_result");
-Ecriture_result(temperature_actuelle, N, "TEMPERATURE_PC_result");
-Ecriture_result_int(etat, N, "Etat_C");
-Ecriture_result(courant_predi, N, "Courant_predi");
-
-
-
-
-cleanup:
-    free(courant_resultat);
-    free(courant_candidat);
-    free(delta_I_SOCmax);
-    free(delta_I_Umax);
-    free(delta_I_SOCmin);
-    free(delta_I_Umin);
-    free(delta_I_Tmax_charge);
-    free(delta_I_Tmax_decharge);
-    free(delta_I_Imax);
-    free(delta_I_Imin);
-    free(delta_I_consigne);
-    free(delta_I_candidat);
-    free(SOC_actuel);
-    free(temperature_actuelle);
-    free(tension_actuelle);
-    free(Ir);
-    free(etat);
-    free(tampon_charge_decharge);
-    free(moyenne_charge_decharge);
-    free(indicateur_boucle);
-}
-
-/* ========================================================================== */
-/*  Programme autonome pour générer SOP_xxx.bin (comme SOE_Theo, etc.)       */
-/* ========================================================================== */
-void setup_SOP(void)
-{
-    const float *courant = NULL;
-    const float *tension = NULL;
-    const float *temperature = NULL;
-    const float *SOH = NULL;
-    const float *SOC = NULL;
-
-    const int NbIteration = 10000;
-
-    float *SOP_charge   = (float*)malloc(NbIteration * sizeof(float));
-    float *SOP_decharge = (float*)malloc(NbIteration * sizeof(float));
-
-    if (!SOP_charge || !SOP_decharge) {
-        perror("malloc SOP");
-        return;
-    }
-
-    /* Chargement des données brutes */
-    Charge_donnees(&courant, &tension, &temperature, &SOH, &SOC);
-    /* Paramètres : à reprendre de vos autres modules / fichiers .mat
-       (mêmes valeurs que dans le script SOP + surveillance_tension / température) */
-    const float moins_eta_sur_Q = 2.3003039e-4f;
-    const float coeffs_therm[4] = {
-        0.206124119186158f,
-        50.3138901982787f,
-        21.6224372540937f,
-        15.8943772584241f
-    };
-    const float TAMB   = 25.0f;
-    const float T1_init = 60.0f;
-    const float T2_init = temperature[0];
-
-    /* Vous pouvez soit :
-       - redéclarer ici les tables OCV (comme dans surveillance_tension.c),
-       - soit les mettre dans un header commun et les déclarer 'extern'. */
-    
-    int n_OCV = 21;
-
-
-    const float X_OCV_global[] = {
+static const float X_OCV_global[SOP_N_OCV] = {
     0.0,
     0.0200000000000000,
     0.0400000000000000,
@@ -1322,7 +1597,7 @@ void setup_SOP(void)
     0.990000000000000,
     1.0
 };
-const float Y_OCV_charge_global[] = {
+static const float Y_OCV_charge_global[SOP_N_OCV] = {
     2.74615136878047,
     2.94688704780013,
     3.04478208162645,
@@ -1345,7 +1620,7 @@ const float Y_OCV_charge_global[] = {
     3.57441784707680,
     3.60655075278407
 };
-const float Y_OCV_decharge_global[]= {
+static const float Y_OCV_decharge_global[SOP_N_OCV] = {
     2.74615136878047,
     2.94688704780013,
     3.04478208162645,
@@ -1369,36 +1644,725 @@ const float Y_OCV_decharge_global[]= {
     3.60655075278407
 };
 
-    const float R0 = 0.022140255136947f;
-    const float R1 = 0.018585867413143f;
-    const float C1_RC = 8.252903566971308e+2f;
-
-    const float SOC_min = 0.1f;
-    const float SOC_max = 0.9f;
-    const float U_min   = 2.0f;
-    const float U_max   = 3.6f;
-    const float T_max   = 60.0f;
-    const float I_min   = -20.0f;
-    const float I_max   = 20.0f;
-
-    SOP_predictif(
-        courant, tension, temperature, SOH, SOC,
-        NbIteration,
-        moins_eta_sur_Q,
-        coeffs_therm,
-        TAMB, T1_init, T2_init,
-        X_OCV_global,
-        Y_OCV_charge_global,
-        Y_OCV_decharge_global,
-        n_OCV,
-        R0, R1, C1_RC,
-        SOC_min, SOC_max,
-        U_min, U_max,
-        T_max,
-        I_min, I_max,
-        SOP_charge,
-        SOP_decharge
-    );
+void SOP_parametres_defaut(SOP_Parametres *p)
+{
+    p->moins_eta_sur_Q     = 2.3003039e-4f;
+    p->coeffs_thermique[0] = 0.206124119186158f;
+    p->coeffs_thermique[1] = 50.3138901982787f;
+    p->coeffs_thermique[2] = 21.6224372540937f;
+    p->coeffs_thermique[3] = 15.8943772584241f;
+    p->TAMB                = 25.0f;
+    p->T1_init             = 60.0f;
+
+    p->X_OCV          = X_OCV_global;
+    p->Y_OCV_charge   = Y_OCV_charge_global;
+    p->Y_OCV_decharge = Y_OCV_decharge_global;
+    p->n_OCV          = SOP_N_OCV;
+    p->R0             = 0.022140255136947f;
+    p->R1             = 0.018585867413143f;
+    p->C1_RC          = 8.252903566971308e+2f;
+
+    p->SOC_min = 0.1f;
+    p->SOC_max = 0.9f;
+    p->U_min   = 2.0f;
+    p->U_max   = 3.6f;
+    p->T_max   = 60.0f;
+    p->I_min   = -20.0f;
+    p->I_max   = 20.0f;
+
+    p->dt      = 1.0f;         /* comme dans le script */
+    p->horizon = 30;           /* horizon de prédiction */
+
+    p->nb_horizons = 4;
+    p->horizons[0] = 2;
+    p->horizons[1] = 10;
+    p->horizons[2] = 30;
+    p->horizons[3] = 60;
+
+    p->evaluateur   = SOP_HORIZON_ANALYTIQUE;
+    p->nb_candidats = 0;       /* sécante */
+    p->amorce       = SOP_AMORCE_CHAUDE;
+}
+
+/* ========================================================================== */
+/*  Modèle compilé                                                            */
+/* ========================================================================== */
+
+int SOP_Modele_compiler(SOP_Modele *m, const SOP_Parametres *p)
+{
+    m->param = *p;
+
+    /* Tables OCV rééchantillonnées à pas constant */
+    if (Table_uniforme_compiler(&m->OCV_charge,   p->X_OCV, p->Y_OCV_charge,   p->n_OCV, 0) != 0 ||
+        Table_uniforme_compiler(&m->OCV_decharge, p->X_OCV, p->Y_OCV_decharge, p->n_OCV, 0) != 0) {
+        printf("SOP : tables OCV invalides\n");
+        return 1;
+    }
+
+    if (p->horizon < 1) {
+        printf("SOP : horizon invalide (%d)\n", p->horizon);
+        return 1;
+    }
+
+    /* Modèle d'horizon en forme fermée (puissances précalculées) ; les
+       coefficients du pas à pas (grille) y sont dans tous les cas */
+    if (horizon_SOP_compiler(&m->horizon, p->dt, p->horizon, p->coeffs_thermique,
+                             p->R0, p->R1, p->C1_RC, p->X_OCV, p->n_OCV,
+                             &m->OCV_charge, &m->OCV_decharge) != 0)
+        printf("SOP : forme fermee de l'horizon inapplicable, evaluation pas a pas\n");
+
+    if (p->nb_candidats != 0 && p->nb_candidats != 4 &&
+        p->nb_candidats != 8 && p->nb_candidats != 16) {
+        printf("SOP : grille de %d candidats invalide (4, 8 ou 16)\n", p->nb_candidats);
+        return 1;
+    }
+
+    /* Horizons des limites multi-horizons : la recherche commune lit les
+       fins d'horizon de chacun (forme fermée), ou balaye le plus long pas à
+       pas si elle est inapplicable */
+    if (p->nb_horizons < 0 || p->nb_horizons > SOP_HORIZONS_MAX) {
+        printf("SOP : nombre d'horizons invalide (%d)\n", p->nb_horizons);
+        return 1;
+    }
+    for (int k = 0; k < p->nb_horizons; ++k) {
+        if (p->horizons[k] < 1 || (k > 0 && p->horizons[k] <= p->horizons[k - 1])) {
+            printf("SOP : horizons non croissants\n");
+            return 1;
+        }
+        horizon_SOP_compiler(&m->horizons[k], p->dt, p->horizons[k], p->coeffs_thermique,
+                             p->R0, p->R1, p->C1_RC, p->X_OCV, p->n_OCV,
+                             &m->OCV_charge, &m->OCV_decharge);
+    }
+
+    /* Évaluateur pas à pas demandé : forme fermée écartée partout */
+    if (p->evaluateur == SOP_HORIZON_PAS) {
+        m->horizon.analytique = 0;
+        for (int k = 0; k < p->nb_horizons; ++k) m->horizons[k].analytique = 0;
+    }
+    return 0;
+}
+
+const SOP_Modele *SOP_modele_defaut(void)
+{
+    static SOP_Modele modele;
+    static int compile = 0;
+    if (!compile) {
+        SOP_Parametres p;
+        SOP_parametres_defaut(&p);
+        SOP_Modele_compiler(&modele, &p);
+        compile = 1;
+    }
+    return &modele;
+}
+
+/* ========================================================================== */
+/*  Limites multi-horizons                                                    */
+/* ========================================================================== */
+
+void SOP_courants_horizons(const SOP_Modele *m,
+                           float SOC, float SOH, float T1, float T2,
+                           float Ir, int etat, float borne, float *I)
+{
+    const SOP_Parametres *p = &m->param;
+    if (p->nb_horizons == 0) return;
+    recherche_racine_SOP_horizons(m->horizons, p->horizons, p->nb_horizons,
+                                  p->moins_eta_sur_Q, SOC, SOH, T1, T2, p->TAMB,
+                                  p->SOC_min, p->SOC_max, p->U_min, p->U_max, p->T_max,
+                                  borne, Ir, etat, I);
+}
+
+/* Limites des deux sens pour tous les horizons, sur un état donné */
+static void limites_horizons(const SOP_Modele *m, float SOC, float SOH,
+                             float T1, float T2, float Ir, int etat,
+                             float tension, SOP_Limite *limites)
+{
+    const SOP_Parametres *p = &m->param;
+    float I[2][SOP_HORIZONS_MAX];
+
+    SOP_courants_horizons(m, SOC, SOH, T1, T2, Ir, etat, p->I_min, I[0]);  /* charge */
+    SOP_courants_horizons(m, SOC, SOH, T1, T2, Ir, etat, p->I_max, I[1]);  /* décharge */
+
+    for (int k = 0; k < p->nb_horizons; ++k) {
+        limites[k].horizon      = p->horizons[k];
+        limites[k].SOP_charge   = I[0][k] * tension;
+        limites[k].SOP_decharge = I[1][k] * tension;
+    }
+}
+
+/* ========================================================================== */
+/*  Limites des deux sens (thread de travail persistant)                      */
+/* ========================================================================== */
+
+static int deux_sens_threads(const SOP_Deux_sens *d)
+{
+    return d->mode == SOP_DEUX_SENS_THREADS;
+}
+
+/* sens 0 : charge (consigne I_min), 1 : décharge (consigne I_max) ; même
+   solveur que la recherche principale (resoudre_SOP) */
+static void limite_sens(SOP_Deux_sens *d, int sens)
+{
+    const SOP_Parametres *p = &d->modele->param;
+    float residus[3];
+    d->courant[sens] = resoudre_SOP(
+        d->modele, d->SOC, d->SOH, d->T1, d->T2, d->Ir, d->etat,
+        sens ? p->I_max : p->I_min, residus,
+        p->amorce == SOP_AMORCE_CHAUDE ? &d->amorce[sens] : NULL);
+}
+
+static void *thread_deux_sens(void *arg)
+{
+    SOP_Deux_sens *d = (SOP_Deux_sens *)arg;
+
+    for (;;)
+    {
+        pthread_barrier_wait(&d->depart);
+        if (d->arret) break;
+        limite_sens(d, 0);
+        pthread_barrier_wait(&d->arrivee);
+    }
+    return NULL;
+}
+
+int SOP_deux_sens_ouvrir(SOP_Deux_sens *d, const SOP_Modele *m, SOP_Deux_sens_mode mode)
+{
+    memset(d, 0, sizeof(*d));
+    d->modele = m ? m : SOP_modele_defaut();
+    d->mode   = mode;
+    if (mode != SOP_DEUX_SENS_THREADS) return 0;
+
+    if (pthread_barrier_init(&d->depart, NULL, 2) != 0) {
+        printf("Erreur initialisation barriere SOP (deux sens)\n");
+        d->mode = SOP_DEUX_SENS_SEQUENTIEL;
+        return 1;
+    }
+    if (pthread_barrier_init(&d->arrivee, NULL, 2) != 0) {
+        printf("Erreur initialisation barriere SOP (deux sens)\n");
+        pthread_barrier_destroy(&d->depart);
+        d->mode = SOP_DEUX_SENS_SEQUENTIEL;
+        return 1;
+    }
+    if (pthread_create(&d->thread, NULL, thread_deux_sens, d) != 0) {
+        printf("Erreur creation thread SOP (deux sens)\n");
+        pthread_barrier_destroy(&d->depart);
+        pthread_barrier_destroy(&d->arrivee);
+        d->mode = SOP_DEUX_SENS_SEQUENTIEL;
+        return 1;
+    }
+    return 0;
+}
+
+void SOP_deux_sens_fermer(SOP_Deux_sens *d)
+{
+    if (d->mode != SOP_DEUX_SENS_THREADS) return;
+    d->arret = 1;
+    pthread_barrier_wait(&d->depart);
+    pthread_join(d->thread, NULL);
+    pthread_barrier_destroy(&d->depart);
+    pthread_barrier_destroy(&d->arrivee);
+    d->mode = SOP_DEUX_SENS_SEQUENTIEL;
+}
+
+/* ========================================================================== */
+/*  SOP_init / SOP_step (script_SOP_predictif_1_RC..., un échantillon)        */
+/* ========================================================================== */
+
+void SOP_init(SOP_Context *ctx)
+{
+    SOP_init_modele(ctx, SOP_modele_defaut());
+}
+
+void SOP_init_modele(SOP_Context *ctx, const SOP_Modele *m)
+{
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->modele = m;
+    Detection_init(&ctx->detection);
+    ctx->etat   = 0;
+}
+
+void SOP_demarrer(SOP_Context *ctx, float SOC, float temperature, float tension)
+{
+    /* Conditions initiales (copiées du script) */
+    ctx->SOC     = SOC;
+    ctx->T1      = ctx->modele->param.T1_init;
+    ctx->T2      = temperature;
+    ctx->T2_prec = temperature;
+    ctx->U       = tension;
+    ctx->U_prec  = tension;
+    ctx->U_prec2 = tension;
+    ctx->Ir      = 0.0f;
+    ctx->courant_candidat = 0.0f;
+    ctx->demarre = 1;
+}
+
+/* Un pas ; limites (facultatif) : limites multi-horizons du même état */
+static float pas_SOP(SOP_Context *ctx,
+                     float courant,
+                     float tension,
+                     float temperature,
+                     float SOH,
+                     float SOC,
+                     float *SOP_charge,
+                     float *SOP_decharge,
+                     SOP_Limite *limites,
+                     SOP_Deux_sens *deux_sens,
+                     int   etat_recu)           /* < 0 : détecteur du contexte */
+{
+    const SOP_Modele     *m = ctx->modele;
+    const SOP_Parametres *p = &m->param;
+    const float dt = p->dt;
+
+    /* --- Paramètres de réglage des correcteurs instantanés --- */
+    const float Ki_T_decharge = 1.0f;
+    const float Kp_T_decharge = 5.0f;
+    const float Ki_T_charge   = -1.0f;
+    const float Kp_T_charge   = -5.0f;
+    const float Ki_Umax       = -5.0f;
+    const float Kp_Umax       = -5.0f;
+    const float Ki_Umin       = -5.0f;
+    const float Kp_Umin       = -5.0f;
+
+    const bool predictif = true;
+    float residus[3];
+
+    if (!ctx->demarre) SOP_demarrer(ctx, SOC, temperature, tension);
+
+    /* Historique lu par les correcteurs instantanés */
+    const float courant_candidat_prec = ctx->courant_candidat;   /* (i-1) */
+    const float tension_prec          = ctx->U_prec;             /* (i-1) */
+    const float tension_prec2         = ctx->U_prec2;            /* (i-2) */
+    const float temperature_actuelle  = ctx->T2;                 /* (i)   */
+    const float temperature_prec      = ctx->T2_prec;            /* (i-1) */
+    const float SOC_actuel            = ctx->SOC;
+
+    /* ================================================================== */
+    /* 1) Indicateur charge/décharge                                     */
+    /* ================================================================== */
+    /* Filtre moyenneur sur le courant (Detection_phase.h), sauf si la
+       phase vient du détecteur commun de la boucle */
+    ctx->etat = (etat_recu >= 0) ? etat_recu : Detection_step(&ctx->detection, -courant);
+    const int etat = ctx->etat;
+
+    /* ================================================================== */
+    /* 2) Limitation PREDICTIVE (appel à la racine SOP)                   */
+    /* ================================================================== */
+
+    /* La recherche ne dépend de la consigne que par son signe (sens de
+       l'encadrement) ; la consigne elle-même est appliquée ensuite. Avec les
+       limites des deux sens, la recherche principale est donc celle du sens
+       de la consigne : la charge part sur le thread de travail pendant que
+       l'appelant fait la décharge, une seule recherche attendue par pas */
+    float courant_final;
+    if (deux_sens) {
+        deux_sens->SOC  = SOC_actuel;
+        deux_sens->SOH  = SOH;
+        deux_sens->T1   = ctx->T1;
+        deux_sens->T2   = temperature_actuelle;
+        deux_sens->Ir   = ctx->Ir;
+        deux_sens->etat = etat;
+        if (deux_sens_threads(deux_sens)) {
+            pthread_barrier_wait(&deux_sens->depart);
+            limite_sens(deux_sens, 1);
+            pthread_barrier_wait(&deux_sens->arrivee);
+        } else {
+            limite_sens(deux_sens, 0);
+            limite_sens(deux_sens, 1);
+        }
+        courant_final = deux_sens->courant[(-courant > 0.0f) ? 1 : 0];
+    } else {
+        courant_final = resoudre_SOP(
+            m, SOC_actuel, SOH, ctx->T1, temperature_actuelle, ctx->Ir, etat,
+            -courant,                /* consigne_courant */
+            residus,
+            p->amorce == SOP_AMORCE_CHAUDE ? &ctx->amorce : NULL);
+    }
+    ctx->courant_predictif = courant_final;
+
+    if (limites)
+        limites_horizons(m, SOC_actuel, SOH, ctx->T1, temperature_actuelle,
+                         ctx->Ir, etat, tension_prec, limites);
+
+    /* On ne dépasse pas la consigne */
+    if (-courant > 0.0f)
+    {
+        if (courant_final > -courant)
+            courant_final = -courant;
+    }
+    else
+    {
+        if (courant_final < -courant)
+            courant_final = -courant;
+    }
+
+    const float courant_resultat = courant_final;
+
+    /* ================================================================== */
+    /* 3) Limitation INSTANTANÉE (boucles SOC / U / T)                    */
+    /* ================================================================== */
+
+    /* ----------------- SOC max ----------------- */
+    float delta_I_SOCmax;
+    if (SOC_actuel >= p->SOC_max) {
+        /* On impose I = 0 */
+        delta_I_SOCmax = -courant_candidat_prec;
+    } else {
+        /* On limite vers I_min */
+        delta_I_SOCmax = p->I_min - courant_candidat_prec;
+    }
+
+    /* ----------------- U max ----------------- */
+
+    /* erreur Umax */
+    float erreur_Umax = p->U_max - tension_prec;
+
+    /* dérivée de la tension : -(U(k)-U(k-1))/dt */
+    float der_erreur_Umax = -(tension_prec - tension_prec2) / dt;
+
+    /* correcteur PI sur delta_I */
+    float delta_I_Umax = Ki_Umax * erreur_Umax + Kp_Umax * der_erreur_Umax;
+
+    /* saturation : delta_I ne peut pas rendre I positif */
+    float max_delta_for_zero = -courant_candidat_prec;
+    if (delta_I_Umax > max_delta_for_zero)
+        delta_I_Umax = max_delta_for_zero;
+
+    /* ===================== BOUCLES SOP DÉCHARGE ===================== */
+
+    /* ---------- SOCmin ---------- */
+    float delta_I_SOCmin;
+    if (SOC_actuel <= p->SOC_min) {
+        /* On impose I = 0 si SOC est en dessous du minimum */
+        delta_I_SOCmin = -courant_candidat_prec;
+    } else {
+        /* Sinon, on autorise jusqu'à I_max */
+        delta_I_SOCmin = p->I_max - courant_candidat_prec;
+    }
+
+    /* ---------- Umin ---------- */
+    float erreur_Umin = p->U_min - tension_prec;
+    float der_erreur_Umin = -(tension_prec - tension_prec2) / dt;
+
+    float delta_I_Umin = Ki_Umin * erreur_Umin + Kp_Umin * der_erreur_Umin;
+
+    /* Saturation : on ne doit pas dépasser ce qui mettrait I à 0 */
+    {
+        float min_delta = -courant_candidat_prec;
+        if (delta_I_Umin < min_delta)
+            delta_I_Umin = min_delta;
+    }
+
+    /* ---------- Tmax ---------- */
+    float erreur_Tmax = p->T_max - temperature_actuelle;
+    float der_erreur_Tmax = -(temperature_actuelle - temperature_prec) / dt;
+
+    float delta_I_Tmax_charge =
+        Ki_T_charge * erreur_Tmax + Kp_T_charge * der_erreur_Tmax;
+
+    float delta_I_Tmax_decharge =
+        Ki_T_decharge * erreur_Tmax + Kp_T_decharge * der_erreur_Tmax;
+
+    /* Saturations charge / décharge */
+    {
+        float max_delta_charge = -courant_candidat_prec;
+        if (delta_I_Tmax_charge > max_delta_charge)
+            delta_I_Tmax_charge = max_delta_charge;
+
+        float min_delta_decharge = -courant_candidat_prec;
+        if (delta_I_Tmax_decharge < min_delta_decharge)
+            delta_I_Tmax_decharge = min_delta_decharge;
+    }
+
+    /* ----- CALCUL DU SOP ----- */
+
+    /* ---------- Limites Imax / Imin ---------- */
+    float delta_I_Imax = p->I_max - courant_candidat_prec;
+    float delta_I_Imin = p->I_min - courant_candidat_prec;
+
+    /* Limites courants en charge */
+    float I_lim_Imin        = courant_candidat_prec + delta_I_Imin;
+    float I_lim_SOCmax      = courant_candidat_prec + delta_I_SOCmax;
+    float I_lim_Umax        = courant_candidat_prec + delta_I_Umax;
+    float I_lim_Tmax_charge = courant_candidat_prec + delta_I_Tmax_charge;
+
+    /* Côté charge : on prend la limite la plus "haute" (max) */
+    float LIMITE_CRITIQUE_COURANTS_CHARGE = I_lim_Imin;
+    if (I_lim_SOCmax      > LIMITE_CRITIQUE_COURANTS_CHARGE) LIMITE_CRITIQUE_COURANTS_CHARGE = I_lim_SOCmax;
+    if (I_lim_Umax        > LIMITE_CRITIQUE_COURANTS_CHARGE) LIMITE_CRITIQUE_COURANTS_CHARGE = I_lim_Umax;
+    if (I_lim_Tmax_charge > LIMITE_CRITIQUE_COURANTS_CHARGE) LIMITE_CRITIQUE_COURANTS_CHARGE = I_lim_Tmax_charge;
+
+    /* Limites courants en décharge */
+    float I_lim_Imax          = courant_candidat_prec + delta_I_Imax;
+    float I_lim_SOCmin        = courant_candidat_prec + delta_I_SOCmin;
+    float I_lim_Umin          = courant_candidat_prec + delta_I_Umin;
+    float I_lim_Tmax_decharge = courant_candidat_prec + delta_I_Tmax_decharge;
+
+    /* Côté décharge : on prend la limite la plus "basse" (min) */
+    float LIMITE_CRITIQUE_COURANTS_DECHARGE = I_lim_Imax;
+    if (I_lim_SOCmin        < LIMITE_CRITIQUE_COURANTS_DECHARGE) LIMITE_CRITIQUE_COURANTS_DECHARGE = I_lim_SOCmin;
+    if (I_lim_Umin          < LIMITE_CRITIQUE_COURANTS_DECHARGE) LIMITE_CRITIQUE_COURANTS_DECHARGE = I_lim_Umin;
+    if (I_lim_Tmax_decharge < LIMITE_CRITIQUE_COURANTS_DECHARGE) LIMITE_CRITIQUE_COURANTS_DECHARGE = I_lim_Tmax_decharge;
+
+    /* SOP = courant critique * tension */
+    *SOP_charge   = LIMITE_CRITIQUE_COURANTS_CHARGE   * tension_prec;
+    *SOP_decharge = LIMITE_CRITIQUE_COURANTS_DECHARGE * tension_prec;
+
+    float delta_I_consigne;
+    if (predictif)
+        delta_I_consigne = courant_resultat - courant_candidat_prec;
+    else
+        delta_I_consigne = -courant - courant_candidat_prec;
+
+    float delta_I_candidat;
+
+    /* Première comparaison avec SOCmax */
+    if (delta_I_consigne < delta_I_SOCmax)
+        delta_I_candidat = delta_I_SOCmax;
+    else
+        delta_I_candidat = delta_I_consigne;
+
+    /* Umax */
+    if (delta_I_candidat < delta_I_Umax)          delta_I_candidat = delta_I_Umax;
+    /* Tmax charge */
+    if (delta_I_candidat < delta_I_Tmax_charge)   delta_I_candidat = delta_I_Tmax_charge;
+    /* SOCmin */
+    if (delta_I_candidat > delta_I_SOCmin)        delta_I_candidat = delta_I_SOCmin;
+    /* Umin */
+    if (delta_I_candidat > delta_I_Umin)          delta_I_candidat = delta_I_Umin;
+    /* Tmax décharge */
+    if (delta_I_candidat > delta_I_Tmax_decharge) delta_I_candidat = delta_I_Tmax_decharge;
+    /* Imax */
+    if (delta_I_candidat > delta_I_Imax)          delta_I_candidat = delta_I_Imax;
+    /* Imin */
+    if (delta_I_candidat < delta_I_Imin)          delta_I_candidat = delta_I_Imin;
+
+    /* Calcul du courant final autorisé */
+    float courant_candidat = courant_candidat_prec + dt * delta_I_candidat;
+
+    /* --- Simulation du système sur un pas --- */
+    float SOC_sys = modele_SOC_CC_step(p->moins_eta_sur_Q, dt, SOC_actuel,
+                                       courant_candidat, SOH);
+
+    float T1 = ctx->T1;
+    float T2 = temperature_actuelle;
+    modele_thermique_foster_ordre_2_step(p->coeffs_thermique, courant_candidat,
+                                         dt, p->TAMB, &T1, &T2);
+
+    /* Ir pour la simulation de la tension “système” (indépendant de l'Ir de l'algo) */
+    float Ir_sys = ctx->Ir;
+    float U_sys  = modele_tension_1RC_step(courant_candidat, SOC_sys, &Ir_sys, etat,
+                                           &m->OCV_charge, &m->OCV_decharge,
+                                           dt, p->R1, p->C1_RC, p->R0);
+
+    /* --- Mise à jour de l'état Ir de l'algorithme SOP --- */
+    /* On repart de Ir[i], comme en MATLAB, et on le fait évoluer avec le courant réellement appliqué */
+    (void) modele_tension_1RC_step(courant_candidat, SOC_sys, &ctx->Ir, etat,
+                                   &m->OCV_charge, &m->OCV_decharge,
+                                   dt, p->R1, p->C1_RC, p->R0);
+
+    /* Décalage de l'historique pour l'échantillon suivant */
+    ctx->SOC      = SOC_sys;
+    ctx->T1       = T1;
+    ctx->T2_prec  = temperature_actuelle;
+    ctx->T2       = T2;
+    ctx->U_prec2  = tension_prec;
+    ctx->U_prec   = ctx->U;
+    ctx->U        = U_sys;
+    ctx->courant_candidat = courant_candidat;
+
+    return courant_candidat;
+}
+
+float SOP_step(SOP_Context *ctx,
+               float courant,
+               float tension,
+               float temperature,
+               float SOH,
+               float SOC,
+               float *SOP_charge,
+               float *SOP_decharge)
+{
+    return pas_SOP(ctx, courant, tension, temperature, SOH, SOC,
+                   SOP_charge, SOP_decharge, NULL, NULL, -1);
+}
+
+float SOP_step_etat(SOP_Context *ctx,
+                    int   etat,
+                    float courant,
+                    float tension,
+                    float temperature,
+                    float SOH,
+                    float SOC,
+                    float *SOP_charge,
+                    float *SOP_decharge)
+{
+    return pas_SOP(ctx, courant, tension, temperature, SOH, SOC,
+                   SOP_charge, SOP_decharge, NULL, NULL, etat);
+}
+
+float SOP_step_horizons(SOP_Context *ctx,
+                        int   etat,
+                        float courant,
+                        float tension,
+                        float temperature,
+                        float SOH,
+                        float SOC,
+                        float *SOP_charge,
+                        float *SOP_decharge,
+                        SOP_Limite *limites)
+{
+    return pas_SOP(ctx, courant, tension, temperature, SOH, SOC,
+                   SOP_charge, SOP_decharge, limites, NULL, etat);
+}
+
+float SOP_step_deux_sens(SOP_Context *ctx,
+                         SOP_Deux_sens *d,
+                         int   etat,
+                         float courant,
+                         float tension,
+                         float temperature,
+                         float SOH,
+                         float SOC,
+                         float *SOP_charge,
+                         float *SOP_decharge,
+                         float *I_charge,
+                         float *I_decharge)
+{
+    float courant_candidat = pas_SOP(ctx, courant, tension, temperature, SOH, SOC,
+                                     SOP_charge, SOP_decharge, NULL, d, etat);
+    *I_charge   = d->courant[0];
+    *I_decharge = d->courant[1];
+    return courant_candidat;
+}
+
+/* Courant admissible d'un état isolé (tables hors ligne : SOP_table.h) */
+float SOP_courant_admissible(const SOP_Modele *m,
+                             float SOC, float SOH, float T1, float T2,
+                             float Ir, int etat, float consigne)
+{
+    const SOP_Parametres *p = &m->param;
+    float residus[3];
+    nb_evaluations = 0;
+    return recherche_racine_SOP_Pegase_1RC(
+        p->moins_eta_sur_Q, p->dt, p->horizon,
+        SOC, SOH, p->coeffs_thermique, T1, T2, p->TAMB,
+        p->SOC_min, p->SOC_max, p->U_min, p->U_max, p->T_max,
+        p->I_min, p->I_max,
+        consigne, Ir, etat,
+        &m->OCV_charge, &m->OCV_decharge,
+        p->R1, p->C1_RC, p->R0,
+        consigne, residus, &m->horizon, NULL);
+}
+
+/* ========================================================================== */
+/*  Rejeu d'une série : SOP_predictif (outil SOP)                             */
+/* ========================================================================== */
+int SOP_predictif(
+    const float *courant,
+    const float *tension,
+    const float *temperature,
+    const float *SOH,
+    const float *SOC,
+    size_t       N,
+    const SOP_Modele *modele,
+    float *SOP_charge,
+    float *SOP_decharge
+)
+{
+    if (N < 3) return 1;
+
+    /* Séries écrites en fin de rejeu (le calcul n'en garde rien) */
+    float *courant_candidat     = (float*)calloc(N, sizeof(float));
+    float *SOC_actuel           = (float*)calloc(N, sizeof(float));
+    float *temperature_actuelle = (float*)calloc(N, sizeof(float));
+    float *tension_actuelle     = (float*)calloc(N, sizeof(float));
+    int   *etat                 = (int*)  calloc(N, sizeof(int));
+    float *courant_predi        = (float*)calloc(N, sizeof(float));
+    int erreur = 0;
+
+    if (!courant_candidat || !SOC_actuel || !temperature_actuelle ||
+        !tension_actuelle || !etat || !courant_predi)
+    {
+        fprintf(stderr, "Erreur allocation mémoire dans SOP_predictif\n");
+        erreur = 1;
+        goto cleanup;
+    }
+
+    SOP_Context ctx;
+    SOP_init_modele(&ctx, modele);
+    SOP_demarrer(&ctx, SOC[0], temperature[0], tension[0]);
+
+    for (size_t i = 0; i < 3; ++i) {
+        SOC_actuel[i]           = SOC[0];
+        temperature_actuelle[i] = temperature[0];
+        tension_actuelle[i]     = tension[0];
+    }
+
+    /* Boucle principale i = 3 : L-1 => indices [2 .. N-2] en C */
+    for (size_t i = 2; i < N - 1; ++i)
+    {
+        courant_candidat[i] = SOP_step(&ctx, courant[i], tension[i], temperature[i],
+                                       SOH[i], SOC[i], &SOP_charge[i], &SOP_decharge[i]);
+        courant_predi[i] = ctx.courant_predictif;
+        if (traces_SOP) {
+            printf("courant_final=%f\n", ctx.courant_predictif);
+            printf("boucle=%zu\n", i);
+        }
+
+        etat[i]                     = ctx.etat;
+        etat[i + 1]                 = ctx.etat;
+        SOC_actuel[i + 1]           = ctx.SOC;
+        temperature_actuelle[i + 1] = ctx.T2;
+        tension_actuelle[i + 1]     = ctx.U;
+
+        if (traces_SOP) printf("La valeur est : %f\n", courant_candidat[i]);
+    }
+
+    Ecriture_result(courant_candidat, N, "courant_resultat_PC_result");
+    Ecriture_result(SOC_actuel, N, "SOP_PC_result");
+    Ecriture_result(tension_actuelle, N, "TENSION_PC_result");
+    Ecriture_result(temperature_actuelle, N, "TEMPERATURE_PC_result");
+    Ecriture_result_int(etat, N, "Etat_C");
+    Ecriture_result(courant_predi, N, "Courant_predi");
+
+cleanup:
+    free(courant_candidat);
+    free(SOC_actuel);
+    free(temperature_actuelle);
+    free(tension_actuelle);
+    free(etat);
+    free(courant_predi);
+    return erreur;
+}
+
+/* ========================================================================== */
+/*  Programme autonome pour générer SOP_xxx.bin (comme SOE_Theo, etc.)       */
+/* ========================================================================== */
+void setup_SOP(const SOP_Modele *modele)
+{
+    const float *courant = NULL;
+    const float *tension = NULL;
+    const float *temperature = NULL;
+    const float *SOH = NULL;
+    const float *SOC = NULL;
+
+    const int NbIteration = 10000;
+
+    float *SOP_charge   = (float*)calloc(NbIteration, sizeof(float));
+    float *SOP_decharge = (float*)calloc(NbIteration, sizeof(float));
+
+    if (!SOP_charge || !SOP_decharge) {
+        perror("malloc SOP");
+        free(SOP_charge);
+        free(SOP_decharge);
+        return;
+    }
+
+    /* Chargement des données brutes */
+    Charge_donnees(&courant, &tension, &temperature, &SOH, &SOC);
+
+    SOP_traces(1);
+    SOP_predictif(courant, tension, temperature, SOH, SOC, NbIteration,
+                  modele, SOP_charge, SOP_decharge);
 
     /* Écriture des résultats */
     //Ecriture_result(SOP_charge,   NbIteration, "SOP_CHARGE_PC_result");
@@ -1408,12 +2372,4 @@ const float Y_OCV_decharge_global[]= {
 
     free(SOP_charge);
     free(SOP_decharge);
-
-    //printf("Fin du SOP PC !\n");
 }
-
-int main(void) {
-    // Votre code
-    setup_SOP();
-    return 0;
-}
\ No newline at end of file
@@ -2,38 +2,22 @@
 #define SOP_H
 
 #include <stddef.h>
+#include <pthread.h>
+#include "Table_uniforme.h"
+#include "Detection_phase.h"
 
 /**
- * Calcule les SOP de charge et de décharge sur tout l’horizon de simulation.
+ * SOP prédictif : courant admissible sur un horizon (recherche de racine sur
+ * les modèles SOC, Foster d'ordre 2 et tension 1RC) puis correcteurs
+ * instantanés SOC / U / T.
  *
- * Entrées :
- *   courant, tension, temperature, SOH, SOC  : signaux d’entrée (taille N)
- *   N                                        : nombre d’échantillons
+ * Utilisation en temps réel : SOP_init puis SOP_step à chaque échantillon,
+ * qui rend SOP_charge / SOP_decharge (W). Paramètres et contraintes BMS :
+ * SOP_Parametres (SOP_parametres_defaut : valeurs du script).
  *
- *   moins_eta_sur_Q                          : 1/(rendement * Q) (même valeur que dans vos autres modules)
- *   coeffs_thermique[4]                      : {R1, C1, R2, C2} du modèle Foster d’ordre 2
- *   TAMB                                     : température ambiante
- *   T1_init, T2_init                         : conditions initiales du modèle thermique
- *
- *   X_OCV, Y_OCV_charge, Y_OCV_decharge      : tables OCV (mêmes que surveillance_tension)
- *   n_OCV                                    : taille des tables OCV
- *   R0, R1, C1_RC                            : paramètres du modèle tension 1RC
- *
- *   SOC_min, SOC_max, U_min, U_max, T_max    : contraintes BMS
- *   I_min, I_max                             : limites courant
- *
- * Sorties :
- *   SOP_charge[i]   : SOP de charge à l’instant i (W)
- *   SOP_decharge[i] : SOP de décharge à l’instant i (W)
+ * Simulation de l'horizon à courant constant (min/max de SOC, T1, T2, U) :
  */
 
- static void interp1rapide_der(const float *x,
-                              const float *y,
-                              int          n,
-                              float        x_req,
-                              float       *sortie,
-                              float       *der);
-
 void simuler_horizon_batterie(float moins_eta_sur_Q,
                               float dt,
                               int   horizon,
@@ -45,10 +29,8 @@ void simuler_horizon_batterie(float moins_eta_sur_Q,
                               float TAMB,
                               float Ir_init,
                               int   etat,
-                              const float *X_OCV_dep,
-                              const float *Y_OCV_dep_charge,
-                              const float *Y_OCV_dep_decharge,
-                              int   n_OCV,
+                              const Table_uniforme *OCV_charge,
+                              const Table_uniforme *OCV_decharge,
                               float R1,
                               float C1,
                               float R0,
@@ -59,99 +41,358 @@ void simuler_horizon_batterie(float moins_eta_sur_Q,
                               float U_minmax[2],
                               float *Ir_final);
 
-static float modele_SOC_CC_step(float moins_eta_sur_Q,
-                                float dt,
-                                float SOC_prev,
-                                float I,
-                                float SOH);
-
-static void modele_thermique_foster_ordre_2_step(const float parametre[4],
-                                                 float       I,
-                                                 float       dt,
-                                                 float       TAMB,
-                                                 float      *T1,   // in/out
-                                                 float      *T2);  // in/out
-
-static float modele_tension_1RC_step(float        I,
-                                     float        SOC,
-                                     float       *Ir,   // in/out
-                                     int          etat, // 1 = décharge, 0 = charge
-                                     const float *X_OCV_dep,
-                                     const float *Y_OCV_dep_charge,
-                                     const float *Y_OCV_dep_decharge,
-                                     int          n_OCV,
-                                     float        dt,
-                                     float        R1,
-                                     float        C1,
-                                     float        R0);
-    
-    
-    
-static float recherche_racine_SOP_Pegase_1RC(
-    float moins_eta_sur_Q,
-    float dt,
-    int   horizon,
-    float SOC_actuel,
-    float SOH_actuel,
-    const float *coefficients_modele_temperature, /* taille 4 */
-    float T1_init,
-    float temperature_actuelle,
-    float TAMB,
-    float SOC_min,
-    float SOC_max,
-    float U_min,
-    float U_max,
-    float T_max,
-    float I_min,
-    float I_max,
-    float consigne_courant,      /* courant(i) dans le script */
-    float Ir_init,
-    int   etat,
-    const float *X_OCV_dep,
-    const float *Y_OCV_dep_charge,
-    const float *Y_OCV_dep_decharge,
-    int   n_OCV,
-    float R1,
-    float C1,
-    float R0,
-    float courant_requete, 
-    float *residus        /* courant(i) dans le script */
-);
+/* -------------------------------------------------------------------------- */
+/*  Horizon à courant constant en forme fermée                               */
+/* -------------------------------------------------------------------------- */
+/* Même résultat que simuler_horizon_batterie (min/max de SOC, T1, T2, U sur  */
+/* l'horizon et Ir final) sans boucler sur l'horizon : voir SOP.c.           */
+
+#define SOP_OCV_NOEUDS_MAX 128
+
+typedef struct
+{
+    int   horizon;
+    float dt;
+    int   valide;          /* forme fermée applicable                         */
+    int   analytique;      /* forme fermée utilisée : valide et évaluateur
+                              SOP_HORIZON_ANALYTIQUE (sinon : pas à pas)      */
+
+    /* 1RC */
+    float R0, R1;
+    float alpha, beta;     /* Ir(k+1) = alpha*Ir(k) + beta*I                  */
+    float gain_Ir;         /* beta / (1 - alpha) : Ir limite = gain_Ir * I    */
+    float ln_alpha;
+    float alpha_fin;       /* alpha^horizon                                   */
+
+    /* Foster d'ordre 2 */
+    float R1_th;
+    float p, q;            /* 1 - dt/(R1 C1), 1 - dt/(R2 C2)                  */
+    float k_A;             /* (dt/(R2 C2)) / (p - q)                          */
+    float ln_p, ln_q;
+    float p_fin, q_fin;    /* p^(horizon-1), q^(horizon-1)                    */
+    float a1, a2;          /* dt/(R1 C1), dt/(R2 C2) (évaluation pas à pas)   */
+
+    /* OCV [0] charge, [1] décharge : noeuds de la table d'origine, pente du
+       morceau j entre les noeuds j-1 et j (0 hors de la table)              */
+    const Table_uniforme *OCV[2];
+    int   nb_noeuds;
+    float noeuds[SOP_OCV_NOEUDS_MAX];
+    float pente[2][SOP_OCV_NOEUDS_MAX + 1];
+    int   croissante[2];
+} Horizon_SOP;
+
+/* Précalculs pour un horizon, des paramètres et des tables OCV donnés
+   (X_OCV : abscisses d'origine des tables rééchantillonnées)
+   (0 = OK, 1 = forme fermée inapplicable : valide = analytique = 0) */
+int horizon_SOP_compiler(Horizon_SOP *h,
+                         float dt,
+                         int   horizon,
+                         const float parametre_therm[4],
+                         float R0,
+                         float R1,
+                         float C1,
+                         const float *X_OCV,
+                         int          n_OCV,
+                         const Table_uniforme *OCV_charge,
+                         const Table_uniforme *OCV_decharge);
+
+/* Évaluation en forme fermée (h->valide requis) */
+void simuler_horizon_analytique(const Horizon_SOP *h,
+                                float moins_eta_sur_Q,
+                                float SOC_init,
+                                float SOH,
+                                float T1_init,
+                                float T2_init,
+                                float TAMB,
+                                float Ir_init,
+                                int   etat,
+                                float I_candidat,
+                                float SOC_minmax[2],
+                                float T1_minmax[2],
+                                float T2_minmax[2],
+                                float U_minmax[2],
+                                float *Ir_final);
+
+/* Évaluateur utilisé par la recherche de racine (SOP_Parametres.evaluateur) */
+typedef enum
+{
+    SOP_HORIZON_PAS = 0,        /* simuler_horizon_batterie                 */
+    SOP_HORIZON_ANALYTIQUE      /* forme fermée (par défaut)                */
+} SOP_Horizon_mode;
+
+/* Démarrage à chaud de la recherche par sécante : racine de l'échantillon
+   précédent, point de départ d'un encadrement étroit à l'échantillon
+   suivant (même etat, même sens de courant). Repli sur l'encadrement
+   complet [0, I_max] ou [I_min, 0] si les signes des résidus aux bornes
+   montrent que la racine n'y est pas. */
+#define SOP_AMORCE_DEMI_LARGEUR 0.5f    /* A autour de la racine précédente  */
+#define SOP_AMORCE_TOLERANCE    1e-3f   /* A : arrêt des itérations à chaud   */
+
+typedef struct
+{
+    int    valide;         /* racine précédente utilisable                    */
+    int    etat;           /* etat (charge/décharge) de cette racine          */
+    int    cote;           /* 1 : consigne > 0                                */
+    float  courant;        /* racine précédente, avant saturation             */
+    size_t nb_replis;      /* encadrements étroits invalides                  */
+} SOP_Amorce;
+
+typedef enum
+{
+    SOP_AMORCE_FROIDE = 0,      /* encadrement complet à chaque échantillon */
+    SOP_AMORCE_CHAUDE           /* par défaut                               */
+} SOP_Amorce_mode;
+
+/* ========================================================================== */
+/*  Module SOP en flux : SOP_init + SOP_step                                  */
+/* ========================================================================== */
+
+#define SOP_HORIZONS_MAX 8         /* horizons des limites multi-horizons       */
+
+/* Paramètres du modèle et contraintes BMS */
+typedef struct
+{
+    float moins_eta_sur_Q;        /* 1/(rendement * Q)                          */
+    float coeffs_thermique[4];    /* {R1, C1, R2, C2} du Foster d'ordre 2       */
+    float TAMB;                   /* température ambiante                       */
+    float T1_init;                /* condition initiale de T1                   */
+
+    const float *X_OCV;           /* tables OCV (mêmes que surveillance_tension) */
+    const float *Y_OCV_charge;
+    const float *Y_OCV_decharge;
+    int          n_OCV;
+    float R0, R1, C1_RC;          /* modèle tension 1RC                         */
+
+    float SOC_min, SOC_max;
+    float U_min, U_max;
+    float T_max;
+    float I_min, I_max;
+
+    float dt;
+    int   horizon;                /* horizon de prédiction (pas)                */
+
+    int   nb_horizons;            /* limites multi-horizons (SOP_step_horizons) */
+    int   horizons[SOP_HORIZONS_MAX];   /* pas, croissants                      */
+
+    /* Résolution : SOP_HORIZON_PAS écarte la forme fermée partout.
+       nb_candidats = 0 -> sécante (recherche_racine_SOP_Pegase_1RC),
+       4 / 8 / 16 -> grille de candidats simulés ensemble pas à pas en voies
+       SIMD, quel que soit l'évaluateur */
+    SOP_Horizon_mode evaluateur;
+    int   nb_candidats;
+    SOP_Amorce_mode  amorce;      /* démarrage de la sécante, d'un pas au suivant */
+} SOP_Parametres;
+
+#define SOP_GRILLE_TOLERANCE  0.01f     /* largeur finale de l'encadrement (A) */
+#define SOP_GRILLE_PASSES_MAX 8
+
+/* Valeurs du script SOP (tables OCV, 1RC, Foster, limites ; horizons
+   2, 10, 30 et 60 s pour les limites multi-horizons ; forme fermée,
+   sécante démarrée à chaud) */
+void SOP_parametres_defaut(SOP_Parametres *p);
+
+/* Tables OCV à pas constant et horizon en forme fermée, compilés une fois.
+   Horizon_SOP pointe sur les tables du même SOP_Modele : pas de copie. */
+typedef struct
+{
+    SOP_Parametres param;
+    Table_uniforme OCV_charge;
+    Table_uniforme OCV_decharge;
+    Horizon_SOP    horizon;
+    Horizon_SOP    horizons[SOP_HORIZONS_MAX];  /* un par horizon de param.horizons */
+} SOP_Modele;
 
-void SOP_predictif(
+/* 0 = OK, 1 = tables ou réglages invalides ; forme fermée inapplicable ou
+   évaluateur pas à pas : horizon.analytique = 0 */
+int SOP_Modele_compiler(SOP_Modele *m, const SOP_Parametres *p);
+
+/* Modèle des paramètres par défaut, compilé au premier appel (SOP_init) */
+const SOP_Modele *SOP_modele_defaut(void);
+
+/* État d'un pas au suivant : seul l'historique lu par les correcteurs
+   instantanés (i-1, i-2) et par la recherche de racine est gardé.
+   Mémoire et latence par pas indépendantes de la durée de la série. */
+typedef struct
+{
+    const SOP_Modele *modele;
+
+    int   demarre;                /* état simulé initialisé                     */
+
+    /* Détection charge/décharge : détecteur propre, avancé seulement par
+       SOP_step et les variantes appelées avec etat < 0. La boucle principale
+       passe l'etat du détecteur commun : il y reste à Detection_init (copie
+       constante dans le point de reprise). */
+    Detection_Context detection;
+    int   etat;                   /* 0 charge, 1 décharge                       */
+
+    /* Système simulé */
+    float SOC;                    /* SOC(i)                                     */
+    float T1;
+    float T2, T2_prec;            /* température (i), (i-1)                     */
+    float U, U_prec, U_prec2;     /* tension (i), (i-1), (i-2)                  */
+    float Ir;                     /* Ir(i) de l'algorithme                      */
+    float courant_candidat;       /* courant candidat (i-1)                     */
+
+    float courant_predictif;      /* dernier courant de la recherche de racine  */
+    SOP_Amorce amorce;            /* racine précédente (démarrage à chaud)      */
+} SOP_Context;
+
+/* Paramètres par défaut */
+void SOP_init(SOP_Context *ctx);
+
+/* Modèle compilé par l'appelant (doit rester valide pendant l'utilisation) */
+void SOP_init_modele(SOP_Context *ctx, const SOP_Modele *m);
+
+/* État simulé initial (fait au premier SOP_step sinon, depuis ses mesures) */
+void SOP_demarrer(SOP_Context *ctx, float SOC, float temperature, float tension);
+
+/* Un pas : courant mesuré (convention des données : > 0 en décharge),
+   SOH ; tension, temperature et SOC ne servent qu'au démarrage.
+   Sorties : SOP de charge / décharge (W). Retour : courant candidat (A) */
+float SOP_step(SOP_Context *ctx,
+               float courant,
+               float tension,
+               float temperature,
+               float SOH,
+               float SOC,
+               float *SOP_charge,
+               float *SOP_decharge);
+
+/* SOP_step avec la phase déjà détectée (détecteur commun de la boucle,
+   Detection_step(-courant)) : même résultat que SOP_step.
+   etat : 0 charge, 1 décharge, < 0 : détecteur du contexte (comme SOP_step).
+   Même convention pour SOP_step_horizons et SOP_step_deux_sens. */
+float SOP_step_etat(SOP_Context *ctx,
+                    int   etat,
+                    float courant,
+                    float tension,
+                    float temperature,
+                    float SOH,
+                    float SOC,
+                    float *SOP_charge,
+                    float *SOP_decharge);
+
+/* Courant admissible exact d'un état isolé : recherche de racine à froid,
+   consigne = I_max (décharge) ou I_min (charge), sans correcteurs
+   instantanés. T1 / T2 : noeuds du modèle thermique. */
+float SOP_courant_admissible(const SOP_Modele *m,
+                             float SOC, float SOH, float T1, float T2,
+                             float Ir, int etat, float consigne);
+
+/* Recherche de racine de SOP_step sur un état isolé : solveur du modèle
+   (param.nb_candidats), démarrage à chaud depuis amorce (NULL : à froid) */
+float SOP_resoudre(const SOP_Modele *m,
+                   float SOC, float SOH, float T1, float T2,
+                   float Ir, int etat, float consigne, SOP_Amorce *amorce);
+
+/* Coût de la dernière recherche du thread appelant : simulations d'horizon
+   (sécante), passes de la grille, ou évaluations tous horizons confondus
+   (SOP_courants_horizons) */
+int SOP_evaluations(void);
+
+/* Limites d'un horizon : SOP (W) = courant admissible * tension (i-1),
+   comme SOP_charge / SOP_decharge de SOP_step */
+typedef struct
+{
+    int   horizon;                /* pas                                        */
+    float SOP_charge;
+    float SOP_decharge;
+} SOP_Limite;
+
+/* SOP_step, plus les limites prédictives de charge et de décharge pour
+   chaque horizon de param.horizons, sur le même état que la recherche de
+   racine. Les horizons partagent une seule recherche : chaque courant évalué
+   donne les résidus de tous les horizons (SOP.c).
+   limites[param.nb_horizons]. Retour : courant candidat (A) */
+float SOP_step_horizons(SOP_Context *ctx,
+                        int   etat,
+                        float courant,
+                        float tension,
+                        float temperature,
+                        float SOH,
+                        float SOC,
+                        float *SOP_charge,
+                        float *SOP_decharge,
+                        SOP_Limite *limites);
+
+/* Courants admissibles (A) d'un sens pour chaque horizon de param.horizons,
+   sur un état isolé : borne = I_min (charge) ou I_max (décharge).
+   I[param.nb_horizons] */
+void SOP_courants_horizons(const SOP_Modele *m,
+                           float SOC, float SOH, float T1, float T2,
+                           float Ir, int etat, float borne, float *I);
+
+/* Limites prédictives des deux sens à chaque pas : courant admissible de
+   charge (consigne I_min) et de décharge (consigne I_max), sur l'état de la
+   recherche de racine, par le solveur du modèle (sécante ou grille). La
+   limite du sens de la consigne tient lieu de recherche principale (la
+   consigne est appliquée ensuite, comme pour SOP_step) : deux recherches
+   par pas au lieu de trois. Les deux sont indépendantes :
+   - SOP_DEUX_SENS_SEQUENTIEL : l'une après l'autre ;
+   - SOP_DEUX_SENS_THREADS : thread de travail persistant (créé par
+     SOP_deux_sens_ouvrir, deux barrières par pas) pour la charge, pendant
+     que l'appelant fait la décharge. Gain seulement avec un second coeur
+     libre : à mesurer sur la cible (bench_sop sens) avant de l'activer.
+   Démarrage à chaud de chaque sens selon param.amorce (amorce[] ; celle du
+   contexte n'est pas utilisée). */
+typedef enum
+{
+    SOP_DEUX_SENS_SEQUENTIEL = 0,
+    SOP_DEUX_SENS_THREADS
+} SOP_Deux_sens_mode;
+
+typedef struct
+{
+    const SOP_Modele  *modele;
+    SOP_Deux_sens_mode mode;
+    int                arret;
+    pthread_t          thread;
+    pthread_barrier_t  depart, arrivee;
+
+    /* État du pas en cours (écrit par l'appelant avant depart) */
+    float SOC, SOH, T1, T2, Ir;
+    int   etat;
+
+    SOP_Amorce amorce[2];         /* charge, décharge                           */
+    float      courant[2];        /* limites (A) : charge <= 0, décharge >= 0   */
+} SOP_Deux_sens;
+
+/* 0 = OK, 1 = erreur (barrières ou thread non créés : mode séquentiel,
+   toujours utilisable) */
+int  SOP_deux_sens_ouvrir(SOP_Deux_sens *d, const SOP_Modele *m, SOP_Deux_sens_mode mode);
+void SOP_deux_sens_fermer(SOP_Deux_sens *d);
+
+/* SOP_step, plus les courants admissibles de charge et de décharge (A) */
+float SOP_step_deux_sens(SOP_Context *ctx,
+                         SOP_Deux_sens *d,
+                         int   etat,
+                         float courant,
+                         float tension,
+                         float temperature,
+                         float SOH,
+                         float SOC,
+                         float *SOP_charge,
+                         float *SOP_decharge,
+                         float *I_charge,
+                         float *I_decharge);
+
+/* Traces par échantillon (racine, itérations) sur la sortie standard */
+void SOP_traces(int actif);
+
+/* Rejeu de N échantillons avec SOP_step (outil SOP) : SOP_charge[i],
+   SOP_decharge[i] et les fichiers *_PC_result.bin. 0 = OK, 1 = erreur */
+int SOP_predictif(
     const float *courant,
     const float *tension,
     const float *temperature,
     const float *SOH,
     const float *SOC,
     size_t       N,
-
-    float moins_eta_sur_Q,
-    const float coeffs_thermique[4],
-    float TAMB,
-    float T1_init,
-    float T2_init,
-
-    const float *X_OCV,
-    const float *Y_OCV_charge,
-    const float *Y_OCV_decharge,
-    int          n_OCV,
-    float R0,
-    float R1,
-    float C1_RC,
-
-    float SOC_min,
-    float SOC_max,
-    float U_min,
-    float U_max,
-    float T_max,
-    float I_min,
-    float I_max,
-
+    const SOP_Modele *modele,
     float *SOP_charge,
     float *SOP_decharge
 );
 
-void setup_SOP(void);
+void setup_SOP(const SOP_Modele *modele);
 
 #endif /* SOP_H */
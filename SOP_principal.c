@@ -0,0 +1,317 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "Read_Write.h"
+#include "SOP.h"
+
+// ============================================================================
+// Outil SOP : rejeu de ../donnees par SOP_step (setup_SOP), fichiers
+// *_PC_result.bin dans le répertoire courant
+//
+// Comparaisons (bilans sur la sortie standard ; les fichiers viennent
+// toujours de la configuration de référence) :
+//   verification : forme fermée contre pas à pas
+//   comparaisonN : grille de N candidats contre sécante
+//   froid | chaud | comparaison : évaluations d'horizon par échantillon de
+//     la sécante à froid, à chaud, ou les deux
+// Les solveurs comparés repartent des états de la recherche de racine du
+// rejeu de référence (SOC, T1, T2, Ir, etat avant chaque SOP_step).
+// ============================================================================
+
+#define SOP_ECHANTILLONS    10000   /* comme setup_SOP */
+#define SOP_EVALUATIONS_MAX 32      /* classes de l'histogramme */
+
+/* État d'une recherche de racine du rejeu */
+typedef struct
+{
+    float SOC, SOH, T1, T2, Ir;
+    int   etat;
+    float consigne;                 /* -courant */
+    float racine;                   /* courant de la recherche de SOP_step */
+} Etat_SOP;
+
+/* Rejeu de N échantillons ; rend le nombre d'états relevés */
+static size_t relever_etats(const SOP_Modele *m, const float *courant, const float *tension,
+                            const float *temperature, const float *SOH, const float *SOC,
+                            size_t N, Etat_SOP *e)
+{
+    SOP_Context ctx;
+    Detection_Context detection;
+    SOP_init_modele(&ctx, m);
+    SOP_demarrer(&ctx, SOC[0], temperature[0], tension[0]);
+    Detection_init(&detection);
+
+    size_t n = 0;
+    for (size_t i = 2; i < N - 1; ++i) {
+        Etat_SOP *s = &e[n++];
+        s->etat     = Detection_step(&detection, -courant[i]);
+        s->SOC      = ctx.SOC;
+        s->SOH      = SOH[i];
+        s->T1       = ctx.T1;
+        s->T2       = ctx.T2;
+        s->Ir       = ctx.Ir;
+        s->consigne = -courant[i];
+
+        float charge, decharge;
+        SOP_step_etat(&ctx, s->etat, courant[i], tension[i], temperature[i], SOH[i], SOC[i],
+                      &charge, &decharge);
+        s->racine = ctx.courant_predictif;
+    }
+    return n;
+}
+
+static void ecart_max(float *ecart, const float a[2], const float b[2])
+{
+    for (int k = 0; k < 2; ++k) {
+        float e = fabsf(a[k] - b[k]);
+        if (!(e <= *ecart)) *ecart = e;
+    }
+}
+
+/* ---- verification : forme fermée / pas à pas ---- */
+
+/* Les deux évaluateurs sur chaque état, aux courants I_min, I_max et à la
+   racine trouvée (m : forme fermée valide) */
+static void verifier_horizon(const SOP_Modele *m, const Etat_SOP *e, size_t n)
+{
+    const SOP_Parametres *p = &m->param;
+    const Horizon_SOP *h = &m->horizon;
+    if (!h->valide) {
+        printf("Verification horizon SOP : forme fermee inapplicable\n");
+        return;
+    }
+
+    float ecart_SOC = 0.0f, ecart_T1 = 0.0f, ecart_T2 = 0.0f, ecart_U = 0.0f, ecart_Ir = 0.0f;
+    float SOC_p[2], T1_p[2], T2_p[2], U_p[2], Ir_p;
+    float SOC_a[2], T1_a[2], T2_a[2], U_a[2], Ir_a;
+    double t_pas = 0.0, t_ana = 0.0;
+    volatile float puits = 0.0f;
+
+    for (size_t i = 0; i < n; ++i) {
+        const Etat_SOP *s = &e[i];
+        const float courants[3] = { p->I_min, p->I_max, s->racine };
+        for (int c = 0; c < 3; ++c) {
+            double t0 = Horloge_secondes();
+            simuler_horizon_batterie(p->moins_eta_sur_Q, p->dt, p->horizon, s->SOC, s->SOH,
+                                     p->coeffs_thermique, s->T1, s->T2, p->TAMB, s->Ir, s->etat,
+                                     &m->OCV_charge, &m->OCV_decharge,
+                                     p->R1, p->C1_RC, p->R0, courants[c],
+                                     SOC_p, T1_p, T2_p, U_p, &Ir_p);
+            double t1 = Horloge_secondes();
+            simuler_horizon_analytique(h, p->moins_eta_sur_Q, s->SOC, s->SOH,
+                                       s->T1, s->T2, p->TAMB, s->Ir, s->etat, courants[c],
+                                       SOC_a, T1_a, T2_a, U_a, &Ir_a);
+            t_ana += Horloge_secondes() - t1;
+            t_pas += t1 - t0;
+            puits += U_p[0] + U_a[0];
+
+            ecart_max(&ecart_SOC, SOC_p, SOC_a);
+            ecart_max(&ecart_T1,  T1_p,  T1_a);
+            ecart_max(&ecart_T2,  T2_p,  T2_a);
+            ecart_max(&ecart_U,   U_p,   U_a);
+            float d = fabsf(Ir_p - Ir_a);
+            if (!(d <= ecart_Ir)) ecart_Ir = d;
+        }
+    }
+
+    double nb = 3.0 * (double)n;
+    printf("\nVerification horizon SOP (forme fermee / pas a pas), %zu appels\n", 3 * n);
+    printf("  Ecart max SOC : %.3e\n", ecart_SOC);
+    printf("  Ecart max T1  : %.3e degC\n", ecart_T1);
+    printf("  Ecart max T2  : %.3e degC\n", ecart_T2);
+    printf("  Ecart max U   : %.3e V\n", ecart_U);
+    printf("  Ecart max Ir  : %.3e A\n", ecart_Ir);
+    printf("  Temps par horizon de %d pas : pas a pas %.1f ns | forme fermee %.1f ns (x%.1f)\n",
+           h->horizon, 1e9 * t_pas / nb, 1e9 * t_ana / nb, t_pas / t_ana);
+    (void)puits;
+}
+
+/* ---- comparaisonN : grille / sécante ---- */
+
+static void comparer_grille(const SOP_Modele *m_grille, const SOP_Modele *m_secante,
+                            const Etat_SOP *e, size_t n)
+{
+    double t_secante = 0.0, t_grille = 0.0, ecart_somme = 0.0;
+    float  ecart = 0.0f;
+    size_t nb_au_dessus = 0;
+    size_t passes[SOP_GRILLE_PASSES_MAX + 1] = { 0 };
+
+    for (size_t i = 0; i < n; ++i) {
+        const Etat_SOP *s = &e[i];
+        double t0 = Horloge_secondes();
+        float I_grille = SOP_resoudre(m_grille, s->SOC, s->SOH, s->T1, s->T2, s->Ir,
+                                      s->etat, s->consigne, NULL);
+        int nb_passes = SOP_evaluations();
+        double t1 = Horloge_secondes();
+        float I = SOP_resoudre(m_secante, s->SOC, s->SOH, s->T1, s->T2, s->Ir,
+                               s->etat, s->consigne, NULL);
+        t_secante += Horloge_secondes() - t1;
+        t_grille  += t1 - t0;
+
+        ++passes[nb_passes < SOP_GRILLE_PASSES_MAX ? nb_passes : SOP_GRILLE_PASSES_MAX];
+        float d = fabsf(I_grille - I);
+        ecart_somme += d;
+        if (!(d <= ecart)) ecart = d;
+        if (fabsf(I_grille) > fabsf(I) + SOP_GRILLE_TOLERANCE) ++nb_au_dessus;
+    }
+
+    double nb = (double)n;
+    printf("\nSolveur SOP : grille de %d candidats / secante, %zu echantillons\n",
+           m_grille->param.nb_candidats, n);
+    printf("  Latence par echantillon : secante %.2f us | grille %.2f us (x%.2f)\n",
+           1e6 * t_secante / nb, 1e6 * t_grille / nb, t_secante / t_grille);
+    printf("  Ecart de courant : moyen %.3e A | max %.3e A\n", ecart_somme / nb, ecart);
+    printf("  Grille au-dessus de la secante (> %.2f A) : %zu\n",
+           (double)SOP_GRILLE_TOLERANCE, nb_au_dessus);
+    printf("  Passes de la grille :");
+    for (int k = 1; k <= SOP_GRILLE_PASSES_MAX; ++k)
+        if (passes[k]) printf(" %d:%zu", k, passes[k]);
+    printf("\n");
+}
+
+/* ---- froid | chaud | comparaison : démarrage de la sécante ---- */
+
+static void afficher_histogramme(const char *nom, const size_t h[], double t, size_t n)
+{
+    size_t total = 0;
+    for (int k = 0; k <= SOP_EVALUATIONS_MAX; ++k) total += (size_t)k * h[k];
+    printf("  %-6s : %.2f evaluations/echantillon, %.2f us |", nom,
+           (double)total / (double)n, 1e6 * t / (double)n);
+    for (int k = 0; k <= SOP_EVALUATIONS_MAX; ++k)
+        if (h[k]) printf(" %d%s:%zu", k, k == SOP_EVALUATIONS_MAX ? "+" : "", h[k]);
+    printf("\n");
+}
+
+/* froid, chaud : démarrages chronométrés */
+static void comparer_amorce(const SOP_Modele *m, const Etat_SOP *e, size_t n,
+                            int froid, int chaud)
+{
+    static size_t h_froid[SOP_EVALUATIONS_MAX + 1], h_chaud[SOP_EVALUATIONS_MAX + 1];
+    double t_froid = 0.0, t_chaud = 0.0, ecart_somme = 0.0;
+    float  ecart = 0.0f;
+    SOP_Amorce amorce;
+    memset(&amorce, 0, sizeof(amorce));
+
+    for (size_t i = 0; i < n; ++i) {
+        const Etat_SOP *s = &e[i];
+        float I_froid = 0.0f, I_chaud = 0.0f;
+        int k;
+        if (froid) {
+            double t0 = Horloge_secondes();
+            I_froid = SOP_resoudre(m, s->SOC, s->SOH, s->T1, s->T2, s->Ir, s->etat,
+                                   s->consigne, NULL);
+            t_froid += Horloge_secondes() - t0;
+            k = SOP_evaluations();
+            ++h_froid[k < SOP_EVALUATIONS_MAX ? k : SOP_EVALUATIONS_MAX];
+        }
+        if (chaud) {
+            double t0 = Horloge_secondes();
+            I_chaud = SOP_resoudre(m, s->SOC, s->SOH, s->T1, s->T2, s->Ir, s->etat,
+                                   s->consigne, &amorce);
+            t_chaud += Horloge_secondes() - t0;
+            k = SOP_evaluations();
+            ++h_chaud[k < SOP_EVALUATIONS_MAX ? k : SOP_EVALUATIONS_MAX];
+        }
+        if (froid && chaud) {
+            float d = fabsf(I_chaud - I_froid);
+            ecart_somme += d;
+            if (!(d <= ecart)) ecart = d;
+        }
+    }
+
+    printf("\nSecante SOP, evaluations d'horizon par echantillon (%zu echantillons)\n", n);
+    if (froid) afficher_histogramme("froid", h_froid, t_froid, n);
+    if (chaud) {
+        afficher_histogramme("chaud", h_chaud, t_chaud, n);
+        printf("  Replis sur l'encadrement complet : %zu\n", amorce.nb_replis);
+    }
+    if (froid && chaud)
+        printf("  Ecart chaud / froid : moyen %.3e A | max %.3e A\n",
+               ecart_somme / (double)n, ecart);
+}
+
+/* Usage : SOP [pas | analytique | verification] [secante | grilleN | comparaisonN]
+             [froid | chaud | comparaison]
+   (évaluateur d'horizon, solveur : N = 4, 8 ou 16 candidats, puis
+   démarrage de la sécante) */
+int main(int argc, char **argv) {
+    SOP_Parametres p;
+    SOP_parametres_defaut(&p);
+    int verifier = 0, grille = 0, comparer = 0, amorce = -1;   /* 0 froid, 1 chaud, 2 les deux */
+
+    if (argc > 2) {
+        int n = -1;
+        if      (strcmp(argv[2], "secante") == 0) n = 0;
+        else if (sscanf(argv[2], "grille%d", &n) == 1)      comparer = 0;
+        else if (sscanf(argv[2], "comparaison%d", &n) == 1) comparer = 1;
+        if (n != 0 && n != 4 && n != 8 && n != 16) {
+            printf("Usage : SOP [pas | analytique | verification] [secante | grilleN | comparaisonN], N = 4, 8, 16\n");
+            return 1;
+        }
+        grille = n;
+        comparer = comparer && n != 0;
+    }
+    if (argc > 3) {
+        if      (strcmp(argv[3], "froid") == 0)       amorce = 0;
+        else if (strcmp(argv[3], "chaud") == 0)       amorce = 1;
+        else if (strcmp(argv[3], "comparaison") == 0) amorce = 2;
+        else {
+            printf("Usage : SOP [pas | analytique | verification] [secante | grilleN | comparaisonN] [froid | chaud | comparaison]\n");
+            return 1;
+        }
+    }
+    if (argc > 1) {
+        if      (strcmp(argv[1], "pas") == 0)          p.evaluateur = SOP_HORIZON_PAS;
+        else if (strcmp(argv[1], "analytique") == 0)   p.evaluateur = SOP_HORIZON_ANALYTIQUE;
+        else if (strcmp(argv[1], "verification") == 0) { p.evaluateur = SOP_HORIZON_PAS; verifier = 1; }
+        else {
+            printf("Usage : SOP [pas | analytique | verification] [secante | grilleN | comparaisonN]\n");
+            return 1;
+        }
+    }
+
+    /* Configuration de référence : sécante si comparaison, à froid si
+       demandé ou comparé au démarrage à chaud */
+    static SOP_Modele modele, modele_grille, modele_analytique;
+    p.nb_candidats = comparer ? 0 : grille;
+    if (amorce == 0 || amorce == 2) p.amorce = SOP_AMORCE_FROIDE;
+    if (SOP_Modele_compiler(&modele, &p) != 0) return 1;
+    setup_SOP(&modele);
+
+    if (!verifier && !comparer && amorce < 0) return 0;
+
+    /* Comparaisons sur les états du rejeu de référence */
+    const float *courant, *tension, *temperature, *SOH, *SOC;
+    Charge_donnees(&courant, &tension, &temperature, &SOH, &SOC);
+    size_t N = Nb_echantillons_donnees();
+    if (N > SOP_ECHANTILLONS) N = SOP_ECHANTILLONS;
+    Etat_SOP *etats = (N >= 4) ? (Etat_SOP *)malloc(N * sizeof(Etat_SOP)) : NULL;
+    if (!courant || !etats) {
+        printf("Erreur chargement des donnees\n");
+        free(etats);
+        Free_donnees(courant, tension, temperature, SOH, SOC);
+        return 1;
+    }
+    size_t n = relever_etats(&modele, courant, tension, temperature, SOH, SOC, N, etats);
+
+    int erreur = 0;
+    if (verifier) {
+        SOP_Parametres q = p;
+        q.evaluateur = SOP_HORIZON_ANALYTIQUE;
+        erreur |= SOP_Modele_compiler(&modele_analytique, &q);
+        if (!erreur) verifier_horizon(&modele_analytique, etats, n);
+    }
+    if (comparer) {
+        SOP_Parametres q = p;
+        q.nb_candidats = grille;
+        erreur |= SOP_Modele_compiler(&modele_grille, &q);
+        if (!erreur) comparer_grille(&modele_grille, &modele, etats, n);
+    }
+    if (amorce >= 0)
+        comparer_amorce(&modele, etats, n, amorce != 1, amorce != 0);
+
+    free(etats);
+    Free_donnees(courant, tension, temperature, SOH, SOC);
+    return erreur;
+}
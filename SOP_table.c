@@ -0,0 +1,273 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SOP_table.h"
+#include "Read_Write.h"
+
+// ============================================================================
+// Helpers internes
+// ============================================================================
+
+static uint64_t aligne(uint64_t position)
+{
+    return (position + SOP_TABLE_ALIGNEMENT - 1) / SOP_TABLE_ALIGNEMENT * SOP_TABLE_ALIGNEMENT;
+}
+
+static int axes_valides(const SOP_Axe axes[SOP_TABLE_NB_AXES])
+{
+    for (int d = 0; d < SOP_TABLE_NB_AXES; ++d)
+        if (axes[d].n < 2 || axes[d].n > SOP_TABLE_NOEUDS_MAX || !(axes[d].max > axes[d].min))
+            return 0;
+    return 1;
+}
+
+// Pas d'indexation, nombres de noeuds et de mailles
+static void indexer(SOP_Table *t)
+{
+    size_t noeuds = 1, mailles = 1;
+    for (int d = 0; d < SOP_TABLE_NB_AXES; ++d) {
+        const SOP_Axe *axe = &t->entete.axes[d];
+        t->inv_pas[d]    = (float)(axe->n - 1) / (axe->max - axe->min);
+        t->pas_noeud[d]  = noeuds;
+        t->pas_maille[d] = mailles;
+        noeuds  *= axe->n;
+        mailles *= axe->n - 1;
+    }
+    t->nb_noeuds  = noeuds;
+    t->nb_mailles = mailles;
+}
+
+static float abscisse(const SOP_Axe *axe, float u)
+{
+    return axe->min + u * (axe->max - axe->min) / (float)(axe->n - 1);
+}
+
+// Points de mesure des marges communs à toutes les mailles : sous-grille de
+// 3 points par axe (coins, milieux des arêtes et des faces, centre), à
+// T1 - T2 = 0, dT1_min et dT1_max
+#define SOP_TABLE_SOUS_GRILLE  81       // 3^SOP_TABLE_NB_AXES
+#define SOP_TABLE_POINTS_FIXES (3 * SOP_TABLE_SOUS_GRILLE)
+
+// Générateur déterministe des points tirés dans les mailles
+static float aleatoire(uint32_t *graine)
+{
+    *graine = *graine * 1664525u + 1013904223u;
+    return (float)(*graine >> 8) * (1.0f / 16777216.0f);
+}
+
+// ============================================================================
+// Construction
+// ============================================================================
+
+int SOP_Table_construire(SOP_Table *t, const SOP_Modele *m,
+                         const SOP_Axe axes[SOP_TABLE_NB_AXES],
+                         int points_par_maille, float dT1_min, float dT1_max)
+{
+    if (!t || !m || !axes_valides(axes) || points_par_maille < 0) {
+        printf("SOP_table : grille invalide\n");
+        return 1;
+    }
+    if (!(dT1_min <= 0.0f && dT1_max >= 0.0f)) {
+        printf("SOP_table : T1 - T2 [%g, %g] doit contenir 0\n", (double)dT1_min, (double)dT1_max);
+        return 1;
+    }
+
+    memset(t, 0, sizeof(*t));
+    memcpy(t->entete.magique, SOP_TABLE_MAGIQUE, 4);
+    t->entete.version = SOP_TABLE_VERSION;
+    memcpy(t->entete.axes, axes, sizeof(t->entete.axes));
+    t->entete.points_par_maille = (uint32_t)points_par_maille;
+    t->entete.horizon = (uint32_t)m->param.horizon;
+    t->entete.I_min   = m->param.I_min;
+    t->entete.I_max   = m->param.I_max;
+    t->entete.dT1_min = dT1_min;
+    t->entete.dT1_max = dT1_max;
+    indexer(t);
+
+    t->stockage = (float *)malloc(SOP_TABLE_NB_BLOCS * (t->nb_noeuds + t->nb_mailles) * sizeof(float));
+    if (!t->stockage) {
+        perror("Erreur allocation table SOP");
+        return 1;
+    }
+    float *courant[SOP_TABLE_NB_BLOCS], *marge[SOP_TABLE_NB_BLOCS];
+    for (int b = 0; b < SOP_TABLE_NB_BLOCS; ++b) {
+        courant[b] = t->stockage + (size_t)b * t->nb_noeuds;
+        marge[b]   = t->stockage + SOP_TABLE_NB_BLOCS * t->nb_noeuds + (size_t)b * t->nb_mailles;
+        t->courant[b] = courant[b];
+        t->marge[b]   = marge[b];
+    }
+
+    // 1) Courant exact aux noeuds (T1 = T2)
+    for (size_t k = 0; k < t->nb_noeuds; ++k) {
+        float x[SOP_TABLE_NB_AXES];
+        for (int d = 0; d < SOP_TABLE_NB_AXES; ++d)
+            x[d] = abscisse(&axes[d], (float)((k / t->pas_noeud[d]) % axes[d].n));
+
+        for (int b = 0; b < SOP_TABLE_NB_BLOCS; ++b) {
+            int etat = b / SOP_TABLE_NB_SENS;
+            float consigne = (b % SOP_TABLE_NB_SENS == SOP_SENS_DECHARGE) ? m->param.I_max
+                                                                          : m->param.I_min;
+            courant[b][k] = SOP_courant_admissible(m, x[SOP_AXE_SOC], x[SOP_AXE_SOH],
+                                                   x[SOP_AXE_T], x[SOP_AXE_T],
+                                                   x[SOP_AXE_IR], etat, consigne);
+        }
+    }
+
+    // 2) Marges : dépassement de l'interpolation sur le courant exact sur la
+    //    sous-grille de chaque maille (aux coins, l'interpolation vaut le
+    //    noeud, calculé à T1 = T2 : seul l'écart de T1 y compte) et en
+    //    points_par_maille points tirés (maille et T1 - T2)
+    uint32_t graine = 12345u;
+    for (size_t c = 0; c < t->nb_mailles; ++c) {
+        float coin[SOP_TABLE_NB_AXES];
+        for (int d = 0; d < SOP_TABLE_NB_AXES; ++d)
+            coin[d] = (float)((c / t->pas_maille[d]) % (axes[d].n - 1));
+
+        for (int b = 0; b < SOP_TABLE_NB_BLOCS; ++b) marge[b][c] = 0.0f;
+
+        for (int p = 0; p < SOP_TABLE_POINTS_FIXES + points_par_maille; ++p) {
+            float x[SOP_TABLE_NB_AXES], dT1;
+            if (p < SOP_TABLE_POINTS_FIXES) {                   // sous-grille
+                int q = p / 3;
+                for (int d = 0; d < SOP_TABLE_NB_AXES; ++d, q /= 3)
+                    x[d] = abscisse(&axes[d], coin[d] + 0.5f * (float)(q % 3));
+                dT1 = (p % 3 == 0) ? 0.0f : (p % 3 == 1) ? dT1_min : dT1_max;
+            } else {                                            // tirés
+                for (int d = 0; d < SOP_TABLE_NB_AXES; ++d)
+                    x[d] = abscisse(&axes[d], coin[d] + aleatoire(&graine));
+                dT1 = dT1_min + aleatoire(&graine) * (dT1_max - dT1_min);
+            }
+
+            for (int b = 0; b < SOP_TABLE_NB_BLOCS; ++b) {
+                int   etat = b / SOP_TABLE_NB_SENS;
+                int   sens = b % SOP_TABLE_NB_SENS;
+                float s    = (sens == SOP_SENS_DECHARGE) ? 1.0f : -1.0f;
+                float exact = SOP_courant_admissible(m, x[SOP_AXE_SOC], x[SOP_AXE_SOH],
+                                                     x[SOP_AXE_T] + dT1, x[SOP_AXE_T], x[SOP_AXE_IR],
+                                                     etat, s > 0.0f ? m->param.I_max : m->param.I_min);
+                float I = SOP_Table_eval(t, etat, sens, x[SOP_AXE_SOC], x[SOP_AXE_T],
+                                         x[SOP_AXE_IR], x[SOP_AXE_SOH]);
+                float depassement = s * (I - exact);
+                if (depassement > marge[b][c]) marge[b][c] = depassement;
+            }
+        }
+        for (int b = 0; b < SOP_TABLE_NB_BLOCS; ++b) marge[b][c] += SOP_TABLE_MARGE_SECURITE;
+    }
+    return 0;
+}
+
+// ============================================================================
+// Écriture
+// ============================================================================
+
+int SOP_Table_ecrire(const SOP_Table *t, const char *chemin)
+{
+    SOP_Table_entete e = t->entete;
+    uint64_t position = aligne(sizeof(SOP_Table_entete));
+    for (int b = 0; b < SOP_TABLE_NB_BLOCS; ++b) {
+        e.offset_courant[b] = position;
+        position = aligne(position + t->nb_noeuds * sizeof(float));
+    }
+    for (int b = 0; b < SOP_TABLE_NB_BLOCS; ++b) {
+        e.offset_marge[b] = position;
+        position = aligne(position + t->nb_mailles * sizeof(float));
+    }
+
+    FILE *f = fopen(chemin, "wb");
+    if (!f) {
+        perror("Erreur ouverture fichier");
+        return 1;
+    }
+
+    static const uint8_t zeros[SOP_TABLE_ALIGNEMENT] = {0};
+    int ok = (fwrite(&e, 1, sizeof(e), f) == sizeof(e));
+    position = sizeof(e);
+
+    for (int k = 0; k < 2 * SOP_TABLE_NB_BLOCS && ok; ++k) {
+        int          b      = k % SOP_TABLE_NB_BLOCS;
+        uint64_t     offset = (k < SOP_TABLE_NB_BLOCS) ? e.offset_courant[b] : e.offset_marge[b];
+        const float *bloc   = (k < SOP_TABLE_NB_BLOCS) ? t->courant[b] : t->marge[b];
+        size_t       n      = (k < SOP_TABLE_NB_BLOCS) ? t->nb_noeuds : t->nb_mailles;
+
+        // bourrage jusqu'au début du bloc
+        size_t bourrage = (size_t)(offset - position);
+        ok = (fwrite(zeros, 1, bourrage, f) == bourrage) &&
+             (fwrite(bloc, sizeof(float), n, f) == n);
+        position = offset + n * sizeof(float);
+    }
+
+    if (fclose(f) != 0) ok = 0;
+    if (!ok) {
+        printf("Erreur ecriture %s\n", chemin);
+        return 1;
+    }
+    return 0;
+}
+
+// ============================================================================
+// Lecture
+// ============================================================================
+
+int SOP_Table_ouvrir(SOP_Table *t, const char *chemin)
+{
+    if (!t) return 1;
+    memset(t, 0, sizeof(*t));
+
+    size_t taille = 0;
+    const uint8_t *base = (const uint8_t *)Mappe_fichier(chemin, &taille);
+    if (!base) return 1;
+
+    const SOP_Table_entete *e = (const SOP_Table_entete *)base;
+    int erreur = 0;
+
+    if (taille < sizeof(SOP_Table_entete) || memcmp(e->magique, SOP_TABLE_MAGIQUE, 4) != 0) {
+        printf("Erreur : %s n'est pas une table SOP PRTS\n", chemin);
+        erreur = 1;
+    } else if (e->version != SOP_TABLE_VERSION) {
+        printf("Erreur : %s version %u non supportee (attendu %d)\n",
+               chemin, e->version, SOP_TABLE_VERSION);
+        erreur = 1;
+    } else if (!axes_valides(e->axes) || !(e->dT1_min <= 0.0f && e->dT1_max >= 0.0f)) {
+        printf("Erreur : %s en-tete invalide\n", chemin);
+        erreur = 1;
+    }
+
+    if (!erreur) {
+        t->entete = *e;
+        indexer(t);
+    }
+
+    // Chaque bloc doit être aligné et entièrement dans le fichier
+    for (int k = 0; k < 2 * SOP_TABLE_NB_BLOCS && !erreur; ++k) {
+        int      b      = k % SOP_TABLE_NB_BLOCS;
+        uint64_t offset = (k < SOP_TABLE_NB_BLOCS) ? e->offset_courant[b] : e->offset_marge[b];
+        uint64_t octets = ((k < SOP_TABLE_NB_BLOCS) ? t->nb_noeuds : t->nb_mailles) * sizeof(float);
+        if (offset % SOP_TABLE_ALIGNEMENT != 0 || offset < sizeof(SOP_Table_entete) ||
+            offset > taille || octets > taille - offset) {
+            printf("Erreur : %s bloc %d invalide\n", chemin, k);
+            erreur = 1;
+        }
+    }
+
+    if (erreur) {
+        Demappe_fichier(base);
+        memset(t, 0, sizeof(*t));
+        return 1;
+    }
+
+    t->base   = base;
+    t->taille = taille;
+    for (int b = 0; b < SOP_TABLE_NB_BLOCS; ++b) {
+        t->courant[b] = (const float *)(base + e->offset_courant[b]);
+        t->marge[b]   = (const float *)(base + e->offset_marge[b]);
+    }
+    return 0;
+}
+
+void SOP_Table_fermer(SOP_Table *t)
+{
+    if (!t) return;
+    if (t->base) Demappe_fichier(t->base);
+    free(t->stockage);
+    memset(t, 0, sizeof(*t));
+}
@@ -0,0 +1,173 @@
+#ifndef SOP_TABLE_H
+#define SOP_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "SOP.h"
+
+// ============================================================================
+// Table SOP hors ligne (.prts)
+//
+// La recherche de racine coûte des dizaines d'évaluations d'horizon par
+// échantillon. Pour un modèle SOP_Modele donné, le courant admissible ne
+// dépend que de l'état (SOC, température, Ir, SOH) et de etat : il est
+// calculé une fois pour toutes par SOP_courant_admissible sur une grille
+// régulière 4-D, pour chaque etat et chaque sens (décharge : consigne I_max,
+// charge : consigne I_min), puis interpolé (multilinéaire, 16 noeuds).
+// Le noeud interne T1 du Foster n'est pas une dimension : la table est
+// calculée à T1 = T2 (noeuds à l'équilibre).
+//
+// Mode prudent : chaque maille porte une marge, le plus grand dépassement de
+// l'interpolation sur le courant exact mesuré à la construction, plus
+// SOP_TABLE_MARGE_SECURITE. Points mesurés : sous-grille de 3 points par
+// axe de la maille (coins, milieux, centre) à T1 = T2 et aux deux bornes de
+// T1 - T2, puis points_par_maille points tirés dans la maille et dans
+// [dT1_min, dT1_max] : l'écart de T1 à l'équilibre est compris dans la
+// marge. Le courant prudent est |I interpolé| - marge, borné
+// à 0 ; hors de la grille (un axe ou T1 - T2 hors bornes, NaN) il vaut 0.
+//
+// La marge est une estimation par échantillonnage, pas une borne : le
+// courant prudent ne dépasse pas la limite exacte aux points mesurés, mais
+// rien ne le garantit entre eux (la limite exacte n'a pas de monotonie
+// établie dans une maille qui permettrait de la borner par ses noeuds).
+// table_sop balayage mesure le pire dépassement sur une sous-grille
+// régulière de chaque maille, table_sop rapport sur le rejeu avec le vrai
+// T1. En mode direct, l'état hors de la grille est ramené sur le bord.
+//
+// Fichier : en-tête fixe (axes, paramètres de construction), puis les
+// blocs float alignés sur 64 octets : courants aux noeuds et marges des
+// mailles, pour chaque (etat, sens). Projeté en mémoire (Mappe_fichier).
+// Format little-endian (x86 / ARM).
+// ============================================================================
+
+#define SOP_TABLE_MAGIQUE      "PRTS"
+#define SOP_TABLE_VERSION      2
+#define SOP_TABLE_ALIGNEMENT   64
+#define SOP_TABLE_NOEUDS_MAX   257     // par axe
+#define SOP_TABLE_MARGE_SECURITE 0.02f // A, ajoutée à la marge mesurée
+
+// Axes de la grille
+enum { SOP_AXE_SOC = 0, SOP_AXE_T, SOP_AXE_IR, SOP_AXE_SOH, SOP_TABLE_NB_AXES };
+
+// Sens du courant : décharge (I > 0, consigne I_max), charge (I < 0)
+enum { SOP_SENS_DECHARGE = 0, SOP_SENS_CHARGE, SOP_TABLE_NB_SENS };
+
+#define SOP_TABLE_NB_BLOCS (2 * SOP_TABLE_NB_SENS)    // etat x sens
+
+typedef struct
+{
+    float    min;
+    float    max;
+    uint32_t n;             // noeuds (>= 2)
+    uint32_t reserve;
+} SOP_Axe;
+
+typedef struct
+{
+    char     magique[4];                        // "PRTS"
+    uint32_t version;
+    SOP_Axe  axes[SOP_TABLE_NB_AXES];
+    uint32_t points_par_maille;                 // points tirés pour les marges
+    uint32_t horizon;                           // du modèle de construction
+    float    I_min, I_max;
+    float    dT1_min, dT1_max;                  // T1 - T2 couvert par les marges
+    uint64_t offset_courant[SOP_TABLE_NB_BLOCS];   // [etat * 2 + sens]
+    uint64_t offset_marge[SOP_TABLE_NB_BLOCS];
+} SOP_Table_entete;
+
+// Table ouverte (projection mémoire, ou construite en mémoire)
+typedef struct
+{
+    const uint8_t          *base;       // projection (NULL si construite)
+    size_t                  taille;
+    SOP_Table_entete        entete;
+
+    // Précalculs d'indexation
+    float  inv_pas[SOP_TABLE_NB_AXES];
+    size_t pas_noeud[SOP_TABLE_NB_AXES];    // écart d'indice entre noeuds voisins
+    size_t pas_maille[SOP_TABLE_NB_AXES];
+    size_t nb_noeuds, nb_mailles;
+
+    const float *courant[SOP_TABLE_NB_BLOCS];
+    const float *marge[SOP_TABLE_NB_BLOCS];
+    float       *stockage;                  // blocs alloués par la construction
+} SOP_Table;
+
+// Construction : courant exact aux noeuds, marges des mailles
+// (points_par_maille points tirés en plus de la sous-grille),
+// T1 - T2 dans [dT1_min, dT1_max] (0 compris). 0 = OK, 1 = erreur
+int SOP_Table_construire(SOP_Table *t, const SOP_Modele *m,
+                         const SOP_Axe axes[SOP_TABLE_NB_AXES],
+                         int points_par_maille, float dT1_min, float dT1_max);
+
+// Écriture / ouverture avec vérification de l'en-tête (0 = OK, 1 = erreur)
+int  SOP_Table_ecrire(const SOP_Table *t, const char *chemin);
+int  SOP_Table_ouvrir(SOP_Table *t, const char *chemin);
+void SOP_Table_fermer(SOP_Table *t);
+
+// Interpolation multilinéaire (16 noeuds) du bloc b, état ramené sur le
+// bord de la grille ; *maille : maille utilisée
+static inline float SOP_Table_interpoler(const SOP_Table *t, int b,
+                                         const float x[SOP_TABLE_NB_AXES],
+                                         size_t *maille)
+{
+    size_t base = 0, m = 0;
+    float  a[SOP_TABLE_NB_AXES];
+
+    for (int d = 0; d < SOP_TABLE_NB_AXES; ++d) {
+        const SOP_Axe *axe = &t->entete.axes[d];
+        float u = (x[d] - axe->min) * t->inv_pas[d];
+        int   i;
+        if (!(u < (float)(axe->n - 1))) { i = (int)axe->n - 2; a[d] = 1.0f; }   // NaN compris
+        else if (u <= 0.0f)             { i = 0;               a[d] = 0.0f; }
+        else                            { i = (int)u;          a[d] = u - (float)i; }
+        base += (size_t)i * t->pas_noeud[d];
+        m    += (size_t)i * t->pas_maille[d];
+    }
+    *maille = m;
+
+    const float *c = t->courant[b] + base;
+    const size_t s0 = t->pas_noeud[0], s1 = t->pas_noeud[1];
+    const size_t s2 = t->pas_noeud[2], s3 = t->pas_noeud[3];
+
+    // Réduction axe par axe : 8 + 4 + 2 + 1 interpolations
+    float v[8];
+    for (int k = 0; k < 8; ++k) {
+        size_t o = ((k & 1) ? s1 : 0) + ((k & 2) ? s2 : 0) + ((k & 4) ? s3 : 0);
+        v[k] = c[o] + a[0] * (c[o + s0] - c[o]);
+    }
+    for (int k = 0; k < 4; ++k) v[k] = v[2 * k] + a[1] * (v[2 * k + 1] - v[2 * k]);
+    for (int k = 0; k < 2; ++k) v[k] = v[2 * k] + a[2] * (v[2 * k + 1] - v[2 * k]);
+    return v[0] + a[3] * (v[1] - v[0]);
+}
+
+// Courant admissible interpolé (A, signé comme le sens), T1 = T2
+static inline float SOP_Table_eval(const SOP_Table *t, int etat, int sens,
+                                   float SOC, float T, float Ir, float SOH)
+{
+    const float x[SOP_TABLE_NB_AXES] = { SOC, T, Ir, SOH };
+    size_t maille;
+    return SOP_Table_interpoler(t, (etat ? 1 : 0) * SOP_TABLE_NB_SENS + sens, x, &maille);
+}
+
+// Courant prudent : marge de la maille retranchée, 0 hors de la grille
+// (T1, T2 : noeuds du Foster)
+static inline float SOP_Table_eval_prudent(const SOP_Table *t, int etat, int sens,
+                                           float SOC, float T1, float T2,
+                                           float Ir, float SOH)
+{
+    const float x[SOP_TABLE_NB_AXES] = { SOC, T2, Ir, SOH };
+    const float dT1 = T1 - T2;
+    if (!(dT1 >= t->entete.dT1_min && dT1 <= t->entete.dT1_max)) return 0.0f;
+    for (int d = 0; d < SOP_TABLE_NB_AXES; ++d)
+        if (!(x[d] >= t->entete.axes[d].min && x[d] <= t->entete.axes[d].max)) return 0.0f;
+
+    const int b = (etat ? 1 : 0) * SOP_TABLE_NB_SENS + sens;
+    size_t maille;
+    const float I = SOP_Table_interpoler(t, b, x, &maille);
+    const float s = (sens == SOP_SENS_DECHARGE) ? 1.0f : -1.0f;
+    const float m = s * I - t->marge[b][maille];
+    return (m > 0.0f) ? s * m : 0.0f;
+}
+
+#endif // SOP_TABLE_H
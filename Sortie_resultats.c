@@ -0,0 +1,400 @@
+// Positions > 2 Go dans les fichiers (Raspberry Pi 32 bits)
+#define _FILE_OFFSET_BITS 64
+
+#include <stdlib.h>
+#include <string.h>
+#include "Sortie_resultats.h"
+#include "Codec_flottant.h"
+
+#ifdef _WIN32
+#include <io.h>
+#define fseek64 _fseeki64
+#define ftell64 _ftelli64
+#define tronquer(f, taille) _chsize_s(_fileno(f), (taille))
+#else
+#include <unistd.h>
+#define fseek64 fseeko
+#define ftell64 ftello
+#define tronquer(f, taille) ftruncate(fileno(f), (off_t)(taille))
+#endif
+
+// ============================================================================
+// Thread d'écriture : écrit le bloc en attente puis le rend à la boucle
+// ============================================================================
+
+static int ecrire_bloc(Sortie_Context *s, const Sortie_bloc *b)
+{
+    // Colonnes compressées les unes à la suite des autres
+    uint32_t tailles[SORTIE_CANAUX_MAX];
+    size_t total = 0;
+    for (int c = 0; c < s->nb_canaux; ++c) {
+        tailles[c] = (uint32_t)Codec_encoder_bloc(b->colonnes + c * SORTIE_LIGNES_BLOC,
+                                                  b->nb, s->compresse + total);
+        total += tailles[c];
+    }
+
+    FILE *f = s->fichier;
+    int ok = (fwrite(&b->nb, sizeof(uint32_t), 1, f) == 1) &&
+             (fwrite(tailles, sizeof(uint32_t), (size_t)s->nb_canaux, f) == (size_t)s->nb_canaux) &&
+             (fwrite(s->compresse, 1, total, f) == total);
+
+    // le bloc est sur disque avant d'attaquer le suivant
+    if (fflush(f) != 0) ok = 0;
+    return ok;
+}
+
+static void *thread_ecriture(void *arg)
+{
+    Sortie_Context *s = (Sortie_Context *)arg;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&s->verrou);
+        while (s->a_ecrire < 0 && !s->arret)
+            pthread_cond_wait(&s->cond_travail, &s->verrou);
+        int indice = s->a_ecrire;
+        pthread_mutex_unlock(&s->verrou);
+
+        if (indice < 0) break;   // arrêt demandé, plus rien à écrire
+
+        Sortie_bloc *b = &s->blocs[indice];
+        int ok = ecrire_bloc(s, b);
+
+        pthread_mutex_lock(&s->verrou);
+        b->nb = 0;
+        s->a_ecrire = -1;
+        if (!ok) s->erreur = 1;
+        pthread_cond_signal(&s->cond_fini);
+        pthread_mutex_unlock(&s->verrou);
+    }
+
+    return NULL;
+}
+
+// Allocation du double tampon et démarrage du thread, fichier déjà ouvert
+// et positionné (en cas d'erreur le fichier est fermé)
+static int demarrer(Sortie_Context *s, int nb_canaux)
+{
+    s->nb_canaux = nb_canaux;
+    for (int i = 0; i < 2; ++i) {
+        s->blocs[i].colonnes = (float *)malloc((size_t)nb_canaux * SORTIE_LIGNES_BLOC * sizeof(float));
+        s->blocs[i].nb = 0;
+    }
+    s->compresse = (uint8_t *)malloc((size_t)nb_canaux * CODEC_TAILLE_MAX_BLOC(SORTIE_LIGNES_BLOC));
+    if (!s->blocs[0].colonnes || !s->blocs[1].colonnes || !s->compresse) {
+        perror("Erreur allocation blocs de sortie");
+        free(s->blocs[0].colonnes);
+        free(s->blocs[1].colonnes);
+        free(s->compresse);
+        fclose(s->fichier);
+        s->fichier = NULL;
+        return 1;
+    }
+
+    s->remplissage = 0;
+    s->a_ecrire    = -1;
+
+    pthread_mutex_init(&s->verrou, NULL);
+    pthread_cond_init(&s->cond_travail, NULL);
+    pthread_cond_init(&s->cond_fini, NULL);
+
+    if (pthread_create(&s->thread, NULL, thread_ecriture, s) != 0) {
+        printf("Erreur creation thread d'ecriture\n");
+        pthread_mutex_destroy(&s->verrou);
+        pthread_cond_destroy(&s->cond_travail);
+        pthread_cond_destroy(&s->cond_fini);
+        free(s->blocs[0].colonnes);
+        free(s->blocs[1].colonnes);
+        free(s->compresse);
+        fclose(s->fichier);
+        s->fichier = NULL;
+        return 1;
+    }
+
+    return 0;
+}
+
+static void remplir_entete(Sortie_entete *e, int nb_canaux, const char *const noms[])
+{
+    memset(e, 0, sizeof(*e));
+    memcpy(e->magique, SORTIE_MAGIQUE, 4);
+    e->version     = SORTIE_VERSION;
+    e->nb_canaux   = (uint32_t)nb_canaux;
+    e->lignes_bloc = SORTIE_LIGNES_BLOC;
+    e->codec       = SORTIE_CODEC_XOR;
+    for (int c = 0; c < nb_canaux; ++c)
+        snprintf(e->noms[c], SORTIE_NOM_MAX, "%s", noms[c]);
+}
+
+// ============================================================================
+// API publique
+// ============================================================================
+
+int Sortie_ouvrir(Sortie_Context *s, const char *chemin,
+                  int nb_canaux, const char *const noms[])
+{
+    if (!s) return 1;
+    memset(s, 0, sizeof(*s));
+
+    if (nb_canaux <= 0 || nb_canaux > SORTIE_CANAUX_MAX) {
+        printf("Erreur : nombre de canaux de sortie invalide (%d)\n", nb_canaux);
+        return 1;
+    }
+
+    Sortie_entete e;
+    remplir_entete(&e, nb_canaux, noms);
+
+    s->fichier = fopen(chemin, "wb");
+    if (!s->fichier) {
+        perror("Erreur ouverture fichier");
+        return 1;
+    }
+    if (fwrite(&e, sizeof(e), 1, s->fichier) != 1 || fflush(s->fichier) != 0) {
+        printf("Erreur ecriture en-tete %s\n", chemin);
+        fclose(s->fichier);
+        s->fichier = NULL;
+        return 1;
+    }
+
+    return demarrer(s, nb_canaux);
+}
+
+int Sortie_reprendre(Sortie_Context *s, const char *chemin,
+                     int nb_canaux, const char *const noms[], long long position)
+{
+    if (!s) return 1;
+    memset(s, 0, sizeof(*s));
+
+    if (nb_canaux <= 0 || nb_canaux > SORTIE_CANAUX_MAX) {
+        printf("Erreur : nombre de canaux de sortie invalide (%d)\n", nb_canaux);
+        return 1;
+    }
+
+    s->fichier = fopen(chemin, "r+b");
+    if (!s->fichier) {
+        perror("Erreur ouverture fichier");
+        return 1;
+    }
+
+    // Le fichier doit avoir été produit avec les mêmes canaux
+    Sortie_entete attendu, lu;
+    remplir_entete(&attendu, nb_canaux, noms);
+    fseek64(s->fichier, 0, SEEK_END);
+    long long taille = ftell64(s->fichier);
+    fseek64(s->fichier, 0, SEEK_SET);
+
+    if (fread(&lu, sizeof(lu), 1, s->fichier) != 1 ||
+        memcmp(&lu, &attendu, sizeof(lu)) != 0 ||
+        position < (long long)sizeof(lu) || position > taille) {
+        printf("Erreur : %s ne correspond pas au point de reprise\n", chemin);
+        fclose(s->fichier);
+        s->fichier = NULL;
+        return 1;
+    }
+
+    // Les lignes écrites après le point de reprise seront recalculées
+    fflush(s->fichier);
+    if (tronquer(s->fichier, position) != 0 ||
+        fseek64(s->fichier, position, SEEK_SET) != 0) {
+        printf("Erreur troncature %s\n", chemin);
+        fclose(s->fichier);
+        s->fichier = NULL;
+        return 1;
+    }
+
+    return demarrer(s, nb_canaux);
+}
+
+long long Sortie_position(Sortie_Context *s)
+{
+    if (!s || !s->fichier) return -1;
+    Sortie_synchroniser(s);
+    return ftell64(s->fichier);
+}
+
+void Sortie_bloc_plein(Sortie_Context *s)
+{
+    pthread_mutex_lock(&s->verrou);
+
+    // Le thread doit avoir fini le bloc précédent (c'est celui qu'on va remplir)
+    while (s->a_ecrire >= 0)
+        pthread_cond_wait(&s->cond_fini, &s->verrou);
+
+    s->a_ecrire    = s->remplissage;
+    s->remplissage = 1 - s->remplissage;
+    pthread_cond_signal(&s->cond_travail);
+
+    pthread_mutex_unlock(&s->verrou);
+}
+
+void Sortie_synchroniser(Sortie_Context *s)
+{
+    if (!s || !s->fichier) return;
+
+    if (s->blocs[s->remplissage].nb > 0)
+        Sortie_bloc_plein(s);
+
+    pthread_mutex_lock(&s->verrou);
+    while (s->a_ecrire >= 0)
+        pthread_cond_wait(&s->cond_fini, &s->verrou);
+    pthread_mutex_unlock(&s->verrou);
+}
+
+int Sortie_fermer(Sortie_Context *s)
+{
+    if (!s || !s->fichier) return 1;
+
+    Sortie_synchroniser(s);
+
+    pthread_mutex_lock(&s->verrou);
+    s->arret = 1;
+    pthread_cond_signal(&s->cond_travail);
+    pthread_mutex_unlock(&s->verrou);
+
+    pthread_join(s->thread, NULL);
+
+    pthread_mutex_destroy(&s->verrou);
+    pthread_cond_destroy(&s->cond_travail);
+    pthread_cond_destroy(&s->cond_fini);
+
+    free(s->blocs[0].colonnes);
+    free(s->blocs[1].colonnes);
+    free(s->compresse);
+    s->blocs[0].colonnes = NULL;
+    s->blocs[1].colonnes = NULL;
+    s->compresse         = NULL;
+
+    if (fclose(s->fichier) != 0) s->erreur = 1;
+    s->fichier = NULL;
+
+    if (s->erreur) printf("Erreur ecriture des resultats\n");
+    return s->erreur;
+}
+
+// ============================================================================
+// Relecture d'un canal
+// ============================================================================
+
+static int verifier_entete(const Sortie_entete *e, const char *chemin)
+{
+    if (memcmp(e->magique, SORTIE_MAGIQUE, 4) != 0 ||
+        e->version != SORTIE_VERSION ||
+        e->nb_canaux == 0 || e->nb_canaux > SORTIE_CANAUX_MAX ||
+        e->lignes_bloc == 0 || e->lignes_bloc > CODEC_VALEURS_BLOC ||
+        (e->codec != SORTIE_CODEC_BRUT && e->codec != SORTIE_CODEC_XOR)) {
+        printf("Erreur : %s n'est pas un fichier de resultats valide\n", chemin);
+        return 1;
+    }
+    return 0;
+}
+
+int Sortie_lire_entete(const char *chemin, Sortie_entete *e)
+{
+    FILE *f = fopen(chemin, "rb");
+    if (!f) {
+        perror("Erreur ouverture fichier");
+        return 1;
+    }
+    int lu = (fread(e, sizeof(*e), 1, f) == 1);
+    fclose(f);
+
+    if (!lu) {
+        printf("Erreur lecture en-tete %s\n", chemin);
+        return 1;
+    }
+    return verifier_entete(e, chemin);
+}
+
+int Sortie_lire_canal(const char *chemin, const char *nom,
+                      float **valeurs, size_t *nb)
+{
+    *valeurs = NULL;
+    *nb      = 0;
+
+    FILE *f = fopen(chemin, "rb");
+    if (!f) {
+        perror("Erreur ouverture fichier");
+        return 1;
+    }
+
+    Sortie_entete e;
+    if (fread(&e, sizeof(e), 1, f) != 1 || verifier_entete(&e, chemin) != 0) {
+        fclose(f);
+        return 1;
+    }
+
+    int canal = -1;
+    for (uint32_t c = 0; c < e.nb_canaux; ++c) {
+        if (strncmp(e.noms[c], nom, SORTIE_NOM_MAX) == 0) canal = (int)c;
+    }
+    if (canal < 0) {
+        printf("Erreur : canal %s absent de %s\n", nom, chemin);
+        fclose(f);
+        return 1;
+    }
+
+    // Taille du fichier : un bloc tronqué (arrêt brutal) est ignoré
+    fseek64(f, 0, SEEK_END);
+    long long taille = ftell64(f);
+    fseek64(f, (long long)sizeof(e), SEEK_SET);
+
+    float   *tampon    = (float *)malloc(e.lignes_bloc * sizeof(float));
+    uint8_t *compresse = (uint8_t *)malloc(CODEC_TAILLE_MAX_BLOC(e.lignes_bloc));
+    float *sortie = NULL;
+    size_t n = 0, capacite = 0;
+
+    uint32_t nb_lignes;
+    while (tampon && compresse && fread(&nb_lignes, sizeof(uint32_t), 1, f) == 1)
+    {
+        if (nb_lignes == 0 || nb_lignes > e.lignes_bloc) break;
+
+        // Position et taille de chaque colonne dans le bloc
+        uint32_t tailles[SORTIE_CANAUX_MAX];
+        if (e.codec == SORTIE_CODEC_XOR) {
+            if (fread(tailles, sizeof(uint32_t), e.nb_canaux, f) != e.nb_canaux) break;
+        } else {
+            for (uint32_t c = 0; c < e.nb_canaux; ++c)
+                tailles[c] = nb_lignes * (uint32_t)sizeof(float);
+        }
+
+        long long debut_bloc = ftell64(f);
+        long long decalage = 0, total = 0;
+        for (uint32_t c = 0; c < e.nb_canaux; ++c) {
+            if (c < (uint32_t)canal) decalage += tailles[c];
+            total += tailles[c];
+        }
+        if (debut_bloc + total > taille) break;
+
+        size_t taille_canal = tailles[canal];
+        if (fseek64(f, debut_bloc + decalage, SEEK_SET) != 0) break;
+
+        if (e.codec == SORTIE_CODEC_XOR) {
+            if (taille_canal > CODEC_TAILLE_MAX_BLOC(e.lignes_bloc) ||
+                fread(compresse, 1, taille_canal, f) != taille_canal ||
+                Codec_decoder_bloc(compresse, taille_canal, nb_lignes, tampon) != 0) break;
+        } else {
+            if (fread(tampon, sizeof(float), nb_lignes, f) != nb_lignes) break;
+        }
+
+        if (fseek64(f, debut_bloc + total, SEEK_SET) != 0) break;
+
+        if (n + nb_lignes > capacite) {
+            size_t nouvelle = capacite ? 2 * capacite : e.lignes_bloc;
+            while (nouvelle < n + nb_lignes) nouvelle *= 2;
+            float *agrandi = (float *)realloc(sortie, nouvelle * sizeof(float));
+            if (!agrandi) break;
+            sortie   = agrandi;
+            capacite = nouvelle;
+        }
+        memcpy(sortie + n, tampon, nb_lignes * sizeof(float));
+        n += nb_lignes;
+    }
+
+    free(tampon);
+    free(compresse);
+    fclose(f);
+
+    *valeurs = sortie;
+    *nb      = n;
+    return 0;
+}
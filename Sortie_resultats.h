@@ -0,0 +1,114 @@
+#ifndef SORTIE_RESULTATS_H
+#define SORTIE_RESULTATS_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+// ============================================================================
+// Écriture des résultats en flux : une ligne par pas, un seul fichier
+//
+// Les lignes sont accumulées dans un bloc de SORTIE_LIGNES_BLOC lignes ;
+// un bloc plein est confié à un thread d'écriture pendant que la boucle
+// remplit le second (double tampon). Mémoire constante quel que soit
+// NbIteration, et le fichier est lisible pendant l'exécution.
+//
+// Format (little-endian) :
+//   en-tête  : Sortie_entete (noms des canaux, codec)
+//   blocs    : uint32 nb_lignes, puis
+//              SORTIE_CODEC_BRUT : nb_canaux colonnes de nb_lignes float
+//              SORTIE_CODEC_XOR  : uint32 taille[nb_canaux], puis chaque
+//                                  colonne compressée (Codec_flottant.h)
+// Chaque bloc est écrit d'un seul tenant puis vidé sur disque : après un
+// arrêt brutal, seuls les blocs complets sont relus.
+// La compression est faite par le thread d'écriture, hors de la boucle.
+// ============================================================================
+
+#define SORTIE_MAGIQUE       "PRTR"
+#define SORTIE_VERSION       2
+#define SORTIE_CANAUX_MAX    16
+#define SORTIE_NOM_MAX       32
+#define SORTIE_LIGNES_BLOC   4096
+
+#define SORTIE_CODEC_BRUT    0
+#define SORTIE_CODEC_XOR     1
+
+typedef struct
+{
+    char     magique[4];
+    uint32_t version;
+    uint32_t nb_canaux;
+    uint32_t lignes_bloc;
+    uint32_t codec;
+    char     noms[SORTIE_CANAUX_MAX][SORTIE_NOM_MAX];
+} Sortie_entete;
+
+typedef struct
+{
+    float   *colonnes;   // nb_canaux x SORTIE_LIGNES_BLOC
+    uint32_t nb;         // lignes remplies
+} Sortie_bloc;
+
+typedef struct
+{
+    FILE *fichier;
+    int   nb_canaux;
+
+    // Double tampon : la boucle remplit `remplissage`, le thread écrit l'autre
+    Sortie_bloc blocs[2];
+    uint8_t    *compresse;   // colonnes codées du bloc en cours d'écriture
+    int  remplissage;
+    int  a_ecrire;       // -1 si aucun bloc en attente d'écriture
+    int  arret;
+    int  erreur;
+
+    pthread_t       thread;
+    pthread_mutex_t verrou;
+    pthread_cond_t  cond_travail;
+    pthread_cond_t  cond_fini;
+} Sortie_Context;
+
+// Création du fichier et démarrage du thread (0 = OK, 1 = erreur)
+int Sortie_ouvrir(Sortie_Context *s, const char *chemin,
+                  int nb_canaux, const char *const noms[]);
+
+// Reprise d'un fichier existant (mêmes canaux) : troncature à `position`,
+// rendue par Sortie_position au point de reprise, puis ajout en fin.
+// (0 = OK, 1 = erreur)
+int Sortie_reprendre(Sortie_Context *s, const char *chemin,
+                     int nb_canaux, const char *const noms[], long long position);
+
+// Synchronisation puis position de fin des lignes déjà écrites
+// (-1 si le fichier n'est pas ouvert)
+long long Sortie_position(Sortie_Context *s);
+
+// Envoi du bloc courant (même incomplet) et attente de son écriture
+void Sortie_synchroniser(Sortie_Context *s);
+
+// Vidage final + fermeture (0 = OK, 1 = erreur d'écriture)
+int Sortie_fermer(Sortie_Context *s);
+
+// Bloc plein : passage au thread d'écriture (usage interne de Sortie_ligne)
+void Sortie_bloc_plein(Sortie_Context *s);
+
+// Ajout d'une ligne (nb_canaux valeurs)
+static inline void Sortie_ligne(Sortie_Context *s, const float *ligne)
+{
+    Sortie_bloc *b = &s->blocs[s->remplissage];
+    for (int c = 0; c < s->nb_canaux; ++c)
+        b->colonnes[c * SORTIE_LIGNES_BLOC + b->nb] = ligne[c];
+
+    if (++b->nb == SORTIE_LIGNES_BLOC)
+        Sortie_bloc_plein(s);
+}
+
+// Relecture de l'en-tête (noms des canaux). 0 = OK, 1 = erreur.
+int Sortie_lire_entete(const char *chemin, Sortie_entete *e);
+
+// Relecture d'un canal (blocs complets uniquement). *valeurs est alloué
+// avec malloc et doit être libéré par l'appelant. 0 = OK, 1 = erreur.
+int Sortie_lire_canal(const char *chemin, const char *nom,
+                      float **valeurs, size_t *nb);
+
+#endif // SORTIE_RESULTATS_H
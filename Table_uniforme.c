@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <math.h>
+#include "Table_uniforme.h"
+
+// ============================================================================
+// Helpers internes
+// ============================================================================
+
+// Interpolation de référence sur la table d'origine (en double)
+static double interp_reference(const float *x, const float *y, int n, double xq)
+{
+    if (xq <= x[0])     return y[0];
+    if (xq >= x[n - 1]) return y[n - 1];
+
+    int i = 0;
+    while (i < n - 2 && xq > x[i + 1]) ++i;
+
+    double dx = (double)x[i + 1] - x[i];
+    if (dx == 0.0) return y[i];
+    return y[i] + (xq - x[i]) / dx * ((double)y[i + 1] - y[i]);
+}
+
+// Plus petit nombre d'intervalles qui place toutes les abscisses sur un
+// noeud de la grille (0 si aucun ne convient)
+static int intervalles_exacts(const float *x, int n)
+{
+    const double etendue = (double)x[n - 1] - x[0];
+
+    for (int m = 1; m < TABLE_UNIFORME_MAX; ++m) {
+        double pas = etendue / m;
+        int k = 1;
+        for (; k < n - 1; ++k) {
+            double v = ((double)x[k] - x[0]) / pas;
+            if (fabs(v - floor(v + 0.5)) > 1e-3) break;
+        }
+        if (k == n - 1) return m;
+    }
+    return 0;
+}
+
+// ============================================================================
+// Compilation
+// ============================================================================
+
+int Table_uniforme_compiler(Table_uniforme *t, const float *x, const float *y,
+                            int n, int n_grille)
+{
+    if (n < 2 || !(x[n - 1] > x[0])) {
+        printf("Erreur table : au moins deux abscisses croissantes attendues\n");
+        return 1;
+    }
+    for (int k = 1; k < n; ++k) {
+        if (!(x[k] >= x[k - 1])) {
+            printf("Erreur table : abscisses non croissantes (indice %d)\n", k);
+            return 1;
+        }
+    }
+
+    int m = n_grille - 1;
+    if (n_grille <= 0) {
+        m = intervalles_exacts(x, n);
+        if (m == 0) m = TABLE_UNIFORME_MAX - 1;
+    }
+    if (m < 1)                      m = 1;
+    if (m > TABLE_UNIFORME_MAX - 1) m = TABLE_UNIFORME_MAX - 1;
+
+    const double etendue = (double)x[n - 1] - x[0];
+    const double pas     = etendue / m;
+
+    t->x0      = x[0];
+    t->pas     = (float)pas;
+    t->inv_pas = (float)(m / etendue);
+    t->n       = m + 1;
+
+    for (int j = 0; j <= m; ++j)
+        t->y[j] = (float)interp_reference(x, y, n, x[0] + j * pas);
+    t->y[m] = y[n - 1];
+
+    // Écart avec la table d'origine : abscisses d'origine + 8 points par
+    // intervalle de la grille
+    double erreur = 0.0;
+    for (int k = 0; k < n; ++k) {
+        double e = fabs(Table_uniforme_eval(t, x[k]) - interp_reference(x, y, n, x[k]));
+        if (e > erreur) erreur = e;
+    }
+    for (int j = 0; j < m; ++j) {
+        for (int s = 1; s < 8; ++s) {
+            float  xq = (float)(x[0] + (j + s / 8.0) * pas);
+            double e  = fabs(Table_uniforme_eval(t, xq) - interp_reference(x, y, n, xq));
+            if (e > erreur) erreur = e;
+        }
+    }
+    t->erreur_max = (float)erreur;
+    return 0;
+}
@@ -0,0 +1,70 @@
+#ifndef TABLE_UNIFORME_H
+#define TABLE_UNIFORME_H
+
+// ============================================================================
+// Tables d'interpolation à pas constant (OCV(SOC), loi RUL(SOH)...)
+//
+// interp1Drapide parcourt la table pour trouver l'intervalle de x : jusqu'à
+// une centaine de comparaisons par appel sur les tables OCV de 104 points.
+// Une table (X, Y) quelconque est ici rééchantillonnée une fois pour toutes
+// sur une grille régulière : l'intervalle s'obtient par un simple calcul
+// d'indice, sans recherche.
+//
+// Le pas est choisi pour que chaque abscisse de la table d'origine tombe sur
+// un noeud de la grille quand c'est possible (tables OCV : pas de 0.001) ;
+// l'interpolation linéaire est alors identique à celle de la table d'origine.
+// Sinon la grille compte TABLE_UNIFORME_MAX points et l'écart maximal avec
+// la table d'origine est mesuré à la compilation (champ erreur_max) ; pour
+// ces tables, Interpolateur.h donne le résultat exact sans recherche complète.
+//
+// Comportement aux bornes identique à interp1Drapide : y[0] en dessous de la
+// première abscisse, y[n-1] au-delà de la dernière.
+// ============================================================================
+
+#define TABLE_UNIFORME_MAX 1025
+
+typedef struct
+{
+    float x0;           // première abscisse
+    float pas;          // pas de la grille
+    float inv_pas;      // 1 / pas
+    int   n;            // nombre de points (2..TABLE_UNIFORME_MAX)
+    float erreur_max;   // écart maximal mesuré avec la table d'origine
+    float y[TABLE_UNIFORME_MAX];
+} Table_uniforme;
+
+// Rééchantillonnage de la table (x croissant, n >= 2) sur n_grille points,
+// ou sur la grille la plus petite qui contient toutes les abscisses si
+// n_grille = 0. (0 = OK, 1 = table invalide)
+int Table_uniforme_compiler(Table_uniforme *t, const float *x, const float *y,
+                            int n, int n_grille);
+
+// Interpolation linéaire à pas constant
+static inline float Table_uniforme_eval(const Table_uniforme *t, float x)
+{
+    float u = (x - t->x0) * t->inv_pas;
+    if (!(u < (float)(t->n - 1))) return t->y[t->n - 1];   // NaN compris
+    if (u <= 0.0f)                return t->y[0];
+
+    int   i = (int)u;
+    float a = u - (float)i;
+    return t->y[i] + a * (t->y[i + 1] - t->y[i]);
+}
+
+// Interpolation + pente de l'intervalle (pente du premier / dernier
+// intervalle hors de la table)
+static inline float Table_uniforme_eval_der(const Table_uniforme *t, float x, float *der)
+{
+    float u = (x - t->x0) * t->inv_pas;
+    int   i;
+    float a;
+    if (!(u < (float)(t->n - 1))) { i = t->n - 2; a = 1.0f; }
+    else if (u <= 0.0f)           { i = 0;        a = 0.0f; }
+    else                          { i = (int)u;   a = u - (float)i; }
+
+    float dy = t->y[i + 1] - t->y[i];
+    *der = dy * t->inv_pas;
+    return t->y[i] + a * dy;
+}
+
+#endif // TABLE_UNIFORME_H
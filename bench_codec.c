@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Read_Write.h"
+#include "Codec_flottant.h"
+
+// ============================================================================
+// Banc d'essai du codec flottant sur le jeu ../donnees
+//
+// Pour chaque canal : taux de compression, débit de codage et de décodage
+// (flux complet puis accès aléatoire à un bloc), et vérification bit à bit.
+//
+// Usage : bench_codec [nb_repetitions]   (défaut : 10)
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    int repetitions = (argc > 1) ? atoi(argv[1]) : 10;
+    if (repetitions < 1) repetitions = 1;
+
+    const float *canaux[5];
+    const char  *noms[5] = {"courant", "tension", "temperature", "SOH", "SOC"};
+    Charge_donnees(&canaux[0], &canaux[1], &canaux[2], &canaux[3], &canaux[4]);
+    size_t N = Nb_echantillons_donnees();
+    if (!canaux[0] || N == 0) {
+        printf("Erreur chargement des donnees\n");
+        return 1;
+    }
+
+    float *decode = (float *)malloc(N * sizeof(float));
+    if (!decode) {
+        perror("Erreur allocation");
+        Free_donnees(canaux[0], canaux[1], canaux[2], canaux[3], canaux[4]);
+        return 1;
+    }
+
+    printf("%zu echantillons, %d repetitions\n\n", N, repetitions);
+    printf("%-12s | %8s | %10s | %10s | %12s | %s\n",
+           "Canal", "Ratio", "Code GB/s", "Decode GB/s", "Bloc (us)", "Verif");
+    printf("--------------------------------------------------------------------------------\n");
+
+    size_t total_brut = 0, total_compresse = 0;
+    int erreur = 0;
+
+    for (int k = 0; k < 5 && !erreur; ++k)
+    {
+        const double brut = (double)N * sizeof(float);
+        uint8_t *flux = NULL;
+        size_t taille = 0;
+
+        // Codage
+        double t0 = Horloge_secondes();
+        for (int r = 0; r < repetitions; ++r) {
+            free(flux);
+            if (Codec_compresser(canaux[k], N, &flux, &taille) != 0) { erreur = 1; break; }
+        }
+        double t_code = (Horloge_secondes() - t0) / repetitions;
+        if (erreur) break;
+
+        // Décodage complet
+        t0 = Horloge_secondes();
+        for (int r = 0; r < repetitions && !erreur; ++r)
+            erreur = Codec_lire(flux, taille, 0, N, decode);
+        double t_decode = (Horloge_secondes() - t0) / repetitions;
+
+        int identique = !erreur && memcmp(decode, canaux[k], N * sizeof(float)) == 0;
+
+        // Accès aléatoire : un bloc pris au hasard (décodé seul grâce à l'index)
+        size_t nb_acces = 1000;
+        srand(1234);
+        t0 = Horloge_secondes();
+        for (size_t a = 0; a < nb_acces && !erreur; ++a) {
+            size_t debut = (size_t)rand() % N;
+            size_t nb    = (N - debut < CODEC_VALEURS_BLOC) ? N - debut : CODEC_VALEURS_BLOC;
+            erreur = Codec_lire(flux, taille, debut, nb, decode);
+            if (memcmp(decode, canaux[k] + debut, nb * sizeof(float)) != 0) identique = 0;
+        }
+        double t_acces = (Horloge_secondes() - t0) / (double)nb_acces;
+
+        printf("%-12s | %8.2f | %10.3f | %11.3f | %12.2f | %s\n",
+               noms[k], brut / (double)taille,
+               brut / t_code * 1e-9, brut / t_decode * 1e-9,
+               t_acces * 1e6, identique ? "OK" : "ECHEC");
+
+        if (!identique) erreur = 1;
+        total_brut      += N * sizeof(float);
+        total_compresse += taille;
+        free(flux);
+    }
+
+    if (!erreur) {
+        printf("--------------------------------------------------------------------------------\n");
+        printf("Total : %zu -> %zu octets (ratio %.2f)\n",
+               total_brut, total_compresse, (double)total_brut / (double)total_compresse);
+    }
+
+    free(decode);
+    Free_donnees(canaux[0], canaux[1], canaux[2], canaux[3], canaux[4]);
+    return erreur;
+}
@@ -0,0 +1,413 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "Read_Write.h"
+#include "SOC.h"
+#include "LSTM_noyau.h"
+#include "Activations.h"
+#include "LSTM_genere.h"
+
+// ============================================================================
+// Banc d'essai des noyaux LSTM et des niveaux d'activation de SOC_step
+//
+// 1) Écart absolu maximal de chaque niveau d'activation (sigmoïde, tanh)
+//    sur [-12, 12], par rapport au calcul en double.
+// 2) Rejeu de toute la série ../donnees pour chaque niveau et chaque noyau
+//    disponible sur ce processeur : temps moyen par pas et écart maximal de
+//    SOC avec la référence (8 produits séparés, activations libm).
+//    Au niveau exact, l'écart doit rester sous SOC_TOLERANCE_NOYAU (sinon
+//    code de retour 1) ; les autres niveaux sont comparés au seuil
+//    SOC_SEUIL_PRODUCTION pour décider de leur emploi.
+// 3) Lot de cellules (SOC_Batch) avec le noyau par défaut : la cellule n
+//    rejoue la série décalée de n * LOT_DECALAGE échantillons. Écart avec
+//    SOC_step cellule par cellule (doit être nul au même noyau), puis débit
+//    en ns par cellule et par pas selon la taille du lot.
+//
+// 4) Produit spécialisé par taille (LSTM_noyau.h) contre produit générique,
+//    pour le réseau intégré et, si donné, un fichier de poids .prtw :
+//    temps par pas au niveau rapide et écart entre les deux (doit être nul).
+// 5) Rejeu hors ligne (SOC_rejouer, projection des entrées par blocs)
+//    contre SOC_step, pour chaque noyau au niveau exact et au niveau
+//    rapide : temps par pas et écart (doit être nul).
+// 6) Noyaux générés (output/LSTM_genere.c) : chaque variante rejoue la
+//    série avec son noyau déroulé et avec le chemin générique du même
+//    réseau (SOC_genere_activer) ; temps par pas et écart.
+//
+// Usage : bench_soc [reseau.prtw]
+// ============================================================================
+
+#define SOC_TOLERANCE_NOYAU  1e-5f
+#define SOC_SEUIL_PRODUCTION 1e-4f
+
+#define LOT_DECALAGE         1009      // décalage de série d'une cellule à l'autre
+#define LOT_CELLULES_VERIF   16
+#define LOT_PAS_VERIF        5000
+#define LOT_CELLULES_PAS     1000000   // cellules x pas par mesure de débit
+
+// Rejeu complet, SOC dans sortie[N]. Renvoie le temps total (s).
+static double rejouer_modele(const SOC_Modele *modele,
+                             const float *courant, const float *tension, const float *temperature,
+                             const float *SOH, size_t N, float *sortie)
+{
+    SOC_Context ctx;
+    SOC_init_modele(&ctx, modele);
+
+    double t0 = Horloge_secondes();
+    for (size_t k = 0; k < N; ++k)
+        sortie[k] = SOC_step(&ctx, courant[k], tension[k], temperature[k], SOH[k]);
+    return Horloge_secondes() - t0;
+}
+
+static double rejouer(const float *courant, const float *tension, const float *temperature,
+                      const float *SOH, size_t N, float *sortie)
+{
+    return rejouer_modele(SOC_modele_integre(), courant, tension, temperature, SOH, N, sortie);
+}
+
+// Produit spécialisé contre générique pour chaque noyau (niveau rapide)
+static int comparer_specialisation(const SOC_Modele *modele,
+                                   const float *courant, const float *tension,
+                                   const float *temperature, const float *SOH, size_t N,
+                                   float *sortie_a, float *sortie_b)
+{
+    int erreur = 0;
+    printf("\nReseau %s (%d unites) : produit %s\n\n", modele->nom, modele->lstm.nb_unites,
+           modele->lstm.specialisation >= 0 ? "specialise disponible" : "generique seulement");
+    if (modele->lstm.specialisation < 0) return 0;
+
+    printf("%-10s | %14s | %14s | %13s\n", "Noyau", "generique ns", "specialise ns", "Ecart SOC");
+    printf("-----------------------------------------------------------\n");
+    for (int k = LSTM_NOYAU_PORTABLE; k < LSTM_NB_NOYAUX; ++k)
+    {
+        if (LSTM_noyau_choisir((LSTM_noyau)k) != 0) continue;
+
+        LSTM_specialisation_activer(0);
+        double t_gen = rejouer_modele(modele, courant, tension, temperature, SOH, N, sortie_a);
+        LSTM_specialisation_activer(1);
+        double t_spe = rejouer_modele(modele, courant, tension, temperature, SOH, N, sortie_b);
+
+        float ecart = 0.0f;
+        for (size_t i = 0; i < N; ++i) {
+            float e = fabsf(sortie_a[i] - sortie_b[i]);
+            if (!(e <= ecart)) ecart = e;
+        }
+        if (ecart != 0.0f) erreur = 1;
+
+        printf("%-10s | %14.1f | %14.1f | %13.3e\n", LSTM_noyau_nom((LSTM_noyau)k),
+               1e9 * t_gen / (double)N, 1e9 * t_spe / (double)N, ecart);
+    }
+    return erreur;
+}
+
+// Rejeu hors ligne (projection des entrées) contre SOC_step, par noyau
+static int comparer_projection(const SOC_Modele *modele,
+                               const float *courant, const float *tension,
+                               const float *temperature, const float *SOH, size_t N,
+                               float *sortie_a, float *sortie_b)
+{
+    int erreur = 0;
+    printf("%-10s | %-7s | %14s | %14s | %13s\n", "Noyau", "Niveau", "SOC_step ns", "rejouer ns",
+           "Ecart SOC");
+    printf("---------------------------------------------------------------------\n");
+    static const Activation_niveau niveaux[2] = { ACTIVATION_EXACTE, ACTIVATION_RAPIDE };
+    for (int k = LSTM_NOYAU_PORTABLE; k < LSTM_NB_NOYAUX; ++k)
+    {
+        if (LSTM_noyau_choisir((LSTM_noyau)k) != 0) continue;
+        for (int a = 0; a < 2; ++a)
+        {
+            Activation_choisir(niveaux[a]);
+            double t_pas = rejouer_modele(modele, courant, tension, temperature, SOH, N, sortie_a);
+
+            SOC_Context ctx;
+            SOC_init_modele(&ctx, modele);
+            double t0 = Horloge_secondes();
+            SOC_rejouer(&ctx, courant, tension, temperature, SOH, N, sortie_b);
+            double t_rejeu = Horloge_secondes() - t0;
+
+            float ecart = 0.0f;
+            for (size_t i = 0; i < N; ++i) {
+                float e = fabsf(sortie_a[i] - sortie_b[i]);
+                if (!(e <= ecart)) ecart = e;
+            }
+            if (ecart != 0.0f) erreur = 1;
+
+            printf("%-10s | %-7s | %14.1f | %14.1f | %13.3e\n", LSTM_noyau_nom((LSTM_noyau)k),
+                   Activation_nom(niveaux[a]), 1e9 * t_pas / (double)N,
+                   1e9 * t_rejeu / (double)N, ecart);
+        }
+    }
+    return erreur;
+}
+
+// Entrées du pas t pour les cellules du lot (série décalée par cellule)
+static void entrees_lot(const float *courant, const float *tension, const float *temperature,
+                        const float *SOH, size_t N, size_t t, int nb,
+                        float *I, float *U, float *T, float *S)
+{
+    for (int n = 0; n < nb; ++n) {
+        size_t k = (t + (size_t)n * LOT_DECALAGE) % N;
+        I[n] = courant[k];
+        U[n] = tension[k];
+        T[n] = temperature[k];
+        S[n] = SOH[k];
+    }
+}
+
+// Écart maximal entre SOC_Batch et SOC_step cellule par cellule (-1 si erreur)
+static float verifier_lot(const float *courant, const float *tension, const float *temperature,
+                          const float *SOH, size_t N)
+{
+    SOC_Batch   lot;
+    SOC_Context ctx[LOT_CELLULES_VERIF];
+    float I[LOT_CELLULES_VERIF], U[LOT_CELLULES_VERIF], T[LOT_CELLULES_VERIF];
+    float S[LOT_CELLULES_VERIF], sortie[LOT_CELLULES_VERIF];
+
+    if (SOC_Batch_init(&lot, LOT_CELLULES_VERIF) != 0) return -1.0f;
+    for (int n = 0; n < LOT_CELLULES_VERIF; ++n) SOC_init(&ctx[n]);
+
+    float ecart = 0.0f;
+    for (size_t t = 0; t < LOT_PAS_VERIF; ++t) {
+        entrees_lot(courant, tension, temperature, SOH, N, t, LOT_CELLULES_VERIF, I, U, T, S);
+        SOC_Batch_step(&lot, I, U, T, S, sortie);
+        for (int n = 0; n < LOT_CELLULES_VERIF; ++n) {
+            float e = fabsf(sortie[n] - SOC_step(&ctx[n], I[n], U[n], T[n], S[n]));
+            if (!(e <= ecart)) ecart = e;
+        }
+    }
+    SOC_Batch_liberer(&lot);
+    return ecart;
+}
+
+// Débit d'un lot de nb cellules : ns par cellule et par pas (-1 si erreur)
+static double debit_lot(const float *courant, const float *tension, const float *temperature,
+                        const float *SOH, size_t N, int nb)
+{
+    SOC_Batch lot;
+    if (SOC_Batch_init(&lot, nb) != 0) return -1.0;
+
+    size_t nb_pas = LOT_CELLULES_PAS / (size_t)nb;
+    if (nb_pas < 20) nb_pas = 20;
+
+    // Entrées préparées hors mesure : on ne chronomètre que SOC_Batch_step
+    const size_t NB_JEUX = 16;
+    float *e = (float *)malloc(NB_JEUX * 4 * (size_t)nb * sizeof(float));
+    float *sortie = (float *)malloc((size_t)nb * sizeof(float));
+    if (!e || !sortie) {
+        perror("Erreur allocation");
+        free(e);
+        free(sortie);
+        SOC_Batch_liberer(&lot);
+        return -1.0;
+    }
+    for (size_t j = 0; j < NB_JEUX; ++j) {
+        float *b = e + j * 4 * (size_t)nb;
+        entrees_lot(courant, tension, temperature, SOH, N, j * 7919, nb,
+                    b, b + nb, b + 2 * nb, b + 3 * nb);
+    }
+
+    double t0 = Horloge_secondes();
+    for (size_t t = 0; t < nb_pas; ++t) {
+        const float *b = e + (t % NB_JEUX) * 4 * (size_t)nb;
+        SOC_Batch_step(&lot, b, b + nb, b + 2 * nb, b + 3 * nb, sortie);
+    }
+    double duree = Horloge_secondes() - t0;
+
+    free(e);
+    free(sortie);
+    SOC_Batch_liberer(&lot);
+    return 1e9 * duree / ((double)nb_pas * (double)nb);
+}
+
+// Variantes générées contre chemin générique du même réseau (niveau actif)
+static int comparer_generes(const float *courant, const float *tension, const float *temperature,
+                            const float *SOH, size_t N, float *generique, float *genere)
+{
+    static SOC_Modele modele;
+    int erreur = 0;
+
+    SOC_genere_enregistrer(LSTM_genere_variantes, LSTM_genere_nb);
+    printf("%-10s | %-6s | %12s | %12s | %13s\n",
+           "Variante", "Unites", "Generique", "Genere", "Ecart SOC max");
+    printf("---------------------------------------------------------------\n");
+    for (int v = 0; v < LSTM_genere_nb; ++v) {
+        const LSTM_genere *g = LSTM_genere_variantes[v];
+        if (SOC_Modele_compiler_blocs(&modele, g->nom, g->nb_entrees, g->nb_unites,
+                                      SOC_TAILLE_SORTIE, g->blocs) != 0 ||
+            modele.genere != g) {
+            printf("%-10s : ignoree (poids differents du reseau source)\n", g->nom);
+            continue;
+        }
+
+        SOC_genere_activer(0);
+        double t_generique = rejouer_modele(&modele, courant, tension, temperature, SOH, N, generique);
+        SOC_genere_activer(1);
+        double t_genere = rejouer_modele(&modele, courant, tension, temperature, SOH, N, genere);
+
+        float ecart = 0.0f;
+        for (size_t i = 0; i < N; ++i) {
+            float e = fabsf(genere[i] - generique[i]);
+            if (!(e <= ecart)) ecart = e;
+        }
+        if (!(ecart <= SOC_TOLERANCE_NOYAU)) erreur = 1;
+
+        printf("%-10s | %6d | %9.1f ns | %9.1f ns | %13.3e\n", g->nom, g->nb_unites,
+               1e9 * t_generique / (double)N, 1e9 * t_genere / (double)N, ecart);
+    }
+    SOC_genere_enregistrer(NULL, 0);
+    return erreur;
+}
+
+int main(int argc, char **argv)
+{
+    const float *courant, *tension, *temperature, *SOH, *SOC;
+    Charge_donnees(&courant, &tension, &temperature, &SOH, &SOC);
+    size_t N = Nb_echantillons_donnees();
+    if (!courant || N == 0) {
+        printf("Erreur chargement des donnees\n");
+        return 1;
+    }
+
+    float *reference = (float *)malloc(N * sizeof(float));
+    float *sortie    = (float *)malloc(N * sizeof(float));
+    if (!reference || !sortie) {
+        perror("Erreur allocation");
+        free(reference);
+        free(sortie);
+        Free_donnees(courant, tension, temperature, SOH, SOC);
+        return 1;
+    }
+
+    LSTM_noyau        defaut_noyau      = LSTM_noyau_actif();
+    Activation_niveau defaut_activation = Activation_active();
+
+    // 1) Précision des activations
+    printf("%-10s | %14s | %14s\n", "Activation", "Ecart sigmoide", "Ecart tanh");
+    printf("--------------------------------------------\n");
+    for (int a = 0; a < ACTIVATION_NB_NIVEAUX; ++a)
+    {
+        Activation_choisir((Activation_niveau)a);
+        double ecart_sig = 0.0, ecart_tanh = 0.0;
+        float x[1000], sig[1000], th[1000];
+        for (int bloc = 0; bloc < 240; ++bloc) {
+            for (int i = 0; i < 1000; ++i)
+                x[i] = -12.0f + 1e-4f * (float)(bloc * 1000 + i);
+            Activation_sigmoide(1000, x, sig);
+            Activation_tanh(1000, x, th);
+            for (int i = 0; i < 1000; ++i) {
+                double es = fabs(sig[i] - 1.0 / (1.0 + exp(-(double)x[i])));
+                double et = fabs(th[i] - tanh((double)x[i]));
+                if (es > ecart_sig)  ecart_sig  = es;
+                if (et > ecart_tanh) ecart_tanh = et;
+            }
+        }
+        printf("%-10s | %14.3e | %14.3e\n", Activation_nom((Activation_niveau)a),
+               ecart_sig, ecart_tanh);
+    }
+
+    // 2) Rejeu : référence (noyau de référence, activations exactes) d'abord
+    const SOC_Modele *modele = SOC_modele_integre();
+    printf("\n%zu echantillons, noyau par defaut : %s\n", N, LSTM_noyau_nom(defaut_noyau));
+    if (modele->Pk_permanent > 0.0f)
+        printf("Kalman : Pk constant apres %ld pas (Pk = %.6e, Kk = %.6e)\n\n",
+               modele->pas_transitoire, modele->Pk_permanent, modele->Kk_permanent);
+    else
+        printf("Kalman : pas de point fixe de Pk, gain recalcule a chaque pas\n\n");
+    printf("%-10s | %-10s | %10s | %13s | %s\n",
+           "Activation", "Noyau", "ns / pas", "Ecart SOC max", "Verif");
+    printf("---------------------------------------------------------------\n");
+
+    int erreur = 0;
+    for (int a = 0; a < ACTIVATION_NB_NIVEAUX; ++a)
+    {
+        Activation_choisir((Activation_niveau)a);
+
+        for (int k = 0; k < LSTM_NB_NOYAUX; ++k)
+        {
+            if (LSTM_noyau_choisir((LSTM_noyau)k) != 0) continue;
+
+            int est_reference = (a == ACTIVATION_EXACTE && k == LSTM_NOYAU_REFERENCE);
+            float *cible = est_reference ? reference : sortie;
+            double t = rejouer(courant, tension, temperature, SOH, N, cible);
+
+            float ecart = 0.0f;
+            for (size_t i = 0; i < N; ++i) {
+                float e = fabsf(cible[i] - reference[i]);
+                if (!(e <= ecart)) ecart = e;       // NaN retenu
+            }
+
+            const char *verdict;
+            if (a == ACTIVATION_EXACTE) {
+                int ok = (ecart <= SOC_TOLERANCE_NOYAU);
+                if (!ok) erreur = 1;
+                verdict = ok ? "OK" : "ECHEC";
+            } else {
+                verdict = (ecart <= SOC_SEUIL_PRODUCTION) ? "OK" : "hors seuil";
+            }
+
+            printf("%-10s | %-10s | %10.1f | %13.3e | %s\n",
+                   Activation_nom((Activation_niveau)a), LSTM_noyau_nom((LSTM_noyau)k),
+                   1e9 * t / (double)N, ecart, verdict);
+        }
+    }
+    printf("\nTolerance niveau exact : %.1e sur le SOC, seuil production : %.1e\n",
+           SOC_TOLERANCE_NOYAU, SOC_SEUIL_PRODUCTION);
+
+    // 3) Lot de cellules, noyau par défaut
+    LSTM_noyau_choisir(defaut_noyau);
+    static const int tailles[] = {1, 8, 64, 512, 4096};
+    const int nb_tailles = (int)(sizeof(tailles) / sizeof(tailles[0]));
+
+    printf("\nLot de cellules (SOC_Batch), noyau %s\n\n", LSTM_noyau_nom(defaut_noyau));
+    printf("%-10s | %13s |", "Activation", "Ecart / step");
+    for (int i = 0; i < nb_tailles; ++i) printf(" N=%-6d", tailles[i]);
+    printf("  (ns par cellule et par pas)\n");
+    printf("--------------------------------------------------------------------------------------\n");
+    for (int a = 0; a < ACTIVATION_NB_NIVEAUX; ++a)
+    {
+        Activation_choisir((Activation_niveau)a);
+        float ecart = verifier_lot(courant, tension, temperature, SOH, N);
+        if (!(ecart >= 0.0f && ecart <= SOC_TOLERANCE_NOYAU)) erreur = 1;
+
+        printf("%-10s | %13.3e |", Activation_nom((Activation_niveau)a), ecart);
+        for (int i = 0; i < nb_tailles; ++i)
+            printf(" %8.1f", debit_lot(courant, tension, temperature, SOH, N, tailles[i]));
+        printf("\n");
+    }
+    printf("\nA 1 pas/s, cellules suivies par coeur = 1e9 / (ns par cellule et par pas)\n");
+
+    // 4) Produit spécialisé par taille, niveau rapide
+    Activation_choisir(ACTIVATION_RAPIDE);
+    if (comparer_specialisation(SOC_modele_integre(), courant, tension, temperature, SOH, N,
+                                reference, sortie) != 0)
+        erreur = 1;
+
+    static SOC_Modele modele_fichier;
+    if (argc > 1) {
+        if (SOC_Modele_charger(&modele_fichier, argv[1]) != 0) {
+            erreur = 1;
+        } else if (comparer_specialisation(&modele_fichier, courant, tension, temperature, SOH, N,
+                                           reference, sortie) != 0) {
+            erreur = 1;
+        }
+    }
+
+    // 5) Rejeu hors ligne, projection des entrées par blocs
+    printf("\nRejeu hors ligne (SOC_rejouer, blocs de %d pas)\n\n", SOC_BLOC_PROJECTION);
+    if (comparer_projection(SOC_modele_integre(), courant, tension, temperature, SOH, N,
+                            reference, sortie) != 0)
+        erreur = 1;
+
+    // 6) Noyaux générés, niveau exact
+    Activation_choisir(ACTIVATION_EXACTE);
+    printf("\nNoyaux generes (output/LSTM_genere.c) / chemin generique\n\n");
+    if (comparer_generes(courant, tension, temperature, SOH, N, reference, sortie) != 0)
+        erreur = 1;
+
+    Activation_choisir(defaut_activation);
+    LSTM_noyau_choisir(defaut_noyau);
+    free(reference);
+    free(sortie);
+    Free_donnees(courant, tension, temperature, SOH, SOC);
+    return erreur;
+}
@@ -0,0 +1,189 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "Read_Write.h"
+#include "SOC.h"
+#include "SOC_quantifie.h"
+#include "LSTM_noyau.h"
+#include "Activations.h"
+
+// ============================================================================
+// Banc d'essai du SOC quantifié (SOC_quantifie.h)
+//
+// 1) Écart absolu maximal des activations entières (table Q15) sur
+//    [-12, 12], par rapport au calcul en double.
+// 2) Rejeu de toute la série ../donnees : SOC_Q_step contre SOC_step
+//    (activations exactes, puis niveau embarqué, noyau par défaut) :
+//    temps moyen par pas (meilleur de BANC_REPETITIONS rejeux), écart de SOC maximal, moyen et final. L'écart
+//    maximal doit rester sous SOC_Q_TOLERANCE (sinon code de retour 1).
+// 3) Taille des paramètres, float contre quantifié.
+//
+// Usage : bench_soc_q [calibration.prtq] [reseau.prtw]
+//   sans calibration : calibration sur le rejeu, comme calibration_soc
+// ============================================================================
+
+#define SOC_Q_TOLERANCE 5e-3f
+#define BANC_REPETITIONS 3
+
+static double rejouer_float(const SOC_Modele *m, const float *courant, const float *tension,
+                            const float *temperature, const float *SOH, size_t N, float *sortie)
+{
+    double meilleur = 0.0;
+    for (int r = 0; r < BANC_REPETITIONS; ++r) {
+        SOC_Context ctx;
+        SOC_init_modele(&ctx, m);
+
+        double t0 = Horloge_secondes();
+        for (size_t k = 0; k < N; ++k)
+            sortie[k] = SOC_step(&ctx, courant[k], tension[k], temperature[k], SOH[k]);
+        double t = Horloge_secondes() - t0;
+        if (r == 0 || t < meilleur) meilleur = t;
+    }
+    return meilleur;
+}
+
+static double rejouer_Q(const SOC_Q_Modele *q, const float *courant, const float *tension,
+                        const float *temperature, const float *SOH, size_t N, float *sortie)
+{
+    double meilleur = 0.0;
+    for (int r = 0; r < BANC_REPETITIONS; ++r) {
+        SOC_Q_Context ctx;
+        SOC_Q_init(&ctx, q);
+
+        double t0 = Horloge_secondes();
+        for (size_t k = 0; k < N; ++k)
+            sortie[k] = SOC_Q_step(&ctx, courant[k], tension[k], temperature[k], SOH[k]);
+        double t = Horloge_secondes() - t0;
+        if (r == 0 || t < meilleur) meilleur = t;
+    }
+    return meilleur;
+}
+
+// Activations entières : mêmes formules que SOC_quantifie.c (table Q15)
+static void ecart_activations(const SOC_Q_Modele *q, double *ecart_sig, double *ecart_tanh)
+{
+    *ecart_sig = 0.0;
+    *ecart_tanh = 0.0;
+    for (int z = -12 * 4096; z <= 12 * 4096; ++z) {
+        int32_t u = z < 0 ? -z : z, i = u >> 7, r;
+        if (i >= SOC_Q_TABLE_N - 1) r = q->table_tanh[SOC_Q_TABLE_N - 1];
+        else r = q->table_tanh[i] + (((q->table_tanh[i + 1] - q->table_tanh[i]) * (u & 127) + 64) >> 7);
+        double th = (z < 0 ? -r : r) / 32767.0;
+
+        int32_t zs = z >> 1;
+        u = zs < 0 ? -zs : zs;
+        i = u >> 7;
+        if (i >= SOC_Q_TABLE_N - 1) r = q->table_tanh[SOC_Q_TABLE_N - 1];
+        else r = q->table_tanh[i] + (((q->table_tanh[i + 1] - q->table_tanh[i]) * (u & 127) + 64) >> 7);
+        double sig = ((32768 + (zs < 0 ? -r : r)) >> 1) / 32767.0;
+
+        double x = z / 4096.0;
+        if (fabs(th - tanh(x)) > *ecart_tanh) *ecart_tanh = fabs(th - tanh(x));
+        if (fabs(sig - 1.0 / (1.0 + exp(-x))) > *ecart_sig) *ecart_sig = fabs(sig - 1.0 / (1.0 + exp(-x)));
+    }
+}
+
+int main(int argc, char **argv)
+{
+    static SOC_Modele modele_fichier;
+    const SOC_Modele *modele = SOC_modele_integre();
+    if (argc > 2) {
+        if (SOC_Modele_charger(&modele_fichier, argv[2]) != 0) return 1;
+        modele = &modele_fichier;
+    }
+
+    const float *courant, *tension, *temperature, *SOH, *SOC;
+    Charge_donnees(&courant, &tension, &temperature, &SOH, &SOC);
+    size_t N = Nb_echantillons_donnees();
+    if (!courant || N == 0) {
+        printf("Erreur chargement des donnees\n");
+        return 1;
+    }
+
+    float *reference = (float *)malloc(N * sizeof(float));
+    float *sortie    = (float *)malloc(N * sizeof(float));
+    if (!reference || !sortie) {
+        perror("Erreur allocation");
+        free(reference);
+        free(sortie);
+        Free_donnees(courant, tension, temperature, SOH, SOC);
+        return 1;
+    }
+
+    // Calibration : fichier ou rejeu
+    SOC_Q_Calibration cal;
+    int erreur = (argc > 1) ? SOC_Q_Calibration_lire(argv[1], &cal)
+                            : SOC_Q_calibrer(&cal, modele, courant, tension, temperature, SOH, N);
+    static SOC_Q_Modele q;
+    if (!erreur) erreur = SOC_Q_Modele_quantifier(&q, modele, &cal);
+    if (erreur) {
+        free(reference);
+        free(sortie);
+        Free_donnees(courant, tension, temperature, SOH, SOC);
+        return 1;
+    }
+
+    printf("Reseau %s (%d unites), calibration %s sur %llu echantillons\n", q.nom, q.nb_unites,
+           (argc > 1) ? argv[1] : "du rejeu", (unsigned long long)cal.nb_echantillons);
+    printf("Entrees int16 : %.3g A, %.3g V, %.3g C pleine echelle | cellule Q%d\n",
+           32767.0 / q.entree_inv[0], 32767.0 / q.entree_inv[1], 32767.0 / q.entree_inv[2],
+           q.bits_cellule);
+    if (q.Pk_permanent > 0)
+        printf("Kalman Q30 : Pk constant = %.6e, Kk = %.6e\n\n",
+               q.Pk_permanent / 1073741824.0, q.Kk_permanent / 1073741824.0);
+    else
+        printf("Kalman Q30 : pas de point fixe de Pk, gain recalcule a chaque pas\n\n");
+
+    // 1) Activations entières
+    double ecart_sig, ecart_tanh;
+    ecart_activations(&q, &ecart_sig, &ecart_tanh);
+    printf("Activations Q15 : ecart sigmoide %.3e | ecart tanh %.3e\n\n", ecart_sig, ecart_tanh);
+
+    // 2) Rejeu : quantifié contre float
+    double t_Q = rejouer_Q(&q, courant, tension, temperature, SOH, N, sortie);
+    printf("%zu echantillons, noyau float : %s\n\n", N, LSTM_noyau_nom(LSTM_noyau_actif()));
+    printf("%-22s | %10s | %13s | %13s | %13s\n",
+           "Chemin", "ns / pas", "Ecart SOC max", "Ecart moyen", "Ecart final");
+    printf("--------------------------------------------------------------------------------------\n");
+    printf("%-22s | %10.1f | %13s | %13s | %13s\n", "SOC_Q_step (entiers)", 1e9 * t_Q / (double)N,
+           "-", "-", "-");
+
+    static const Activation_niveau niveaux[2] = { ACTIVATION_EXACTE, ACTIVATION_EMBARQUEE };
+    for (int a = 0; a < 2; ++a) {
+        Activation_choisir(niveaux[a]);
+        double t = rejouer_float(modele, courant, tension, temperature, SOH, N, reference);
+
+        double somme = 0.0;
+        float ecart = 0.0f;
+        for (size_t i = 0; i < N; ++i) {
+            float e = fabsf(sortie[i] - reference[i]);
+            if (!(e <= ecart)) ecart = e;
+            somme += e;
+        }
+        if (a == 0 && !(ecart <= SOC_Q_TOLERANCE)) erreur = 1;
+
+        char nom[32];
+        snprintf(nom, sizeof(nom), "SOC_step (%s)", Activation_nom(niveaux[a]));
+        printf("%-22s | %10.1f | %13.3e | %13.3e | %13.3e   x%.1f\n", nom, 1e9 * t / (double)N,
+               ecart, somme / (double)N, fabsf(sortie[N - 1] - reference[N - 1]), t / t_Q);
+    }
+    Activation_choisir(ACTIVATION_EXACTE);
+    printf("(xN : temps du chemin float / temps du chemin entier)\n");
+
+    // 3) Taille des paramètres
+    printf("\nPoids des portes : float %zu octets | int16/int8 %zu octets (x%.1f)\n",
+           SOC_Q_octets_poids(&q, 0), SOC_Q_octets_poids(&q, 1),
+           (double)SOC_Q_octets_poids(&q, 0) / (double)SOC_Q_octets_poids(&q, 1));
+    printf("Modele complet   : float %zu octets | quantifie %zu octets (x%.1f, table comprise)\n",
+           SOC_Q_octets_modele(&q, 0), SOC_Q_octets_modele(&q, 1),
+           (double)SOC_Q_octets_modele(&q, 0) / (double)SOC_Q_octets_modele(&q, 1));
+
+    printf("\nVerification : ecart SOC max %s %.0e\n", erreur ? ">" : "<=", SOC_Q_TOLERANCE);
+
+    free(reference);
+    free(sortie);
+    Free_donnees(courant, tension, temperature, SOH, SOC);
+    return erreur;
+}
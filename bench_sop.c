@@ -0,0 +1,221 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "Read_Write.h"
+#include "SOP.h"
+
+// ============================================================================
+// Banc d'essai du SOP sur ../donnees
+//
+// horizons : rejeu par SOP_step_horizons (limites de charge et de décharge
+//   à 2, 10, 30 et 60 s), comparées à une recherche par sécante par horizon
+//   et par sens sur le même état ; dernières limites affichées.
+// sens : limites de charge et de décharge à chaque pas (SOP_step_deux_sens),
+//   séquentielles puis sur le thread de travail ; temps par échantillon
+//   contre SOP_step seul, écart entre les deux modes, écart du courant
+//   retenu avec SOP_step seul (recherche principale remplacée par la limite
+//   du sens de la consigne). À lancer sur la cible avant de compiler la
+//   boucle principale avec MODE_SOP_DEUX_SENS=SOP_DEUX_SENS_THREADS.
+//
+// Usage : bench_sop horizons|sens [echantillons]
+// ============================================================================
+
+#define BANC_ECHANTILLONS_DEFAUT 10000
+
+/* Limites multi-horizons : recherche commune (SOP_courants_horizons) contre
+   une sécante par horizon et par sens (SOP_courant_admissible d'un modèle
+   compilé à cet horizon), sur l'état de chaque pas du rejeu */
+static int banc_horizons(const float *courant, const float *tension,
+                         const float *temperature, const float *SOH,
+                         const float *SOC, size_t N)
+{
+    const SOP_Modele *m = SOP_modele_defaut();
+    const SOP_Parametres *p = &m->param;
+    const int nb = p->nb_horizons;
+    SOP_Limite limites[SOP_HORIZONS_MAX];
+
+    static SOP_Modele separes[SOP_HORIZONS_MAX];
+    for (int k = 0; k < nb; ++k) {
+        SOP_Parametres q = *p;
+        q.horizon     = p->horizons[k];
+        q.nb_horizons = 0;
+        if (SOP_Modele_compiler(&separes[k], &q) != 0) return 1;
+    }
+
+    double t_commun = 0.0, t_separe = 0.0;
+    size_t evaluations_commun = 0, evaluations_separe = 0;
+    float  ecart_max[SOP_HORIZONS_MAX] = { 0.0f };
+    double ecart_somme[SOP_HORIZONS_MAX] = { 0.0 };
+    size_t nb_au_dessus = 0, nb_en_dessous = 0, n = 0;
+    const float bornes[2] = { p->I_min, p->I_max };     /* charge, décharge */
+
+    SOP_Context ctx;
+    Detection_Context detection;
+    SOP_init_modele(&ctx, m);
+    SOP_demarrer(&ctx, SOC[0], temperature[0], tension[0]);
+    Detection_init(&detection);
+    for (size_t i = 2; i < N - 1; ++i) {
+        const int etat = Detection_step(&detection, -courant[i]);
+        float I[2][SOP_HORIZONS_MAX], I_separe[2][SOP_HORIZONS_MAX];
+
+        double t0 = Horloge_secondes();
+        for (int sens = 0; sens < 2; ++sens) {
+            SOP_courants_horizons(m, ctx.SOC, SOH[i], ctx.T1, ctx.T2, ctx.Ir, etat,
+                                  bornes[sens], I[sens]);
+            evaluations_commun += (size_t)SOP_evaluations();
+        }
+        double t1 = Horloge_secondes();
+        for (int sens = 0; sens < 2; ++sens)
+            for (int k = 0; k < nb; ++k) {
+                I_separe[sens][k] = SOP_courant_admissible(&separes[k], ctx.SOC, SOH[i],
+                                                           ctx.T1, ctx.T2, ctx.Ir, etat,
+                                                           bornes[sens]);
+                evaluations_separe += (size_t)SOP_evaluations();
+            }
+        t_separe += Horloge_secondes() - t1;
+        t_commun += t1 - t0;
+
+        for (int sens = 0; sens < 2; ++sens)
+            for (int k = 0; k < nb; ++k) {
+                float e = fabsf(I[sens][k] - I_separe[sens][k]);
+                ecart_somme[k] += e;
+                if (!(e <= ecart_max[k])) ecart_max[k] = e;
+                if (fabsf(I[sens][k]) > fabsf(I_separe[sens][k]) + SOP_GRILLE_TOLERANCE)
+                    ++nb_au_dessus;
+                if (fabsf(I[sens][k]) < fabsf(I_separe[sens][k]) - SOP_GRILLE_TOLERANCE)
+                    ++nb_en_dessous;
+            }
+        ++n;
+
+        float charge, decharge;
+        SOP_step_horizons(&ctx, etat, courant[i], tension[i], temperature[i], SOH[i], SOC[i],
+                          &charge, &decharge, limites);
+    }
+
+    double nn = (double)n;
+    printf("Limites multi-horizons (charge + decharge), %zu echantillons\n", n);
+    printf("  Latence par echantillon : recherche commune %.2f us | secante par horizon %.2f us (x%.2f)\n",
+           1e6 * t_commun / nn, 1e6 * t_separe / nn, t_separe / t_commun);
+    printf("  Evaluations par echantillon : commune (tous horizons) %.1f | secantes %.1f\n",
+           (double)evaluations_commun / nn, (double)evaluations_separe / nn);
+    for (int k = 0; k < nb; ++k)
+        printf("  Horizon %3d pas : ecart moyen %.3e A | max %.3e A\n", p->horizons[k],
+               ecart_somme[k] / (2.0 * nn), ecart_max[k]);
+    printf("  Commun au-dessus de la secante (> %.2f A) : %zu | en dessous : %zu\n",
+           (double)SOP_GRILLE_TOLERANCE, nb_au_dessus, nb_en_dessous);
+
+    printf("\n  Dernier echantillon : horizon | SOP charge (W) | SOP decharge (W)\n");
+    for (int k = 0; k < nb; ++k)
+        printf("  %27d | %14.3f | %16.3f\n", limites[k].horizon,
+               limites[k].SOP_charge, limites[k].SOP_decharge);
+    return 0;
+}
+
+/* Rejeu complet ; d == NULL : SOP_step seul. Courant retenu dans
+   candidat[i]. Rend le temps total (s) */
+static double rejeu_deux_sens(const float *courant, const float *tension,
+                              const float *temperature, const float *SOH,
+                              const float *SOC, size_t N, SOP_Deux_sens *d,
+                              float *I_charge, float *I_decharge, float *candidat)
+{
+    SOP_Context ctx;
+    SOP_init_modele(&ctx, SOP_modele_defaut());
+    SOP_demarrer(&ctx, SOC[0], temperature[0], tension[0]);
+    double t0 = Horloge_secondes();
+    for (size_t i = 2; i < N - 1; ++i) {
+        float charge, decharge;
+        if (d)
+            candidat[i] = SOP_step_deux_sens(&ctx, d, -1, courant[i], tension[i], temperature[i],
+                                             SOH[i], SOC[i], &charge, &decharge,
+                                             &I_charge[i], &I_decharge[i]);
+        else
+            candidat[i] = SOP_step(&ctx, courant[i], tension[i], temperature[i], SOH[i], SOC[i],
+                                   &charge, &decharge);
+    }
+    return Horloge_secondes() - t0;
+}
+
+static int banc_sens(const float *courant, const float *tension,
+                     const float *temperature, const float *SOH,
+                     const float *SOC, size_t N)
+{
+    float *I = (float *)calloc(7 * N, sizeof(float));
+    if (!I) {
+        perror("Erreur allocation");
+        return 1;
+    }
+    float *I_charge = I, *I_decharge = I + N;           /* séquentiel */
+    float *J_charge = I + 2 * N, *J_decharge = I + 3 * N;   /* thread */
+    float *C_seul = I + 4 * N, *C_seq = I + 5 * N, *C_par = I + 6 * N;
+
+    SOP_Deux_sens seq, par;
+    SOP_deux_sens_ouvrir(&seq, NULL, SOP_DEUX_SENS_SEQUENTIEL);
+    if (SOP_deux_sens_ouvrir(&par, NULL, SOP_DEUX_SENS_THREADS) != 0) {
+        free(I);
+        return 1;
+    }
+
+    double t_seul = rejeu_deux_sens(courant, tension, temperature, SOH, SOC, N, NULL,
+                                    NULL, NULL, C_seul);
+    double t_seq  = rejeu_deux_sens(courant, tension, temperature, SOH, SOC, N, &seq,
+                                    I_charge, I_decharge, C_seq);
+    double t_par  = rejeu_deux_sens(courant, tension, temperature, SOH, SOC, N, &par,
+                                    J_charge, J_decharge, C_par);
+    SOP_deux_sens_fermer(&par);
+    SOP_deux_sens_fermer(&seq);
+
+    float  ecart = 0.0f, ecart_candidat = 0.0f;
+    for (size_t i = 2; i < N - 1; ++i) {
+        float e = fmaxf(fabsf(I_charge[i] - J_charge[i]), fabsf(I_decharge[i] - J_decharge[i]));
+        e = fmaxf(e, fabsf(C_seq[i] - C_par[i]));
+        if (!(e <= ecart)) ecart = e;
+        float c = fabsf(C_seq[i] - C_seul[i]);
+        if (!(c <= ecart_candidat)) ecart_candidat = c;
+    }
+
+    double n = (double)(N - 3);
+    printf("Limites des deux sens, %zu echantillons, %ld coeur(s)\n",
+           N - 3, sysconf(_SC_NPROCESSORS_ONLN));
+    printf("  Temps par echantillon : SOP_step seul %.2f us | deux sens sequentiels %.2f us"
+           " | deux sens thread %.2f us\n", 1e6 * t_seul / n, 1e6 * t_seq / n, 1e6 * t_par / n);
+    printf("  Surcout des deux sens : sequentiel %.2f us | thread %.2f us\n",
+           1e6 * (t_seq - t_seul) / n, 1e6 * (t_par - t_seul) / n);
+    printf("  Ecart max sequentiel / thread : %.3e A\n", ecart);
+    printf("  Ecart max du courant retenu / SOP_step seul : %.3e A\n", ecart_candidat);
+    printf("  Thread %s que sequentiel sur cette machine%s\n",
+           t_par < t_seq ? "plus rapide" : "plus lent",
+           t_par < t_seq ? " : MODE_SOP_DEUX_SENS=SOP_DEUX_SENS_THREADS utile" : "");
+    printf("  Dernier echantillon : charge %.3f A | decharge %.3f A\n",
+           I_charge[N - 2], I_decharge[N - 2]);
+
+    free(I);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || (strcmp(argv[1], "horizons") != 0 && strcmp(argv[1], "sens") != 0)) {
+        printf("Usage : bench_sop horizons|sens [echantillons]\n");
+        return 1;
+    }
+    size_t nb_max = (argc > 2) ? (size_t)atol(argv[2]) : BANC_ECHANTILLONS_DEFAUT;
+
+    const float *courant, *tension, *temperature, *SOH, *SOC;
+    Charge_donnees(&courant, &tension, &temperature, &SOH, &SOC);
+    size_t N = Nb_echantillons_donnees();
+    if (!courant || N < 4) {
+        printf("Erreur chargement des donnees\n");
+        return 1;
+    }
+    if (N > nb_max) N = nb_max;
+
+    int erreur = (strcmp(argv[1], "sens") == 0)
+               ? banc_sens(courant, tension, temperature, SOH, SOC, N)
+               : banc_horizons(courant, tension, temperature, SOH, SOC, N);
+
+    Free_donnees(courant, tension, temperature, SOH, SOC);
+    return erreur;
+}
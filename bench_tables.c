@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "Read_Write.h"
+#include "Table_uniforme.h"
+#include "Interpolateur.h"
+#include "sur_tension.h"
+#include "SOE.h"
+
+// ============================================================================
+// Banc d'essai des tables d'interpolation
+//
+// Pour chaque table compilée par les X_init : nombre de points, pas et écart
+// maximal avec la table d'origine. Puis comparaison de débit sur la table
+// OCV de charge entre interp1Drapide, l'interpolateur à intervalle mémorisé
+// et la table à pas constant, pour des SOC tirés au hasard puis pour une
+// trajectoire lente (marche aléatoire de ±0.0003 par pas, comme en 1 Hz).
+//
+// Usage : bench_tables [nb_points]   (défaut : 1000000)
+// ============================================================================
+
+extern const float X_OCV_global[104];
+extern const float Y_OCV_charge_global[104];
+
+static void afficher(const char *nom, const Table_uniforme *t)
+{
+    printf("%-22s | %6d | %10.6f | %12.3e\n", nom, t->n, t->pas, t->erreur_max);
+}
+
+int main(int argc, char **argv)
+{
+    long nb = (argc > 1) ? atol(argv[1]) : 1000000;
+    if (nb < 1) nb = 1;
+
+    TENSION_Context tension;
+    SOE_Context     soe;
+    TENSION_init(&tension);
+    SOE_init(&soe);
+
+    printf("%-22s | %6s | %10s | %12s\n", "Table", "Points", "Pas", "Erreur max");
+    printf("---------------------------------------------------------------\n");
+    afficher("OCV charge",             tension.OCV_charge);
+    afficher("OCV decharge",           tension.OCV_decharge);
+    afficher("Loi integ. OCV (SOE)",   soe.LOI_INTEG_OCV_DECHARGE);
+
+    float *soc = (float *)malloc((size_t)nb * sizeof(float));
+    if (!soc) {
+        perror("Erreur allocation");
+        return 1;
+    }
+
+    srand(1234);
+    for (int trajectoire = 0; trajectoire < 2; ++trajectoire)
+    {
+        if (trajectoire == 0) {
+            for (long i = 0; i < nb; ++i)
+                soc[i] = (float)rand() / (float)RAND_MAX;
+        } else {
+            float s = 0.5f;
+            for (long i = 0; i < nb; ++i) {
+                s += 0.0003f * (2.0f * (float)rand() / (float)RAND_MAX - 1.0f);
+                if (s < 0.0f) s = 0.0f;
+                if (s > 1.0f) s = 1.0f;
+                soc[i] = s;
+            }
+        }
+
+        Interpolateur it;
+        Interpolateur_init(&it, X_OCV_global, Y_OCV_charge_global, 104);
+
+        // Débit : recherche linéaire / intervalle mémorisé / indice direct
+        volatile float puits;
+        float somme;
+        double t[3];
+
+        somme = 0.0f;
+        double t0 = Horloge_secondes();
+        for (long i = 0; i < nb; ++i)
+            somme += interp1Drapide(X_OCV_global, Y_OCV_charge_global, 104, soc[i]);
+        t[0] = Horloge_secondes() - t0;
+        puits = somme;
+
+        somme = 0.0f;
+        t0 = Horloge_secondes();
+        for (long i = 0; i < nb; ++i)
+            somme += Interpolateur_eval(&it, soc[i]);
+        t[1] = Horloge_secondes() - t0;
+        puits = somme;
+
+        somme = 0.0f;
+        t0 = Horloge_secondes();
+        for (long i = 0; i < nb; ++i)
+            somme += Table_uniforme_eval(tension.OCV_charge, soc[i]);
+        t[2] = Horloge_secondes() - t0;
+        puits = somme;
+        (void)puits;
+
+        // Vérification : intervalle mémorisé identique bit à bit, écart de
+        // la table à pas constant
+        long  differences = 0;
+        float ecart = 0.0f;
+        Interpolateur_init(&it, X_OCV_global, Y_OCV_charge_global, 104);
+        for (long i = 0; i < nb; ++i) {
+            float ref = interp1Drapide(X_OCV_global, Y_OCV_charge_global, 104, soc[i]);
+            if (Interpolateur_eval(&it, soc[i]) != ref) ++differences;
+            float e = fabsf(Table_uniforme_eval(tension.OCV_charge, soc[i]) - ref);
+            if (e > ecart) ecart = e;
+        }
+
+        printf("\nOCV charge, %ld points, %s :\n", nb,
+               trajectoire ? "trajectoire lente" : "SOC aleatoires");
+        printf("  interp1Drapide        : %8.2f ns/appel\n", 1e9 * t[0] / nb);
+        printf("  intervalle memorise   : %8.2f ns/appel  (x%.1f, %ld differences)\n",
+               1e9 * t[1] / nb, t[0] / t[1], differences);
+        printf("  pas constant          : %8.2f ns/appel  (x%.1f, ecart max %.3e V)\n",
+               1e9 * t[2] / nb, t[0] / t[2], ecart);
+    }
+
+    free(soc);
+    return 0;
+}
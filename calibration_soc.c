@@ -0,0 +1,51 @@
+#include <stdio.h>
+
+#include "Read_Write.h"
+#include "SOC.h"
+#include "SOC_quantifie.h"
+
+// ============================================================================
+// Calibration du SOC quantifié (SOC_quantifie.h)
+//
+// Rejoue toute la série ../donnees avec SOC_step en float et relève les
+// maximums des entrées brutes [I, U, T] et de la cellule c ; les échelles
+// int16 et le format de c en sont déduits (avec la marge SOC_Q_MARGE) à la
+// quantification.
+//
+// Usage : calibration_soc sortie.prtq [reseau.prtw]
+//   sans reseau.prtw : réseau intégré à SOC.c
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        printf("Usage : calibration_soc sortie.prtq [reseau.prtw]\n");
+        return 1;
+    }
+
+    static SOC_Modele modele_fichier;
+    const SOC_Modele *modele = SOC_modele_integre();
+    if (argc > 2) {
+        if (SOC_Modele_charger(&modele_fichier, argv[2]) != 0) return 1;
+        modele = &modele_fichier;
+    }
+
+    const float *courant, *tension, *temperature, *SOH, *SOC;
+    Charge_donnees(&courant, &tension, &temperature, &SOH, &SOC);
+    size_t N = Nb_echantillons_donnees();
+    if (!courant || N == 0) {
+        printf("Erreur chargement des donnees\n");
+        return 1;
+    }
+
+    SOC_Q_Calibration cal;
+    int erreur = SOC_Q_calibrer(&cal, modele, courant, tension, temperature, SOH, N);
+    Free_donnees(courant, tension, temperature, SOH, SOC);
+    if (erreur || SOC_Q_Calibration_ecrire(argv[1], &cal) != 0) return 1;
+
+    printf("Reseau %s (%u unites), %llu echantillons -> %s\n", cal.nom, cal.nb_unites,
+           (unsigned long long)cal.nb_echantillons, argv[1]);
+    printf("max |I| = %.4g A | max |U| = %.4g V | max |T| = %.4g C | max |c| = %.4g\n",
+           cal.entree_max[0], cal.entree_max[1], cal.entree_max[2], cal.cellule_max);
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Read_Write.h"
+#include "Conteneur.h"
+
+// ============================================================================
+// Conversion du jeu historique courant/tension/temperature/SOH/SOC.bin
+// vers un conteneur .prt unique.
+//
+// Usage : conversion_donnees [-z] [dossier_entree] [fichier_sortie]
+//   par défaut : ../donnees  →  ../donnees/donnees.prt
+//   -z : canaux compressés sans perte (CONTENEUR_F32_XOR) ; les lecteurs
+//        décodent à la volée, au prix de la vue directe en mémoire
+//
+// Contrairement à l'ancien fread, une longueur incohérente est une erreur :
+// aucun conteneur n'est écrit.
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    int compresse = (argc > 1 && strcmp(argv[1], "-z") == 0);
+    if (compresse) { argc--; argv++; }
+
+    const char *dossier = (argc > 1) ? argv[1] : "../donnees";
+    char sortie_defaut[256];
+    snprintf(sortie_defaut, sizeof(sortie_defaut), "%s/%s", dossier, DONNEES_CONTENEUR);
+    const char *sortie  = (argc > 2) ? argv[2] : sortie_defaut;
+
+    const char *noms[] = {"courant", "tension", "temperature", "SOH", "SOC"};
+    const int nb_canaux = 5;
+    const double periode_s = 1.0;   // acquisition à 1 Hz
+
+    const void *donnees[5] = {NULL};
+    uint32_t    types[5];
+    size_t      N = 0;
+    int         erreur = 0;
+
+    for (int k = 0; k < nb_canaux && !erreur; ++k) {
+        char chemin[256];
+        snprintf(chemin, sizeof(chemin), "%s/%s.bin", dossier, noms[k]);
+
+        size_t taille = 0;
+        donnees[k] = Mappe_fichier(chemin, &taille);
+        types[k]   = compresse ? CONTENEUR_F32_XOR : CONTENEUR_F32;
+        if (!donnees[k]) {
+            erreur = 1;
+            break;
+        }
+
+        if (taille % sizeof(float) != 0) {
+            printf("Erreur : %s n'a pas une taille multiple de %zu octets\n", chemin, sizeof(float));
+            erreur = 1;
+        } else if (k == 0) {
+            N = taille / sizeof(float);
+        } else if (taille / sizeof(float) != N) {
+            printf("Erreur : %s contient %zu elements au lieu de %zu\n",
+                   chemin, taille / sizeof(float), N);
+            erreur = 1;
+        }
+    }
+
+    if (!erreur) {
+        erreur = Conteneur_ecrire(sortie, periode_s, N, nb_canaux, noms, types, donnees);
+        if (!erreur)
+            printf("%s : %d canaux, %zu echantillons\n", sortie, nb_canaux, N);
+    }
+
+    for (int k = 0; k < nb_canaux; ++k)
+        Demappe_fichier(donnees[k]);
+
+    return erreur;
+}
@@ -0,0 +1,152 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "Read_Write.h"
+#include "Reseau_poids.h"
+
+// ============================================================================
+// Conversion des tableaux de poids d'une source C / .ino vers un fichier
+// de poids .prtw (Reseau_poids.h).
+//
+// Usage : conversion_reseau source sortie.prtw [nom]
+//   ex. : conversion_reseau SOC.c ../donnees/reseau_soc.prtw soc_20
+//         conversion_reseau SOC_Aurore.c reseau_aurore.prtw aurore_12
+//
+// Les tableaux sont cherchés sous les noms des sources actuelles (Wi, Wf,
+// Wg, Wo, Ri..., bi..., WFC, bFC, MOY, ECART_TYPE) ; les états initiaux
+// sous HT_INIT / CT_INIT, ou ht / ct. Les dimensions sont déduites de MOY
+// (E), bi (H) et bFC (O) ; toute longueur incohérente est une erreur.
+// ============================================================================
+
+#define VALEURS_MAX 8192
+
+static int est_identifiant(char c)
+{
+    return isalnum((unsigned char)c) || c == '_';
+}
+
+static const char *sauter_blancs(const char *p)
+{
+    for (;;) {
+        while (isspace((unsigned char)*p)) ++p;
+        if (p[0] == '/' && p[1] == '/') {
+            while (*p && *p != '\n') ++p;
+        } else if (p[0] == '/' && p[1] == '*') {
+            const char *fin = strstr(p + 2, "*/");
+            p = fin ? fin + 2 : p + strlen(p);
+        } else {
+            return p;
+        }
+    }
+}
+
+// Initialiseur "nom[...] = { v0, v1, ... }" : nombre de valeurs lues,
+// 0 si le tableau est absent, -1 si l'initialiseur est illisible
+static int lire_tableau(const char *texte, const char *nom, float *valeurs, int max)
+{
+    const size_t n = strlen(nom);
+
+    for (const char *p = strstr(texte, nom); p; p = strstr(p + 1, nom))
+    {
+        if ((p > texte && est_identifiant(p[-1])) || est_identifiant(p[n])) continue;
+
+        const char *q = sauter_blancs(p + n);
+        if (*q == '[') {
+            q = strchr(q, ']');
+            if (!q) return -1;
+            q = sauter_blancs(q + 1);
+        }
+        if (*q != '=') continue;
+        q = sauter_blancs(q + 1);
+        if (*q != '{') continue;        // affectation, pas une déclaration
+
+        int nb = 0;
+        q = sauter_blancs(q + 1);
+        while (*q != '}') {
+            char *fin;
+            float v = strtof(q, &fin);
+            if (fin == q || nb >= max) return -1;
+            valeurs[nb++] = v;
+            q = fin;
+            if (*q == 'f' || *q == 'F') ++q;
+            q = sauter_blancs(q);
+            if (*q == ',') q = sauter_blancs(q + 1);
+        }
+        return nb;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3) {
+        printf("Usage : conversion_reseau source sortie.prtw [nom]\n");
+        return 1;
+    }
+    const char *source = argv[1];
+    const char *sortie = argv[2];
+    const char *nom    = (argc > 3) ? argv[3] : "reseau";
+
+    // Texte de la source, terminé par '\0'
+    size_t taille = 0;
+    const char *projection = (const char *)Mappe_fichier(source, &taille);
+    if (!projection) return 1;
+    char *texte = (char *)malloc(taille + 1);
+    if (!texte) {
+        perror("Erreur allocation");
+        Demappe_fichier(projection);
+        return 1;
+    }
+    memcpy(texte, projection, taille);
+    texte[taille] = '\0';
+    Demappe_fichier(projection);
+
+    static float valeurs[RESEAU_NB_BLOCS][VALEURS_MAX];
+    int nb[RESEAU_NB_BLOCS];
+    int erreur = 0;
+
+    for (int b = 0; b < RESEAU_NB_BLOCS && !erreur; ++b) {
+        const char *nom_bloc = Reseau_nom_bloc((Reseau_bloc)b);
+        nb[b] = lire_tableau(texte, nom_bloc, valeurs[b], VALEURS_MAX);
+
+        // États initiaux : ht / ct dans les sources historiques
+        if (nb[b] == 0 && b == RESEAU_HT_INIT) nb[b] = lire_tableau(texte, "ht", valeurs[b], VALEURS_MAX);
+        if (nb[b] == 0 && b == RESEAU_CT_INIT) nb[b] = lire_tableau(texte, "ct", valeurs[b], VALEURS_MAX);
+
+        if (nb[b] <= 0) {
+            printf("Erreur : tableau %s %s dans %s\n", nom_bloc,
+                   nb[b] == 0 ? "absent" : "illisible", source);
+            erreur = 1;
+        }
+    }
+
+    uint32_t E = 0, H = 0, O = 0;
+    if (!erreur) {
+        E = (uint32_t)nb[RESEAU_MOY];
+        H = (uint32_t)nb[RESEAU_BI];
+        O = (uint32_t)nb[RESEAU_BFC];
+        for (int b = 0; b < RESEAU_NB_BLOCS; ++b) {
+            size_t attendu = Reseau_taille_bloc((Reseau_bloc)b, E, H, O);
+            if ((size_t)nb[b] != attendu) {
+                printf("Erreur : %s contient %d valeurs au lieu de %zu\n",
+                       Reseau_nom_bloc((Reseau_bloc)b), nb[b], attendu);
+                erreur = 1;
+            }
+        }
+    }
+
+    if (!erreur) {
+        const float *blocs[RESEAU_NB_BLOCS];
+        for (int b = 0; b < RESEAU_NB_BLOCS; ++b) blocs[b] = valeurs[b];
+        erreur = Reseau_ecrire(sortie, nom, E, H, O, blocs);
+    }
+
+    free(texte);
+    if (erreur) return 1;
+
+    printf("%s -> %s : reseau %s, %u entrees, %u unites, %u sorties\n",
+           source, sortie, nom, E, H, O);
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "Read_Write.h"
+#include "Sortie_resultats.h"
+
+// ============================================================================
+// Extraction d'un fichier de résultats .res vers un .bin par canal
+// (même format que l'ancien Ecriture_result : float bruts), pour les
+// scripts MATLAB de post-traitement.
+//
+// Usage : extraction_resultats [fichier_resultats]
+//   par défaut : RESULTATS_vscode.res  →  <canal>.bin dans le dossier courant
+//
+// Fonctionne aussi sur un fichier partiel (exécution interrompue) :
+// seuls les blocs complets sont extraits.
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    const char *chemin = (argc > 1) ? argv[1] : "RESULTATS_vscode.res";
+
+    Sortie_entete e;
+    if (Sortie_lire_entete(chemin, &e) != 0) return 1;
+
+    int erreur = 0;
+    for (uint32_t c = 0; c < e.nb_canaux && !erreur; ++c) {
+        char nom[SORTIE_NOM_MAX + 1];
+        snprintf(nom, sizeof(nom), "%.*s", SORTIE_NOM_MAX, e.noms[c]);
+
+        float *valeurs = NULL;
+        size_t nb = 0;
+        if (Sortie_lire_canal(chemin, nom, &valeurs, &nb) != 0) {
+            erreur = 1;
+        } else if (nb == 0) {
+            printf("Canal %s : aucune ligne complete\n", nom);
+        } else {
+            erreur = Ecriture_result(valeurs, (int)nb, nom);
+        }
+        free(valeurs);
+    }
+
+    return erreur;
+}
@@ -0,0 +1,258 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "Reseau_poids.h"
+#include "SOC.h"
+
+// ============================================================================
+// Génération de noyaux LSTM déroulés pour des réseaux fixés (LSTM_genere.h)
+//
+// Usage : generation_lstm sortie.c nom=reseau.prtw [nom=reseau.prtw ...]
+//   ex. : generation_lstm output/LSTM_genere.c soc_20=output/reseau_soc_20.prtw
+//                                              ino_12=output/reseau_ino_12.prtw
+//
+// Chaque réseau est compilé comme par SOC_Modele_charger (normalisation
+// repliée, mêmes arrondis) ; on écrit pour chacun :
+//   - les poids compilés en tableaux static const alignés, rangés par
+//     colonne sans lignes de complément : W[E+H][4H] ;
+//   - un pas où chaque ligne est une seule expression b + W[0] x0 + ...
+//     (même ordre d'addition que le noyau portable), puis les activations
+//     (au niveau rapide : une boucle à borne constante, vectorisée) ;
+//     instancié pour le jeu de base et, sur x86, pour AVX2 + FMA quand
+//     c'est le noyau LSTM actif ;
+//   - la couche de sortie déroulée ;
+//   - les blocs du réseau source, pour recompiler le modèle générique ;
+//   - la table LSTM_genere_variantes.
+// ============================================================================
+
+#define VARIANTES_MAX 16
+
+typedef struct
+{
+    char         nom[RESEAU_NOM_MAX];
+    Reseau_poids reseau;
+    SOC_Modele   modele;
+} Variante;
+
+static int nom_valide(const char *nom)
+{
+    if (!nom[0] || isdigit((unsigned char)nom[0])) return 0;
+    for (const char *c = nom; *c; ++c)
+        if (!isalnum((unsigned char)*c) && *c != '_') return 0;
+    return 1;
+}
+
+// Tableau de n floats, 4 valeurs par ligne (9 chiffres : float exact)
+static void ecrire_valeurs(FILE *f, const float *v, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        fprintf(f, "%s%.8ef,%s", (i % 4 == 0) ? "    " : " ", v[i],
+                (i % 4 == 3 || i + 1 == n) ? "\n" : "");
+}
+
+static void ecrire_variante(FILE *f, const Variante *v)
+{
+    const char *id = v->nom;
+    const LSTM_poids *p = &v->modele.lstm;
+    const int E   = p->nb_entrees;
+    const int H   = p->nb_unites;
+    const int pad = p->nb_unites_pad;
+    const int NL  = 4 * H;          // lignes sans complément
+    const int NC  = E + H;
+
+    fprintf(f, "// ============================================================================\n");
+    fprintf(f, "// %s : %d entrees, %d unites (reseau %s)\n", id, E, H, v->reseau.entete->nom);
+    fprintf(f, "// ============================================================================\n\n");
+
+    // Poids compilés : colonne j, ligne l = porte * H + unité
+    fprintf(f, "_Alignas(32) static const float %s_W[%d][%d] = {\n", id, NC, NL);
+    for (int j = 0; j < NC; ++j) {
+        float colonne[4 * LSTM_MAX_UNITES];
+        for (int l = 0; l < NL; ++l)
+            colonne[l] = p->W[j * p->nb_lignes + (l / H) * pad + l % H];
+        fprintf(f, "  {\n");
+        ecrire_valeurs(f, colonne, (size_t)NL);
+        fprintf(f, "  },\n");
+    }
+    fprintf(f, "};\n\n");
+
+    float biais[4 * LSTM_MAX_UNITES];
+    for (int l = 0; l < NL; ++l)
+        biais[l] = p->b[(l / H) * pad + l % H];
+    fprintf(f, "_Alignas(32) static const float %s_b[%d] = {\n", id, NL);
+    ecrire_valeurs(f, biais, (size_t)NL);
+    fprintf(f, "};\n\n");
+
+    fprintf(f, "_Alignas(32) static const float %s_WFC[%d] = {\n", id, H);
+    ecrire_valeurs(f, v->modele.WFC, (size_t)H);
+    fprintf(f, "};\n\n");
+    fprintf(f, "static const float %s_bFC = %.8ef;\n\n", id, v->modele.bFC);
+
+    // Pas : une expression par ligne de portes
+    fprintf(f, "static inline __attribute__((always_inline))\n");
+    fprintf(f, "void %s_pas_corps(const float *restrict x, float *restrict h, float *restrict c)\n{\n", id);
+    fprintf(f, "    float acc[%d];\n", NL);
+    fprintf(f, "    float it[%d], ft[%d], gt[%d], ot[%d];\n", H, H, H, H);
+    for (int j = 0; j < E; ++j)
+        fprintf(f, "    const float v%d = x[%d];\n", j, j);
+    for (int j = 0; j < H; ++j)
+        fprintf(f, "    const float v%d = h[%d];\n", E + j, j);
+    fprintf(f, "\n");
+    for (int l = 0; l < NL; ++l) {
+        fprintf(f, "    acc[%d] = %s_b[%d]", l, id, l);
+        for (int j = 0; j < NC; ++j)
+            fprintf(f, " + %s_W[%d][%d] * v%d", id, j, l, j);
+        fprintf(f, ";\n");
+    }
+    fprintf(f, "\n");
+
+    // Niveau rapide : portes et cellule en une boucle à borne constante,
+    // que le compilateur vectorise (les tableaux d'Activations.h ne le sont
+    // pas, leur taille étant lue à l'exécution)
+    fprintf(f, "    if (Activation_active() == ACTIVATION_RAPIDE) {\n");
+    fprintf(f, "        for (int r = 0; r < %d; ++r) {\n", H);
+    fprintf(f, "            const float i_r = act_sigmoide_rapide(acc[r]);\n");
+    fprintf(f, "            const float f_r = act_sigmoide_rapide(acc[%d + r]);\n", H);
+    fprintf(f, "            const float g_r = act_tanh_rapide(acc[%d + r]);\n", 2 * H);
+    fprintf(f, "            const float o_r = act_sigmoide_rapide(acc[%d + r]);\n", 3 * H);
+    fprintf(f, "            c[r] = f_r * c[r] + i_r * g_r;\n");
+    fprintf(f, "            h[r] = o_r * act_tanh_rapide(c[r]);\n");
+    fprintf(f, "        }\n");
+    fprintf(f, "        return;\n");
+    fprintf(f, "    }\n\n");
+
+    fprintf(f, "    Activation_sigmoide(%d, acc, it);\n", H);
+    fprintf(f, "    Activation_sigmoide(%d, acc + %d, ft);\n", H, H);
+    fprintf(f, "    Activation_tanh(%d, acc + %d, gt);\n", H, 2 * H);
+    fprintf(f, "    Activation_sigmoide(%d, acc + %d, ot);\n\n", H, 3 * H);
+    for (int r = 0; r < H; ++r)
+        fprintf(f, "    c[%d] = ft[%d] * c[%d] + it[%d] * gt[%d];\n", r, r, r, r, r);
+    fprintf(f, "    Activation_tanh(%d, c, h);\n", H);
+    for (int r = 0; r < H; ++r)
+        fprintf(f, "    h[%d] = ot[%d] * h[%d];\n", r, r, r);
+    fprintf(f, "}\n\n");
+
+    // Instances : jeu d'instructions de base, AVX2 + FMA si c'est le noyau
+    // LSTM actif (mêmes FMA que produit_avx2)
+    fprintf(f, "static void %s_pas_base(const float *x, float *h, float *c)\n", id);
+    fprintf(f, "{\n    %s_pas_corps(x, h, c);\n}\n\n", id);
+    fprintf(f, "#ifdef GENERE_X86\n");
+    fprintf(f, "__attribute__((target(\"avx2,fma\")))\n");
+    fprintf(f, "static void %s_pas_avx2(const float *x, float *h, float *c)\n", id);
+    fprintf(f, "{\n    %s_pas_corps(x, h, c);\n}\n#endif\n\n", id);
+    fprintf(f, "static void %s_pas(const float *x, float *h, float *c)\n{\n", id);
+    fprintf(f, "#ifdef GENERE_X86\n");
+    fprintf(f, "    if (LSTM_noyau_actif() == LSTM_NOYAU_AVX2) {\n");
+    fprintf(f, "        %s_pas_avx2(x, h, c);\n        return;\n    }\n#endif\n", id);
+    fprintf(f, "    %s_pas_base(x, h, c);\n}\n\n", id);
+
+    // Sortie : même ordre que SOC (somme puis biais)
+    fprintf(f, "static float %s_sortie(const float *h)\n{\n", id);
+    fprintf(f, "    float s = %s_WFC[0] * h[0];\n", id);
+    for (int r = 1; r < H; ++r)
+        fprintf(f, "    s += %s_WFC[%d] * h[%d];\n", id, r, r);
+    fprintf(f, "    return s + %s_bFC;\n}\n\n", id);
+
+    // Réseau source
+    const Reseau_entete *e = v->reseau.entete;
+    for (int b = 0; b < RESEAU_NB_BLOCS; ++b) {
+        size_t n = Reseau_taille_bloc((Reseau_bloc)b, e->nb_entrees, e->nb_unites, e->nb_sorties);
+        fprintf(f, "static const float %s_source_%s[%zu] = {\n", id, Reseau_nom_bloc((Reseau_bloc)b), n);
+        ecrire_valeurs(f, v->reseau.bloc[b], n);
+        fprintf(f, "};\n");
+    }
+    fprintf(f, "\n");
+
+    fprintf(f, "static const LSTM_genere %s_variante = {\n", id);
+    fprintf(f, "    \"%s\", %d, %d, 0x%08Xu,\n", id, E, H, (unsigned)SOC_Modele_empreinte(&v->modele));
+    fprintf(f, "    %s_pas, %s_sortie,\n    {", id, id);
+    for (int b = 0; b < RESEAU_NB_BLOCS; ++b)
+        fprintf(f, "%s%s_source_%s,", (b % 3 == 0) ? "\n        " : " ", id, Reseau_nom_bloc((Reseau_bloc)b));
+    fprintf(f, "\n    }\n};\n\n");
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3 || argc - 2 > VARIANTES_MAX) {
+        printf("Usage : generation_lstm sortie.c nom=reseau.prtw [nom=reseau.prtw ...]\n");
+        return 1;
+    }
+    const char *sortie = argv[1];
+    const int   nb     = argc - 2;
+
+    static Variante variantes[VARIANTES_MAX];
+    int erreur = 0;
+    int ouverts = 0;
+
+    for (int v = 0; v < nb && !erreur; ++v) {
+        const char *arg = argv[v + 2];
+        const char *egal = strchr(arg, '=');
+        size_t lg = egal ? (size_t)(egal - arg) : 0;
+        if (!egal || lg == 0 || lg >= RESEAU_NOM_MAX) {
+            printf("Erreur : argument %s (attendu nom=reseau.prtw)\n", arg);
+            erreur = 1;
+            break;
+        }
+        memcpy(variantes[v].nom, arg, lg);
+        variantes[v].nom[lg] = '\0';
+        if (!nom_valide(variantes[v].nom)) {
+            printf("Erreur : nom %s invalide (identifiant C attendu)\n", variantes[v].nom);
+            erreur = 1;
+            break;
+        }
+
+        if (Reseau_ouvrir(&variantes[v].reseau, egal + 1) != 0) {
+            erreur = 1;
+            break;
+        }
+        ouverts++;
+
+        const Reseau_entete *e = variantes[v].reseau.entete;
+        erreur = SOC_Modele_compiler_blocs(&variantes[v].modele, e->nom, (int)e->nb_entrees,
+                                           (int)e->nb_unites, (int)e->nb_sorties,
+                                           variantes[v].reseau.bloc);
+    }
+
+    if (!erreur) {
+        FILE *f = fopen(sortie, "w");
+        if (!f) {
+            perror("Erreur ouverture fichier");
+            erreur = 1;
+        } else {
+            fprintf(f, "// Fichier genere par generation_lstm : ne pas modifier\n\n");
+            // Sans exceptions flottantes, GCC peut calculer les deux côtés
+            // du bornage de act_exp_rapide : la boucle du niveau rapide se
+            // vectorise (mêmes résultats)
+            fprintf(f, "#if defined(__GNUC__) && !defined(__clang__)\n");
+            fprintf(f, "#pragma GCC optimize (\"no-trapping-math\")\n#endif\n\n");
+            fprintf(f, "#include \"LSTM_genere.h\"\n#include \"LSTM_noyau.h\"\n#include \"Activations.h\"\n\n");
+            fprintf(f, "#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))\n");
+            fprintf(f, "#define GENERE_X86 1\n#endif\n\n");
+            for (int v = 0; v < nb; ++v)
+                ecrire_variante(f, &variantes[v]);
+
+            fprintf(f, "const LSTM_genere *const LSTM_genere_variantes[] = {\n");
+            for (int v = 0; v < nb; ++v)
+                fprintf(f, "    &%s_variante,\n", variantes[v].nom);
+            fprintf(f, "};\nconst int LSTM_genere_nb = %d;\n", nb);
+
+            if (fclose(f) != 0) {
+                printf("Erreur ecriture %s\n", sortie);
+                erreur = 1;
+            }
+        }
+    }
+
+    for (int v = 0; v < ouverts; ++v)
+        Reseau_fermer(&variantes[v].reseau);
+    if (erreur) return 1;
+
+    for (int v = 0; v < nb; ++v)
+        printf("%s : reseau %s, %d unites, empreinte %08X\n", variantes[v].nom,
+               variantes[v].modele.nom, variantes[v].modele.lstm.nb_unites,
+               (unsigned)SOC_Modele_empreinte(&variantes[v].modele));
+    printf("-> %s\n", sortie);
+    return 0;
+}
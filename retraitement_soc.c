@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "Read_Write.h"
+#include "SOC.h"
+#include "SOC_parallele.h"
+
+// ============================================================================
+// Retraitement hors ligne du SOC en parallèle dans le temps (SOC_parallele.h)
+//
+// Rejoue toute la série ../donnees deux fois : en séquentiel (référence),
+// puis en K segments avec rodage. Donne les deux temps, l'accélération, et
+// pour chaque raccord l'écart au rejeu séquentiel : au premier pas rendu,
+// maximal sur le segment, et nombre de pas avant de rester sous
+// RACCORD_SEUIL. Le SOC recousu est écrit dans SOC_retraitement.bin.
+//
+// Usage : retraitement_soc [segments] [rodage] [reseau.prtw]
+//   segments : par défaut le nombre de coeurs ; rodage : RODAGE_DEFAUT pas
+// ============================================================================
+
+#define RODAGE_DEFAUT  7200         // 2 h au pas de 1 s
+#define RACCORD_SEUIL  1e-4f
+
+int main(int argc, char **argv)
+{
+    long coeurs = sysconf(_SC_NPROCESSORS_ONLN);
+    int    nb_segments = (argc > 1) ? atoi(argv[1]) : (coeurs > 0 ? (int)coeurs : 1);
+    size_t rodage      = (argc > 2) ? (size_t)atol(argv[2]) : RODAGE_DEFAUT;
+    if (nb_segments < 1 || nb_segments > SOC_PARALLELE_MAX_SEGMENTS) {
+        printf("Usage : retraitement_soc [segments 1..%d] [rodage] [reseau.prtw]\n",
+               SOC_PARALLELE_MAX_SEGMENTS);
+        return 1;
+    }
+
+    static SOC_Modele modele_fichier;
+    const SOC_Modele *modele = SOC_modele_integre();
+    if (argc > 3) {
+        if (SOC_Modele_charger(&modele_fichier, argv[3]) != 0) return 1;
+        modele = &modele_fichier;
+    }
+
+    const float *courant, *tension, *temperature, *SOH, *SOC;
+    Charge_donnees(&courant, &tension, &temperature, &SOH, &SOC);
+    size_t N = Nb_echantillons_donnees();
+    if (!courant || N == 0) {
+        printf("Erreur chargement des donnees\n");
+        return 1;
+    }
+
+    float *reference = (float *)malloc(N * sizeof(float));
+    float *sortie    = (float *)malloc(N * sizeof(float));
+    if (!reference || !sortie) {
+        perror("Erreur allocation");
+        free(reference);
+        free(sortie);
+        Free_donnees(courant, tension, temperature, SOH, SOC);
+        return 1;
+    }
+
+    // 1) Référence séquentielle
+    SOC_Context ctx;
+    SOC_init_modele(&ctx, modele);
+    double t0 = Horloge_secondes();
+    for (size_t k = 0; k < N; ++k)
+        reference[k] = SOC_step(&ctx, courant[k], tension[k], temperature[k], SOH[k]);
+    double t_seq = Horloge_secondes() - t0;
+
+    // 2) Segments en parallèle
+    SOC_Segment segments[SOC_PARALLELE_MAX_SEGMENTS];
+    t0 = Horloge_secondes();
+    int erreur = SOC_parallele(modele, courant, tension, temperature, SOH, N,
+                               nb_segments, rodage, sortie, segments);
+    double t_par = Horloge_secondes() - t0;
+
+    if (!erreur) {
+        size_t pas_rodage = 0;
+        for (int s = 0; s < nb_segments; ++s) pas_rodage += segments[s].debut - segments[s].depart;
+
+        printf("Reseau %s, %zu echantillons, %d segments, rodage %zu pas, %ld coeurs\n",
+               modele->nom, N, nb_segments, rodage, coeurs);
+        printf("Sequentiel : %.3f s | parallele : %.3f s (x%.2f, rodage : %.1f %% de pas en plus)\n\n",
+               t_seq, t_par, t_seq / t_par, 100.0 * (double)pas_rodage / (double)N);
+
+        // 3) Écart aux raccords
+        printf("Segment |      debut |   Ecart raccord |  Ecart max seg. | Pas > %.0e\n",
+               (double)RACCORD_SEUIL);
+        printf("-----------------------------------------------------------------------\n");
+        float ecart_global = 0.0f;
+        for (int s = 0; s < nb_segments; ++s) {
+            const SOC_Segment *g = &segments[s];
+            float ecart_max = 0.0f;
+            size_t dernier = g->debut;      // premier pas après le dernier dépassement
+            for (size_t k = g->debut; k < g->fin; ++k) {
+                float e = fabsf(sortie[k] - reference[k]);
+                if (!(e <= ecart_max)) ecart_max = e;
+                if (!(e <= RACCORD_SEUIL)) dernier = k + 1;
+            }
+            if (!(ecart_max <= ecart_global)) ecart_global = ecart_max;
+            float ecart_raccord = (g->fin > g->debut)
+                                ? fabsf(sortie[g->debut] - reference[g->debut]) : 0.0f;
+            printf("%7d | %10zu | %15.3e | %15.3e | %zu\n", s, g->debut,
+                   ecart_raccord, ecart_max, dernier - g->debut);
+        }
+        printf("\nEcart max au rejeu sequentiel : %.3e\n", ecart_global);
+
+        erreur = Ecriture_result(sortie, (int)N, "SOC_retraitement");
+    }
+
+    free(reference);
+    free(sortie);
+    Free_donnees(courant, tension, temperature, SOH, SOC);
+    return erreur;
+}
@@ -1,8 +1,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
+#include <math.h>
 
 #include "Read_Write.h"
+#include "Flux_donnees.h"
+#include "Sortie_resultats.h"
 #include "sur_temperature.h"
 #include "sur_tension.h"
 #include "SOE.h"
@@ -10,28 +13,89 @@
 #include "RUL.h"
 #include "RINT.h"
 #include "SOC.h"
+#include "SOP.h"
+#include "Detection_phase.h"
+#include "LSTM_noyau.h"
+#include "LSTM_genere.h"
+#include "Activations.h"
+#include "Point_reprise.h"
 #include "script_principal_step.h"
 
+// Tous les résultats dans un seul fichier ; extraction_resultats.exe
+// régénère les <canal>.bin attendus par les scripts MATLAB
+#define FICHIER_RESULTATS "RESULTATS_vscode.res"
+
+// Point de reprise écrit périodiquement (multiple de la taille des blocs de
+// résultats : la synchronisation n'écrit pas de bloc partiel) et supprimé en
+// fin d'exécution normale. S'il existe au démarrage, la boucle reprend là.
+#define FICHIER_REPRISE   "REPRISE_vscode.chk"
+#define PERIODE_REPRISE   (25 * SORTIE_LIGNES_BLOC)
+
+// Réseau du SOC : fichier de poids utilisé s'il existe (conversion_reseau),
+// sinon réseau intégré à SOC.c
+#define FICHIER_RESEAU_SOC "../donnees/reseau_soc.prtw"
+
+// Niveau des activations du LSTM (voir Activations.h et bench_soc)
+#ifndef NIVEAU_ACTIVATION_SOC
+#define NIVEAU_ACTIVATION_SOC ACTIVATION_EXACTE
+#endif
+
+// Limites SOP des deux sens : séquentielles par défaut. Le thread de travail
+// (SOP_DEUX_SENS_THREADS) ne se compile qu'après mesure sur la cible
+// (bench_sop sens) : sans second coeur libre, il coûte plus qu'il ne gagne
+#ifndef MODE_SOP_DEUX_SENS
+#define MODE_SOP_DEUX_SENS SOP_DEUX_SENS_SEQUENTIEL
+#endif
+
 static double duree_en_seconde(clock_t t0, clock_t t1)
 {
     return (double)(t1 - t0) / (double)CLOCKS_PER_SEC;
 }
 
-int main(void)
+// Usage : script_principal_step [point_de_reprise]
+//   sans argument : reprise automatique sur FICHIER_REPRISE s'il existe
+//   avec argument : départ depuis l'état sauvegardé (nouveau fichier de
+//                   résultats, à partir de l'échantillon du point de reprise ;
+//                   ce fichier n'est pas supprimé en fin d'exécution)
+//   Le point de reprise doit venir du même modèle SOC (refusé sinon)
+int main(int argc, char **argv)
 {
     // =====================================================================
-    // 1) Chargement des données communes
+    // 0) Point de reprise éventuel
     // =====================================================================
-    const float *courant     = NULL;
-    const float *tension     = NULL;
-    const float *temperature = NULL;
-    const float *SOH_vec     = NULL;
-    const float *SOC_vec     = NULL;
+    static Reprise_instantane reprise;
+    const char *chemin_reprise = (argc > 1) ? argv[1] : FICHIER_REPRISE;
+    int    depuis_reprise  = 0;    // contextes restaurés
+    int    suite_resultats = 0;    // on complète le fichier de résultats existant
+    size_t debut           = 0;
+
+    FILE *fp_reprise = fopen(chemin_reprise, "rb");
+    if (fp_reprise != NULL) {
+        fclose(fp_reprise);
+        if (Reprise_lire(chemin_reprise, &reprise) != 0) return 1;
+        depuis_reprise  = 1;
+        suite_resultats = (argc <= 1);
+        debut           = (size_t)reprise.echantillon;
+        printf("Reprise depuis %s a l'echantillon %zu\n", chemin_reprise, debut);
+    } else if (argc > 1) {
+        perror("Erreur ouverture point de reprise");
+        return 1;
+    }
 
-    const int   NbIteration  = 1000000;   // 1 000 000 pas de 1 s
+    // =====================================================================
+    // 1) Ouverture du flux de données (lecture par blocs en arrière-plan)
+    // =====================================================================
     const float periode_s    = 1.0f;      // cadence logique : 1 seconde
 
-    Charge_donnees(&courant, &tension, &temperature, &SOH_vec, &SOC_vec);
+    Flux_Context flux;
+    if (Flux_ouvrir(&flux, "../donnees", debut) != 0) {
+        printf("Erreur ouverture des donnees\n");
+        return 1;
+    }
+
+    // 1 000 000 pas de 1 s, limité à la taille réelle des données
+    size_t nb_donnees = Flux_nb_echantillons(&flux);
+    const int NbIteration = (nb_donnees < 1000000) ? (int)nb_donnees : 1000000;
 
     // Max par module (sur toutes les itérations)
     double temp_TEMP_max    = 0.0;
@@ -41,6 +105,7 @@ int main(void)
     double temp_RUL_max     = 0.0;
     double temp_RINT_max    = 0.0;
     double temp_SOC_max     = 0.0;
+    double temp_SOP_max     = 0.0;
 
     // Dernière durée mesurée (pour la moyenne on ne garde que le cumul)
     double temp_TEMP_last   = 0.0;
@@ -50,44 +115,35 @@ int main(void)
     double temp_RUL_last    = 0.0;
     double temp_RINT_last   = 0.0;
     double temp_SOC_last    = 0.0;
+    double temp_SOP_last    = 0.0;
 
     // =====================================================================
-    // 2) Allocation des vecteurs de résultats
+    // 2) Ouverture du fichier de résultats (une ligne par pas, écrite en flux)
     // =====================================================================
-    float *vect_T2_temp        = (float*)malloc(NbIteration * sizeof(float));
-    float *vect_alerte_temp    = (float*)malloc(NbIteration * sizeof(float));
-
-    float *vect_U_tension      = (float*)malloc(NbIteration * sizeof(float));
-    float *vect_alerte_tension = (float*)malloc(NbIteration * sizeof(float));
-
-    float *vect_SOE            = (float*)malloc(NbIteration * sizeof(float));
-    float *vect_SOH            = (float*)malloc(NbIteration * sizeof(float));
-    float *vect_RUL            = (float*)malloc(NbIteration * sizeof(float));
-    float *vect_RINT           = (float*)malloc(NbIteration * sizeof(float));
-    float *vect_SOC            = (float*)malloc(NbIteration * sizeof(float));
-
-    // Pour information sur le temps d'exécution de chaque pas de 1 s
-    float *vect_temps_cycle    = (float*)malloc(NbIteration * sizeof(float));
-
-    if (!vect_T2_temp || !vect_alerte_temp ||
-        !vect_U_tension || !vect_alerte_tension ||
-        !vect_SOE || !vect_SOH || !vect_RUL || !vect_RINT ||
-        !vect_temps_cycle || !vect_SOC)
-    {
-        perror("Erreur allocation vecteurs resultat");
-        free(vect_T2_temp);
-        free(vect_alerte_temp);
-        free(vect_U_tension);
-        free(vect_alerte_tension);
-        free(vect_SOE);
-        free(vect_SOH);
-        free(vect_RUL);
-        free(vect_RINT);
-        free(vect_temps_cycle);
-        free(vect_SOC);
-        Free_donnees(courant, tension, temperature, SOH_vec, SOC_vec);
+    enum {
+        R_TEMPERATURE, R_ALERTE_TEMPERATURE, R_TENSION, R_ALERTE_TENSION,
+        R_SOE, R_SOH, R_RUL, R_RINT, R_SOC, R_SOP_CHARGE, R_SOP_DECHARGE,
+        R_I_CHARGE_SOP, R_I_DECHARGE_SOP, R_TEMPS_CYCLE, NB_RESULTATS
+    };
+    static const char *const noms_resultats[NB_RESULTATS] = {
+        "TEMPERATURE_vscode", "ALERTE_TEMPERATURE_vscode",
+        "TENSION_vscode",     "ALERTE_TENSION_vscode",
+        "SOE_vscode", "SOH_vscode", "RUL_vscode", "RINT_vscode", "SOC_vscode",
+        "SOP_CHARGE_vscode", "SOP_DECHARGE_vscode",
+        "I_CHARGE_SOP_vscode", "I_DECHARGE_SOP_vscode",     // prédictifs (A)
+        "TEMPS_CYCLE_CPU"       // temps CPU de chaque pas de 1 s
+    };
+
+    Sortie_Context sortie;
+    int erreur_ouverture = suite_resultats
+        ? Sortie_reprendre(&sortie, FICHIER_RESULTATS, NB_RESULTATS, noms_resultats,
+                           (long long)reprise.position_resultats)
+        : Sortie_ouvrir(&sortie, FICHIER_RESULTATS, NB_RESULTATS, noms_resultats);
+    if (erreur_ouverture != 0) {
+        Flux_fermer(&flux);
         return 1;
     }
+    float ligne[NB_RESULTATS];
 
     // =====================================================================
     // 3) Initialisation des contextes
@@ -99,6 +155,9 @@ int main(void)
     RUL_Context rul_ctx;
     RINT_Context rint_ctx;
     SOC_Context soc_ctx;
+    SOP_Context sop_ctx;
+    SOP_Deux_sens sop_deux_sens;        // limites prédictives de charge / décharge
+    Detection_Context detection_ctx;    // phase charge/décharge commune
 
     TEMP_init(&temp_ctx);
     TENSION_init(&tens_ctx);
@@ -106,7 +165,41 @@ int main(void)
     SOH_init(&soh_ctx);
     RUL_init(&rul_ctx);
     RINT_init(&rint_ctx);
-    SOC_init(&soc_ctx);
+    SOP_init(&sop_ctx);
+    Detection_init(&detection_ctx);
+    Activation_choisir(NIVEAU_ACTIVATION_SOC);
+
+    // Noyaux générés : utilisés par les modèles compilés dont ils ont les poids
+    SOC_genere_enregistrer(LSTM_genere_variantes, LSTM_genere_nb);
+
+    static SOC_Modele modele_soc;
+    FILE *fp_reseau = fopen(FICHIER_RESEAU_SOC, "rb");
+    if (fp_reseau != NULL) {
+        fclose(fp_reseau);
+        if (SOC_Modele_charger(&modele_soc, FICHIER_RESEAU_SOC) != 0) {
+            Sortie_fermer(&sortie);
+            Flux_fermer(&flux);
+            return 1;
+        }
+        SOC_init_modele(&soc_ctx, &modele_soc);
+    } else {
+        SOC_init(&soc_ctx);
+    }
+
+    // Limites des deux sens (repli séquentiel si le thread ne peut pas être
+    // créé)
+    SOP_deux_sens_ouvrir(&sop_deux_sens, sop_ctx.modele, MODE_SOP_DEUX_SENS);
+
+    const Reprise_modules modules = {
+        &temp_ctx, &tens_ctx, &soe_ctx, &soh_ctx, &rul_ctx, &rint_ctx, &soc_ctx,
+        &sop_ctx, &detection_ctx, &sop_deux_sens
+    };
+    if (depuis_reprise && Reprise_restaurer(&reprise, &modules, chemin_reprise) != 0) {
+        SOP_deux_sens_fermer(&sop_deux_sens);
+        Sortie_fermer(&sortie);
+        Flux_fermer(&flux);
+        return 1;
+    }
 
     printf("========= Execution des modules (step) dans UNE boucle cadencee a 1 s =========\n");
 
@@ -120,23 +213,35 @@ int main(void)
     double temps_RUL         = 0.0;
     double temps_RINT        = 0.0;
     double temps_SOC         = 0.0;
+    double temps_SOP         = 0.0;
 
     double temps_cycle_total = 0.0;
     double temps_cycle_max   = 0.0;
 
+    double temps_reprise     = 0.0;
+    int    nb_reprises       = 0;
+
     // =====================================================================
     // 5) Boucle principale unique, cadence "logique" de 1 seconde
     // =====================================================================
-    for (int k = 0; k < NbIteration; ++k)
+    int nb_pas = 0;
+    for (int k = (int)debut; k < NbIteration; ++k)
     {
         // Début du cycle de 1 s (en temps CPU)
         clock_t t_cycle0 = clock();
 
-        float I_mes   = courant[k];
-        float U_mes   = tension[k];
-        float T_mes   = temperature[k];
-        float SOC_k   = SOC_vec[k];
-        float SOH_k   = SOH_vec[k];
+        Echantillon e;
+        if (!Flux_suivant(&flux, &e)) break;
+
+        float I_mes   = e.courant;
+        float U_mes   = e.tension;
+        float T_mes   = e.temperature;
+        float SOC_k   = e.SOC;
+        float SOH_k   = e.SOH;
+
+        // Phase charge/décharge (0 = charge, 1 = décharge), une fois par pas
+        // pour TENSION, SOH et SOP ; convention de la simulation : -courant
+        int etat = Detection_step(&detection_ctx, -I_mes);
 
         // -----------------------------------------------------------------
         // a) Module TEMPERATURE
@@ -152,8 +257,8 @@ int main(void)
             temps_TEMP += temp_TEMP_last;
             if (temp_TEMP_last > temp_TEMP_max) temp_TEMP_max = temp_TEMP_last;
 
-            vect_T2_temp[k]     = T2;
-            vect_alerte_temp[k] = (float)alerte;
+            ligne[R_TEMPERATURE]        = T2;
+            ligne[R_ALERTE_TEMPERATURE] = (float)alerte;
         }
 
         // -----------------------------------------------------------------
@@ -163,7 +268,6 @@ int main(void)
             clock_t t0 = clock();
 
             int   alerte = 0;
-            int   etat   = 1;       // décharge
             float I_sim  = -I_mes;
 
             float U_model = TENSION_step(&tens_ctx,
@@ -178,8 +282,8 @@ int main(void)
             temps_TENSION += temp_TENSION_last;
             if (temp_TENSION_last > temp_TENSION_max) temp_TENSION_max = temp_TENSION_last;
 
-            vect_U_tension[k]      = U_model;
-            vect_alerte_tension[k] = (float)alerte;
+            ligne[R_TENSION]        = U_model;
+            ligne[R_ALERTE_TENSION] = (float)alerte;
         }
 
         // -----------------------------------------------------------------
@@ -195,7 +299,7 @@ int main(void)
             temps_SOE += temp_SOE_last;
             if (temp_SOE_last > temp_SOE_max) temp_SOE_max = temp_SOE_last;
 
-            vect_SOE[k] = soe_val;
+            ligne[R_SOE] = soe_val;
         }
 
         // -----------------------------------------------------------------
@@ -204,14 +308,14 @@ int main(void)
         {
             clock_t t0 = clock();
 
-            float soh_val = SOH_step(&soh_ctx, I_mes, SOC_k);
+            float soh_val = SOH_step_etat(&soh_ctx, I_mes, SOC_k, etat);
 
             clock_t t1 = clock();
             temp_SOH_last = duree_en_seconde(t0, t1);
             temps_SOH += temp_SOH_last;
             if (temp_SOH_last > temp_SOH_max) temp_SOH_max = temp_SOH_last;
 
-            vect_SOH[k] = soh_val;
+            ligne[R_SOH] = soh_val;
         }
 
         // -----------------------------------------------------------------
@@ -227,7 +331,7 @@ int main(void)
             temps_RUL += temp_RUL_last;
             if (temp_RUL_last > temp_RUL_max) temp_RUL_max = temp_RUL_last;
 
-            vect_RUL[k] = RUL_corrige;
+            ligne[R_RUL] = RUL_corrige;
         }
 
         // -----------------------------------------------------------------
@@ -250,7 +354,7 @@ int main(void)
             temps_RINT += temp_RINT_last;
             if (temp_RINT_last > temp_RINT_max) temp_RINT_max = temp_RINT_last;
 
-            vect_RINT[k] = Rint;
+            ligne[R_RINT] = Rint;
         }
 
         // -----------------------------------------------------------------
@@ -270,7 +374,29 @@ int main(void)
             temps_SOC += temp_SOC_last;
             if (temp_SOC_last > temp_SOC_max) temp_SOC_max = temp_SOC_last;
 
-            vect_SOC[k] = SOC_est;
+            ligne[R_SOC] = SOC_est;
+        }
+
+        // -----------------------------------------------------------------
+        // h) Module SOP (puissance admissible en charge / décharge)
+        // -----------------------------------------------------------------
+        {
+            clock_t t0 = clock();
+
+            float SOP_charge, SOP_decharge, I_charge, I_decharge;
+            SOP_step_deux_sens(&sop_ctx, &sop_deux_sens, etat, I_mes, U_mes, T_mes,
+                               SOH_k, SOC_k, &SOP_charge, &SOP_decharge,
+                               &I_charge, &I_decharge);
+
+            clock_t t1 = clock();
+            temp_SOP_last = duree_en_seconde(t0, t1);
+            temps_SOP += temp_SOP_last;
+            if (temp_SOP_last > temp_SOP_max) temp_SOP_max = temp_SOP_last;
+
+            ligne[R_SOP_CHARGE]     = SOP_charge;
+            ligne[R_SOP_DECHARGE]   = SOP_decharge;
+            ligne[R_I_CHARGE_SOP]   = I_charge;
+            ligne[R_I_DECHARGE_SOP] = I_decharge;
         }
 
         // -----------------------------------------------------------------
@@ -282,13 +408,32 @@ int main(void)
         if (duree_cycle > temps_cycle_max) temps_cycle_max = duree_cycle;
 
         // On mémorise le temps CPU utilisé pour ce pas de 1 s
-        vect_temps_cycle[k] = (float)duree_cycle;
+        ligne[R_TEMPS_CYCLE] = (float)duree_cycle;
+        Sortie_ligne(&sortie, ligne);
+        nb_pas++;
+
+        // -----------------------------------------------------------------
+        // Point de reprise périodique (hors temps de cycle)
+        // -----------------------------------------------------------------
+        if ((k + 1) % PERIODE_REPRISE == 0 && k + 1 < NbIteration)
+        {
+            // les lignes jusqu'à k doivent être sur disque avant le point de reprise
+            long long position = Sortie_position(&sortie);
+
+            clock_t t0 = clock();
+            Reprise_capturer(&reprise, &modules, (uint64_t)(k + 1), (int64_t)position);
+            Reprise_ecrire(FICHIER_REPRISE, &reprise);
+            temps_reprise += duree_en_seconde(t0, clock());
+            nb_reprises++;
+        }
     }
 
     // =====================================================================
     // 6) Bilan des temps CPU
     // =====================================================================
-    double temps_moyen_cycle   = temps_cycle_total / (double)NbIteration;
+    // Moyennes sur les pas exécutés (moins que NbIteration après une reprise)
+    if (nb_pas == 0) nb_pas = 1;
+    double temps_moyen_cycle   = temps_cycle_total / (double)nb_pas;
     double charge_cpu_pour_1Hz = (temps_moyen_cycle / (double)periode_s) * 100.0;
 
     printf("\n======================== BILAN DES TEMPS CPU ========================\n");
@@ -299,80 +444,75 @@ int main(void)
     printf("%-12s | %12.6f | %12.2f | %12.2f\n",
            "TEMP",
            temps_TEMP,
-           (temps_TEMP / NbIteration) * 1e6,
+           (temps_TEMP / nb_pas) * 1e6,
            temp_TEMP_max * 1e6);
 
     printf("%-12s | %12.6f | %12.2f | %12.2f\n",
            "TENSION",
            temps_TENSION,
-           (temps_TENSION / NbIteration) * 1e6,
+           (temps_TENSION / nb_pas) * 1e6,
            temp_TENSION_max * 1e6);
 
     printf("%-12s | %12.6f | %12.2f | %12.2f\n",
            "SOE",
            temps_SOE,
-           (temps_SOE / NbIteration) * 1e6,
+           (temps_SOE / nb_pas) * 1e6,
            temp_SOE_max * 1e6);
 
     printf("%-12s | %12.6f | %12.2f | %12.2f\n",
            "SOH",
            temps_SOH,
-           (temps_SOH / NbIteration) * 1e6,
+           (temps_SOH / nb_pas) * 1e6,
            temp_SOH_max * 1e6);
 
     printf("%-12s | %12.6f | %12.2f | %12.2f\n",
            "RUL",
            temps_RUL,
-           (temps_RUL / NbIteration) * 1e6,
+           (temps_RUL / nb_pas) * 1e6,
            temp_RUL_max * 1e6);
 
     printf("%-12s | %12.6f | %12.2f | %12.2f\n",
            "RINT",
            temps_RINT,
-           (temps_RINT / NbIteration) * 1e6,
+           (temps_RINT / nb_pas) * 1e6,
            temp_RINT_max * 1e6);
 
     printf("%-12s | %12.6f | %12.2f | %12.2f\n",
            "SOC",
            temps_SOC,
-           (temps_SOC / NbIteration) * 1e6,
+           (temps_SOC / nb_pas) * 1e6,
            temp_SOC_max * 1e6);
 
+    printf("%-12s | %12.6f | %12.2f | %12.2f\n",
+           "SOP",
+           temps_SOP,
+           (temps_SOP / nb_pas) * 1e6,
+           temp_SOP_max * 1e6);
+
     printf("---------------------------------------------------------------------\n");
     printf("Cycle 1 s : cumul = %10.6f s | moyen = %10.9f s | max = %10.9f s\n",
            temps_cycle_total, temps_moyen_cycle, temps_cycle_max);
     printf("Charge CPU pour cadence 1 Hz : %.3f %%\n", charge_cpu_pour_1Hz);
+    printf("Reseau du SOC : %s (%d unites) | noyau LSTM : %s | activations : %s\n",
+           soc_ctx.modele->nom, soc_ctx.modele->lstm.nb_unites,
+           soc_ctx.modele->genere ? "genere" : LSTM_noyau_nom(LSTM_noyau_actif()),
+           Activation_nom(Activation_active()));
+    if (nb_reprises > 0)
+        printf("Points de reprise : %d | moyen = %.2f us (capture + ecriture)\n",
+               nb_reprises, temps_reprise / nb_reprises * 1e6);
     printf("=====================================================================\n");
 
     // =====================================================================
-    // 7) Écriture des résultats
+    // 7) Fermeture du fichier de résultats et du flux d'entrée
     // =====================================================================
-    Ecriture_result(vect_T2_temp,        NbIteration, "TEMPERATURE_vscode");
-    Ecriture_result(vect_alerte_temp,    NbIteration, "ALERTE_TEMPERATURE_vscode");
-    Ecriture_result(vect_U_tension,      NbIteration, "TENSION_vscode");
-    Ecriture_result(vect_alerte_tension, NbIteration, "ALERTE_TENSION_vscode");
-    Ecriture_result(vect_SOE,            NbIteration, "SOE_vscode");
-    Ecriture_result(vect_SOH,            NbIteration, "SOH_vscode");
-    Ecriture_result(vect_RUL,            NbIteration, "RUL_vscode");
-    Ecriture_result(vect_RINT,           NbIteration, "RINT_vscode");
-    Ecriture_result(vect_SOC,            NbIteration, "SOC_vscode");
-    Ecriture_result(vect_temps_cycle,    NbIteration, "TEMPS_CYCLE_CPU");
+    SOP_deux_sens_fermer(&sop_deux_sens);
+    int erreur_sortie = Sortie_fermer(&sortie);
+    Flux_fermer(&flux);
 
-    // =====================================================================
-    // 8) Nettoyage des données d'entrée
-    // =====================================================================
-    Free_donnees(courant, tension, temperature, SOH_vec, SOC_vec);
-
-    free(vect_T2_temp);
-    free(vect_alerte_temp);
-    free(vect_U_tension);
-    free(vect_alerte_tension);
-    free(vect_SOE);
-    free(vect_SOH);
-    free(vect_RUL);
-    free(vect_RINT);
-    free(vect_SOC);
-    free(vect_temps_cycle);
-
-    return 0;
+    // Exécution terminée : le prochain lancement repart du début. Seul le
+    // point de reprise par défaut est supprimé, s'il a été repris ou écrit
+    // par cette exécution ; celui passé en argument est gardé
+    if (erreur_sortie == 0 && (suite_resultats || nb_reprises > 0)) remove(FICHIER_REPRISE);
+
+    return erreur_sortie;
 }
@@ -1,9 +1,6 @@
 #include <math.h>
 #include "sur_tension.h"
 
-// Interpolation 1D rapide (prototype ; implémentation ailleurs)
-float interp1Drapide(const float *x, const float *y, int n, float x_req);
-
 // ============================================================================
 // Fonction principale : surveillance tension (step)
 // ============================================================================
@@ -12,10 +9,8 @@ void surveillance_tension(float courant,
                           float SOC,
                           float tension_mesuree,
                           int   etat,  // 1=decharge, 0=charge
-                          const float *X_OCV,
-                          const float *Y_OCV_charge,
-                          const float *Y_OCV_decharge,
-                          int   n_OCV,
+                          const Table_uniforme *OCV_charge,
+                          const Table_uniforme *OCV_decharge,
                           float dt,
                           float R1,
                           float C1,
@@ -38,10 +33,10 @@ void surveillance_tension(float courant,
     }
 
     // Sélection de la table OCV charge / décharge
-    const float *Y_tab = etat ? Y_OCV_decharge : Y_OCV_charge;
+    const Table_uniforme *table = etat ? OCV_decharge : OCV_charge;
 
     // Interpolation OCV(SOC)
-    float OCV = interp1Drapide(X_OCV, Y_tab, n_OCV, SOC);
+    float OCV = Table_uniforme_eval(table, SOC);
 
     // Tension modèle : U = OCV - R1*Ir - R0*courant
     float U_loc = OCV - R1 * (*Ir) - R0 * courant;
@@ -61,6 +56,11 @@ const float Y_OCV_charge_global[104] = {1.93320591726383,2.72927689206185,2.9057
 const float Y_OCV_decharge_global[104] = {2.17810726521397,2.64619885228218,2.74779038224984,2.84220326941330,2.90907808281774,2.96003300726194,3.00002764677570,3.03173972664926,3.05703202409312,3.07714439136274,3.09342646528549,3.10669722619243,3.11781916418998,3.12733211365986,3.13573778519909,3.14322508606925,3.15000996853790,3.15618873540485,3.16191568251172,3.16720046276118,3.17201621695117,3.17655777655872,3.18077301979361,3.18466000207268,3.18831930305334,3.19170321461967,3.19494109336420,3.19797311646528,3.20082089765752,3.20358137134503,3.20628617948389,3.20881527327443,3.21134027164807,3.21377917232735,3.21622271645205,3.21862503928664,3.22103664159122,3.22343893834968,3.22584469241097,3.22824823750213,3.23061081113556,3.23295223806204,3.23534871980090,3.23759913447216,3.23994447093429,3.24225186714112,3.24440884775619,3.24664525008857,3.24884964562732,3.25099169367741,3.25309552824769,3.25521488994224,3.25727226291227,3.25930097400990,3.26131973419157,3.26323853558761,3.26517658596839,3.26712241006934,3.26897736902661,3.27078522791041,3.27258568136030,3.27441186129856,3.27618634300700,3.27794268776836,3.27970139500087,3.28141275249602,3.28316141447282,3.28484626230925,3.28651341679660,3.28821625301702,3.28979974744345,3.29142621817904,3.29294886371251,3.29444861570200,3.29600873750741,3.29748116965315,3.29895959752347,3.30036366025858,3.30178411818127,3.30322004214205,3.30458996161796,3.30604529164250,3.30742439296035,3.30878167152838,3.31019335279497,3.31154547438990,3.31292540758604,3.31436748604800,3.31586685661157,3.31729803615602,3.31877306915676,3.32042327196300,3.32204905990387,3.32379772541427,3.32570573356999,3.32776400223940,3.33034810161321,3.33433271623742,3.33790923926188,3.34437324998017,3.34629999118907,3.38101846324182,3.46955240362839,3.77810770618289};
 const int N_OCV_global = 104;
 
+// Tables rééchantillonnées à pas constant (compilées au premier TENSION_init)
+static Table_uniforme OCV_charge_uniforme;
+static Table_uniforme OCV_decharge_uniforme;
+static int            tables_compilees = 0;
+
 // ============================================================================
 // Gestion du contexte : TENSION_init / TENSION_step
 // ============================================================================
@@ -75,10 +75,15 @@ void TENSION_init(TENSION_Context *ctx)
     ctx->R0    = 0.0185f;
     ctx->seuil = 1.0f;
 
-    ctx->X_OCV         = X_OCV_global;
-    ctx->Y_OCV_charge  = Y_OCV_charge_global;
-    ctx->Y_OCV_decharge= Y_OCV_decharge_global;
-    ctx->n_OCV         = N_OCV_global;
+    if (!tables_compilees) {
+        Table_uniforme_compiler(&OCV_charge_uniforme,   X_OCV_global,
+                                Y_OCV_charge_global,   N_OCV_global, 0);
+        Table_uniforme_compiler(&OCV_decharge_uniforme, X_OCV_global,
+                                Y_OCV_decharge_global, N_OCV_global, 0);
+        tables_compilees = 1;
+    }
+    ctx->OCV_charge    = &OCV_charge_uniforme;
+    ctx->OCV_decharge  = &OCV_decharge_uniforme;
 
     ctx->Ir = 0.0f;
 }
@@ -101,10 +106,8 @@ float TENSION_step(TENSION_Context *ctx,
         SOC,
         tension_mesuree,
         etat,
-        ctx->X_OCV,
-        ctx->Y_OCV_charge,
-        ctx->Y_OCV_decharge,
-        ctx->n_OCV,
+        ctx->OCV_charge,
+        ctx->OCV_decharge,
         ctx->dt,
         ctx->R1,
         ctx->C1,
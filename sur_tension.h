@@ -1,6 +1,8 @@
 #ifndef SUR_TENSION_H
 #define SUR_TENSION_H
 
+#include "Table_uniforme.h"
+
 // ============================================================================
 // Fonction step "brute" : un échantillon → mise à jour Ir, U, alerte
 // ============================================================================
@@ -11,10 +13,8 @@ void surveillance_tension(float courant,
                           float SOC,
                           float tension_mesuree,
                           int   etat,
-                          const float *X_OCV,
-                          const float *Y_OCV_charge,
-                          const float *Y_OCV_decharge,
-                          int   n_OCV,
+                          const Table_uniforme *OCV_charge,
+                          const Table_uniforme *OCV_decharge,
                           float dt,
                           float R1,
                           float C1,
@@ -36,11 +36,9 @@ typedef struct {
     float R0;
     float seuil;
 
-    // Tables OCV
-    const float *X_OCV;
-    const float *Y_OCV_charge;
-    const float *Y_OCV_decharge;
-    int   n_OCV;
+    // Tables OCV (pas constant, compilées par TENSION_init)
+    const Table_uniforme *OCV_charge;
+    const Table_uniforme *OCV_decharge;
 
     // État interne du filtre RC
     float Ir;
@@ -3,6 +3,7 @@
 #include <math.h>
 #include "surveillance_tension.h"
 #include "Read_Write.h"
+#include "Detection_phase.h"
 
 // ============================================================================
 // Fonction principale : surveillance tension
@@ -92,8 +93,8 @@ void TENSION_setup(void)
      // === Variables pour la détection charge/décharge (équivalent MATLAB) ===
     // etat = 0 --> charge, etat = 1 --> décharge
     int etat = 0;
-    int etat_precedent = 0;
-    float tampon_charge_decharge[60] = {0.0f};
+    Detection_Context detection;
+    Detection_init(&detection);
 
     for (int i = 0; i < NbIteration; ++i)
     {
@@ -104,12 +105,7 @@ void TENSION_setup(void)
         float courant_simulation = -courant[i];
 
         // === Détection de la phase charge/décharge ===
-        detection_charge_decharge_rw(
-            courant_simulation,
-            tampon_charge_decharge,
-            &etat,
-            &etat_precedent
-        );
+        etat = Detection_step(&detection, courant_simulation);
 
         // === Modèle de tension ===
         surveillance_tension(
@@ -0,0 +1,381 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "Read_Write.h"
+#include "SOP.h"
+#include "SOP_table.h"
+
+// ============================================================================
+// Table SOP hors ligne (SOP_table.h) : construction et rapport de précision
+//
+// construire : courant admissible exact (SOP_courant_admissible) sur la
+//   grille 4-D, marges du mode prudent sur [dT1_min, dT1_max], écriture du
+//   fichier .prts.
+// rapport : rejoue ../donnees avec SOP_step et compare, à chaque
+//   échantillon, la table (directe et prudente) au solveur exact sur l'état
+//   du SOP (SOC, T1, T2, Ir, SOH, etat) ; temps par évaluation des deux.
+//   Les écarts et dépassements sont comptés sur la limite avec le vrai T1 ;
+//   colonne T1 : écart de cette limite avec celle à T1 = T2 (hypothèse des
+//   noeuds de la table).
+// balayage : la marge prudente étant échantillonnée, pire dépassement de la
+//   limite exacte sur une sous-grille régulière de chaque maille (n points
+//   par axe, bords compris ; T1 - T2 : n points de [dT1_min, dT1_max] et 0).
+//
+// Usage : table_sop construire fichier.prts [axe=min:max:n ...] [points=K]
+//                                           [dT1=min:max]
+//           axe : SOC, T, Ir, SOH (défauts : SOC=0:1:21 T=0:60:13
+//                 Ir=-20:20:9 SOH=0.8:1:5 points=16 dT1=-5:35)
+//         table_sop rapport fichier.prts [echantillons]
+//         table_sop balayage fichier.prts [n]   (défaut : n = 4)
+// ============================================================================
+
+#define RAPPORT_ECHANTILLONS_DEFAUT 20000
+#define BALAYAGE_POINTS_DEFAUT      4
+#define POINTS_PAR_MAILLE_DEFAUT    16
+#define DT1_MIN_DEFAUT              -5.0f   // T1 - T2 (degC) ; T1 démarre à
+#define DT1_MAX_DEFAUT              35.0f   // 60 degC sur les données
+
+static const char *const noms_axes[SOP_TABLE_NB_AXES] = { "SOC", "T", "Ir", "SOH" };
+
+static void usage(void)
+{
+    printf("Usage : table_sop construire fichier.prts [SOC|T|Ir|SOH=min:max:n ...] [points=K]\n");
+    printf("                                         [dT1=min:max]\n");
+    printf("        table_sop rapport fichier.prts [echantillons]\n");
+    printf("        table_sop balayage fichier.prts [n]\n");
+}
+
+// ============================================================================
+// Construction
+// ============================================================================
+
+static int construire(const char *chemin, int argc, char **argv)
+{
+    SOP_Axe axes[SOP_TABLE_NB_AXES] = {
+        { 0.0f,   1.0f,  21, 0 },       // SOC
+        { 0.0f,   60.0f, 13, 0 },       // T (degC)
+        { -20.0f, 20.0f, 9,  0 },       // Ir (A)
+        { 0.8f,   1.0f,  5,  0 },       // SOH
+    };
+    int   points  = POINTS_PAR_MAILLE_DEFAUT;
+    float dT1_min = DT1_MIN_DEFAUT, dT1_max = DT1_MAX_DEFAUT;
+
+    for (int k = 0; k < argc; ++k) {
+        char  nom[16];
+        float mn, mx;
+        int   n;
+        if (sscanf(argv[k], "points=%d", &points) == 1) continue;
+        if (sscanf(argv[k], "dT1=%f:%f", &dT1_min, &dT1_max) == 2) continue;
+        if (sscanf(argv[k], "%15[^=]=%f:%f:%d", nom, &mn, &mx, &n) != 4) {
+            usage();
+            return 1;
+        }
+        int d = 0;
+        while (d < SOP_TABLE_NB_AXES && strcmp(nom, noms_axes[d]) != 0) ++d;
+        if (d == SOP_TABLE_NB_AXES) {
+            printf("Axe inconnu : %s\n", nom);
+            return 1;
+        }
+        axes[d].min = mn;
+        axes[d].max = mx;
+        axes[d].n   = (uint32_t)n;
+    }
+
+    const SOP_Modele *m = SOP_modele_defaut();
+    SOP_Table table;
+    double t0 = Horloge_secondes();
+    if (SOP_Table_construire(&table, m, axes, points, dT1_min, dT1_max) != 0) return 1;
+    double t_construction = Horloge_secondes() - t0;
+
+    int erreur = SOP_Table_ecrire(&table, chemin);
+    if (!erreur) {
+        printf("Table SOP %s : horizon %d pas\n", chemin, m->param.horizon);
+        for (int d = 0; d < SOP_TABLE_NB_AXES; ++d)
+            printf("  %-4s [%g, %g] : %u noeuds\n", noms_axes[d],
+                   (double)axes[d].min, (double)axes[d].max, axes[d].n);
+        printf("  T1 - T2 [%g, %g] degC (marges)\n", (double)dT1_min, (double)dT1_max);
+        printf("  %zu noeuds, %zu mailles (marges : sous-grille 3^4 + %d points tires), %.1f ko\n",
+               table.nb_noeuds, table.nb_mailles, points,
+               (double)(SOP_TABLE_NB_BLOCS * (table.nb_noeuds + table.nb_mailles) * sizeof(float)) / 1024.0);
+        printf("  Construction : %.2f s\n", t_construction);
+    }
+    SOP_Table_fermer(&table);
+    return erreur;
+}
+
+// ============================================================================
+// Rapport de précision sur le rejeu
+// ============================================================================
+
+typedef struct
+{
+    double somme;           // |table - exact|
+    float  max;
+    double somme_prudent;   // perte du mode prudent (exact - prudent, en |I|)
+    float  depassement;     // plus grand dépassement prudent de la limite exacte
+    size_t nb_depassements;
+    float  ecart_T1;        // exact (vrai T1) / exact (T1 = T2)
+} Ecarts;
+
+// Table du modèle SOP par défaut (0 = OK, 1 = erreur)
+static int ouvrir_table(SOP_Table *table, const char *chemin, const SOP_Modele *m)
+{
+    if (SOP_Table_ouvrir(table, chemin) != 0) return 1;
+    if ((int)table->entete.horizon != m->param.horizon ||
+        table->entete.I_min != m->param.I_min || table->entete.I_max != m->param.I_max) {
+        printf("Erreur : %s construite pour un autre modele SOP\n", chemin);
+        SOP_Table_fermer(table);
+        return 1;
+    }
+    return 0;
+}
+
+static int rapport(const char *chemin, size_t nb_max)
+{
+    SOP_Table table;
+    const SOP_Modele *m = SOP_modele_defaut();
+    if (ouvrir_table(&table, chemin, m) != 0) return 1;
+
+    const float *courant, *tension, *temperature, *SOH, *SOC;
+    Charge_donnees(&courant, &tension, &temperature, &SOH, &SOC);
+    size_t N = Nb_echantillons_donnees();
+    if (N > nb_max) N = nb_max;
+    if (!courant || N < 4) {
+        printf("Erreur chargement des donnees (au moins 4 echantillons)\n");
+        Free_donnees(courant, tension, temperature, SOH, SOC);
+        SOP_Table_fermer(&table);
+        return 1;
+    }
+
+    // États rencontrés par le SOP au fil du rejeu
+    size_t n = N - 3;
+    float *etats = (float *)malloc(5 * n * sizeof(float));
+    int   *etat  = (int *)malloc(n * sizeof(int));
+    if (!etats || !etat) {
+        perror("Erreur allocation");
+        free(etats);
+        free(etat);
+        Free_donnees(courant, tension, temperature, SOH, SOC);
+        SOP_Table_fermer(&table);
+        return 1;
+    }
+    float *e_SOC = etats, *e_T = etats + n, *e_Ir = etats + 2 * n;
+    float *e_SOH = etats + 3 * n, *e_T1 = etats + 4 * n;
+
+    SOP_Context ctx;
+    SOP_init_modele(&ctx, m);
+    SOP_demarrer(&ctx, SOC[0], temperature[0], tension[0]);
+    for (size_t i = 2; i < N - 1; ++i) {
+        size_t j = i - 2;
+        e_SOC[j] = ctx.SOC;
+        e_T[j]   = ctx.T2;
+        e_Ir[j]  = ctx.Ir;
+        e_SOH[j] = SOH[i];
+        e_T1[j]  = ctx.T1;
+        float charge, decharge;
+        SOP_step(&ctx, courant[i], tension[i], temperature[i], SOH[i], SOC[i], &charge, &decharge);
+        etat[j]  = ctx.etat;                    // phase de la recherche du pas
+    }
+
+    // Comparaison
+    Ecarts ecarts[SOP_TABLE_NB_SENS];
+    memset(ecarts, 0, sizeof(ecarts));
+    size_t hors_grille = 0;                     // prudent à 0 (axe ou T1 - T2)
+    for (size_t j = 0; j < n; ++j) {
+        const float x[SOP_TABLE_NB_AXES] = { e_SOC[j], e_T[j], e_Ir[j], e_SOH[j] };
+        const float dT1 = e_T1[j] - e_T[j];
+        int dehors = !(dT1 >= table.entete.dT1_min && dT1 <= table.entete.dT1_max);
+        for (int d = 0; d < SOP_TABLE_NB_AXES; ++d)
+            if (!(x[d] >= table.entete.axes[d].min && x[d] <= table.entete.axes[d].max)) dehors = 1;
+        hors_grille += (size_t)dehors;
+
+        for (int sens = 0; sens < SOP_TABLE_NB_SENS; ++sens) {
+            Ecarts *E = &ecarts[sens];
+            float s = (sens == SOP_SENS_DECHARGE) ? 1.0f : -1.0f;
+            float consigne = (s > 0.0f) ? m->param.I_max : m->param.I_min;
+            float exact = SOP_courant_admissible(m, e_SOC[j], e_SOH[j], e_T[j], e_T[j],
+                                                 e_Ir[j], etat[j], consigne);
+            float exact_T1 = SOP_courant_admissible(m, e_SOC[j], e_SOH[j], e_T1[j], e_T[j],
+                                                    e_Ir[j], etat[j], consigne);
+            float I  = SOP_Table_eval(&table, etat[j], sens, e_SOC[j], e_T[j], e_Ir[j], e_SOH[j]);
+            float Ip = SOP_Table_eval_prudent(&table, etat[j], sens, e_SOC[j], e_T1[j], e_T[j],
+                                              e_Ir[j], e_SOH[j]);
+
+            float e = fabsf(I - exact_T1);
+            E->somme += e;
+            if (!(e <= E->max)) E->max = e;
+            E->somme_prudent += s * (exact_T1 - Ip);
+            float d = s * (Ip - exact_T1);
+            if (d > 0.0f) {
+                ++E->nb_depassements;
+                if (d > E->depassement) E->depassement = d;
+            }
+            float eT1 = fabsf(exact_T1 - exact);
+            if (!(eT1 <= E->ecart_T1)) E->ecart_T1 = eT1;
+        }
+    }
+
+    // Temps par évaluation : table (directe, prudente) et solveur exact
+    volatile float puits = 0.0f;
+    double t0 = Horloge_secondes();
+    for (size_t j = 0; j < n; ++j)
+        puits += SOP_Table_eval(&table, etat[j], SOP_SENS_DECHARGE,
+                                e_SOC[j], e_T[j], e_Ir[j], e_SOH[j]);
+    double t_table = Horloge_secondes() - t0;
+    t0 = Horloge_secondes();
+    for (size_t j = 0; j < n; ++j)
+        puits += SOP_Table_eval_prudent(&table, etat[j], SOP_SENS_DECHARGE,
+                                        e_SOC[j], e_T1[j], e_T[j], e_Ir[j], e_SOH[j]);
+    double t_prudent = Horloge_secondes() - t0;
+    t0 = Horloge_secondes();
+    for (size_t j = 0; j < n; ++j)
+        puits += SOP_courant_admissible(m, e_SOC[j], e_SOH[j], e_T1[j], e_T[j],
+                                        e_Ir[j], etat[j], m->param.I_max);
+    double t_exact = Horloge_secondes() - t0;
+
+    printf("Table SOP %s : %zu noeuds, rejeu de %zu echantillons (%zu hors grille, prudent a 0)\n",
+           chemin, table.nb_noeuds, n, hors_grille);
+    printf("Sens      | Ecart moyen | Ecart max  | Prudent : perte moy. | depassements | depassement max | Ecart T1 max\n");
+    printf("----------------------------------------------------------------------------------------------------\n");
+    for (int sens = 0; sens < SOP_TABLE_NB_SENS; ++sens) {
+        const Ecarts *E = &ecarts[sens];
+        printf("%-9s | %9.3e A | %.3e A | %18.3e A | %12zu | %13.3e A | %.3e A\n",
+               sens == SOP_SENS_DECHARGE ? "decharge" : "charge",
+               E->somme / (double)n, E->max, E->somme_prudent / (double)n,
+               E->nb_depassements, E->depassement, E->ecart_T1);
+    }
+    printf("\nTemps par evaluation : table %.1f ns | prudente %.1f ns | solveur exact %.2f us (x%.0f)\n",
+           1e9 * t_table / (double)n, 1e9 * t_prudent / (double)n,
+           1e6 * t_exact / (double)n, t_exact / t_table);
+
+    free(etats);
+    free(etat);
+    Free_donnees(courant, tension, temperature, SOH, SOC);
+    SOP_Table_fermer(&table);
+    return 0;
+}
+
+// ============================================================================
+// Balayage dense des mailles (mode prudent)
+// ============================================================================
+
+typedef struct
+{
+    size_t nb_points;
+    size_t nb_depassements;
+    size_t nb_mailles;              // mailles avec au moins un dépassement
+    float  depassement;             // plus grand dépassement (A)
+    float  x[SOP_TABLE_NB_AXES];    // où
+    float  dT1;
+    int    etat;
+} Balayage;
+
+static int balayage(const char *chemin, int n)
+{
+    if (n < 2) {
+        printf("Erreur : balayage de %d points par axe (au moins 2)\n", n);
+        return 1;
+    }
+
+    SOP_Table table;
+    const SOP_Modele *m = SOP_modele_defaut();
+    if (ouvrir_table(&table, chemin, m) != 0) return 1;
+    const SOP_Axe *axes = table.entete.axes;
+
+    // T1 - T2 : n points de [dT1_min, dT1_max], puis 0
+    float dT1[65];
+    int   nb_dT1 = (n < 64) ? n : 64;
+    for (int j = 0; j < nb_dT1; ++j)
+        dT1[j] = table.entete.dT1_min
+               + (float)j / (float)(nb_dT1 - 1) * (table.entete.dT1_max - table.entete.dT1_min);
+    dT1[nb_dT1++] = 0.0f;
+
+    size_t nb_sous_points = 1;
+    for (int d = 0; d < SOP_TABLE_NB_AXES; ++d) nb_sous_points *= (size_t)n;
+
+    Balayage B[SOP_TABLE_NB_SENS];
+    memset(B, 0, sizeof(B));
+
+    double t0 = Horloge_secondes();
+    for (size_t c = 0; c < table.nb_mailles; ++c) {
+        int touchee[SOP_TABLE_NB_SENS] = { 0, 0 };
+
+        for (size_t q = 0; q < nb_sous_points; ++q) {
+            float  x[SOP_TABLE_NB_AXES];
+            size_t r = q;
+            for (int d = 0; d < SOP_TABLE_NB_AXES; ++d) {
+                const SOP_Axe *axe = &axes[d];
+                float u = (float)((c / table.pas_maille[d]) % (axe->n - 1))
+                        + (float)(r % (size_t)n) / (float)(n - 1);
+                r /= (size_t)n;
+                x[d] = axe->min + u * (axe->max - axe->min) / (float)(axe->n - 1);
+                if (x[d] > axe->max) x[d] = axe->max;       // arrondi au bord
+            }
+
+            for (int k = 0; k < nb_dT1; ++k) {
+                const float T1 = x[SOP_AXE_T] + dT1[k];
+                for (int etat = 0; etat < 2; ++etat)
+                    for (int sens = 0; sens < SOP_TABLE_NB_SENS; ++sens) {
+                        Balayage *b = &B[sens];
+                        float s = (sens == SOP_SENS_DECHARGE) ? 1.0f : -1.0f;
+                        float exact = SOP_courant_admissible(m, x[SOP_AXE_SOC], x[SOP_AXE_SOH],
+                                                             T1, x[SOP_AXE_T], x[SOP_AXE_IR], etat,
+                                                             s > 0.0f ? m->param.I_max : m->param.I_min);
+                        float Ip = SOP_Table_eval_prudent(&table, etat, sens, x[SOP_AXE_SOC], T1,
+                                                          x[SOP_AXE_T], x[SOP_AXE_IR], x[SOP_AXE_SOH]);
+                        ++b->nb_points;
+                        float e = s * (Ip - exact);
+                        if (e > 0.0f) {
+                            ++b->nb_depassements;
+                            touchee[sens] = 1;
+                            if (e > b->depassement) {
+                                b->depassement = e;
+                                memcpy(b->x, x, sizeof(x));
+                                b->dT1  = dT1[k];
+                                b->etat = etat;
+                            }
+                        }
+                    }
+            }
+        }
+        for (int sens = 0; sens < SOP_TABLE_NB_SENS; ++sens) B[sens].nb_mailles += (size_t)touchee[sens];
+    }
+    double t_balayage = Horloge_secondes() - t0;
+
+    printf("Table SOP %s : balayage de %zu mailles, %d points par axe, %d valeurs de T1 - T2 (%.1f s)\n",
+           chemin, table.nb_mailles, n, nb_dT1, t_balayage);
+    printf("Sens      | points   | depassements | mailles | depassement max | SOC    T      Ir      SOH    T1-T2  etat\n");
+    printf("--------------------------------------------------------------------------------------------------------\n");
+    for (int sens = 0; sens < SOP_TABLE_NB_SENS; ++sens) {
+        const Balayage *b = &B[sens];
+        printf("%-9s | %8zu | %12zu | %7zu | %13.3e A",
+               sens == SOP_SENS_DECHARGE ? "decharge" : "charge",
+               b->nb_points, b->nb_depassements, b->nb_mailles, b->depassement);
+        if (b->nb_depassements)
+            printf(" | %.3f  %5.1f  %6.2f  %.3f  %5.1f  %d",
+                   b->x[SOP_AXE_SOC], b->x[SOP_AXE_T], b->x[SOP_AXE_IR], b->x[SOP_AXE_SOH],
+                   b->dT1, b->etat);
+        printf("\n");
+    }
+
+    SOP_Table_fermer(&table);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3) {
+        usage();
+        return 1;
+    }
+    if (strcmp(argv[1], "construire") == 0)
+        return construire(argv[2], argc - 3, argv + 3);
+    if (strcmp(argv[1], "rapport") == 0)
+        return rapport(argv[2], (argc > 3) ? (size_t)atol(argv[3]) : RAPPORT_ECHANTILLONS_DEFAUT);
+    if (strcmp(argv[1], "balayage") == 0)
+        return balayage(argv[2], (argc > 3) ? atoi(argv[3]) : BALAYAGE_POINTS_DEFAUT);
+    usage();
+    return 1;
+}